@@ -0,0 +1,158 @@
+#include "Benchmark.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "File/AssetArchive.h"
+#include "File/LZ4.h"
+#include "File/VirtualFileSystem.h"
+
+using namespace LIEngine;
+
+namespace {
+
+    // 小さなファイルを多数 (シェーダーやjson、小さなテクスチャを想定)
+    const size_t kNumFiles = 500;
+    const std::filesystem::path kDirectory = "ArchiveBenchmark";
+    const std::filesystem::path kArchivePath = "ArchiveBenchmark.pak";
+
+    // 半分は圧縮の効くテキスト風、半分は圧縮の効かない乱数
+    std::vector<uint8_t> MakeContent(size_t i, std::mt19937& random) {
+        size_t size = 256 + random() % (i % 50 == 0 ? 256 * 1024 : 8 * 1024);
+        std::vector<uint8_t> content(size);
+        if (i % 2 == 0) {
+            static const char kWords[][8] = { "float ", "return ", "Vector3", "{ ", "}\n", "0.5f, ", "name", "\"type\"" };
+            for (size_t j = 0; j < size; ++j) {
+                const char* word = kWords[(j / 7 + random() % 3) % 8];
+                content[j] = static_cast<uint8_t>(word[j % std::strlen(word)]);
+            }
+        }
+        else {
+            for (auto& byte : content) { byte = static_cast<uint8_t>(random()); }
+        }
+        return content;
+    }
+
+    std::filesystem::path MakePath(size_t i) {
+        return kDirectory / ("Sub" + std::to_string(i % 8)) / ("File" + std::to_string(i) + ".bin");
+    }
+
+    bool IsSame(const FileData& fileData, const std::vector<uint8_t>& content) {
+        return fileData.IsValid() && fileData.GetSize() == content.size() &&
+            (content.empty() || std::memcmp(fileData.GetData(), content.data(), content.size()) == 0);
+    }
+
+    // 圧縮して展開すると元に戻る、壊れた入力でもfalseを返すだけ
+    bool CheckLZ4(std::mt19937& random) {
+        bool isValid = true;
+        for (size_t i = 0; i < 64; ++i) {
+            std::vector<uint8_t> source = MakeContent(i, random);
+            // 0と端数の長さも試す
+            source.resize(i % 8 == 7 ? 0 : source.size() - i % 5);
+            std::vector<uint8_t> compressed(LZ4::CompressBound(source.size()));
+            size_t compressedSize = LZ4::Compress(source.data(), source.size(), compressed.data(), compressed.size());
+            std::vector<uint8_t> decompressed(source.size());
+            isValid &= compressedSize > 0 && LZ4::Decompress(compressed.data(), compressedSize, decompressed.data(), decompressed.size());
+            isValid &= decompressed == source;
+            // 長さ違い
+            if (!source.empty()) {
+                isValid &= !LZ4::Decompress(compressed.data(), compressedSize, decompressed.data(), decompressed.size() - 1);
+            }
+            // ランダムに壊す
+            for (size_t n = 0; n < 16 && compressedSize > 0; ++n) {
+                std::vector<uint8_t> corrupted(compressed.begin(), compressed.begin() + compressedSize);
+                corrupted[random() % corrupted.size()] = static_cast<uint8_t>(random());
+                LZ4::Decompress(corrupted.data(), random() % (corrupted.size() + 1), decompressed.data(), decompressed.size());
+            }
+        }
+        return isValid;
+    }
+
+}
+
+void RunArchiveBenchmark() {
+    std::mt19937 random(12345);
+    std::error_code errorCode;
+    std::filesystem::remove_all(kDirectory, errorCode);
+    std::vector<std::vector<uint8_t>> contents;
+    std::vector<std::filesystem::path> paths;
+    for (size_t i = 0; i < kNumFiles; ++i) {
+        contents.emplace_back(MakeContent(i, random));
+        paths.emplace_back(MakePath(i));
+        std::filesystem::create_directories(paths.back().parent_path(), errorCode);
+        std::ofstream file(paths.back(), std::ios::binary);
+        file.write(reinterpret_cast<const char*>(contents.back().data()), static_cast<std::streamsize>(contents.back().size()));
+    }
+
+    double ns = Benchmark::Measure(2, [&](size_t) {
+        AssetArchive::Build(kDirectory, kArchivePath);
+        });
+    Benchmark::Report("Archive", "Build 500 files", ns);
+
+    size_t looseSize = 0;
+    for (auto& content : contents) { looseSize += content.size(); }
+    size_t archiveSize = static_cast<size_t>(std::filesystem::file_size(kArchivePath, errorCode));
+    std::printf("[Archive] loose=%zuKB archive=%zuKB\n", looseSize / 1024, archiveSize / 1024);
+
+    // ディスクから
+    bool isLooseValid = true;
+    for (size_t i = 0; i < kNumFiles; ++i) {
+        FileData fileData;
+        isLooseValid &= VirtualFileSystem::ReadFile(paths[i], fileData) && IsSame(fileData, contents[i]);
+    }
+    ns = Benchmark::Measure(5, [&](size_t) {
+        for (auto& path : paths) {
+            FileData fileData;
+            VirtualFileSystem::ReadFile(path, fileData);
+            Benchmark::DoNotOptimize(fileData);
+        }
+        });
+    Benchmark::Report("Archive", "Read loose 500 files", ns);
+
+    // アーカイブから (大文字小文字と区切りが違っても引ける)
+    bool isMounted = VirtualFileSystem::Mount(kArchivePath);
+    bool isArchiveValid = isMounted;
+    for (size_t i = 0; i < kNumFiles; ++i) {
+        FileData fileData;
+        VirtualFileSystem::FileInfo fileInfo;
+        std::string upperPath = paths[i].generic_string();
+        for (auto& c : upperPath) { if (c >= 'a' && c <= 'z') { c = static_cast<char>(c - 'a' + 'A'); } }
+        isArchiveValid &= VirtualFileSystem::GetFileInfo(upperPath, fileInfo) && fileInfo.isInArchive && fileInfo.size == contents[i].size();
+        isArchiveValid &= VirtualFileSystem::ReadFile(upperPath, fileData) && IsSame(fileData, contents[i]);
+    }
+    // 無いものはディスクも探して無ければfalse
+    FileData missing;
+    isArchiveValid &= !VirtualFileSystem::ReadFile(kDirectory / "Missing.bin", missing) && !missing.IsValid();
+    ns = Benchmark::Measure(5, [&](size_t) {
+        for (auto& path : paths) {
+            FileData fileData;
+            VirtualFileSystem::ReadFile(path, fileData);
+            Benchmark::DoNotOptimize(fileData);
+        }
+        });
+    Benchmark::Report("Archive", "Read archive 500 files", ns);
+    VirtualFileSystem::UnmountAll();
+
+    std::vector<uint8_t> text = MakeContent(0, random);
+    text.resize(64 * 1024, ' ');
+    std::vector<uint8_t> compressed(LZ4::CompressBound(text.size()));
+    size_t compressedSize = 0;
+    ns = Benchmark::Measure(50, [&](size_t) {
+        compressedSize = LZ4::Compress(text.data(), text.size(), compressed.data(), compressed.size());
+        });
+    Benchmark::Report("Archive", "LZ4 compress 64KB", ns);
+    std::vector<uint8_t> decompressed(text.size());
+    ns = Benchmark::Measure(50, [&](size_t) {
+        LZ4::Decompress(compressed.data(), compressedSize, decompressed.data(), decompressed.size());
+        });
+    Benchmark::Report("Archive", "LZ4 decompress 64KB", ns);
+
+    std::printf("[Archive] loose=%s archive=%s lz4=%s\n", isLooseValid ? "ok" : "NG", isArchiveValid ? "ok" : "NG", CheckLZ4(random) ? "ok" : "NG");
+
+    std::filesystem::remove_all(kDirectory, errorCode);
+    std::filesystem::remove(kArchivePath, errorCode);
+}
@@ -0,0 +1,152 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// アセットの基底クラスがWindowsのヘッダーを使うので、Windows以外では実行しない
+#ifdef _WIN32
+
+#include "Framework/AssetMap.h"
+
+using namespace LIEngine;
+
+namespace {
+
+    // 表に入れるアセット数
+    const size_t kNumAssets = 2000;
+    // 同時に取得するスレッド数と、その間に追加と削除を繰り返す回数
+    const size_t kNumReaders = 3;
+    const size_t kNumChurns = 20000;
+
+    // 読み込まないアセット
+    class BenchmarkAsset : public Asset {
+    public:
+        explicit BenchmarkAsset(const std::string& name) { SetName(name); }
+#ifdef ENABLE_IMGUI
+        ThumbnailData GetThumbnail() override { return {}; }
+#endif // ENABLE_IMGUI
+    private:
+        void InternalLoad() override {}
+    };
+
+    std::string MakeName(size_t i) { return "Asset" + std::to_string(i); }
+
+    // 名前、ハンドル、削除、名前の変更、同じ名前
+    bool CheckMap() {
+        AssetMap<BenchmarkAsset> map;
+        auto a = std::make_shared<BenchmarkAsset>("A");
+        auto b = std::make_shared<BenchmarkAsset>("B");
+        auto a2 = std::make_shared<BenchmarkAsset>("A");
+        auto handleA = map.Add(a);
+        map.Add(b);
+        auto handleA2 = map.Add(a2);
+        bool isValid = map.Get("A") == a && map.Get(handleA2) == a2 && map.GetSize() == 3;
+        // 先に追加した方を消すと後の方が見つかる
+        map.Remove(handleA);
+        isValid &= map.Get(handleA) == nullptr && map.Get("A") == a2;
+        // 空いた場所を使いまわしても古いハンドルからは取得できない
+        auto c = std::make_shared<BenchmarkAsset>("C");
+        auto handleC = map.Add(c);
+        isValid &= map.Get(handleA) == nullptr && map.Get(handleC) == c;
+        map.Rename(*b, "D");
+        isValid &= map.Get("B") == nullptr && map.Get("D") == b && b->GetName() == "D";
+        map.Remove(b);
+        isValid &= map.Get("D") == nullptr && map.Get("Unknown") == nullptr && map.GetSize() == 2;
+        map.Clear();
+        isValid &= map.Get(handleC) == nullptr && map.Get("C") == nullptr && map.GetSize() == 0;
+        return isValid;
+    }
+
+    // 他のスレッドが追加と削除を繰り返している間に取得する
+    // 別の名前のアセットが返ればNG
+    bool CheckConcurrentReads() {
+        AssetMap<BenchmarkAsset> map;
+        std::vector<std::shared_ptr<BenchmarkAsset>> assets;
+        std::vector<AssetHandle<BenchmarkAsset>> handles;
+        for (size_t i = 0; i < kNumAssets; ++i) {
+            assets.emplace_back(std::make_shared<BenchmarkAsset>(MakeName(i)));
+            handles.emplace_back(map.Add(assets.back()));
+        }
+        std::atomic<bool> stop = false;
+        std::atomic<bool> isValid = true;
+        std::vector<std::thread> readers;
+        for (size_t r = 0; r < kNumReaders; ++r) {
+            readers.emplace_back([&, r]() {
+                std::vector<AssetName> names;
+                for (size_t i = 0; i < kNumAssets; ++i) { names.emplace_back(MakeName(i)); }
+                for (size_t i = r; !stop.load(std::memory_order_relaxed); i = (i + 7) % kNumAssets) {
+                    // 偶数番は消えないので必ず見つかる
+                    auto byName = map.Get(names[i]);
+                    auto byHandle = map.Get(handles[i]);
+                    if (i % 2 == 0 && (!byName || !byHandle)) { isValid = false; }
+                    if (byName && byName->GetName() != names[i].GetString()) { isValid = false; }
+                    if (byHandle && byHandle != assets[i]) { isValid = false; }
+                }
+                });
+        }
+        // 奇数番を消しては追加しなおす
+        for (size_t n = 0; n < kNumChurns; ++n) {
+            size_t i = (n * 2 + 1) % kNumAssets;
+            map.Remove(assets[i]);
+            map.Add(assets[i]);
+        }
+        stop = true;
+        for (auto& reader : readers) { reader.join(); }
+        return isValid;
+    }
+
+}
+
+void RunAssetBenchmark() {
+    std::vector<std::shared_ptr<BenchmarkAsset>> assets;
+    for (size_t i = 0; i < kNumAssets; ++i) {
+        assets.emplace_back(std::make_shared<BenchmarkAsset>(MakeName(i)));
+    }
+    std::vector<std::string> names;
+    for (size_t i = 0; i < kNumAssets; ++i) { names.emplace_back(MakeName(i)); }
+
+    // 以前の実装 (リストを名前で線形探索)
+    std::list<std::shared_ptr<BenchmarkAsset>> list(assets.begin(), assets.end());
+    double ns = Benchmark::Measure(20, [&](size_t) {
+        for (auto& name : names) {
+            auto iter = std::find_if(list.begin(), list.end(), [&](auto& asset) { return asset->GetName() == name; });
+            Benchmark::DoNotOptimize(iter);
+        }
+        });
+    Benchmark::Report("Asset", "Get by name linear list 2000", ns / double(kNumAssets));
+
+    AssetMap<BenchmarkAsset> map;
+    std::vector<AssetHandle<BenchmarkAsset>> handles;
+    for (auto& asset : assets) { handles.emplace_back(map.Add(asset)); }
+    std::vector<AssetName> internedNames;
+    for (auto& name : names) { internedNames.emplace_back(name); }
+
+    bool isFound = true;
+    ns = Benchmark::Measure(20, [&](size_t) {
+        for (size_t i = 0; i < kNumAssets; ++i) { isFound &= map.Get(names[i]) == assets[i]; }
+        });
+    Benchmark::Report("Asset", "Get by name hashed 2000", ns / double(kNumAssets));
+    ns = Benchmark::Measure(20, [&](size_t) {
+        for (size_t i = 0; i < kNumAssets; ++i) { isFound &= map.Get(internedNames[i]) == assets[i]; }
+        });
+    Benchmark::Report("Asset", "Get by interned name 2000", ns / double(kNumAssets));
+    ns = Benchmark::Measure(20, [&](size_t) {
+        for (size_t i = 0; i < kNumAssets; ++i) { isFound &= map.Get(handles[i]) == assets[i]; }
+        });
+    Benchmark::Report("Asset", "Get by handle 2000", ns / double(kNumAssets));
+
+    std::printf("[Asset] map lookup=%s semantics=%s concurrent=%s\n", isFound ? "ok" : "NG", CheckMap() ? "ok" : "NG", CheckConcurrentReads() ? "ok" : "NG");
+}
+
+#else
+
+void RunAssetBenchmark() {
+    std::printf("[Asset] skipped (Windows only)\n");
+}
+
+#endif // _WIN32
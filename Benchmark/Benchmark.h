@@ -0,0 +1,65 @@
+///
+/// ベンチマーク共通
+/// 
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Benchmark {
+
+    /// <summary>
+    /// 最適化で計算が消されないように値を逃がす
+    /// </summary>
+    /// <typeparam name="T"></typeparam>
+    /// <param name="value"></param>
+    template<typename T>
+    inline void DoNotOptimize(const T& value) {
+#if defined(_MSC_VER)
+        static const volatile void* volatile sink;
+        sink = &value;
+        _ReadWriteBarrier();
+#else
+        asm volatile("" : : "r"(&value) : "memory");
+#endif
+    }
+
+    /// <summary>
+    /// 1回あたりの時間(ナノ秒)を計測する
+    /// 一度ウォームアップしてから計測する
+    /// </summary>
+    /// <typeparam name="Func"></typeparam>
+    /// <param name="iterations">繰り返し回数</param>
+    /// <param name="func">計測する関数</param>
+    /// <returns>1回あたりのナノ秒</returns>
+    template<typename Func>
+    inline double Measure(size_t iterations, Func&& func) {
+        for (size_t i = 0; i < iterations / 10 + 1; ++i) {
+            func(i);
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            func(i);
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double, std::nano>(elapsed).count() / double(iterations);
+    }
+
+    /// <summary>
+    /// 結果を出力
+    /// </summary>
+    /// <param name="group">グループ名</param>
+    /// <param name="name">計測名</param>
+    /// <param name="nanoseconds">1回あたりのナノ秒</param>
+    inline void Report(const char* group, const std::string& name, double nanoseconds) {
+        std::printf("[%s] %-48s %12.3f ns\n", group, name.c_str(), nanoseconds);
+    }
+
+}
@@ -0,0 +1,628 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Math/Geometry.h"
+#include "Math/Random.h"
+#include "Collision/DynamicAABBTree.h"
+#include "Collision/SpatialHashGrid.h"
+#include "Framework/ThreadPool.h"
+
+using namespace LIEngine;
+
+namespace {
+
+    // 密度を一定に保つので1つあたりの重なり数はほぼ変わらない
+    const float kRadius = 0.5f;
+    const float kVolumePerSphere = 8.0f;
+    // 1フレームの移動量
+    const float kSpeed = 0.05f;
+    // これ以上の数は総当たりを計測しない
+    const size_t kMaxBruteForce = 5000;
+    // 視線や接地判定程度の長さ
+    const float kRayLength = 16.0f;
+
+    struct Scene {
+        std::vector<Math::Sphere> spheres;
+        std::vector<Vector3> velocities;
+        float extent;
+
+        Scene(size_t count, uint64_t seed) {
+            extent = std::cbrt(kVolumePerSphere * float(count));
+            Random::PCG32 random(seed);
+            spheres.resize(count);
+            velocities.resize(count);
+            for (size_t i = 0; i < count; ++i) {
+                spheres[i].center = {
+                    random.NextFloatRange(0.0f, extent),
+                    random.NextFloatRange(0.0f, extent),
+                    random.NextFloatRange(0.0f, extent) };
+                spheres[i].radius = kRadius;
+                velocities[i] = random.NextUnitVector() * kSpeed;
+            }
+        }
+
+        void Step() {
+            for (size_t i = 0; i < spheres.size(); ++i) {
+                Move(i);
+            }
+        }
+
+        void Move(size_t i) {
+            Vector3& center = spheres[i].center;
+            center += velocities[i];
+            // 範囲外に出たら跳ね返す
+            for (size_t d = 0; d < 3; ++d) {
+                float& velocity = velocities[i][d];
+                if ((center[d] < 0.0f && velocity < 0.0f) || (center[d] > extent && velocity > 0.0f)) { velocity = -velocity; }
+            }
+        }
+    };
+
+    Math::AABB GetBounds(const Math::Sphere& sphere) {
+        Vector3 radius(sphere.radius);
+        return { sphere.center - radius, sphere.center + radius };
+    }
+
+    void BruteForce(const Scene& scene, std::vector<std::pair<uint32_t, uint32_t>>& pairs) {
+        pairs.clear();
+        for (uint32_t i = 0; i < uint32_t(scene.spheres.size()); ++i) {
+            for (uint32_t j = i + 1; j < uint32_t(scene.spheres.size()); ++j) {
+                if (Math::IsCollision(scene.spheres[i], scene.spheres[j])) {
+                    pairs.emplace_back(i, j);
+                }
+            }
+        }
+    }
+
+    template<typename Broadphase>
+    void FindPairs(const Scene& scene, const Broadphase& broadphase, uint32_t begin, uint32_t end, std::vector<std::pair<uint32_t, uint32_t>>& pairs) {
+        for (uint32_t i = begin; i < end; ++i) {
+            broadphase.Query(GetBounds(scene.spheres[i]), [&](int32_t proxyId) {
+                uint32_t j = uint32_t(reinterpret_cast<uintptr_t>(broadphase.GetUserData(proxyId)));
+                if (j > i && Math::IsCollision(scene.spheres[i], scene.spheres[j])) {
+                    pairs.emplace_back(i, j);
+                }
+                return true;
+                });
+        }
+    }
+
+    template<typename Broadphase>
+    void UpdateProxies(const Scene& scene, Broadphase& broadphase, std::vector<int32_t>& proxies) {
+        if (proxies.empty()) {
+            for (uint32_t i = 0; i < uint32_t(scene.spheres.size()); ++i) {
+                proxies.emplace_back(broadphase.CreateProxy(GetBounds(scene.spheres[i]), reinterpret_cast<void*>(uintptr_t(i))));
+            }
+        }
+        else {
+            for (size_t i = 0; i < scene.spheres.size(); ++i) {
+                broadphase.MoveProxy(proxies[i], GetBounds(scene.spheres[i]));
+            }
+        }
+    }
+
+    // CollisionManager::CheckCollisionと同じ手順
+    void Broadphase(const Scene& scene, DynamicAABBTree& tree, std::vector<int32_t>& proxies, std::vector<std::pair<uint32_t, uint32_t>>& pairs) {
+        UpdateProxies(scene, tree, proxies);
+        pairs.clear();
+        FindPairs(scene, tree, 0, uint32_t(scene.spheres.size()), pairs);
+        std::sort(pairs.begin(), pairs.end());
+    }
+
+    // BroadphaseType::HashGridを選んだ時と同じ手順
+    void Broadphase(const Scene& scene, SpatialHashGrid& grid, std::vector<int32_t>& proxies, std::vector<std::pair<uint32_t, uint32_t>>& pairs, ThreadPool* threadPool) {
+        UpdateProxies(scene, grid, proxies);
+        grid.Update(threadPool);
+        pairs.clear();
+        FindPairs(scene, grid, 0, uint32_t(scene.spheres.size()), pairs);
+        std::sort(pairs.begin(), pairs.end());
+    }
+
+    // CollisionManager::CheckCollisionにスレッドプールを渡した時と同じ手順
+    // ブロードフェーズは更新済み
+    template<typename Broadphase>
+    void FindPairsParallel(const Scene& scene, const Broadphase& broadphase, ThreadPool& threadPool,
+        std::vector<std::vector<std::pair<uint32_t, uint32_t>>>& buffers, std::vector<std::pair<uint32_t, uint32_t>>& pairs) {
+        const uint32_t kChunkSize = 64;
+        uint32_t count = uint32_t(scene.spheres.size());
+        size_t numChunks = (count + kChunkSize - 1) / kChunkSize;
+        size_t numWorkers = std::min(threadPool.GetNumThreads() + 1, numChunks);
+        buffers.resize(std::max(buffers.size(), numWorkers));
+
+        threadPool.ParallelChunks(numWorkers, numChunks, [&](size_t chunk, size_t worker) {
+            uint32_t begin = uint32_t(chunk) * kChunkSize;
+            FindPairs(scene, broadphase, begin, std::min(count, begin + kChunkSize), buffers[worker]);
+            });
+
+        pairs.clear();
+        for (size_t i = 0; i < numWorkers; ++i) {
+            std::copy(buffers[i].begin(), buffers[i].end(), std::back_inserter(pairs));
+            buffers[i].clear();
+        }
+        std::sort(pairs.begin(), pairs.end());
+    }
+
+    // 線分と球が交差する位置の割合 (交差しなければ負)
+    float RayCastSphere(const Math::Sphere& sphere, const Vector3& origin, const Vector3& diff) {
+        Vector3 m = origin - sphere.center;
+        float a = Dot(diff, diff);
+        float b = Dot(m, diff);
+        float c = Dot(m, m) - sphere.radius * sphere.radius;
+        if (c > 0.0f && b > 0.0f) { return -1.0f; }
+        float discriminant = b * b - a * c;
+        if (discriminant < 0.0f) { return -1.0f; }
+        float t = std::max((-b - std::sqrt(discriminant)) / a, 0.0f);
+        return t <= 1.0f ? t : -1.0f;
+    }
+
+    struct Ray {
+        Vector3 origin;
+        Vector3 diff;
+    };
+
+    std::vector<Ray> MakeRays(const Scene& scene, size_t count) {
+        Random::PCG32 random(count);
+        std::vector<Ray> rays(count);
+        for (auto& ray : rays) {
+            ray.origin = {
+                random.NextFloatRange(0.0f, scene.extent),
+                random.NextFloatRange(0.0f, scene.extent),
+                random.NextFloatRange(0.0f, scene.extent) };
+            ray.diff = random.NextUnitVector() * kRayLength;
+        }
+        return rays;
+    }
+
+    // CollisionManager::RayCastの以前の実装と同じ手順
+    float RayCastLinear(const Scene& scene, const Ray& ray) {
+        float nearest = 1.1f;
+        for (auto& sphere : scene.spheres) {
+            float t = RayCastSphere(sphere, ray.origin, ray.diff);
+            if (t >= 0.0f && t < nearest) { nearest = t; }
+        }
+        return nearest <= 1.0f ? nearest : -1.0f;
+    }
+
+    template<typename Broadphase>
+    float RayCastTree(const Scene& scene, const Broadphase& broadphase, const Ray& ray, bool any) {
+        float nearest = 1.1f;
+        broadphase.RayCast(ray.origin, ray.diff, [&](int32_t proxyId, float maxFraction) {
+            uint32_t i = uint32_t(reinterpret_cast<uintptr_t>(broadphase.GetUserData(proxyId)));
+            float t = RayCastSphere(scene.spheres[i], ray.origin, ray.diff);
+            if (t < 0.0f || t >= nearest) { return maxFraction; }
+            nearest = t;
+            return any ? -1.0f : t;
+            });
+        return nearest <= 1.0f ? nearest : -1.0f;
+    }
+
+    // センサーのように数か所から扇状に飛ばすレイ (順番はばらばら)
+    std::vector<Ray> MakeSensorRays(const Scene& scene, size_t numSensors, size_t raysPerSensor) {
+        Random::PCG32 random(numSensors);
+        std::vector<Ray> rays;
+        for (size_t sensor = 0; sensor < numSensors; ++sensor) {
+            Vector3 origin = {
+                random.NextFloatRange(0.0f, scene.extent),
+                random.NextFloatRange(0.0f, scene.extent),
+                random.NextFloatRange(0.0f, scene.extent) };
+            Vector3 forward = random.NextUnitVector();
+            for (size_t i = 0; i < raysPerSensor; ++i) {
+                Vector3 direction = (forward + random.NextUnitVector() * 0.3f).Normalized();
+                rays.push_back({ origin, direction * kRayLength });
+            }
+        }
+        for (size_t i = rays.size() - 1; i > 0; --i) {
+            std::swap(rays[i], rays[random.NextUIntBounded(uint32_t(i + 1))]);
+        }
+        return rays;
+    }
+
+    uint32_t SpreadBits(uint32_t value) {
+        value &= 0x3FF;
+        value = (value | (value << 16)) & 0x030000FF;
+        value = (value | (value << 8)) & 0x0300F00F;
+        value = (value | (value << 4)) & 0x030C30C3;
+        value = (value | (value << 2)) & 0x09249249;
+        return value;
+    }
+
+    // CollisionManager::RayCastBatchと同じ並べ替え
+    void SortRays(const Scene& scene, const std::vector<Ray>& rays, std::vector<std::pair<uint64_t, uint32_t>>& keys, std::vector<uint32_t>& order) {
+        float scale = 1023.0f / scene.extent;
+        keys.resize(rays.size());
+        for (size_t i = 0; i < rays.size(); ++i) {
+            const Ray& ray = rays[i];
+            uint32_t octant = (ray.diff.x < 0.0f ? 1u : 0u) | (ray.diff.y < 0.0f ? 2u : 0u) | (ray.diff.z < 0.0f ? 4u : 0u);
+            Vector3 position = Vector3::Max(ray.origin, Vector3::zero) * scale;
+            uint32_t morton = SpreadBits(uint32_t(position.x)) | (SpreadBits(uint32_t(position.y)) << 1) | (SpreadBits(uint32_t(position.z)) << 2);
+            keys[i] = { (uint64_t(octant) << 30) | morton, uint32_t(i) };
+        }
+        std::sort(keys.begin(), keys.end());
+        order.resize(rays.size());
+        for (size_t i = 0; i < rays.size(); ++i) {
+            order[i] = keys[i].second;
+        }
+    }
+
+    void RayCastPackets(const Scene& scene, const DynamicAABBTree& tree, const std::vector<Ray>& rays, const std::vector<uint32_t>& order, std::vector<float>& results) {
+        constexpr size_t kPacketSize = DynamicAABBTree::kPacketSize;
+        results.resize(rays.size());
+        for (size_t packet = 0; packet < rays.size(); packet += kPacketSize) {
+            size_t count = std::min(kPacketSize, rays.size() - packet);
+            Vector3 origins[kPacketSize];
+            Vector3 diffs[kPacketSize];
+            float nearest[kPacketSize];
+            for (size_t lane = 0; lane < count; ++lane) {
+                origins[lane] = rays[order[packet + lane]].origin;
+                diffs[lane] = rays[order[packet + lane]].diff;
+                nearest[lane] = 1.1f;
+            }
+            tree.RayCastPacket(origins, diffs, count, [&](int32_t proxyId, size_t lane, float maxFraction) {
+                uint32_t i = uint32_t(reinterpret_cast<uintptr_t>(tree.GetUserData(proxyId)));
+                float t = RayCastSphere(scene.spheres[i], origins[lane], diffs[lane]);
+                if (t < 0.0f || t >= nearest[lane]) { return maxFraction; }
+                nearest[lane] = t;
+                return t;
+                });
+            for (size_t lane = 0; lane < count; ++lane) {
+                results[order[packet + lane]] = nearest[lane] <= 1.0f ? nearest[lane] : -1.0f;
+            }
+        }
+    }
+
+    // CollisionManager::CheckCollisionのペアキャッシュと同じ手順
+    // 動いたものだけツリーを調べ直し、動いたものを含むペアだけ判定し直す
+    struct PairCache {
+        struct Pair {
+            uint64_t key;
+            uint32_t sphere1;
+            uint32_t sphere2;
+            bool touching;
+            bool isNew;
+        };
+
+        DynamicAABBTree tree;
+        std::vector<int32_t> proxies;
+        std::vector<uint32_t> movedFrames;
+        std::vector<uint32_t> changedFrames;
+        std::vector<uint32_t> dirty;
+        std::vector<uint32_t> moved;
+        std::vector<Pair> pairs;
+        std::unordered_map<uint64_t, uint32_t> pairIndices;
+        std::vector<uint64_t> newPairs;
+        uint32_t frame = 1;
+
+        static uint64_t MakeKey(int32_t proxyId1, int32_t proxyId2) {
+            if (proxyId1 > proxyId2) { std::swap(proxyId1, proxyId2); }
+            return (uint64_t(uint32_t(proxyId1)) << 32) | uint32_t(proxyId2);
+        }
+        uint32_t GetSphere(int32_t proxyId) const { return uint32_t(reinterpret_cast<uintptr_t>(tree.GetUserData(proxyId))); }
+
+        // CollisionManager::UpdateBroadphaseと同じ手順 (RayCastからも呼ばれる)
+        void UpdateBroadphase(const Scene& scene) {
+            for (uint32_t i : dirty) {
+                changedFrames[i] = frame;
+                if (tree.MoveProxy(proxies[i], GetBounds(scene.spheres[i])) && movedFrames[i] != frame) {
+                    movedFrames[i] = frame;
+                    moved.emplace_back(i);
+                }
+            }
+            dirty.clear();
+        }
+
+        // changedは形状が変わった球
+        // dispatchはコールバックの代わりで、フレームを進めてから呼ぶ
+        template<typename Dispatch>
+        void Update(const Scene& scene, const std::vector<uint32_t>& changed, Dispatch&& dispatch) {
+            if (proxies.empty()) {
+                movedFrames.assign(scene.spheres.size(), 0);
+                changedFrames.assign(scene.spheres.size(), 0);
+                for (uint32_t i = 0; i < uint32_t(scene.spheres.size()); ++i) {
+                    proxies.emplace_back(tree.CreateProxy(GetBounds(scene.spheres[i]), reinterpret_cast<void*>(uintptr_t(i))));
+                    movedFrames[i] = frame;
+                    moved.emplace_back(i);
+                }
+            }
+            dirty.insert(dirty.end(), changed.begin(), changed.end());
+            UpdateBroadphase(scene);
+
+            if (!moved.empty()) {
+                for (size_t i = pairs.size(); i > 0; --i) {
+                    Pair& pair = pairs[i - 1];
+                    if (movedFrames[pair.sphere1] != frame && movedFrames[pair.sphere2] != frame) { continue; }
+                    if (tree.GetFatAABB(proxies[pair.sphere1]).Intersects(tree.GetFatAABB(proxies[pair.sphere2]))) { continue; }
+                    pairIndices.erase(pair.key);
+                    if (i != pairs.size()) {
+                        pair = pairs.back();
+                        pairIndices[pair.key] = uint32_t(i - 1);
+                    }
+                    pairs.pop_back();
+                }
+                newPairs.clear();
+                for (uint32_t i : moved) {
+                    tree.Query(tree.GetFatAABB(proxies[i]), [&](int32_t proxyId) {
+                        uint32_t j = GetSphere(proxyId);
+                        if (j == i || (movedFrames[j] == frame && proxyId < proxies[i])) { return true; }
+                        uint64_t key = MakeKey(proxies[i], proxyId);
+                        if (!pairIndices.contains(key)) { newPairs.emplace_back(key); }
+                        return true;
+                        });
+                }
+                std::sort(newPairs.begin(), newPairs.end());
+                newPairs.erase(std::unique(newPairs.begin(), newPairs.end()), newPairs.end());
+                for (uint64_t key : newPairs) {
+                    pairIndices.emplace(key, uint32_t(pairs.size()));
+                    pairs.push_back({ key, GetSphere(int32_t(key >> 32)), GetSphere(int32_t(key & 0xFFFFFFFF)), false, true });
+                }
+            }
+
+            for (auto& pair : pairs) {
+                if (pair.isNew || changedFrames[pair.sphere1] == frame || changedFrames[pair.sphere2] == frame) {
+                    pair.isNew = false;
+                    pair.touching = Math::IsCollision(scene.spheres[pair.sphere1], scene.spheres[pair.sphere2]);
+                }
+            }
+
+            moved.clear();
+            ++frame;
+            dispatch();
+        }
+        void Update(const Scene& scene, const std::vector<uint32_t>& changed) {
+            Update(scene, changed, []() {});
+        }
+
+        void GetTouching(std::vector<std::pair<uint32_t, uint32_t>>& touching) const {
+            touching.clear();
+            for (auto& pair : pairs) {
+                if (pair.touching) { touching.emplace_back(std::min(pair.sphere1, pair.sphere2), std::max(pair.sphere1, pair.sphere2)); }
+            }
+            std::sort(touching.begin(), touching.end());
+        }
+    };
+}
+
+void RunCollisionBenchmark() {
+    const size_t kCounts[] = { 100, 1000, 5000, 10000, 50000 };
+
+    std::vector<std::pair<uint32_t, uint32_t>> bruteForcePairs, treePairs, parallelPairs;
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> pairBuffers;
+    // 呼び出したスレッドも判定するので合計2,4,8スレッド
+    std::vector<std::unique_ptr<ThreadPool>> threadPools;
+    for (size_t workers : { 1, 3, 7 }) {
+        threadPools.emplace_back(std::make_unique<ThreadPool>(workers));
+    }
+
+    for (size_t count : kCounts) {
+        // 計測回数は数に応じて減らす
+        size_t iterations = std::max<size_t>(2, 200000 / count);
+
+        Scene scene(count, count);
+        DynamicAABBTree tree;
+        std::vector<int32_t> proxies;
+
+        // 数フレーム動かして同じペアが得られるか確認する
+        bool match = true;
+        if (count <= kMaxBruteForce) {
+            Scene check(count, count + 1);
+            DynamicAABBTree checkTree;
+            std::vector<int32_t> checkProxies;
+            for (size_t frame = 0; frame < 10; ++frame) {
+                check.Step();
+                BruteForce(check, bruteForcePairs);
+                Broadphase(check, checkTree, checkProxies, treePairs);
+                match &= bruteForcePairs == treePairs;
+            }
+        }
+
+        double ns = Benchmark::Measure(iterations, [&](size_t) {
+            scene.Step();
+            Broadphase(scene, tree, proxies, treePairs);
+            Benchmark::DoNotOptimize(treePairs.data());
+            });
+        std::printf("[Collision] n=%zu pairs=%zu height=%d match=%s\n",
+            count, treePairs.size(), tree.GetHeight(), count <= kMaxBruteForce ? (match ? "ok" : "NG") : "-");
+        Benchmark::Report("Collision", "DynamicAABBTree n=" + std::to_string(count), ns);
+
+        // 空間ハッシュグリッド
+        // セルの一辺は直径とその倍で比べる
+        for (float cellScale : { 1.0f, 2.0f }) {
+            SpatialHashGrid grid(kRadius * 2.0f * cellScale);
+            std::vector<int32_t> gridProxies;
+            std::vector<std::pair<uint32_t, uint32_t>> gridPairs;
+            Broadphase(scene, grid, gridProxies, gridPairs, nullptr);
+            bool gridRayMatch = true;
+            for (auto& ray : MakeRays(scene, 256)) {
+                gridRayMatch &= RayCastTree(scene, grid, ray, false) == RayCastTree(scene, tree, ray, false);
+            }
+            std::string suffix = " cell=" + std::to_string(int(cellScale)) + "d n=" + std::to_string(count);
+            std::printf("[Collision] grid%s entries=%zu match=%s ray match=%s\n",
+                suffix.c_str(), grid.GetNumCellEntries(), gridPairs == treePairs ? "ok" : "NG", gridRayMatch ? "ok" : "NG");
+
+            Scene gridScene(count, count);
+            ns = Benchmark::Measure(iterations, [&](size_t) {
+                gridScene.Step();
+                Broadphase(gridScene, grid, gridProxies, gridPairs, nullptr);
+                Benchmark::DoNotOptimize(gridPairs.data());
+                });
+            Benchmark::Report("Collision", "SpatialHashGrid" + suffix, ns);
+            // セルへの登録だけ並列にする
+            for (auto& threadPool : threadPools) {
+                ns = Benchmark::Measure(iterations, [&](size_t) {
+                    gridScene.Step();
+                    Broadphase(gridScene, grid, gridProxies, gridPairs, threadPool.get());
+                    Benchmark::DoNotOptimize(gridPairs.data());
+                    });
+                Benchmark::Report("Collision", "SpatialHashGrid " + std::to_string(threadPool->GetNumThreads() + 1) + " threads" + suffix, ns);
+            }
+        }
+
+        // 並列に判定してもペアと順番が変わらないか
+        // ツリーの更新は含まないので、比較用に判定だけの時間も測る
+        ns = Benchmark::Measure(iterations, [&](size_t) {
+            parallelPairs.clear();
+            FindPairs(scene, tree, 0, uint32_t(count), parallelPairs);
+            std::sort(parallelPairs.begin(), parallelPairs.end());
+            Benchmark::DoNotOptimize(parallelPairs.data());
+            });
+        Benchmark::Report("Collision", "Pairs serial n=" + std::to_string(count), ns);
+        for (auto& threadPool : threadPools) {
+            std::string label = "Pairs " + std::to_string(threadPool->GetNumThreads() + 1) + " threads n=" + std::to_string(count);
+            FindPairsParallel(scene, tree, *threadPool, pairBuffers, parallelPairs);
+            std::printf("[Collision] %s match=%s\n", label.c_str(), parallelPairs == treePairs ? "ok" : "NG");
+            ns = Benchmark::Measure(iterations, [&](size_t) {
+                FindPairsParallel(scene, tree, *threadPool, pairBuffers, parallelPairs);
+                Benchmark::DoNotOptimize(parallelPairs.data());
+                });
+            Benchmark::Report("Collision", label, ns);
+        }
+
+        // レイキャスト
+        const size_t kNumRays = 256;
+        std::vector<Ray> rays = MakeRays(scene, kNumRays);
+        bool rayMatch = true;
+        for (auto& ray : rays) {
+            float linear = RayCastLinear(scene, ray);
+            float closest = RayCastTree(scene, tree, ray, false);
+            float any = RayCastTree(scene, tree, ray, true);
+            rayMatch &= linear == closest && (linear < 0.0f) == (any < 0.0f);
+        }
+        std::printf("[Collision] n=%zu ray match=%s\n", count, rayMatch ? "ok" : "NG");
+        ns = Benchmark::Measure(iterations, [&](size_t) {
+            float sum = 0.0f;
+            for (auto& ray : rays) { sum += RayCastTree(scene, tree, ray, false); }
+            Benchmark::DoNotOptimize(sum);
+            });
+        Benchmark::Report("Collision", "RayCast closest x256 n=" + std::to_string(count), ns);
+        ns = Benchmark::Measure(iterations, [&](size_t) {
+            float sum = 0.0f;
+            for (auto& ray : rays) { sum += RayCastTree(scene, tree, ray, true); }
+            Benchmark::DoNotOptimize(sum);
+            });
+        Benchmark::Report("Collision", "RayCast any x256 n=" + std::to_string(count), ns);
+
+        // まとめてレイキャスト
+        std::vector<Ray> sensorRays = MakeSensorRays(scene, 32, 32);
+        std::vector<std::pair<uint64_t, uint32_t>> rayKeys;
+        std::vector<uint32_t> rayOrder;
+        std::vector<float> packetResults;
+        SortRays(scene, sensorRays, rayKeys, rayOrder);
+        RayCastPackets(scene, tree, sensorRays, rayOrder, packetResults);
+        bool packetMatch = true;
+        for (size_t i = 0; i < sensorRays.size(); ++i) {
+            packetMatch &= packetResults[i] == RayCastTree(scene, tree, sensorRays[i], false);
+        }
+        std::printf("[Collision] n=%zu packet match=%s (%zu lanes)\n", count, packetMatch ? "ok" : "NG", DynamicAABBTree::kPacketSize);
+        ns = Benchmark::Measure(iterations, [&](size_t) {
+            float sum = 0.0f;
+            for (auto& ray : sensorRays) { sum += RayCastTree(scene, tree, ray, false); }
+            Benchmark::DoNotOptimize(sum);
+            });
+        Benchmark::Report("Collision", "Sensor rays one by one x1024 n=" + std::to_string(count), ns);
+        ns = Benchmark::Measure(iterations, [&](size_t) {
+            SortRays(scene, sensorRays, rayKeys, rayOrder);
+            RayCastPackets(scene, tree, sensorRays, rayOrder, packetResults);
+            Benchmark::DoNotOptimize(packetResults.data());
+            });
+        Benchmark::Report("Collision", "Sensor rays sorted packets x1024 n=" + std::to_string(count), ns);
+
+        if (count <= kMaxBruteForce) {
+            ns = Benchmark::Measure(std::max<size_t>(2, iterations / 10), [&](size_t) {
+                float sum = 0.0f;
+                for (auto& ray : rays) { sum += RayCastLinear(scene, ray); }
+                Benchmark::DoNotOptimize(sum);
+                });
+            Benchmark::Report("Collision", "RayCast linear x256 n=" + std::to_string(count), ns);
+
+            ns = Benchmark::Measure(std::max<size_t>(2, iterations / 10), [&](size_t) {
+                scene.Step();
+                BruteForce(scene, bruteForcePairs);
+                Benchmark::DoNotOptimize(bruteForcePairs.data());
+                });
+            Benchmark::Report("Collision", "BruteForce n=" + std::to_string(count), ns);
+        }
+    }
+
+    // ほとんどが止まっているシーン
+    // 毎フレーム全部のペアを探し直す場合と、ペアを保持して動いたものだけ調べ直す場合
+    const size_t kStaticCount = 10000;
+    const size_t kMovingPerFrame = kStaticCount / 50;
+    for (size_t moving : { kMovingPerFrame, size_t(0) }) {
+        Scene scene(kStaticCount, 3);
+        DynamicAABBTree tree;
+        std::vector<int32_t> proxies;
+        PairCache cache;
+        std::vector<uint32_t> changed;
+        std::vector<std::pair<uint32_t, uint32_t>> cachePairs;
+        Random::PCG32 random(5);
+        auto step = [&]() {
+            changed.clear();
+            for (size_t i = 0; i < moving; ++i) {
+                uint32_t index = random.NextUIntRange(0, uint32_t(kStaticCount - 1));
+                scene.Move(index);
+                changed.emplace_back(index);
+            }
+            };
+
+        bool match = true;
+        for (size_t frame = 0; frame < 30; ++frame) {
+            step();
+            Broadphase(scene, tree, proxies, treePairs);
+            cache.Update(scene, changed);
+            cache.GetTouching(cachePairs);
+            match &= cachePairs == treePairs;
+        }
+        std::printf("[Collision] static n=%zu moving=%zu cached pairs=%zu match=%s\n",
+            kStaticCount, moving, cache.pairs.size(), match ? "ok" : "NG");
+
+        // コールバックの中で動かしてレイキャストしても、次のチェックで調べ直される
+        if (moving > 0) {
+            bool callbackMatch = true;
+            for (size_t frame = 0; frame < 30; ++frame) {
+                step();
+                Broadphase(scene, tree, proxies, treePairs);
+                cache.Update(scene, changed, [&]() {
+                    for (size_t i = 0; i < moving / 4; ++i) {
+                        uint32_t index = random.NextUIntRange(0, uint32_t(kStaticCount - 1));
+                        // 大きく動かして新しいペアを作る
+                        for (size_t n = 0; n < 20; ++n) { scene.Move(index); }
+                        cache.dirty.emplace_back(index);
+                        cache.UpdateBroadphase(scene);
+                        Ray ray{ scene.spheres[index].center, scene.velocities[index] * 100.0f };
+                        float hit = RayCastTree(scene, cache.tree, ray, false);
+                        callbackMatch &= hit == RayCastLinear(scene, ray);
+                    }
+                    });
+                cache.GetTouching(cachePairs);
+                callbackMatch &= cachePairs == treePairs;
+            }
+            // 最後のコールバックで動いた分
+            changed.clear();
+            Broadphase(scene, tree, proxies, treePairs);
+            cache.Update(scene, changed);
+            cache.GetTouching(cachePairs);
+            callbackMatch &= cachePairs == treePairs;
+            std::printf("[Collision] move and raycast in callback match=%s\n", callbackMatch ? "ok" : "NG");
+        }
+
+        std::string suffix = " moving=" + std::to_string(moving) + " n=" + std::to_string(kStaticCount);
+        double ns = Benchmark::Measure(20, [&](size_t) {
+            step();
+            Broadphase(scene, tree, proxies, treePairs);
+            Benchmark::DoNotOptimize(treePairs.data());
+            });
+        Benchmark::Report("Collision", "Rediscover all pairs" + suffix, ns);
+        ns = Benchmark::Measure(200, [&](size_t) {
+            step();
+            cache.Update(scene, changed);
+            Benchmark::DoNotOptimize(cache.pairs.data());
+            });
+        Benchmark::Report("Collision", "Pair cache" + suffix, ns);
+    }
+}
@@ -0,0 +1,264 @@
+#include "Benchmark.h"
+
+#include <cmath>
+#include <vector>
+
+#if __has_include(<DirectXMath.h>)
+#include <DirectXMath.h>
+#define BENCHMARK_HAS_DIRECTXMATH 1
+#endif
+
+#include "Math/MathUtils.h"
+#include "Math/BatchTransform.h"
+#include "Math/Camera.h"
+#include "Math/Culling.h"
+
+using namespace LIEngine;
+
+namespace {
+
+    const size_t kNumMatrices = 1024;
+    const size_t kIterations = 4000000;
+
+    std::vector<Matrix4x4> CreateMatrices() {
+        std::vector<Matrix4x4> matrices(kNumMatrices);
+        for (size_t i = 0; i < kNumMatrices; ++i) {
+            float t = float(i);
+            matrices[i] = Matrix4x4::MakeAffineTransform(
+                { 1.0f + std::fmod(t, 3.0f), 1.0f, 2.0f - std::fmod(t, 1.5f) },
+                Quaternion::MakeFromEulerAngle({ t * 0.1f, t * 0.2f, t * 0.3f }),
+                { t, -t, t * 0.5f });
+        }
+        return matrices;
+    }
+
+    // バックエンドがスカラー実装と一致しているか確認する
+    float MaxError(const float lhs[4][4], const float rhs[4][4]) {
+        float error = 0.0f;
+        for (size_t i = 0; i < 4; ++i) {
+            for (size_t j = 0; j < 4; ++j) {
+                float scale = std::max(1.0f, std::abs(lhs[i][j]));
+                error = std::max(error, std::abs(lhs[i][j] - rhs[i][j]) / scale);
+            }
+        }
+        return error;
+    }
+
+    const size_t kNumPoints = 4096;
+    const size_t kBatchIterations = 2000;
+
+    void MeasureBatchTransform(const std::vector<Matrix4x4>& matrices) {
+        std::vector<Vector3> points(kNumPoints);
+        Math::Vector3SoA soaPoints(kNumPoints);
+        Math::AABBSoA soaAABBs;
+        std::vector<Math::AABB> aabbs(kNumPoints);
+        soaAABBs.Resize(kNumPoints);
+        for (size_t i = 0; i < kNumPoints; ++i) {
+            float t = float(i);
+            points[i] = { std::sin(t), std::cos(t * 0.7f), t * 0.01f };
+            soaPoints.Set(i, points[i]);
+            aabbs[i] = { points[i] - Vector3(0.5f), points[i] + Vector3(1.0f) };
+            soaAABBs.Set(i, aabbs[i]);
+        }
+
+        // 一括変換が1点ずつの変換と一致しているか確認する
+        {
+            Math::Vector3SoA transformed;
+            Math::TransformPoints(matrices[1], soaPoints, transformed);
+            Math::AABBSoA transformedAABBs;
+            Math::TransformAABBs(matrices[1], soaAABBs, transformedAABBs);
+            float error = 0.0f;
+            for (size_t i = 0; i < kNumPoints; ++i) {
+                error = std::max(error, (transformed.Get(i) - points[i] * matrices[1]).Length());
+                Math::AABB expected = Math::TransformAABB(matrices[1], aabbs[i]);
+                error = std::max(error, (transformedAABBs.Get(i).min - expected.min).Length());
+                error = std::max(error, (transformedAABBs.Get(i).max - expected.max).Length());
+            }
+            std::printf("[Math] max error of batch transform: %g\n", error);
+        }
+
+        std::vector<Vector3> outPoints(kNumPoints);
+        Math::Vector3SoA outSoA(kNumPoints);
+        double ns = Benchmark::Measure(kBatchIterations, [&](size_t i) {
+            const Matrix4x4& matrix = matrices[i % kNumMatrices];
+            for (size_t p = 0; p < kNumPoints; ++p) {
+                outPoints[p] = points[p] * matrix;
+            }
+            Benchmark::DoNotOptimize(outPoints[0]);
+            });
+        Benchmark::Report("Math", "TransformPoints per point (x4096)", ns);
+        ns = Benchmark::Measure(kBatchIterations, [&](size_t i) {
+            Math::TransformPoints(matrices[i % kNumMatrices], soaPoints, outSoA);
+            Benchmark::DoNotOptimize(outSoA.x[0]);
+            });
+        Benchmark::Report("Math", std::string("TransformPoints SoA ") + SIMD::kBackendName + " (x4096)", ns);
+
+        std::vector<Math::AABB> outAABBs(kNumPoints);
+        Math::AABBSoA outSoAAABBs;
+        outSoAAABBs.Resize(kNumPoints);
+        ns = Benchmark::Measure(kBatchIterations, [&](size_t i) {
+            const Matrix4x4& matrix = matrices[i % kNumMatrices];
+            for (size_t p = 0; p < kNumPoints; ++p) {
+                outAABBs[p] = Math::TransformAABB(matrix, aabbs[p]);
+            }
+            Benchmark::DoNotOptimize(outAABBs[0]);
+            });
+        Benchmark::Report("Math", "TransformAABB per box (x4096)", ns);
+        ns = Benchmark::Measure(kBatchIterations, [&](size_t i) {
+            Math::TransformAABBs(matrices[i % kNumMatrices], soaAABBs, outSoAAABBs);
+            Benchmark::DoNotOptimize(outSoAAABBs.min.x[0]);
+            });
+        Benchmark::Report("Math", std::string("TransformAABBs SoA ") + SIMD::kBackendName + " (x4096)", ns);
+
+        std::vector<Matrix4x4> outMatrices(kNumMatrices);
+        ns = Benchmark::Measure(kBatchIterations, [&](size_t i) {
+            Math::MultiplyMatrices(matrices.data(), matrices[i % kNumMatrices], outMatrices.data(), kNumMatrices);
+            Benchmark::DoNotOptimize(outMatrices[0]);
+            });
+        Benchmark::Report("Math", "MultiplyMatrices (x1024)", ns);
+    }
+
+    // スキニングのパレット更新と同じ計算を4x4と3x4で比較する
+    void MeasureAffine(const std::vector<Matrix4x4>& matrices) {
+        std::vector<Matrix3x4> affineMatrices(matrices.size());
+        for (size_t i = 0; i < matrices.size(); ++i) {
+            affineMatrices[i] = Matrix3x4(matrices[i]);
+        }
+
+        double ns = Benchmark::Measure(kIterations, [&](size_t i) {
+            Matrix4x4 result = matrices[i % kNumMatrices].Inverse().Transpose();
+            Benchmark::DoNotOptimize(result);
+            });
+        Benchmark::Report("Math", "Matrix4x4 Inverse().Transpose()", ns);
+        ns = Benchmark::Measure(kIterations, [&](size_t i) {
+            Matrix3x4 result = affineMatrices[i % kNumMatrices].InverseTranspose();
+            Benchmark::DoNotOptimize(result);
+            });
+        Benchmark::Report("Math", "Matrix3x4 InverseTranspose", ns);
+        ns = Benchmark::Measure(kIterations, [&](size_t i) {
+            Matrix3x4 result = affineMatrices[i % kNumMatrices].Inverse();
+            Benchmark::DoNotOptimize(result);
+            });
+        Benchmark::Report("Math", "Matrix3x4 Inverse", ns);
+        ns = Benchmark::Measure(kIterations, [&](size_t i) {
+            Matrix3x4 result = affineMatrices[i % kNumMatrices].InverseOrthonormal();
+            Benchmark::DoNotOptimize(result);
+            });
+        Benchmark::Report("Math", "Matrix3x4 InverseOrthonormal", ns);
+        ns = Benchmark::Measure(kIterations, [&](size_t i) {
+            Matrix3x4 result = affineMatrices[i % kNumMatrices] * affineMatrices[(i + 1) % kNumMatrices];
+            Benchmark::DoNotOptimize(result);
+            });
+        Benchmark::Report("Math", "Matrix3x4 Multiply", ns);
+    }
+
+    void MeasureCulling() {
+        const size_t kNumBoxes = 16384;
+        Camera camera;
+        camera.SetPosition({ 0.0f, 10.0f, -50.0f });
+        camera.SetRotate(Quaternion::MakeFromEulerAngle({ 0.2f, 0.5f, 0.0f }));
+        camera.UpdateMatrices();
+
+        std::vector<Math::AABB> boxes(kNumBoxes);
+        Math::AABBSoA soaBoxes;
+        for (size_t i = 0; i < kNumBoxes; ++i) {
+            float t = float(i);
+            Vector3 center = { std::fmod(t * 7.3f, 400.0f) - 200.0f, std::fmod(t * 3.1f, 60.0f) - 30.0f, std::fmod(t * 11.7f, 400.0f) - 200.0f };
+            Vector3 extent = { 1.0f + std::fmod(t, 4.0f), 1.0f, 1.0f + std::fmod(t, 3.0f) };
+            boxes[i] = { center - extent, center + extent };
+            soaBoxes.PushBack(boxes[i]);
+        }
+
+        std::vector<uint8_t> visible;
+        size_t numVisible = Math::CullAABBs(camera.GetFrustum(), soaBoxes, visible);
+        size_t mismatch = 0;
+        for (size_t i = 0; i < kNumBoxes; ++i) {
+            mismatch += Math::IsCollision(camera.GetFrustum(), boxes[i]) != bool(visible[i]) ? 1 : 0;
+        }
+        std::printf("[Math] frustum culling: %zu / %zu visible, %zu mismatch\n", numVisible, kNumBoxes, mismatch);
+
+        double ns = Benchmark::Measure(kBatchIterations, [&](size_t) {
+            for (size_t i = 0; i < kNumBoxes; ++i) {
+                visible[i] = Math::IsCollision(camera.GetFrustum(), boxes[i]) ? 1 : 0;
+            }
+            Benchmark::DoNotOptimize(visible[0]);
+            });
+        Benchmark::Report("Math", "Frustum vs AABB per box (x16384)", ns);
+        ns = Benchmark::Measure(kBatchIterations, [&](size_t) {
+            Math::CullAABBs(camera.GetFrustum(), soaBoxes, visible);
+            Benchmark::DoNotOptimize(visible[0]);
+            });
+        Benchmark::Report("Math", std::string("CullAABBs SoA ") + SIMD::kBackendName + " (x16384)", ns);
+    }
+
+    template<typename Func>
+    void MeasureMultiply(const std::vector<Matrix4x4>& matrices, const char* name, Func func) {
+        double ns = Benchmark::Measure(kIterations, [&](size_t i) {
+            Matrix4x4 result;
+            func(matrices[i % kNumMatrices].m, matrices[(i + 1) % kNumMatrices].m, result.m);
+            Benchmark::DoNotOptimize(result);
+            });
+        Benchmark::Report("Math", std::string("Matrix4x4 Multiply ") + name, ns);
+    }
+
+    template<typename Func>
+    void MeasureInverse(const std::vector<Matrix4x4>& matrices, const char* name, Func func) {
+        double ns = Benchmark::Measure(kIterations, [&](size_t i) {
+            Matrix4x4 result;
+            func(matrices[i % kNumMatrices].m, result.m);
+            Benchmark::DoNotOptimize(result);
+            });
+        Benchmark::Report("Math", std::string("Matrix4x4 Inverse ") + name, ns);
+    }
+
+}
+
+void RunMathBenchmark() {
+    auto matrices = CreateMatrices();
+
+    std::printf("[Math] SIMD backend: %s\n", SIMD::kBackendName);
+    {
+        float multiplyError = 0.0f;
+        float inverseError = 0.0f;
+        for (size_t i = 0; i < kNumMatrices; ++i) {
+            float expected[4][4], actual[4][4];
+            SIMD::Scalar::MultiplyMatrix4x4(matrices[i].m, matrices[(i + 1) % kNumMatrices].m, expected);
+            SIMD::MultiplyMatrix4x4(matrices[i].m, matrices[(i + 1) % kNumMatrices].m, actual);
+            multiplyError = std::max(multiplyError, MaxError(expected, actual));
+            SIMD::Scalar::InverseMatrix4x4(matrices[i].m, expected);
+            SIMD::InverseMatrix4x4(matrices[i].m, actual);
+            inverseError = std::max(inverseError, MaxError(expected, actual));
+        }
+        std::printf("[Math] max relative error vs scalar: multiply %g, inverse %g\n", multiplyError, inverseError);
+    }
+
+    MeasureMultiply(matrices, "Scalar", SIMD::Scalar::MultiplyMatrix4x4);
+#if defined(LIENGINE_SIMD_SSE)
+    MeasureMultiply(matrices, "SSE", SIMD::SSE::MultiplyMatrix4x4);
+#endif
+#if defined(LIENGINE_SIMD_AVX2)
+    MeasureMultiply(matrices, "AVX2", SIMD::AVX2::MultiplyMatrix4x4);
+#endif
+#if defined(BENCHMARK_HAS_DIRECTXMATH)
+    MeasureMultiply(matrices, "DirectXMath", [](const float lhs[4][4], const float rhs[4][4], float result[4][4]) {
+        DirectX::XMMATRIX l = DirectX::XMLoadFloat4x4(reinterpret_cast<const DirectX::XMFLOAT4X4*>(lhs));
+        DirectX::XMMATRIX r = DirectX::XMLoadFloat4x4(reinterpret_cast<const DirectX::XMFLOAT4X4*>(rhs));
+        DirectX::XMStoreFloat4x4(reinterpret_cast<DirectX::XMFLOAT4X4*>(result), DirectX::XMMatrixMultiply(l, r));
+        });
+#endif
+
+    MeasureInverse(matrices, "Scalar", SIMD::Scalar::InverseMatrix4x4);
+#if defined(LIENGINE_SIMD_SSE)
+    MeasureInverse(matrices, "SSE", SIMD::SSE::InverseMatrix4x4);
+#endif
+#if defined(BENCHMARK_HAS_DIRECTXMATH)
+    MeasureInverse(matrices, "DirectXMath", [](const float m[4][4], float result[4][4]) {
+        DirectX::XMMATRIX matrix = DirectX::XMLoadFloat4x4(reinterpret_cast<const DirectX::XMFLOAT4X4*>(m));
+        DirectX::XMStoreFloat4x4(reinterpret_cast<DirectX::XMFLOAT4X4*>(result), DirectX::XMMatrixInverse(nullptr, matrix));
+        });
+#endif
+
+    MeasureAffine(matrices);
+    MeasureBatchTransform(matrices);
+    MeasureCulling();
+}
@@ -0,0 +1,195 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "Math/Geometry.h"
+#include "Math/Random.h"
+#include "Collision/MeshBVH.h"
+
+using namespace LIEngine;
+
+namespace {
+
+    // 起伏のある地面と柱 (部屋やステージ程度の三角形数)
+    const uint32_t kGridSize = 256;
+    const float kGridSpacing = 0.25f;
+    const size_t kNumPillars = 64;
+    const size_t kNumQueries = 1024;
+    // 総当たりと比べる数
+    const size_t kNumChecks = 128;
+
+    struct Mesh {
+        std::vector<Vector3> positions;
+        std::vector<uint32_t> indices;
+    };
+
+    void AddBox(Mesh& mesh, const Vector3& min, const Vector3& max) {
+        uint32_t base = uint32_t(mesh.positions.size());
+        for (uint32_t i = 0; i < 8; ++i) {
+            mesh.positions.push_back({ (i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z });
+        }
+        const uint32_t kFaces[6][4] = { { 0, 2, 6, 4 }, { 1, 5, 7, 3 }, { 0, 4, 5, 1 }, { 2, 3, 7, 6 }, { 0, 1, 3, 2 }, { 4, 6, 7, 5 } };
+        for (auto& face : kFaces) {
+            for (uint32_t index : { face[0], face[1], face[2], face[0], face[2], face[3] }) {
+                mesh.indices.push_back(base + index);
+            }
+        }
+    }
+
+    Mesh MakeLevel(Random::PCG32& random) {
+        Mesh mesh;
+        for (uint32_t z = 0; z <= kGridSize; ++z) {
+            for (uint32_t x = 0; x <= kGridSize; ++x) {
+                float height = std::sin(float(x) * 0.1f) * std::cos(float(z) * 0.13f) * 1.5f;
+                mesh.positions.push_back({ float(x) * kGridSpacing, height, float(z) * kGridSpacing });
+            }
+        }
+        for (uint32_t z = 0; z < kGridSize; ++z) {
+            for (uint32_t x = 0; x < kGridSize; ++x) {
+                uint32_t i0 = z * (kGridSize + 1) + x;
+                uint32_t i1 = i0 + 1;
+                uint32_t i2 = i0 + kGridSize + 1;
+                uint32_t i3 = i2 + 1;
+                for (uint32_t index : { i0, i2, i1, i1, i2, i3 }) {
+                    mesh.indices.push_back(index);
+                }
+            }
+        }
+        float extent = float(kGridSize) * kGridSpacing;
+        for (size_t i = 0; i < kNumPillars; ++i) {
+            Vector3 position = { random.NextFloatRange(0.0f, extent), -2.0f, random.NextFloatRange(0.0f, extent) };
+            AddBox(mesh, position, position + Vector3(random.NextFloatRange(0.5f, 2.0f), random.NextFloatRange(2.0f, 8.0f), random.NextFloatRange(0.5f, 2.0f)));
+        }
+        return mesh;
+    }
+
+    // 総当たり (比較用)
+    float RayCastBruteForce(const Mesh& mesh, const Vector3& origin, const Vector3& diff) {
+        float nearest = -1.0f;
+        for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+            const Vector3& v0 = mesh.positions[mesh.indices[i + 0]];
+            Vector3 edge1 = mesh.positions[mesh.indices[i + 1]] - v0;
+            Vector3 edge2 = mesh.positions[mesh.indices[i + 2]] - v0;
+            Vector3 p = Cross(diff, edge2);
+            float determinant = Dot(edge1, p);
+            if (determinant == 0.0f) { continue; }
+            float inverseDeterminant = 1.0f / determinant;
+            Vector3 s = origin - v0;
+            float u = Dot(s, p) * inverseDeterminant;
+            if (u < 0.0f || u > 1.0f) { continue; }
+            Vector3 q = Cross(s, edge1);
+            float v = Dot(diff, q) * inverseDeterminant;
+            if (v < 0.0f || u + v > 1.0f) { continue; }
+            float t = Dot(edge2, q) * inverseDeterminant;
+            if (t >= 0.0f && t <= 1.0f && (nearest < 0.0f || t < nearest)) { nearest = t; }
+        }
+        return nearest;
+    }
+
+    float DistanceToSegment(const Vector3& point, const Vector3& start, const Vector3& end) {
+        Vector3 diff = end - start;
+        float t = std::clamp(Dot(point - start, diff) / diff.LengthSquare(), 0.0f, 1.0f);
+        return (start + diff * t - point).Length();
+    }
+
+    // 面に下ろした点が内側なら面との距離、外側なら辺との距離 (比較用)
+    float DistanceBruteForce(const Mesh& mesh, const Vector3& point) {
+        float minDistance = FLT_MAX;
+        for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+            const Vector3& v0 = mesh.positions[mesh.indices[i + 0]];
+            const Vector3& v1 = mesh.positions[mesh.indices[i + 1]];
+            const Vector3& v2 = mesh.positions[mesh.indices[i + 2]];
+            Vector3 normal = Cross(v1 - v0, v2 - v0).Normalized();
+            float planeDistance = Dot(point - v0, normal);
+            Vector3 projected = point - normal * planeDistance;
+            bool inside =
+                Dot(Cross(v1 - v0, projected - v0), normal) >= 0.0f &&
+                Dot(Cross(v2 - v1, projected - v1), normal) >= 0.0f &&
+                Dot(Cross(v0 - v2, projected - v2), normal) >= 0.0f;
+            float distance = inside ? std::abs(planeDistance) :
+                std::min({ DistanceToSegment(point, v0, v1), DistanceToSegment(point, v1, v2), DistanceToSegment(point, v2, v0) });
+            minDistance = std::min(minDistance, distance);
+        }
+        return minDistance;
+    }
+
+}
+
+void RunMeshBVHBenchmark() {
+    Random::PCG32 random(11);
+    Mesh mesh = MakeLevel(random);
+
+    std::unique_ptr<MeshBVH> bvh;
+    double ns = Benchmark::Measure(3, [&](size_t) {
+        bvh = std::make_unique<MeshBVH>(mesh.positions, mesh.indices);
+        });
+    std::printf("[MeshBVH] triangles=%zu nodes=%zu\n", bvh->GetNumTriangles(), bvh->GetNumNodes());
+    Benchmark::Report("MeshBVH", "Build", ns);
+
+    // 上から見下ろすレイと水平なレイ
+    float extent = float(kGridSize) * kGridSpacing;
+    std::vector<Vector3> origins(kNumQueries), diffs(kNumQueries);
+    for (size_t i = 0; i < kNumQueries; ++i) {
+        origins[i] = { random.NextFloatRange(0.0f, extent), random.NextFloatRange(0.5f, 5.0f), random.NextFloatRange(0.0f, extent) };
+        diffs[i] = (i % 2 == 0) ? Vector3(0.0f, -10.0f, 0.0f) : random.NextUnitVector() * 20.0f;
+    }
+    std::vector<Math::Sphere> spheres(kNumQueries);
+    std::vector<Math::Capsule> capsules(kNumQueries);
+    for (size_t i = 0; i < kNumQueries; ++i) {
+        Vector3 center = { random.NextFloatRange(0.0f, extent), random.NextFloatRange(-1.5f, 2.5f), random.NextFloatRange(0.0f, extent) };
+        spheres[i] = { center, random.NextFloatRange(0.2f, 1.0f) };
+        capsules[i] = { { center, Vector3(0.0f, 1.5f, 0.0f) }, random.NextFloatRange(0.2f, 0.5f) };
+    }
+
+    size_t rayMismatches = 0;
+    size_t sphereMismatches = 0;
+    for (size_t i = 0; i < kNumChecks; ++i) {
+        MeshBVH::RayHit hit{};
+        float expected = RayCastBruteForce(mesh, origins[i], diffs[i]);
+        bool found = bvh->RayCast(origins[i], diffs[i], 1.0f, hit);
+        if (found != (expected >= 0.0f) || (found && std::abs(hit.fraction - expected) > 1.0e-5f)) { ++rayMismatches; }
+
+        // めり込み量が半径と表面までの距離の差と一致するか
+        Narrowphase::Contact contact{};
+        float distance = DistanceBruteForce(mesh, spheres[i].center);
+        bool hitSphere = bvh->Collide(spheres[i], contact);
+        if (hitSphere != (distance <= spheres[i].radius) || (hitSphere && std::abs(contact.depth - (spheres[i].radius - distance)) > 1.0e-4f)) { ++sphereMismatches; }
+    }
+    std::printf("[MeshBVH] ray mismatches: %zu / %zu, sphere mismatches: %zu / %zu\n", rayMismatches, kNumChecks, sphereMismatches, kNumChecks);
+
+    ns = Benchmark::Measure(3, [&](size_t) {
+        float sum = 0.0f;
+        for (size_t i = 0; i < kNumChecks; ++i) { sum += RayCastBruteForce(mesh, origins[i], diffs[i]); }
+        Benchmark::DoNotOptimize(sum);
+        });
+    Benchmark::Report("MeshBVH", "RayCast brute force per ray", ns / double(kNumChecks));
+
+    size_t hits = 0;
+    ns = Benchmark::Measure(100, [&](size_t) {
+        hits = 0;
+        MeshBVH::RayHit hit{};
+        for (size_t i = 0; i < kNumQueries; ++i) { hits += bvh->RayCast(origins[i], diffs[i], 1.0f, hit) ? 1 : 0; }
+        Benchmark::DoNotOptimize(hits);
+        });
+    Benchmark::Report("MeshBVH", "RayCast per ray (hit " + std::to_string(hits * 100 / kNumQueries) + "%)", ns / double(kNumQueries));
+
+    ns = Benchmark::Measure(100, [&](size_t) {
+        hits = 0;
+        Narrowphase::Contact contact{};
+        for (auto& sphere : spheres) { hits += bvh->Collide(sphere, contact) ? 1 : 0; }
+        Benchmark::DoNotOptimize(hits);
+        });
+    Benchmark::Report("MeshBVH", "Sphere per query (hit " + std::to_string(hits * 100 / kNumQueries) + "%)", ns / double(kNumQueries));
+
+    ns = Benchmark::Measure(100, [&](size_t) {
+        hits = 0;
+        Narrowphase::Contact contact{};
+        for (auto& capsule : capsules) { hits += bvh->Collide(capsule, contact) ? 1 : 0; }
+        Benchmark::DoNotOptimize(hits);
+        });
+    Benchmark::Report("MeshBVH", "Capsule per query (hit " + std::to_string(hits * 100 / kNumQueries) + "%)", ns / double(kNumQueries));
+}
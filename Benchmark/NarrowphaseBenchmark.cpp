@@ -0,0 +1,201 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+#include "Math/Geometry.h"
+#include "Math/Random.h"
+#include "Collision/Narrowphase.h"
+
+using namespace LIEngine;
+
+namespace {
+
+    const size_t kNumPairs = 4096;
+    const size_t kIterations = 200;
+
+    // 以前のBoxCollider同士の判定 (比較用)
+    namespace Reference {
+
+        std::vector<Vector3> GetVertices(const Math::OBB& obb) {
+            Vector3 halfSize = obb.size * 0.5f;
+
+            std::vector<Vector3> vertices(8);
+
+            vertices[0] = { -halfSize.x, -halfSize.y, -halfSize.z };
+            vertices[1] = { -halfSize.x,  halfSize.y, -halfSize.z };
+            vertices[2] = { halfSize.x,  halfSize.y, -halfSize.z };
+            vertices[3] = { halfSize.x, -halfSize.y, -halfSize.z };
+            vertices[4] = { -halfSize.x, -halfSize.y,  halfSize.z };
+            vertices[5] = { -halfSize.x,  halfSize.y,  halfSize.z };
+            vertices[6] = { halfSize.x,  halfSize.y,  halfSize.z };
+            vertices[7] = { halfSize.x, -halfSize.y,  halfSize.z };
+
+            Matrix3x4 obbWorldMatrix = Matrix3x4::MakeFromAxes(obb.orientations[0], obb.orientations[1], obb.orientations[2], obb.center);
+            for (size_t i = 0; i < vertices.size(); ++i) {
+                vertices[i] = vertices[i] * obbWorldMatrix;
+            }
+
+            return vertices;
+        }
+
+        Vector2 Projection(const std::vector<Vector3>& vertices, const Vector3& axis) {
+            Vector2 minmax(Dot(axis, vertices[0]));
+            for (size_t i = 1; i < vertices.size(); ++i) {
+                float dot = Dot(axis, vertices[i]);
+                minmax.x = std::min(dot, minmax.x);
+                minmax.y = std::max(dot, minmax.y);
+            }
+            return minmax;
+        }
+
+        float GetOverlap(const Vector2& minmax1, const Vector2& minmax2) {
+            float range1 = minmax1.y - minmax1.x;
+            float range2 = minmax2.y - minmax2.x;
+            float maxOverlap = std::max(minmax1.y, minmax2.y) - std::min(minmax1.x, minmax2.x);
+            return range1 + range2 - maxOverlap;
+        }
+
+        bool Collide(const Math::OBB& a, const Math::OBB& b, Narrowphase::Contact& contact) {
+            auto vertices1 = GetVertices(a);
+            auto vertices2 = GetVertices(b);
+
+            Vector3 axes[15] = { a.orientations[0], a.orientations[1], a.orientations[2], b.orientations[0], b.orientations[1], b.orientations[2] };
+            for (size_t i = 0; i < 3; ++i) {
+                for (size_t j = 0; j < 3; ++j) {
+                    axes[6 + i * 3 + j] = Cross(a.orientations[i], b.orientations[j]).Normalized();
+                }
+            }
+
+            float minOverlap = FLT_MAX;
+            Vector3 minOverlapAxis = {};
+            for (auto& axis : axes) {
+                if (std::isnan(axis.x) || std::isnan(axis.y) || std::isnan(axis.z)) { continue; }
+                if (axis == Vector3::zero) { continue; }
+                Vector2 minmax1 = Projection(vertices1, axis);
+                Vector2 minmax2 = Projection(vertices2, axis);
+                if (!(minmax1.x <= minmax2.y && minmax1.y >= minmax2.x)) {
+                    return false;
+                }
+                float overlap = GetOverlap(minmax1, minmax2);
+                if (overlap < minOverlap) {
+                    minOverlapAxis = axis;
+                    minOverlap = overlap;
+                }
+            }
+            contact.normal = minOverlapAxis.Normalized();
+            if (Dot(b.center - a.center, contact.normal) < 0.0f) {
+                contact.normal *= -1;
+            }
+            contact.depth = minOverlap;
+            return true;
+        }
+
+    }
+
+    Vector3 RandomPoint(Random::PCG32& random, float extent) {
+        return { random.NextFloatRange(-extent, extent), random.NextFloatRange(-extent, extent), random.NextFloatRange(-extent, extent) };
+    }
+
+    Math::OBB RandomOBB(Random::PCG32& random) {
+        Quaternion rotation = Quaternion::MakeFromAngleAxis(random.NextFloatRange(0.0f, 6.2831853f), random.NextUnitVector());
+        Math::OBB obb;
+        obb.center = RandomPoint(random, 1.5f);
+        obb.orientations[0] = rotation.GetRight();
+        obb.orientations[1] = rotation.GetUp();
+        obb.orientations[2] = rotation.GetForward();
+        obb.size = { random.NextFloatRange(0.5f, 2.0f), random.NextFloatRange(0.5f, 2.0f), random.NextFloatRange(0.5f, 2.0f) };
+        return obb;
+    }
+
+    Math::Capsule RandomCapsule(Random::PCG32& random) {
+        return { { RandomPoint(random, 1.5f), random.NextUnitVector() * random.NextFloatRange(0.0f, 2.0f) }, random.NextFloatRange(0.2f, 0.8f) };
+    }
+
+    Math::Sphere RandomSphere(Random::PCG32& random) {
+        return { RandomPoint(random, 1.5f), random.NextFloatRange(0.2f, 1.0f) };
+    }
+
+    Math::Sphere Translated(Math::Sphere shape, const Vector3& offset) { shape.center += offset; return shape; }
+    Math::OBB Translated(Math::OBB shape, const Vector3& offset) { shape.center += offset; return shape; }
+    Math::Capsule Translated(Math::Capsule shape, const Vector3& offset) { shape.segment.origin += offset; return shape; }
+
+    // bを法線方向にめり込み量より少し多く動かすと離れるか
+    // カプセルと箱は最近点で求めるので押し出し量が最小とは限らず対象外
+    template<typename A, typename B>
+    size_t CountPushOutFailures(const std::vector<A>& a, const std::vector<B>& b) {
+        size_t failures = 0;
+        for (size_t i = 0; i < kNumPairs; ++i) {
+            Narrowphase::Contact contact, separated;
+            if (!Narrowphase::Collide(a[i], b[i], contact) || contact.normal == Vector3::zero) { continue; }
+            if (Narrowphase::Collide(a[i], Translated(b[i], contact.normal * (contact.depth + 1.0e-3f)), separated)) { ++failures; }
+        }
+        return failures;
+    }
+
+    template<typename A, typename B, typename Func>
+    void MeasurePairs(const char* name, const std::vector<A>& a, const std::vector<B>& b, Func&& collide) {
+        size_t hits = 0;
+        double ns = Benchmark::Measure(kIterations, [&](size_t) {
+            hits = 0;
+            Narrowphase::Contact contact;
+            for (size_t i = 0; i < kNumPairs; ++i) {
+                hits += collide(a[i], b[i], contact) ? 1 : 0;
+            }
+            Benchmark::DoNotOptimize(hits);
+            });
+        char label[64];
+        std::snprintf(label, sizeof(label), "%s per pair (hit %zu%%)", name, hits * 100 / kNumPairs);
+        Benchmark::Report("Narrowphase", label, ns / double(kNumPairs));
+    }
+
+}
+
+void RunNarrowphaseBenchmark() {
+    Random::PCG32 random(7);
+    std::vector<Math::OBB> obbs1(kNumPairs), obbs2(kNumPairs);
+    std::vector<Math::Sphere> spheres1(kNumPairs), spheres2(kNumPairs);
+    std::vector<Math::Capsule> capsules1(kNumPairs), capsules2(kNumPairs);
+    for (size_t i = 0; i < kNumPairs; ++i) {
+        obbs1[i] = RandomOBB(random);
+        obbs2[i] = RandomOBB(random);
+        spheres1[i] = RandomSphere(random);
+        spheres2[i] = RandomSphere(random);
+        capsules1[i] = RandomCapsule(random);
+        capsules2[i] = RandomCapsule(random);
+    }
+
+    // 以前の実装と衝突の有無が一致するか
+    size_t mismatches = 0;
+    for (size_t i = 0; i < kNumPairs; ++i) {
+        Narrowphase::Contact reference{}, contact{};
+        bool referenceHit = Reference::Collide(obbs1[i], obbs2[i], reference);
+        bool hit = Narrowphase::Collide(obbs1[i], obbs2[i], contact);
+        if (referenceHit != hit) { ++mismatches; }
+    }
+    std::printf("[Narrowphase] OBB/OBB hit mismatches vs reference: %zu / %zu\n", mismatches, kNumPairs);
+    std::printf("[Narrowphase] push-out failures Sphere/Sphere: %zu, Sphere/OBB: %zu, OBB/OBB: %zu, Capsule/Capsule: %zu\n",
+        CountPushOutFailures(spheres1, spheres2), CountPushOutFailures(spheres1, obbs2),
+        CountPushOutFailures(obbs1, obbs2), CountPushOutFailures(capsules1, capsules2));
+
+    MeasurePairs("OBB/OBB reference", obbs1, obbs2, [](const Math::OBB& a, const Math::OBB& b, Narrowphase::Contact& contact) {
+        return Reference::Collide(a, b, contact);
+        });
+    MeasurePairs("OBB/OBB", obbs1, obbs2, [](const Math::OBB& a, const Math::OBB& b, Narrowphase::Contact& contact) {
+        return Narrowphase::Collide(a, b, contact);
+        });
+    MeasurePairs("Sphere/Sphere", spheres1, spheres2, [](const Math::Sphere& a, const Math::Sphere& b, Narrowphase::Contact& contact) {
+        return Narrowphase::Collide(a, b, contact);
+        });
+    MeasurePairs("Sphere/OBB", spheres1, obbs2, [](const Math::Sphere& a, const Math::OBB& b, Narrowphase::Contact& contact) {
+        return Narrowphase::Collide(a, b, contact);
+        });
+    MeasurePairs("Capsule/Capsule", capsules1, capsules2, [](const Math::Capsule& a, const Math::Capsule& b, Narrowphase::Contact& contact) {
+        return Narrowphase::Collide(a, b, contact);
+        });
+    MeasurePairs("Capsule/OBB", capsules1, obbs2, [](const Math::Capsule& a, const Math::OBB& b, Narrowphase::Contact& contact) {
+        return Narrowphase::Collide(a, b, contact);
+        });
+}
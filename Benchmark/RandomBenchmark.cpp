@@ -0,0 +1,99 @@
+#include "Benchmark.h"
+
+#include <random>
+#include <vector>
+
+#include "Math/Random.h"
+
+using namespace LIEngine;
+
+namespace {
+
+    const size_t kNumValues = 65536;
+    const size_t kIterations = 200;
+
+    // 既知の出力と一致するか確認する
+    bool CheckKnownAnswers() {
+        // PCG32 (seed 42, stream 54) の先頭
+        const uint32_t pcgExpected[] = { 0xA15C02B7, 0x7B47F409, 0xBA1D3330, 0x83D2F293, 0xBFA4784B, 0xCBED606E };
+        Random::PCG32 pcg(42, 54);
+        for (uint32_t expected : pcgExpected) {
+            if (pcg.Next() != expected) { return false; }
+        }
+        // Philox4x32-10 (カウンター0, キー0)
+        const uint32_t philoxExpected[] = { 0x6627E8D5, 0xE169C58D, 0xBC57AC4C, 0x9B00DBD8 };
+        uint32_t counter[4] = {}, key[2] = {}, result[4];
+        Random::Philox4x32(counter, key, result);
+        for (size_t i = 0; i < 4; ++i) {
+            if (result[i] != philoxExpected[i]) { return false; }
+        }
+        return true;
+    }
+
+    // 分割して埋めても一括と同じ結果になるか確認する
+    bool CheckReproducible() {
+        Random::CounterRandom random(12345, 7);
+        std::vector<uint32_t> whole(kNumValues), split(kNumValues);
+        random.FillUInt(whole.data(), kNumValues);
+        // 半端な境界で分割する
+        const size_t kChunk = 1000 + 3;
+        for (size_t begin = 0; begin < kNumValues; begin += kChunk) {
+            random.FillUInt(split.data() + begin, std::min(kChunk, kNumValues - begin), begin);
+        }
+        for (size_t i = 0; i < kNumValues; ++i) {
+            if (whole[i] != split[i] || whole[i] != random.UInt(i)) { return false; }
+        }
+
+        // Advanceで読み飛ばしても同じ
+        Random::PCG32 a(99), b(99);
+        for (size_t i = 0; i < 1000; ++i) { a.Next(); }
+        b.Advance(1000);
+        return a.Next() == b.Next();
+    }
+
+}
+
+void RunRandomBenchmark() {
+    std::printf("[Random] known answers: %s, reproducible split: %s\n",
+        CheckKnownAnswers() ? "ok" : "NG", CheckReproducible() ? "ok" : "NG");
+
+    std::vector<float> values(kNumValues);
+    std::vector<Vector3> vectors(kNumValues);
+
+    double ns = Benchmark::Measure(kIterations, [&](size_t i) {
+        std::mt19937 engine{ uint32_t(i) };
+        for (auto& value : values) {
+            value = std::uniform_real_distribution<float>(0.0f, 1.0f)(engine);
+        }
+        Benchmark::DoNotOptimize(values[0]);
+        });
+    Benchmark::Report("Random", "mt19937 + uniform_real_distribution (x65536)", ns);
+
+    ns = Benchmark::Measure(kIterations, [&](size_t i) {
+        Random::PCG32 pcg(i);
+        pcg.FillFloatUnit(values.data(), values.size());
+        Benchmark::DoNotOptimize(values[0]);
+        });
+    Benchmark::Report("Random", "PCG32 FillFloatUnit (x65536)", ns);
+
+    ns = Benchmark::Measure(kIterations, [&](size_t i) {
+        Random::CounterRandom random(i);
+        random.FillFloatUnit(values.data(), values.size());
+        Benchmark::DoNotOptimize(values[0]);
+        });
+    Benchmark::Report("Random", "CounterRandom FillFloatUnit (x65536)", ns);
+
+    ns = Benchmark::Measure(kIterations, [&](size_t i) {
+        Random::PCG32 pcg(i);
+        pcg.FillUnitVector(vectors.data(), vectors.size());
+        Benchmark::DoNotOptimize(vectors[0]);
+        });
+    Benchmark::Report("Random", "PCG32 FillUnitVector (x65536)", ns);
+
+    ns = Benchmark::Measure(kIterations, [&](size_t i) {
+        Random::CounterRandom random(i);
+        random.FillUnitVector(vectors.data(), vectors.size());
+        Benchmark::DoNotOptimize(vectors[0]);
+        });
+    Benchmark::Report("Random", "CounterRandom FillUnitVector (x65536)", ns);
+}
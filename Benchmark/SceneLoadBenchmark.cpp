@@ -0,0 +1,216 @@
+#include "Benchmark.h"
+
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "File/BinaryStream.h"
+#include "File/ContentHash.h"
+#include "File/LZ4.h"
+#include "File/MappedFile.h"
+#include "Framework/AssetLoadGraph.h"
+#include "Framework/ThreadPool.h"
+
+using namespace LIEngine;
+
+namespace {
+
+    // 起動時のシーンを模したもの
+    // モデルとテクスチャはエンジンと同じく、元のファイルを確かめてから焼いたファイルを読む (無ければ焼く)
+    const size_t kNumModels = 24;
+    const size_t kNumTextures = 48;
+    const size_t kTexturesPerModel = 4;
+    const size_t kModelSize = 512 * 1024;
+    const size_t kTextureSize = 256 * 1024;
+    const std::filesystem::path kDirectory = "SceneLoadBenchmark";
+    const std::filesystem::path kCacheDirectory = kDirectory / "Cache";
+
+    struct CacheHeader {
+        uint64_t sourceHash;
+        uint64_t size;
+        uint64_t compressedSize;
+    };
+
+    struct Scene {
+        std::vector<std::filesystem::path> models;
+        std::vector<std::filesystem::path> textures;
+        // モデルごとのテクスチャの番号 (モデルどうしで共有するものもある)
+        std::vector<std::vector<size_t>> modelTextures;
+    };
+
+    void WriteSource(const std::filesystem::path& path, size_t size, std::mt19937& random) {
+        std::vector<uint8_t> content(size);
+        // 圧縮が効く程度に繰り返す
+        for (size_t i = 0; i < size; ++i) {
+            content[i] = static_cast<uint8_t>(i % 64 < 48 ? (i / 64) % 7 : random());
+        }
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(content.data()), static_cast<std::streamsize>(content.size()));
+    }
+
+    Scene MakeScene() {
+        std::mt19937 random(4321);
+        std::error_code errorCode;
+        std::filesystem::create_directories(kDirectory, errorCode);
+        Scene scene;
+        for (size_t i = 0; i < kNumTextures; ++i) {
+            scene.textures.emplace_back(kDirectory / ("Texture" + std::to_string(i) + ".png"));
+            WriteSource(scene.textures.back(), kTextureSize, random);
+        }
+        for (size_t i = 0; i < kNumModels; ++i) {
+            scene.models.emplace_back(kDirectory / ("Model" + std::to_string(i) + ".gltf"));
+            WriteSource(scene.models.back(), kModelSize, random);
+            auto& textures = scene.modelTextures.emplace_back();
+            for (size_t j = 0; j < kTexturesPerModel; ++j) {
+                textures.emplace_back((i * 3 + j * 5) % kNumTextures);
+            }
+        }
+        return scene;
+    }
+
+    // 焼いたファイルがあり元のファイルが変わっていなければそれを展開し、無ければ焼く
+    size_t LoadCooked(const std::filesystem::path& sourcePath) {
+        uint64_t sourceHash = ContentHash::ComputeFile(sourcePath);
+        std::filesystem::path cachePath = kCacheDirectory / (sourcePath.filename().string() + ".cooked");
+        MappedFile cacheFile;
+        if (cacheFile.Open(cachePath)) {
+            BinaryReader reader(cacheFile.GetData(), cacheFile.GetSize());
+            CacheHeader header = reader.Read<CacheHeader>();
+            const void* compressed = reader.ReadBytes(static_cast<size_t>(header.compressedSize));
+            if (reader.IsValid() && header.sourceHash == sourceHash) {
+                std::vector<uint8_t> data(static_cast<size_t>(header.size));
+                if (LZ4::Decompress(compressed, static_cast<size_t>(header.compressedSize), data.data(), data.size())) {
+                    return data.size();
+                }
+            }
+        }
+
+        MappedFile source;
+        if (!source.Open(sourcePath)) {
+            return 0;
+        }
+        std::vector<uint8_t> compressed(LZ4::CompressBound(source.GetSize()));
+        CacheHeader header{ sourceHash, source.GetSize(), LZ4::Compress(source.GetData(), source.GetSize(), compressed.data(), compressed.size()) };
+        BinaryWriter writer;
+        writer.Write(header);
+        writer.WriteBytes(compressed.data(), static_cast<size_t>(header.compressedSize));
+        writer.SaveFile(cachePath);
+        return source.GetSize();
+    }
+
+    // 同じテクスチャは1回だけ読み込む (TextureLoaderの代わり)
+    struct TextureTable {
+        explicit TextureTable(size_t numTextures) : flags(numTextures), sizes(numTextures) {}
+        void Load(const Scene& scene, size_t texture) {
+            std::call_once(flags[texture], [&]() { sizes[texture] = LoadCooked(scene.textures[texture]); });
+        }
+        std::vector<std::once_flag> flags;
+        std::vector<size_t> sizes;
+    };
+
+    // 以前のSceneIO: アセットごとに1タスク、テクスチャはモデルの読み込みの中で順に
+    void LoadPerAssetTasks(ThreadPool& threadPool, const Scene& scene) {
+        TextureTable textureTable(scene.textures.size());
+        std::vector<TaskFuture<void>> tasks;
+        for (size_t i = 0; i < scene.models.size(); ++i) {
+            tasks.emplace_back(threadPool.Submit([&, i]() {
+                LoadCooked(scene.models[i]);
+                for (size_t texture : scene.modelTextures[i]) { textureTable.Load(scene, texture); }
+                }, TaskPriority::Background));
+        }
+        for (auto& task : tasks) { task.Wait(); }
+    }
+
+    // 読み込みグラフ: テクスチャをモデルと別のタスクにし、そろったらモデルを仕上げる
+    void LoadWithGraph(ThreadPool& threadPool, const Scene& scene, AssetLoadGraph::Progress& progress) {
+        TextureTable textureTable(scene.textures.size());
+        AssetLoadGraph loadGraph;
+        std::vector<AssetLoadGraph::TaskHandle> textureTasks;
+        for (size_t i = 0; i < scene.textures.size(); ++i) {
+            textureTasks.emplace_back(loadGraph.AddTask("Texture", [&, i]() { textureTable.Load(scene, i); }));
+        }
+        for (size_t i = 0; i < scene.models.size(); ++i) {
+            auto cook = loadGraph.AddTask("ModelCook", [&, i]() { LoadCooked(scene.models[i]); });
+            auto model = loadGraph.AddTask("Model", [&, i]() {
+                size_t size = 0;
+                for (size_t texture : scene.modelTextures[i]) { size += textureTable.sizes[texture]; }
+                Benchmark::DoNotOptimize(size);
+                }, { cook });
+            for (size_t texture : scene.modelTextures[i]) {
+                loadGraph.AddDependency(model, textureTasks[texture]);
+            }
+        }
+        loadGraph.Start(threadPool);
+        loadGraph.Wait();
+        progress = loadGraph.GetProgress();
+    }
+
+    // 依存先がすべて終わってから実行され、全部終わると準備完了になる
+    bool CheckGraph(ThreadPool& threadPool) {
+        bool isValid = true;
+        {
+            AssetLoadGraph empty;
+            empty.Start(threadPool);
+            empty.Wait();
+            isValid &= empty.IsReady() && empty.GetProgress().numTasks == 0;
+        }
+        std::mt19937 random(99);
+        for (size_t n = 0; n < 20; ++n) {
+            const size_t kNumTasks = 200;
+            AssetLoadGraph loadGraph;
+            std::vector<std::atomic<bool>> isDone(kNumTasks);
+            std::vector<std::vector<AssetLoadGraph::TaskHandle>> dependencies(kNumTasks);
+            std::atomic<bool> isOrdered = true;
+            for (size_t i = 0; i < kNumTasks; ++i) {
+                size_t numDependencies = i > 0 ? random() % 4 : 0;
+                for (size_t d = 0; d < numDependencies; ++d) {
+                    dependencies[i].emplace_back(AssetLoadGraph::TaskHandle(random() % i));
+                }
+                auto task = loadGraph.AddTask("Task", [&, i]() {
+                    for (auto dependency : dependencies[i]) {
+                        if (!isDone[dependency].load(std::memory_order_acquire)) { isOrdered = false; }
+                    }
+                    isDone[i].store(true, std::memory_order_release);
+                    });
+                for (auto dependency : dependencies[i]) { loadGraph.AddDependency(task, dependency); }
+            }
+            loadGraph.Start(threadPool);
+            loadGraph.Wait();
+            auto progress = loadGraph.GetProgress();
+            isValid &= isOrdered && loadGraph.IsReady() && progress.numCompleted == kNumTasks && progress.numTasks == kNumTasks;
+        }
+        return isValid;
+    }
+
+}
+
+void RunSceneLoadBenchmark() {
+    ThreadPool threadPool;
+    Scene scene = MakeScene();
+    std::error_code errorCode;
+
+    // 焼いたファイルが無い初回と、ある2回目以降
+    auto MeasureStartup = [&](const char* name, bool isCold, auto&& load) {
+        double ns = Benchmark::Measure(3, [&](size_t) {
+            if (isCold) { std::filesystem::remove_all(kCacheDirectory, errorCode); }
+            load();
+            });
+        Benchmark::Report("SceneLoad", name, ns);
+        };
+    AssetLoadGraph::Progress progress;
+    MeasureStartup("Cold per asset task", true, [&]() { LoadPerAssetTasks(threadPool, scene); });
+    MeasureStartup("Cold load graph", true, [&]() { LoadWithGraph(threadPool, scene, progress); });
+    MeasureStartup("Warm per asset task", false, [&]() { LoadPerAssetTasks(threadPool, scene); });
+    MeasureStartup("Warm load graph", false, [&]() { LoadWithGraph(threadPool, scene, progress); });
+
+    bool isProgressValid = progress.numTasks == kNumTextures + kNumModels * 2 && progress.numCompleted == progress.numTasks;
+    std::printf("[SceneLoad] graph=%s progress=%s\n", CheckGraph(threadPool) ? "ok" : "NG", isProgressValid ? "ok" : "NG");
+
+    std::filesystem::remove_all(kDirectory, errorCode);
+}
@@ -0,0 +1,351 @@
+#include "Benchmark.h"
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "Framework/TaskGraph.h"
+#include "Framework/ThreadPool.h"
+
+using namespace LIEngine;
+
+namespace {
+
+    // 1回に追加するタスク数
+    const size_t kNumTasks = 10000;
+    // 分岐していくタスクの深さ (葉は2^kSplitDepth個)
+    const uint32_t kSplitDepth = 13;
+    // ParallelForの要素数
+    const size_t kNumElements = 1 << 20;
+    // 読み込みに見立てたBackgroundのタスク数と1つの時間
+    const size_t kNumBackgroundTasks = 64;
+    const auto kBackgroundTaskTime = std::chrono::milliseconds(2);
+    // タスクグラフの段数と1段のタスク数
+    const uint32_t kGraphStages = 64;
+    const uint32_t kGraphWidth = 16;
+
+    // 以前のスレッドプール (比較用)
+    // 1つのキューを1つのミューテックスで守る
+    class LegacyThreadPool {
+    public:
+        LegacyThreadPool(size_t threads) :
+            stop_(false),
+            activeTasks_(0) {
+            for (size_t i = 0; i < threads; ++i) {
+                workers_.emplace_back([this] {
+                    while (true) {
+                        std::function<void()> task;
+                        {
+                            std::unique_lock<std::mutex> lock(mutex_);
+                            condition_.wait(lock, [this] {
+                                return stop_ || !taskQueue_.empty();
+                                });
+                            if (stop_ && taskQueue_.empty()) {
+                                return;
+                            }
+                            task = std::move(taskQueue_.front());
+                            taskQueue_.pop();
+                            ++activeTasks_;
+                        }
+                        task();
+                        {
+                            std::unique_lock<std::mutex> lock(mutex_);
+                            --activeTasks_;
+                            if (taskQueue_.empty() && activeTasks_ == 0) {
+                                completionCondition_.notify_all();
+                            }
+                        }
+                    }
+                    });
+            }
+        }
+        ~LegacyThreadPool() {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            condition_.notify_all();
+            for (std::thread& worker : workers_) {
+                worker.join();
+            }
+        }
+
+        void PushTask(std::function<void()> task) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                taskQueue_.emplace(task);
+            }
+            condition_.notify_one();
+        }
+        void WaitForAll() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            completionCondition_.wait(lock, [this] {
+                return taskQueue_.empty() && activeTasks_ == 0;
+                });
+        }
+        size_t GetNumThreads() const { return workers_.size(); }
+
+    private:
+        std::vector<std::thread> workers_;
+        std::queue<std::function<void()>> taskQueue_;
+        std::mutex mutex_;
+        std::condition_variable condition_;
+        std::condition_variable completionCondition_;
+        bool stop_;
+        size_t activeTasks_;
+    };
+
+    // 2つに分かれながら増えていくタスク
+    // ワーカーから追加されるタスクが多い場合
+    template<typename Pool>
+    void Split(Pool& pool, std::atomic<size_t>& leaves, uint32_t depth) {
+        if (depth == 0) {
+            leaves.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        for (int i = 0; i < 2; ++i) {
+            pool.PushTask([&pool, &leaves, depth]() { Split(pool, leaves, depth - 1); });
+        }
+    }
+
+    template<typename Pool>
+    void RunPool(const char* name, Pool& pool) {
+        std::string suffix = std::string(" ") + name + " " + std::to_string(pool.GetNumThreads()) + " workers";
+
+        // 作成したスレッドから細かいタスクを大量に追加する
+        std::atomic<size_t> counter = 0;
+        double ns = Benchmark::Measure(20, [&](size_t) {
+            counter = 0;
+            for (size_t i = 0; i < kNumTasks; ++i) {
+                pool.PushTask([&counter]() { counter.fetch_add(1, std::memory_order_relaxed); });
+            }
+            pool.WaitForAll();
+            });
+        std::printf("[ThreadPool] push%s count=%s\n", suffix.c_str(), counter == kNumTasks ? "ok" : "NG");
+        Benchmark::Report("ThreadPool", "Push per task" + suffix, ns / double(kNumTasks));
+
+        // キューを持たないスレッドから追加する
+        ns = Benchmark::Measure(20, [&](size_t) {
+            counter = 0;
+            std::thread producer([&]() {
+                for (size_t i = 0; i < kNumTasks; ++i) {
+                    pool.PushTask([&counter]() { counter.fetch_add(1, std::memory_order_relaxed); });
+                }
+                });
+            producer.join();
+            pool.WaitForAll();
+            });
+        std::printf("[ThreadPool] external push%s count=%s\n", suffix.c_str(), counter == kNumTasks ? "ok" : "NG");
+        Benchmark::Report("ThreadPool", "External push per task" + suffix, ns / double(kNumTasks));
+
+        // ワーカーが次々にタスクを追加する
+        std::atomic<size_t> leaves = 0;
+        ns = Benchmark::Measure(20, [&](size_t) {
+            leaves = 0;
+            Split(pool, leaves, kSplitDepth);
+            pool.WaitForAll();
+            });
+        size_t numSplitTasks = (size_t(2) << kSplitDepth) - 2;
+        std::printf("[ThreadPool] split%s leaves=%s\n", suffix.c_str(), leaves == (size_t(1) << kSplitDepth) ? "ok" : "NG");
+        Benchmark::Report("ThreadPool", "Split per task" + suffix, ns / double(numSplitTasks));
+    }
+
+    // 止まらない読み込みに見立てたタスク
+    void Sleep(const CancellationToken& token) {
+        auto end = std::chrono::steady_clock::now() + kBackgroundTaskTime;
+        while (std::chrono::steady_clock::now() < end && !token.IsCancelled()) {
+            std::this_thread::yield();
+        }
+    }
+
+    // 結果の受け取り、優先度、キャンセル
+    void RunFutures(ThreadPool& pool) {
+        std::string suffix = " " + std::to_string(pool.GetNumThreads()) + " workers";
+
+        // 結果を受け取る
+        std::vector<TaskFuture<size_t>> futures;
+        for (size_t i = 0; i < 1000; ++i) {
+            futures.emplace_back(pool.Submit([i]() { return i * i; }));
+        }
+        bool isCorrect = true;
+        for (size_t i = 0; i < futures.size(); ++i) { isCorrect &= futures[i].Get() == i * i; }
+
+        // 始まる前にキャンセルしたものは実行されない
+        std::atomic<size_t> numExecuted = 0;
+        std::vector<TaskFuture<void>> loads;
+        for (size_t i = 0; i < kNumBackgroundTasks; ++i) {
+            loads.emplace_back(pool.Submit([&](const CancellationToken& token) { Sleep(token); ++numExecuted; }, TaskPriority::Background));
+        }
+        for (auto& load : loads) { load.Cancel(); }
+        size_t numSkipped = 0;
+        for (auto& load : loads) {
+            load.Wait();
+            numSkipped += load.HasResult() ? 0 : 1;
+        }
+        bool isCancelled = numExecuted + numSkipped == kNumBackgroundTasks && numSkipped > 0;
+        std::printf("[ThreadPool] future%s get=%s cancel=%s (skipped %zu)\n", suffix.c_str(), isCorrect ? "ok" : "NG", isCancelled ? "ok" : "NG", numSkipped);
+
+        // 別のスレッドから読み込みを積んでいる間のParallelFor
+        // 待っているスレッドはBackgroundのタスクを手伝わない
+        std::thread::id mainThread = std::this_thread::get_id();
+        std::vector<float> values(kNumElements / 4);
+        auto Fill = [&](size_t i) { values[i] = values[i] * 0.5f + 1.0f; };
+        double idle = Benchmark::Measure(20, [&](size_t) { pool.ParallelFor(0, values.size(), Fill); });
+
+        std::atomic<size_t> numOnMainThread = 0;
+        loads.clear();
+        std::thread loader([&]() {
+            for (size_t i = 0; i < kNumBackgroundTasks; ++i) {
+                loads.emplace_back(pool.Submit([&](const CancellationToken& token) {
+                    if (std::this_thread::get_id() == mainThread) { ++numOnMainThread; }
+                    Sleep(token);
+                    }, TaskPriority::Background));
+            }
+            });
+        loader.join();
+        double ns = Benchmark::Measure(20, [&](size_t) { pool.ParallelFor(0, values.size(), Fill); });
+        size_t numWaitedOn = numOnMainThread;
+        for (auto& load : loads) { load.Cancel(); }
+        pool.WaitForAll();
+        std::printf("[ThreadPool] background loads%s ran on waiting thread=%s\n", suffix.c_str(), numWaitedOn == 0 ? "ok" : "NG");
+        Benchmark::Report("ThreadPool", "ParallelFor 256K with loads" + suffix, ns);
+        Benchmark::Report("ThreadPool", "ParallelFor 256K no loads" + suffix, idle);
+    }
+
+    // 段ごとに全員が前の段の全員を待つグラフ
+    // 前の段が終わっていなければ、またはMainThreadのタスクが他のスレッドで動けばNG
+    void RunTaskGraph(ThreadPool& pool) {
+        std::string suffix = " " + std::to_string(pool.GetNumThreads()) + " workers";
+        std::vector<std::atomic<uint32_t>> finished(kGraphStages);
+        std::atomic<bool> isValid = true;
+        std::thread::id mainThread = std::this_thread::get_id();
+
+        TaskGraph graph;
+        std::vector<TaskGraph::TaskHandle> previous, current;
+        for (uint32_t stage = 0; stage < kGraphStages; ++stage) {
+            current.clear();
+            for (uint32_t i = 0; i < kGraphWidth; ++i) {
+                // 各段の先頭はMainThread
+                auto affinity = i == 0 ? TaskGraph::Affinity::MainThread : TaskGraph::Affinity::Any;
+                auto task = graph.AddTask("Stage" + std::to_string(stage), [&, stage, i]() {
+                    if (stage > 0 && finished[stage - 1].load(std::memory_order_acquire) != kGraphWidth) { isValid = false; }
+                    if (i == 0 && std::this_thread::get_id() != mainThread) { isValid = false; }
+                    finished[stage].fetch_add(1, std::memory_order_release);
+                    }, {}, affinity);
+                for (auto dependency : previous) {
+                    graph.AddDependency(task, dependency);
+                }
+                current.emplace_back(task);
+            }
+            std::swap(previous, current);
+        }
+
+        bool isComplete = true;
+        double ns = Benchmark::Measure(20, [&](size_t) {
+            for (auto& count : finished) { count = 0; }
+            graph.Run(pool);
+            for (auto& count : finished) { isComplete &= count == kGraphWidth; }
+            });
+        std::printf("[ThreadPool] task graph%s order=%s complete=%s\n", suffix.c_str(), isValid ? "ok" : "NG", isComplete ? "ok" : "NG");
+        Benchmark::Report("ThreadPool", "TaskGraph per task" + suffix, ns / double(graph.GetNumTasks()));
+    }
+
+    // 計測の負荷と集計
+    void RunProfiler(ThreadPool& pool) {
+        std::string suffix = " " + std::to_string(pool.GetNumThreads()) + " workers";
+        ThreadPoolProfiler& profiler = pool.GetProfiler();
+
+        std::atomic<size_t> counter = 0;
+        auto Push = [&](size_t) {
+            counter = 0;
+            for (size_t i = 0; i < kNumTasks; ++i) {
+                pool.PushTask([&counter]() { counter.fetch_add(1, std::memory_order_relaxed); });
+            }
+            pool.WaitForAll();
+            };
+        double off = Benchmark::Measure(20, Push);
+        profiler.Start();
+        double on = Benchmark::Measure(20, Push);
+        profiler.Stop();
+        Benchmark::Report("ThreadPool", "Push per task profiler off" + suffix, off / double(kNumTasks));
+        Benchmark::Report("ThreadPool", "Push per task profiler on" + suffix, on / double(kNumTasks));
+
+        // グラフの名前付きの処理と、プールのタスクの数が合うか
+        TaskGraph graph;
+        std::vector<TaskGraph::TaskHandle> previous, current;
+        for (uint32_t stage = 0; stage < kGraphStages; ++stage) {
+            current.clear();
+            for (uint32_t i = 0; i < kGraphWidth; ++i) {
+                auto affinity = i == 0 ? TaskGraph::Affinity::MainThread : TaskGraph::Affinity::Any;
+                auto task = graph.AddTask(i == 0 ? "Main" : "Worker", [&]() { counter.fetch_add(1, std::memory_order_relaxed); }, {}, affinity);
+                for (auto dependency : previous) {
+                    graph.AddDependency(task, dependency);
+                }
+                current.emplace_back(task);
+            }
+            std::swap(previous, current);
+        }
+        profiler.Start();
+        graph.Run(pool);
+        profiler.Stop();
+
+        nlohmann::json json = profiler.ExportJson();
+        uint64_t numTasks = 0;
+        for (auto& thread : json["threads"]) { numTasks += thread["tasks"].get<uint64_t>(); }
+        uint64_t numNamed = 0;
+        for (auto& named : json["named_tasks"]) { numNamed += named["count"].get<uint64_t>(); }
+        // MainThreadのタスクはプールを通らない
+        size_t numPoolTasks = size_t(kGraphStages) * (kGraphWidth - 1);
+        bool isCounted = numTasks == numPoolTasks && numNamed == graph.GetNumTasks() && json["latency"]["count"].get<uint64_t>() == numPoolTasks;
+        size_t numTraceEvents = profiler.ExportChromeTrace()["traceEvents"].size();
+        bool isTraced = numTraceEvents == profiler.GetNumThreads() + numPoolTasks + graph.GetNumTasks();
+        std::printf("[ThreadPool] profiler%s count=%s trace=%s p50=%lluns p99=%lluns\n", suffix.c_str(), isCounted ? "ok" : "NG", isTraced ? "ok" : "NG",
+            (unsigned long long)json["latency"]["p50_ns"].get<uint64_t>(), (unsigned long long)json["latency"]["p99_ns"].get<uint64_t>());
+    }
+
+}
+
+void RunThreadPoolBenchmark() {
+    for (size_t workers : { 1, 3, 7 }) {
+        LegacyThreadPool legacy(workers);
+        RunPool("legacy", legacy);
+        ThreadPool pool(workers);
+        RunPool("stealing", pool);
+
+        // ParallelForとParallelReduce
+        std::vector<float> values(kNumElements);
+        pool.ParallelFor(0, kNumElements, [&](size_t i) { values[i] = float(i % 1000) * 0.001f; });
+        bool filled = true;
+        for (size_t i = 0; i < kNumElements; ++i) { filled &= values[i] == float(i % 1000) * 0.001f; }
+
+        auto Sum = [](float a, float b) { return a + b; };
+        auto Get = [&](size_t i) { return values[i]; };
+        // 自動の塊分けはスレッド数によらないので、1スレッドで計算した値と一致する
+        ThreadPool serial(1);
+        float expected = serial.ParallelReduce(0, kNumElements, 0.0f, Get, Sum);
+        float sum = pool.ParallelReduce(0, kNumElements, 0.0f, Get, Sum);
+        std::string suffix = " " + std::to_string(workers) + " workers";
+        std::printf("[ThreadPool] parallel for%s fill=%s reduce=%s\n", suffix.c_str(), filled ? "ok" : "NG", sum == expected ? "ok" : "NG");
+
+        double ns = Benchmark::Measure(20, [&](size_t) {
+            pool.ParallelFor(0, kNumElements, [&](size_t i) { values[i] = values[i] * 0.5f + 1.0f; });
+            });
+        Benchmark::Report("ThreadPool", "ParallelFor 1M" + suffix, ns);
+        ns = Benchmark::Measure(20, [&](size_t) {
+            sum = pool.ParallelReduce(0, kNumElements, 0.0f, Get, Sum);
+            Benchmark::DoNotOptimize(sum);
+            });
+        Benchmark::Report("ThreadPool", "ParallelReduce 1M" + suffix, ns);
+
+        RunFutures(pool);
+        RunTaskGraph(pool);
+        RunProfiler(pool);
+    }
+}
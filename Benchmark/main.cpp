@@ -0,0 +1,56 @@
+///
+/// ベンチマーク
+/// Windows以外でもエンジンに依存しないグループは単体でビルドできる
+/// 例: g++ -std=c++20 -O2 -mavx2 -I Engine Benchmark/*.cpp Engine/Math/*.cpp Engine/Collision/DynamicAABBTree.cpp Engine/Collision/MeshBVH.cpp Engine/Collision/Narrowphase.cpp Engine/Collision/SpatialHashGrid.cpp Engine/Framework/ThreadPool.cpp Engine/Framework/TaskGraph.cpp Engine/Framework/ThreadPoolProfiler.cpp Engine/Framework/AssetLoadGraph.cpp Engine/File/MappedFile.cpp Engine/File/BinaryStream.cpp Engine/File/ContentHash.cpp Engine/File/LZ4.cpp Engine/File/AssetArchive.cpp Engine/File/VirtualFileSystem.cpp -pthread
+/// (Assetはエンジンのアセットを使うのでWindowsのみ)
+/// 引数でグループ名を指定するとそのグループのみ実行する
+/// 
+
+#include <cstring>
+#include <cstdio>
+
+void RunMathBenchmark();
+void RunRandomBenchmark();
+void RunCollisionBenchmark();
+void RunNarrowphaseBenchmark();
+void RunMeshBVHBenchmark();
+void RunThreadPoolBenchmark();
+void RunAssetBenchmark();
+void RunArchiveBenchmark();
+void RunSceneLoadBenchmark();
+
+namespace {
+
+    struct Group {
+        const char* name;
+        void (*run)();
+    };
+
+    const Group kGroups[] = {
+        { "Math", RunMathBenchmark },
+        { "Random", RunRandomBenchmark },
+        { "Collision", RunCollisionBenchmark },
+        { "Narrowphase", RunNarrowphaseBenchmark },
+        { "MeshBVH", RunMeshBVHBenchmark },
+        { "ThreadPool", RunThreadPoolBenchmark },
+        { "Asset", RunAssetBenchmark },
+        { "Archive", RunArchiveBenchmark },
+        { "SceneLoad", RunSceneLoadBenchmark },
+    };
+
+}
+
+int main(int argc, char* argv[]) {
+    for (auto& group : kGroups) {
+        bool selected = argc <= 1;
+        for (int i = 1; i < argc; ++i) {
+            if (std::strcmp(argv[i], group.name) == 0) {
+                selected = true;
+            }
+        }
+        if (selected) {
+            group.run();
+        }
+    }
+    return 0;
+}
@@ -4,8 +4,13 @@
 #include <mfapi.h>
 #include <mfidl.h>
 #include <mfreadwrite.h>
+#include <shlwapi.h>
 #include <wrl.h>
 
+#include "File/VirtualFileSystem.h"
+
+#pragma comment(lib, "shlwapi.lib")
+
 template<class T>
 using ComPtr = Microsoft::WRL::ComPtr<T>;
 
@@ -21,7 +26,29 @@ namespace LIEngine {
         HRESULT hr = S_FALSE;
 
         ComPtr<IMFSourceReader> mfSourceReader;
-        hr = MFCreateSourceReaderFromURL(path.wstring().c_str(), NULL, mfSourceReader.GetAddressOf());
+        VirtualFileSystem::FileInfo fileInfo;
+        if (VirtualFileSystem::GetFileInfo(path, fileInfo) && fileInfo.isInArchive) {
+            // アーカイブ内のものはメモリから読む
+            FileData file;
+            bool isRead = VirtualFileSystem::ReadFile(path, file);
+            assert(isRead);
+            isRead;
+            ComPtr<IStream> stream;
+            stream.Attach(SHCreateMemStream(file.GetData(), static_cast<UINT>(file.GetSize())));
+            assert(stream);
+            ComPtr<IMFByteStream> mfByteStream;
+            hr = MFCreateMFByteStreamOnStream(stream.Get(), mfByteStream.GetAddressOf());
+            assert(SUCCEEDED(hr));
+            // 形式を拡張子から判断させる
+            ComPtr<IMFAttributes> mfByteStreamAttributes;
+            if (SUCCEEDED(mfByteStream.As(&mfByteStreamAttributes))) {
+                mfByteStreamAttributes->SetString(MF_BYTESTREAM_ORIGIN_NAME, path.wstring().c_str());
+            }
+            hr = MFCreateSourceReaderFromByteStream(mfByteStream.Get(), NULL, mfSourceReader.GetAddressOf());
+        }
+        else {
+            hr = MFCreateSourceReaderFromURL(path.wstring().c_str(), NULL, mfSourceReader.GetAddressOf());
+        }
         assert(SUCCEEDED(hr));
 
         ComPtr<IMFMediaType> mfMediaType;
@@ -23,6 +23,8 @@ namespace LIEngine {
 
         const WAVEFORMATEX* GetWaveFormat() const { return waveFormat_; }
         const std::vector<BYTE>& GetMediaData() const { return mediaData_; }
+        // メモリ使用量 (バイト)
+        size_t GetCPUMemorySize() const { return mediaData_.size(); }
 
     private:
         Sound();
@@ -1,54 +1,81 @@
 #include "Collider.h"
 
-#include <array>
+#include <cmath>
+#include <mutex>
+#include <unordered_map>
 
 #include "CollisionManager.h"
-
-#include <limits>
+#include "MeshBVH.h"
+#include "Narrowphase.h"
+#include "Graphics/Model.h"
 
 namespace {
 
     using namespace LIEngine;
 
-    std::vector<Vector3> GetVertices(const Math::OBB& obb) {
-        Vector3 halfSize = obb.size * 0.5f;
-
-        std::vector<Vector3> vertices(8);
-
-        vertices[0] = { -halfSize.x, -halfSize.y, -halfSize.z };   // 左下前
-        vertices[1] = { -halfSize.x,  halfSize.y, -halfSize.z };   // 左上前
-        vertices[2] = { halfSize.x,  halfSize.y, -halfSize.z };   // 右上前
-        vertices[3] = { halfSize.x, -halfSize.y, -halfSize.z };   // 右下前
-        vertices[4] = { -halfSize.x, -halfSize.y,  halfSize.z };   // 左下奥 
-        vertices[5] = { -halfSize.x,  halfSize.y,  halfSize.z };   // 左上奥
-        vertices[6] = { halfSize.x,  halfSize.y,  halfSize.z };   // 右上奥
-        vertices[7] = { halfSize.x, -halfSize.y,  halfSize.z };   // 右下奥
-
-        Matrix4x4 obbWorldMatrix =
-            Matrix4x4().SetXAxis(obb.orientations[0]).SetYAxis(obb.orientations[1]).SetZAxis(obb.orientations[2]).SetTranslate(obb.center);
-        for (size_t i = 0; i < vertices.size(); ++i) {
-            vertices[i] = vertices[i] * obbWorldMatrix;
+    // 詳細判定を行い、衝突情報を格納する
+    template<typename A, typename B>
+    bool Collide(Collider* self, const A& a, const B& b, CollisionInfo& collisionInfo) {
+        Narrowphase::Contact contact;
+        if (!Narrowphase::Collide(a, b, contact)) {
+            return false;
         }
-
-        return vertices;
+        collisionInfo.gameObject = self->GetGameObject();
+        collisionInfo.normal = contact.normal;
+        collisionInfo.depth = contact.depth;
+        return true;
     }
 
-    Vector2 Projection(const std::vector<Vector3>& vertices, const Vector3& axis) {
-        Vector2 minmax(Dot(axis, vertices[0]));
-        for (size_t i = 1; i < vertices.size(); ++i) {
-            float dot = Dot(axis, vertices[i]);
-            minmax.x = std::min(dot, minmax.x);
-            minmax.y = std::max(dot, minmax.y);
+    // メッシュとの判定 (法線はshapeからメッシュへ)
+    template<typename Shape>
+    bool CollideMesh(Collider* self, const Shape& shape, const MeshCollider* mesh, CollisionInfo& collisionInfo) {
+        Narrowphase::Contact contact;
+        if (!mesh->Collide(shape, contact)) {
+            return false;
         }
-        return minmax;
+        collisionInfo.gameObject = self->GetGameObject();
+        collisionInfo.normal = contact.normal;
+        collisionInfo.depth = contact.depth;
+        return true;
     }
 
-    float GetOverlap(const Vector2& minmax1, const Vector2& minmax2) {
-        float range1 = minmax1.y - minmax1.x;
-        float range2 = minmax2.y - minmax2.x;
-        float maxOverlap = std::max(minmax1.y, minmax2.y) - std::min(minmax1.x, minmax2.x);
-        return range1 + range2 - maxOverlap;
+    // 同じモデルのBVHを共有する
+    struct SharedBVH {
+        // 同じアドレスに別のモデルが作られた場合の判別用
+        std::weak_ptr<Model> model;
+        std::weak_ptr<const MeshBVH> bvh;
+    };
+    std::mutex g_sharedBVHMutex;
+    std::unordered_map<const Model*, SharedBVH> g_sharedBVHs;
+
+    std::shared_ptr<const MeshBVH> GetSharedBVH(const std::shared_ptr<Model>& model) {
+        std::lock_guard<std::mutex> lock(g_sharedBVHMutex);
+        SharedBVH& shared = g_sharedBVHs[model.get()];
+        if (!shared.model.expired()) {
+            if (auto bvh = shared.bvh.lock()) {
+                return bvh;
+            }
+        }
+
+        // インデックスはメッシュごとなので頂点の位置をずらす
+        std::vector<Vector3> positions(model->GetNumVertices());
+        for (size_t i = 0; i < positions.size(); ++i) {
+            positions[i] = model->GetVertices()[i].position;
+        }
+        std::vector<uint32_t> indices;
+        indices.reserve(model->GetNumIndices());
+        for (auto& mesh : model->GetMeshes()) {
+            for (uint32_t i = 0; i < mesh.indexCount; ++i) {
+                indices.emplace_back(model->GetIndices()[mesh.indexOffset + i] + mesh.vertexOffset);
+            }
+        }
+
+        auto bvh = std::make_shared<const MeshBVH>(positions, indices);
+        shared.model = model;
+        shared.bvh = bvh;
+        return bvh;
     }
+
 }
 
 namespace LIEngine {
@@ -67,6 +94,18 @@ namespace LIEngine {
         }
     }
 
+    void Collider::OnCollisionEnter(const CollisionInfo& collisionInfo) {
+        if (enterCallback_) {
+            enterCallback_(collisionInfo);
+        }
+    }
+
+    void Collider::OnCollisionExit(const CollisionInfo& collisionInfo) {
+        if (exitCallback_) {
+            exitCallback_(collisionInfo);
+        }
+    }
+
     bool Collider::CanCollision(Collider* other) const {
         return (this->collisionAttribute_ & other->collisionMask_) && (other->collisionAttribute_ & this->collisionMask_);
     }
@@ -75,6 +114,12 @@ namespace LIEngine {
         return (this->collisionAttribute_ & mask);
     }
 
+    void Collider::SetDirty() {
+        if (!isDirty_) {
+            CollisionManager::GetInstance()->MarkDirty(this);
+        }
+    }
+
     bool SphereCollider::IsCollision(Collider* other, CollisionInfo& collisionInfo) {
         if (CanCollision(other)) {
             return  other->IsCollision(this, collisionInfo);
@@ -83,56 +128,23 @@ namespace LIEngine {
     }
 
     bool SphereCollider::IsCollision(SphereCollider* other, CollisionInfo& collisionInfo) {
-        // 差分ベクトルを求める
-        Vector3 diff = other->sphere_.center - this->sphere_.center;
-        float hitRange = this->sphere_.radius + other->sphere_.radius;
-        if (diff.LengthSquare() > hitRange * hitRange) {
-            return false;
-        }
-
-        // 衝突情報を格納していく
-        float length = diff.Length();
-        collisionInfo.gameObject = this->GetGameObject();
-        if (length != 0.0f) {
-            collisionInfo.normal = diff / length;
-        }
-        else {
-            collisionInfo.normal = Vector3::zero;
-        }
-        collisionInfo.depth = hitRange - length;
-        return true;
+        return Collide(this, sphere_, other->GetSphere(), collisionInfo);
     }
 
     bool SphereCollider::IsCollision(BoxCollider* other, CollisionInfo& collisionInfo) {
-        Math::Sphere& sphere = this->sphere_;
-        Math::OBB& obb = other->obb_;
-        // obbのローカル空間で衝突判定を行う
-        Matrix4x4 obbRotateMatrix = Matrix4x4().SetXAxis(obb.orientations[0]).SetYAxis(obb.orientations[1]).SetZAxis(obb.orientations[2]);
-        Matrix4x4 obbWorldInverse = Matrix4x4::MakeAffineInverse(obbRotateMatrix, obb.center);
-        Vector3 centerInOBBLocal = sphere.center * obbWorldInverse;
-        Vector3 halfSize = obb.size * 0.5f;
+        return Collide(this, sphere_, other->GetOBB(), collisionInfo);
+    }
 
-        Vector3 point = {
-              std::clamp(centerInOBBLocal.x, -halfSize.x, halfSize.x),
-              std::clamp(centerInOBBLocal.y, -halfSize.y, halfSize.y),
-              std::clamp(centerInOBBLocal.z, -halfSize.z, halfSize.z) };
-        Vector3 diff = point - centerInOBBLocal;
+    bool SphereCollider::IsCollision(CapsuleCollider* other, CollisionInfo& collisionInfo) {
+        return Collide(this, sphere_, other->GetCapsule(), collisionInfo);
+    }
 
-        if (diff.LengthSquare() > sphere.radius * sphere.radius) {
-            return false;
-        }
+    bool SphereCollider::IsCollision(AABBCollider* other, CollisionInfo& collisionInfo) {
+        return Collide(this, sphere_, other->GetAABB(), collisionInfo);
+    }
 
-        // 衝突情報を格納していく
-        float length = diff.Length();
-        collisionInfo.gameObject = this->GetGameObject();
-        if (length != 0.0f) {
-            collisionInfo.normal = (diff / length) * obbRotateMatrix;
-        }
-        else {
-            collisionInfo.normal = Vector3::zero;
-        }
-        collisionInfo.depth = sphere.radius - length;
-        return true;
+    bool SphereCollider::IsCollision(MeshCollider* other, CollisionInfo& collisionInfo) {
+        return CollideMesh(this, sphere_, other, collisionInfo);
     }
 
     bool SphereCollider::RayCast(const Vector3& origin, const Vector3& diff, uint32_t mask, RayCastInfo& nearest) {
@@ -150,6 +162,11 @@ namespace LIEngine {
         return true;
     }
 
+    Math::AABB SphereCollider::GetBounds() const {
+        Vector3 radius(sphere_.radius);
+        return { sphere_.center - radius, sphere_.center + radius };
+    }
+
     bool BoxCollider::IsCollision(Collider* other, CollisionInfo& collisionInfo) {
         if (CanCollision(other)) {
             return  other->IsCollision(this, collisionInfo);
@@ -158,100 +175,24 @@ namespace LIEngine {
     }
 
     bool BoxCollider::IsCollision(SphereCollider* other, CollisionInfo& collisionInfo) {
-        Math::Sphere& sphere = other->sphere_;
-        Math::OBB& obb = this->obb_;
-        // obbのローカル空間で衝突判定を行う
-        Matrix4x4 obbRotateMatrix = Matrix4x4().SetXAxis(obb.orientations[0]).SetYAxis(obb.orientations[1]).SetZAxis(obb.orientations[2]);
-        Matrix4x4 obbWorldInverse = Matrix4x4::MakeAffineInverse(obbRotateMatrix, obb.center);
-        Vector3 centerInOBBLocal = sphere.center * obbWorldInverse;
-        Vector3 halfSize = obb.size * 0.5f;
-
-        Vector3 point = {
-              std::clamp(centerInOBBLocal.x, -halfSize.x, halfSize.x),
-              std::clamp(centerInOBBLocal.y, -halfSize.y, halfSize.y),
-              std::clamp(centerInOBBLocal.z, -halfSize.z, halfSize.z) };
-        Vector3 diff = centerInOBBLocal - point;
-
-        if (diff.LengthSquare() > sphere.radius * sphere.radius) {
-            return false;
-        }
-
-        // 衝突情報を格納していく
-        float length = diff.Length();
-        collisionInfo.gameObject = this->GetGameObject();
-        if (length != 0.0f) {
-            collisionInfo.normal = (diff / length) * obbRotateMatrix;
-        }
-        else {
-            collisionInfo.normal = Vector3::zero;
-        }
-        collisionInfo.depth = sphere.radius - length;
-        return true;
+        return Collide(this, obb_, other->GetSphere(), collisionInfo);
     }
 
     bool BoxCollider::IsCollision(BoxCollider* other, CollisionInfo& collisionInfo) {
-        auto vertices1 = GetVertices(this->obb_);
-        auto vertices2 = GetVertices(other->obb_);
-
-        Vector3 axes[] = {
-            this->obb_.orientations[0],
-            this->obb_.orientations[1],
-            this->obb_.orientations[2],
-
-            other->obb_.orientations[0],
-            other->obb_.orientations[1],
-            other->obb_.orientations[2],
-
-            Cross(this->obb_.orientations[0], other->obb_.orientations[0]).Normalized(),
-            Cross(this->obb_.orientations[0], other->obb_.orientations[1]).Normalized(),
-            Cross(this->obb_.orientations[0], other->obb_.orientations[2]).Normalized(),
-
-            Cross(this->obb_.orientations[1], other->obb_.orientations[0]).Normalized(),
-            Cross(this->obb_.orientations[1], other->obb_.orientations[1]).Normalized(),
-            Cross(this->obb_.orientations[1], other->obb_.orientations[2]).Normalized(),
-
-            Cross(this->obb_.orientations[2], other->obb_.orientations[0]).Normalized(),
-            Cross(this->obb_.orientations[2], other->obb_.orientations[1]).Normalized(),
-            Cross(this->obb_.orientations[2], other->obb_.orientations[2]).Normalized(),
-        };
-
-        float minOverlap = FLT_MAX;
-        Vector3 minOverlapAxis = {};
-
-        // 分離軸判定関数
-        auto IsSeparateAxis = [&](const Vector3& axis) {
-            if (axis == Vector3::zero) { return false; }
-            Vector2 minmax1 = Projection(vertices1, axis);
-            Vector2 minmax2 = Projection(vertices2, axis);
-
-            // 分離軸である
-            if (!(minmax1.x <= minmax2.y && minmax1.y >= minmax2.x)) {
-                return true;
-            }
-
-            float overlap = GetOverlap(minmax1, minmax2);
-
-            if (overlap < minOverlap) {
-                minOverlapAxis = axis;
-                minOverlap = overlap;
-            }
+        return Collide(this, obb_, other->GetOBB(), collisionInfo);
+    }
 
-            return false;
-            };
+    bool BoxCollider::IsCollision(CapsuleCollider* other, CollisionInfo& collisionInfo) {
+        return Collide(this, obb_, other->GetCapsule(), collisionInfo);
+    }
 
-        for (auto& axis : axes) {
-            if (std::isnan(axis.x) || std::isnan(axis.y) || std::isnan(axis.z)) { continue; }
-            if (IsSeparateAxis(axis)) { return false; }
-        }
+    bool BoxCollider::IsCollision(AABBCollider* other, CollisionInfo& collisionInfo) {
+        return Collide(this, obb_, other->GetAABB(), collisionInfo);
+    }
 
-        // 衝突情報を格納していく
-        collisionInfo.gameObject = this->GetGameObject();
-        collisionInfo.normal = minOverlapAxis.Normalized();
-        if (Dot(other->obb_.center - this->obb_.center, collisionInfo.normal) < 0.0f) {
-            collisionInfo.normal *= -1;
-        }
-        collisionInfo.depth = minOverlap;
-        return true;
+    bool BoxCollider::IsCollision(MeshCollider*, CollisionInfo&) {
+        // 箱とメッシュの判定は未対応
+        return false;
     }
 
     bool BoxCollider::RayCast(const Vector3& origin, const Vector3& diff, uint32_t mask, RayCastInfo& nearest) {
@@ -259,13 +200,12 @@ namespace LIEngine {
 
         Math::OBB& obb = this->obb_;
         // obbのローカル空間で衝突判定を行う
-        Matrix4x4 obbRotateMatrix = Matrix4x4().SetXAxis(obb.orientations[0]).SetYAxis(obb.orientations[1]).SetZAxis(obb.orientations[2]);
-        Matrix4x4 obbWorldInverse = Matrix4x4::MakeAffineInverse(obbRotateMatrix, obb.center);
+        Matrix3x4 obbWorldInverse = Matrix3x4::MakeFromAxes(obb.orientations[0], obb.orientations[1], obb.orientations[2], obb.center).InverseOrthonormal();
         Vector3 halfSize = obb.size * 0.5f;
         Math::AABB aabbInOBBLocal{ -halfSize, halfSize };
 
         Vector3 originInOBBLocal = origin * obbWorldInverse;
-        Vector3 diffInOBBLocal = ((origin + diff) * obbWorldInverse) - originInOBBLocal;
+        Vector3 diffInOBBLocal = obbWorldInverse.ApplyRotation(diff);
 
 
         float tXMin = (aabbInOBBLocal.min.x - originInOBBLocal.x) / diffInOBBLocal.x;
@@ -301,4 +241,222 @@ namespace LIEngine {
         return true;
     }
 
+    Math::AABB BoxCollider::GetBounds() const {
+        // 各軸の半分の長さをワールド軸に射影した合計
+        Vector3 halfSize = obb_.size * 0.5f;
+        Vector3 extent = {
+            std::abs(obb_.orientations[0].x) * halfSize.x + std::abs(obb_.orientations[1].x) * halfSize.y + std::abs(obb_.orientations[2].x) * halfSize.z,
+            std::abs(obb_.orientations[0].y) * halfSize.x + std::abs(obb_.orientations[1].y) * halfSize.y + std::abs(obb_.orientations[2].y) * halfSize.z,
+            std::abs(obb_.orientations[0].z) * halfSize.x + std::abs(obb_.orientations[1].z) * halfSize.y + std::abs(obb_.orientations[2].z) * halfSize.z };
+        return { obb_.center - extent, obb_.center + extent };
+    }
+
+    bool CapsuleCollider::IsCollision(Collider* other, CollisionInfo& collisionInfo) {
+        if (CanCollision(other)) {
+            return  other->IsCollision(this, collisionInfo);
+        }
+        return false;
+    }
+
+    bool CapsuleCollider::IsCollision(SphereCollider* other, CollisionInfo& collisionInfo) {
+        return Collide(this, capsule_, other->GetSphere(), collisionInfo);
+    }
+
+    bool CapsuleCollider::IsCollision(BoxCollider* other, CollisionInfo& collisionInfo) {
+        return Collide(this, capsule_, other->GetOBB(), collisionInfo);
+    }
+
+    bool CapsuleCollider::IsCollision(CapsuleCollider* other, CollisionInfo& collisionInfo) {
+        return Collide(this, capsule_, other->GetCapsule(), collisionInfo);
+    }
+
+    bool CapsuleCollider::IsCollision(AABBCollider* other, CollisionInfo& collisionInfo) {
+        return Collide(this, capsule_, other->GetAABB(), collisionInfo);
+    }
+
+    bool CapsuleCollider::IsCollision(MeshCollider* other, CollisionInfo& collisionInfo) {
+        return CollideMesh(this, capsule_, other, collisionInfo);
+    }
+
+    bool CapsuleCollider::RayCast(const Vector3& origin, const Vector3& diff, uint32_t mask, RayCastInfo& nearest) {
+        if (!CanCollision(mask)) { return false; }
+
+        // レイと芯の最も近い位置で判定する
+        float t1, t2;
+        Narrowphase::ClosestFractions({ origin, diff }, capsule_.segment, t1, t2);
+        Vector3 closest = capsule_.segment.origin + capsule_.segment.diff * t2;
+        float distanceSquare = (origin + diff * t1 - closest).LengthSquare();
+        float radiusSquare = capsule_.radius * capsule_.radius;
+        if (distanceSquare > radiusSquare) {
+            return false;
+        }
+        // 最も近い位置の球に入る位置まで戻す (表面より奥になることはない)
+        float length = diff.Length();
+        float back = length != 0.0f ? std::sqrt(radiusSquare - distanceSquare) / length : 0.0f;
+        nearest.nearest = std::max(t1 - back, 0.0f);
+        return true;
+    }
+
+    Math::AABB CapsuleCollider::GetBounds() const {
+        Vector3 radius(capsule_.radius);
+        Vector3 start = capsule_.segment.origin;
+        Vector3 end = capsule_.segment.origin + capsule_.segment.diff;
+        return { Vector3::Min(start, end) - radius, Vector3::Max(start, end) + radius };
+    }
+
+    bool AABBCollider::IsCollision(Collider* other, CollisionInfo& collisionInfo) {
+        if (CanCollision(other)) {
+            return  other->IsCollision(this, collisionInfo);
+        }
+        return false;
+    }
+
+    bool AABBCollider::IsCollision(SphereCollider* other, CollisionInfo& collisionInfo) {
+        return Collide(this, aabb_, other->GetSphere(), collisionInfo);
+    }
+
+    bool AABBCollider::IsCollision(BoxCollider* other, CollisionInfo& collisionInfo) {
+        return Collide(this, aabb_, other->GetOBB(), collisionInfo);
+    }
+
+    bool AABBCollider::IsCollision(CapsuleCollider* other, CollisionInfo& collisionInfo) {
+        return Collide(this, aabb_, other->GetCapsule(), collisionInfo);
+    }
+
+    bool AABBCollider::IsCollision(AABBCollider* other, CollisionInfo& collisionInfo) {
+        return Collide(this, aabb_, other->GetAABB(), collisionInfo);
+    }
+
+    bool AABBCollider::IsCollision(MeshCollider*, CollisionInfo&) {
+        // 箱とメッシュの判定は未対応
+        return false;
+    }
+
+    bool AABBCollider::RayCast(const Vector3& origin, const Vector3& diff, uint32_t mask, RayCastInfo& nearest) {
+        if (!CanCollision(mask)) { return false; }
+
+        float tMin = -FLT_MAX;
+        float tMax = FLT_MAX;
+        for (size_t i = 0; i < 3; ++i) {
+            // 軸に平行な場合は範囲内かどうかのみ
+            if (diff[i] == 0.0f) {
+                if (origin[i] < aabb_.min[i] || origin[i] > aabb_.max[i]) { return false; }
+                continue;
+            }
+            float t1 = (aabb_.min[i] - origin[i]) / diff[i];
+            float t2 = (aabb_.max[i] - origin[i]) / diff[i];
+            tMin = (std::max)(tMin, (std::min)(t1, t2));
+            tMax = (std::min)(tMax, (std::max)(t1, t2));
+        }
+        if (tMin > tMax) { return false; }
+        // 始点側は判定無し
+        if (tMax < 0.0f) { return false; }
+
+        nearest.nearest = (std::max)(tMin, 0.0f);
+        return true;
+    }
+
+    bool MeshCollider::IsCollision(Collider* other, CollisionInfo& collisionInfo) {
+        if (CanCollision(other)) {
+            return  other->IsCollision(this, collisionInfo);
+        }
+        return false;
+    }
+
+    bool MeshCollider::IsCollision(SphereCollider* other, CollisionInfo& collisionInfo) {
+        if (!CollideMesh(this, other->GetSphere(), this, collisionInfo)) { return false; }
+        collisionInfo.normal = -collisionInfo.normal;
+        return true;
+    }
+
+    bool MeshCollider::IsCollision(BoxCollider*, CollisionInfo&) {
+        // 箱とメッシュの判定は未対応
+        return false;
+    }
+
+    bool MeshCollider::IsCollision(CapsuleCollider* other, CollisionInfo& collisionInfo) {
+        if (!CollideMesh(this, other->GetCapsule(), this, collisionInfo)) { return false; }
+        collisionInfo.normal = -collisionInfo.normal;
+        return true;
+    }
+
+    bool MeshCollider::IsCollision(AABBCollider*, CollisionInfo&) {
+        // 箱とメッシュの判定は未対応
+        return false;
+    }
+
+    bool MeshCollider::IsCollision(MeshCollider*, CollisionInfo&) {
+        // 動かないもの同士は判定しない
+        return false;
+    }
+
+    bool MeshCollider::RayCast(const Vector3& origin, const Vector3& diff, uint32_t mask, RayCastInfo& nearest) {
+        if (!CanCollision(mask)) { return false; }
+        if (!bvh_) { return false; }
+
+        // アフィン変換なので割合はローカル空間でも同じ
+        MeshBVH::RayHit hit;
+        if (!bvh_->RayCast(origin * worldInverse_, worldInverse_.ApplyRotation(diff), 1.0f, hit)) {
+            return false;
+        }
+        nearest.nearest = hit.fraction;
+        return true;
+    }
+
+    Math::AABB MeshCollider::GetBounds() const {
+        Vector3 translate = worldMatrix_.GetTranslate();
+        if (!bvh_) { return Math::AABB(translate); }
+
+        // 中心と半分の大きさを変換する
+        const Math::AABB& local = bvh_->GetBounds();
+        Vector3 center = local.Center() * worldMatrix_;
+        Vector3 halfSize = local.Extent() * 0.5f;
+        Vector3 extent;
+        for (size_t i = 0; i < 3; ++i) {
+            extent[i] =
+                std::abs(worldMatrix_.m[i][0]) * halfSize.x +
+                std::abs(worldMatrix_.m[i][1]) * halfSize.y +
+                std::abs(worldMatrix_.m[i][2]) * halfSize.z;
+        }
+        return { center - extent, center + extent };
+    }
+
+    void MeshCollider::SetModel(const std::shared_ptr<Model>& model) {
+        bvh_ = model ? GetSharedBVH(model) : nullptr;
+        SetDirty();
+    }
+
+    void MeshCollider::SetWorldMatrix(const Matrix4x4& worldMatrix) {
+        worldMatrix_ = Matrix3x4(worldMatrix);
+        worldInverse_ = worldMatrix_.Inverse();
+        scale_ = worldMatrix_.GetXAxis().Length();
+        SetDirty();
+    }
+
+    bool MeshCollider::Collide(const Math::Sphere& sphere, Narrowphase::Contact& contact) const {
+        if (!bvh_) { return false; }
+        if (!bvh_->Collide(Math::Sphere{ sphere.center * worldInverse_, sphere.radius / scale_ }, contact)) {
+            return false;
+        }
+        ToWorld(contact);
+        return true;
+    }
+
+    bool MeshCollider::Collide(const Math::Capsule& capsule, Narrowphase::Contact& contact) const {
+        if (!bvh_) { return false; }
+        Math::Capsule localCapsule = {
+            { capsule.segment.origin * worldInverse_, worldInverse_.ApplyRotation(capsule.segment.diff) },
+            capsule.radius / scale_ };
+        if (!bvh_->Collide(localCapsule, contact)) {
+            return false;
+        }
+        ToWorld(contact);
+        return true;
+    }
+
+    void MeshCollider::ToWorld(Narrowphase::Contact& contact) const {
+        contact.normal = worldMatrix_.ApplyRotation(contact.normal).Normalized();
+        contact.depth *= scale_;
+    }
+
 }
\ No newline at end of file
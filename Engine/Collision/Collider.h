@@ -12,6 +12,7 @@
 
 #include "Math/MathUtils.h"
 #include "Math/Geometry.h"
+#include "Narrowphase.h"
 
 namespace LIEngine {
 
@@ -19,6 +20,11 @@ namespace LIEngine {
     class Collider;
     class SphereCollider;
     class BoxCollider;
+    class CapsuleCollider;
+    class AABBCollider;
+    class MeshCollider;
+    class MeshBVH;
+    class Model;
 
     struct CollisionInfo {
         std::shared_ptr<GameObject> gameObject;
@@ -26,11 +32,39 @@ namespace LIEngine {
         float depth;
     };
 
+    enum class ContactEventType {
+        // 触れ始めた
+        Enter,
+        // 触れ続けている
+        Stay,
+        // 離れた
+        Exit
+    };
+
     struct RayCastInfo {
         std::shared_ptr<GameObject> gameObject;
         float nearest;
     };
 
+    enum class RayCastMode {
+        // 最も近いヒット
+        Closest,
+        // どれか一つでもヒットすれば終了 (遮蔽や可視判定用)
+        Any
+    };
+
+    struct RayCastCommand {
+        Vector3 origin;
+        Vector3 diff;
+        uint32_t mask = 0xFFFFFFFF;
+        RayCastMode mode = RayCastMode::Closest;
+    };
+
+    struct RayCastResult {
+        RayCastInfo info;
+        bool hit;
+    };
+
     class Collider :
         public Component {
         friend class CollisionManager;
@@ -46,64 +80,231 @@ namespace LIEngine {
         virtual bool IsCollision(Collider* collider, CollisionInfo& collisionInfo) = 0;
         virtual bool IsCollision(SphereCollider* collider, CollisionInfo& collisionInfo) = 0;
         virtual bool IsCollision(BoxCollider* collider, CollisionInfo& collisionInfo) = 0;
+        virtual bool IsCollision(CapsuleCollider* collider, CollisionInfo& collisionInfo) = 0;
+        virtual bool IsCollision(AABBCollider* collider, CollisionInfo& collisionInfo) = 0;
+        virtual bool IsCollision(MeshCollider* collider, CollisionInfo& collisionInfo) = 0;
 
         virtual bool RayCast(const Vector3& origin, const Vector3& diff, uint32_t mask, RayCastInfo& nearest) = 0;
 
+        /// <summary>
+        /// ワールド空間のAABBを取得
+        /// </summary>
+        /// <returns></returns>
+        virtual Math::AABB GetBounds() const = 0;
+
         /// <summary>
         /// ヒット時のコールバック関数
+        /// 触れている間毎フレーム呼ばれる (触れ始めたフレームも含む)
         /// </summary>
         /// <param name="callback">コールバック関数</param>
         void SetCallback(Callback callback) { callback_ = callback; }
-        void SetCollisionAttribute(uint32_t attribute) { collisionAttribute_ = attribute; }
-        void SetCollisionMask(uint32_t mask) { collisionMask_ = mask; }
+        /// <summary>
+        /// 触れ始めた時のコールバック関数
+        /// </summary>
+        /// <param name="callback">コールバック関数</param>
+        void SetEnterCallback(Callback callback) { enterCallback_ = callback; }
+        /// <summary>
+        /// 離れた時のコールバック関数
+        /// 衝突情報は最後に触れていた時のもの
+        /// 触れていた相手が削除された時も次のCheckCollisionで呼ばれる
+        /// </summary>
+        /// <param name="callback">コールバック関数</param>
+        void SetExitCallback(Callback callback) { exitCallback_ = callback; }
+        void SetCollisionAttribute(uint32_t attribute) { collisionAttribute_ = attribute; SetDirty(); }
+        void SetCollisionMask(uint32_t mask) { collisionMask_ = mask; SetDirty(); }
 
         void OnCollision(const CollisionInfo& collisionInfo);
+        void OnCollisionEnter(const CollisionInfo& collisionInfo);
+        void OnCollisionExit(const CollisionInfo& collisionInfo);
 
     protected:
         bool CanCollision(Collider* other) const;
         bool CanCollision(uint32_t mask) const;
+        /// <summary>
+        /// 形状を変更したらブロードフェーズに知らせる
+        /// </summary>
+        void SetDirty();
 
         Callback callback_;
+        Callback enterCallback_;
+        Callback exitCallback_;
         uint32_t collisionAttribute_ = 0xFFFFFFFF;
         uint32_t collisionMask_ = 0xFFFFFFFF;
+
+    private:
+        // CollisionManagerが管理する
+        int32_t proxyId_ = -1;
+        uint32_t index_ = 0;
+        // 形状や属性が変わったフレーム
+        uint32_t changedFrame_ = 0xFFFFFFFF;
+        // 太らせたAABBが変わったフレーム
+        uint32_t movedFrame_ = 0xFFFFFFFF;
+        bool isDirty_ = false;
     };
 
     class SphereCollider :
         public Collider {
-        friend class BoxCollider;
     public:
-        bool IsCollision(Collider* collider, CollisionInfo& collisionInfo) override;
-        bool IsCollision(SphereCollider* collider, CollisionInfo& collisionInfo) override;
-        bool IsCollision(BoxCollider* collider, CollisionInfo& collisionInfo) override;
+        bool IsCollision(Collider* other, CollisionInfo& collisionInfo) override;
+        bool IsCollision(SphereCollider* other, CollisionInfo& collisionInfo) override;
+        bool IsCollision(BoxCollider* other, CollisionInfo& collisionInfo) override;
+        bool IsCollision(CapsuleCollider* other, CollisionInfo& collisionInfo) override;
+        bool IsCollision(AABBCollider* other, CollisionInfo& collisionInfo) override;
+        bool IsCollision(MeshCollider* other, CollisionInfo& collisionInfo) override;
         bool RayCast(const Vector3& origin, const Vector3& diff, uint32_t mask, RayCastInfo& nearest) override;
+        Math::AABB GetBounds() const override;
 
+        void SetCenter(const Vector3& center) { sphere_.center = center; SetDirty(); }
+        void SetRadius(float radius) { sphere_.radius = radius; SetDirty(); }
 
-        void SetCenter(const Vector3& center) { sphere_.center = center; }
-        void SetRadius(float radius) { sphere_.radius = radius; }
+        const Math::Sphere& GetSphere() const { return sphere_; }
 
     private:
-        Math::Sphere sphere_;
+        Math::Sphere sphere_{ Vector3::zero, 1.0f };
     };
 
     class BoxCollider :
         public Collider {
-        friend class SphereCollider;
     public:
         bool IsCollision(Collider* other, CollisionInfo& collisionInfo) override;
         bool IsCollision(SphereCollider* other, CollisionInfo& collisionInfo) override;
         bool IsCollision(BoxCollider* other, CollisionInfo& collisionInfo) override;
+        bool IsCollision(CapsuleCollider* other, CollisionInfo& collisionInfo) override;
+        bool IsCollision(AABBCollider* other, CollisionInfo& collisionInfo) override;
+        bool IsCollision(MeshCollider* other, CollisionInfo& collisionInfo) override;
         bool RayCast(const Vector3& origin, const Vector3& diff, uint32_t mask, RayCastInfo& nearest) override;
+        Math::AABB GetBounds() const override;
 
-        void SetCenter(const Vector3& center) { obb_.center = center; }
+        void SetCenter(const Vector3& center) { obb_.center = center; SetDirty(); }
         void SetOrientation(const Quaternion& orientation) {
             obb_.orientations[0] = orientation.GetRight();
             obb_.orientations[1] = orientation.GetUp();
             obb_.orientations[2] = orientation.GetForward();
+            SetDirty();
+        }
+        void SetSize(const Vector3& size) { obb_.size = size; SetDirty(); }
+
+        const Math::OBB& GetOBB() const { return obb_; }
+
+    private:
+        Math::OBB obb_{ Vector3::zero, { Vector3::unitX, Vector3::unitY, Vector3::unitZ }, Vector3::one };
+    };
+
+    class CapsuleCollider :
+        public Collider {
+    public:
+        bool IsCollision(Collider* other, CollisionInfo& collisionInfo) override;
+        bool IsCollision(SphereCollider* other, CollisionInfo& collisionInfo) override;
+        bool IsCollision(BoxCollider* other, CollisionInfo& collisionInfo) override;
+        bool IsCollision(CapsuleCollider* other, CollisionInfo& collisionInfo) override;
+        bool IsCollision(AABBCollider* other, CollisionInfo& collisionInfo) override;
+        bool IsCollision(MeshCollider* other, CollisionInfo& collisionInfo) override;
+        bool RayCast(const Vector3& origin, const Vector3& diff, uint32_t mask, RayCastInfo& nearest) override;
+        Math::AABB GetBounds() const override;
+
+        /// <summary>
+        /// 芯になる線分をセット
+        /// </summary>
+        /// <param name="start">始点</param>
+        /// <param name="end">終点</param>
+        void SetSegment(const Vector3& start, const Vector3& end) {
+            capsule_.segment.origin = start;
+            capsule_.segment.diff = end - start;
+            SetDirty();
         }
-        void SetSize(const Vector3& size) { obb_.size = size; }
+        void SetRadius(float radius) { capsule_.radius = radius; SetDirty(); }
+
+        const Math::Capsule& GetCapsule() const { return capsule_; }
+
+    private:
+        Math::Capsule capsule_{ { Vector3::zero, Vector3::unitY }, 0.5f };
+    };
+
+    class AABBCollider :
+        public Collider {
+    public:
+        bool IsCollision(Collider* other, CollisionInfo& collisionInfo) override;
+        bool IsCollision(SphereCollider* other, CollisionInfo& collisionInfo) override;
+        bool IsCollision(BoxCollider* other, CollisionInfo& collisionInfo) override;
+        bool IsCollision(CapsuleCollider* other, CollisionInfo& collisionInfo) override;
+        bool IsCollision(AABBCollider* other, CollisionInfo& collisionInfo) override;
+        bool IsCollision(MeshCollider* other, CollisionInfo& collisionInfo) override;
+        bool RayCast(const Vector3& origin, const Vector3& diff, uint32_t mask, RayCastInfo& nearest) override;
+        Math::AABB GetBounds() const override { return aabb_; }
+
+        void SetCenter(const Vector3& center) {
+            Vector3 halfSize = aabb_.Extent() * 0.5f;
+            aabb_ = { center - halfSize, center + halfSize };
+            SetDirty();
+        }
+        void SetSize(const Vector3& size) {
+            Vector3 center = aabb_.Center();
+            aabb_ = { center - size * 0.5f, center + size * 0.5f };
+            SetDirty();
+        }
+
+        const Math::AABB& GetAABB() const { return aabb_; }
+
+    private:
+        Math::AABB aabb_{ -Vector3::one * 0.5f, Vector3::one * 0.5f };
+    };
+
+    /// <summary>
+    /// モデルの三角形で判定するコライダー
+    /// 動かない地形や建物用で、球とカプセル、レイのみ判定する
+    /// 同じモデルのBVHは共有する
+    /// </summary>
+    class MeshCollider :
+        public Collider {
+    public:
+        bool IsCollision(Collider* other, CollisionInfo& collisionInfo) override;
+        bool IsCollision(SphereCollider* other, CollisionInfo& collisionInfo) override;
+        bool IsCollision(BoxCollider* other, CollisionInfo& collisionInfo) override;
+        bool IsCollision(CapsuleCollider* other, CollisionInfo& collisionInfo) override;
+        bool IsCollision(AABBCollider* other, CollisionInfo& collisionInfo) override;
+        bool IsCollision(MeshCollider* other, CollisionInfo& collisionInfo) override;
+        bool RayCast(const Vector3& origin, const Vector3& diff, uint32_t mask, RayCastInfo& nearest) override;
+        Math::AABB GetBounds() const override;
+
+        /// <summary>
+        /// モデルをセット
+        /// 初めて使うモデルの場合はBVHを構築する
+        /// </summary>
+        /// <param name="model"></param>
+        void SetModel(const std::shared_ptr<Model>& model);
+        /// <summary>
+        /// ワールド行列をセット
+        /// 拡縮は均一のみ対応
+        /// </summary>
+        /// <param name="worldMatrix"></param>
+        void SetWorldMatrix(const Matrix4x4& worldMatrix);
+
+        /// <summary>
+        /// 球との判定
+        /// </summary>
+        /// <param name="sphere">ワールド空間の球</param>
+        /// <param name="contact">法線は球からメッシュへ</param>
+        /// <returns>衝突しているか</returns>
+        bool Collide(const Math::Sphere& sphere, Narrowphase::Contact& contact) const;
+        /// <summary>
+        /// カプセルとの判定
+        /// </summary>
+        /// <param name="capsule">ワールド空間のカプセル</param>
+        /// <param name="contact">法線はカプセルからメッシュへ</param>
+        /// <returns>衝突しているか</returns>
+        bool Collide(const Math::Capsule& capsule, Narrowphase::Contact& contact) const;
+
+        const std::shared_ptr<const MeshBVH>& GetBVH() const { return bvh_; }
 
     private:
-        Math::OBB obb_;
+        // 結果をワールド空間に戻す
+        void ToWorld(Narrowphase::Contact& contact) const;
+
+        std::shared_ptr<const MeshBVH> bvh_;
+        // アフィン変換なので3x4で持つ
+        Matrix3x4 worldMatrix_;
+        Matrix3x4 worldInverse_;
+        float scale_ = 1.0f;
     };
 
 }
\ No newline at end of file
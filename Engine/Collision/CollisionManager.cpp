@@ -1,7 +1,70 @@
 #include "CollisionManager.h"
 
+#include <algorithm>
+
+#include "Framework/ThreadPool.h"
+
+namespace {
+
+    using namespace LIEngine;
+
+    // 1タスクが一度に取るパケット数
+    const size_t kPacketsPerChunk = 16;
+    // CheckCollisionで1タスクが一度に取るコライダー数
+    const size_t kCollidersPerChunk = 64;
+    // CheckCollisionで1タスクが一度に詳細判定するペア数
+    const size_t kPairsPerChunk = 256;
+
+    // プロキシ番号の小さい方を上位に入れる
+    uint64_t MakePairKey(int32_t proxyId1, int32_t proxyId2) {
+        if (proxyId1 > proxyId2) { std::swap(proxyId1, proxyId2); }
+        return (uint64_t(uint32_t(proxyId1)) << 32) | uint32_t(proxyId2);
+    }
+
+    // 10bitを3bit間隔に広げる
+    uint32_t SpreadBits(uint32_t value) {
+        value &= 0x3FF;
+        value = (value | (value << 16)) & 0x030000FF;
+        value = (value | (value << 8)) & 0x0300F00F;
+        value = (value | (value << 4)) & 0x030C30C3;
+        value = (value | (value << 2)) & 0x09249249;
+        return value;
+    }
+
+    // 向きの符号ごとに分け、その中を始点のモートン順に並べるキー
+    uint64_t MakeRayKey(const RayCastCommand& command, const Math::AABB& bounds, const Vector3& scale) {
+        uint32_t octant =
+            (command.diff.x < 0.0f ? 1u : 0u) |
+            (command.diff.y < 0.0f ? 2u : 0u) |
+            (command.diff.z < 0.0f ? 4u : 0u);
+        Vector3 position = command.origin - bounds.min;
+        uint32_t morton =
+            SpreadBits(uint32_t(position.x * scale.x)) |
+            (SpreadBits(uint32_t(position.y * scale.y)) << 1) |
+            (SpreadBits(uint32_t(position.z * scale.z)) << 2);
+        return (uint64_t(octant) << 30) | morton;
+    }
+
+}
+
 namespace LIEngine {
 
+    template<typename Function>
+    decltype(auto) CollisionManager::VisitBroadphase(Function&& function) {
+        if (broadphaseType_ == BroadphaseType::HashGrid) {
+            return function(hashGrid_);
+        }
+        return function(broadphase_);
+    }
+
+    template<typename Function>
+    decltype(auto) CollisionManager::VisitBroadphase(Function&& function) const {
+        if (broadphaseType_ == BroadphaseType::HashGrid) {
+            return function(hashGrid_);
+        }
+        return function(broadphase_);
+    }
+
     CollisionManager* CollisionManager::GetInstance() {
         static CollisionManager instance;
         return &instance;
@@ -9,6 +72,9 @@ namespace LIEngine {
 
     void CollisionManager::AddCollider(Collider* collider) {
         colliders_.emplace_back(collider);
+        // コンストラクタから呼ばれるので形状はまだ取れない
+        // 次のチェックでブロードフェーズに登録する
+        MarkDirty(collider);
     }
 
     void CollisionManager::RemoveCollider(Collider* collider) {
@@ -16,52 +82,350 @@ namespace LIEngine {
         if (iter != colliders_.end()) {
             colliders_.erase(iter);
         }
+        if (collider->isDirty_) {
+            auto dirtyIter = std::find(dirtyColliders_.begin(), dirtyColliders_.end(), collider);
+            if (dirtyIter != dirtyColliders_.end()) {
+                dirtyColliders_.erase(dirtyIter);
+            }
+            collider->isDirty_ = false;
+        }
+        if (collider->movedFrame_ == frame_) {
+            auto movedIter = std::find(movedColliders_.begin(), movedColliders_.end(), collider);
+            if (movedIter != movedColliders_.end()) {
+                movedColliders_.erase(movedIter);
+            }
+        }
+        if (collider->proxyId_ != DynamicAABBTree::kNullNode) {
+            // 削除されたコライダーとのペアを消し、触れていた相手には次のDispatchEventsでExitを呼ぶ
+            for (size_t i = pairs_.size(); i > 0; --i) {
+                Pair& pair = pairs_[i - 1];
+                if (pair.collider1 != collider && pair.collider2 != collider) { continue; }
+                if (pair.touching) {
+                    // 法線は相手を押し出す向きにする
+                    bool isCollider1 = pair.collider1 == collider;
+                    Collider* other = isCollider1 ? pair.collider2 : pair.collider1;
+                    removedContacts_.push_back({ other, { collider->GetGameObject(), isCollider1 ? -pair.normal : pair.normal, pair.depth } });
+                }
+                RemovePair(i - 1);
+            }
+            VisitBroadphase([&](auto& broadphase) { broadphase.DestroyProxy(collider->proxyId_); });
+            collider->proxyId_ = DynamicAABBTree::kNullNode;
+        }
+        // コールバック中に削除された場合は残りのイベントで呼ばない
+        for (auto& event : events_) {
+            if (event.collider1 == collider) { event.collider1 = nullptr; }
+            if (event.collider2 == collider) { event.collider2 = nullptr; }
+        }
+        for (auto& removedContact : removedContacts_) {
+            if (removedContact.collider == collider) { removedContact.collider = nullptr; }
+        }
+    }
+
+    void CollisionManager::ClearCollider() {
+        for (auto collider : colliders_) {
+            collider->proxyId_ = DynamicAABBTree::kNullNode;
+            collider->isDirty_ = false;
+        }
+        colliders_.clear();
+        dirtyColliders_.clear();
+        movedColliders_.clear();
+        pairs_.clear();
+        pairIndices_.clear();
+        removedContacts_.clear();
+        broadphase_.Clear();
+        hashGrid_.Clear();
     }
 
-    void CollisionManager::CheckCollision() {
+    void CollisionManager::MarkDirty(Collider* collider) {
+        if (!collider->isDirty_) {
+            collider->isDirty_ = true;
+            dirtyColliders_.emplace_back(collider);
+        }
+    }
 
-        auto iter1 = colliders_.begin();
-        for (; iter1 != colliders_.end(); ++iter1) {
-            Collider* collider1 = *iter1;
-            // アクティブじゃなければ通さない
-            if (!collider1->IsActive()) { continue; }
+    void CollisionManager::SetBroadphase(BroadphaseType type, float cellSize) {
+        hashGrid_.SetCellSize(cellSize);
+        if (type == broadphaseType_) { return; }
 
-            auto iter2 = iter1;
-            ++iter2;
-            for (; iter2 != colliders_.end(); ++iter2) {
-                Collider* collider2 = *iter2;
-                // アクティブじゃなければ通さない
-                if (!collider2->IsActive()) { continue; }
-
-                CollisionInfo collisionInfo1;
-                if (collider1->IsCollision(collider2, collisionInfo1)) {
-                    // 衝突情報を反転
-                    CollisionInfo collisionInfo2 = collisionInfo1;
-                    collisionInfo2.gameObject = collider1->GetGameObject();
-                    collisionInfo2.normal = -collisionInfo1.normal;
-                    // Stayを呼び出す
-                    collider1->OnCollision(collisionInfo1);
-                    collider2->OnCollision(collisionInfo2);
+        broadphase_.Clear();
+        hashGrid_.Clear();
+        broadphaseType_ = type;
+        // 登録済みのものは新しいブロードフェーズで作り直し、ペアを探し直す
+        for (auto collider : colliders_) {
+            if (collider->proxyId_ == DynamicAABBTree::kNullNode) { continue; }
+            collider->proxyId_ = VisitBroadphase([&](auto& broadphase) { return broadphase.CreateProxy(collider->GetBounds(), collider); });
+            if (collider->movedFrame_ != frame_) {
+                collider->movedFrame_ = frame_;
+                movedColliders_.emplace_back(collider);
+            }
+        }
+        // 保持しているペアを新しい番号で引けるようにする
+        pairIndices_.clear();
+        for (uint32_t i = 0; i < uint32_t(pairs_.size()); ++i) {
+            Pair& pair = pairs_[i];
+            if (pair.collider1->proxyId_ > pair.collider2->proxyId_) {
+                std::swap(pair.collider1, pair.collider2);
+                pair.normal = -pair.normal;
+            }
+            pair.key = MakePairKey(pair.collider1->proxyId_, pair.collider2->proxyId_);
+            pairIndices_.emplace(pair.key, i);
+        }
+    }
+
+    void CollisionManager::UpdateBroadphase(ThreadPool* threadPool) {
+        for (auto collider : dirtyColliders_) {
+            bool moved = true;
+            Math::AABB bounds = collider->GetBounds();
+            if (collider->proxyId_ == DynamicAABBTree::kNullNode) {
+                collider->proxyId_ = VisitBroadphase([&](auto& broadphase) { return broadphase.CreateProxy(bounds, collider); });
+            }
+            else {
+                moved = VisitBroadphase([&](auto& broadphase) { return broadphase.MoveProxy(collider->proxyId_, bounds); });
+            }
+            // 次のチェックで詳細判定をやり直す
+            collider->changedFrame_ = frame_;
+            if (moved && collider->movedFrame_ != frame_) {
+                collider->movedFrame_ = frame_;
+                movedColliders_.emplace_back(collider);
+            }
+            collider->isDirty_ = false;
+        }
+        dirtyColliders_.clear();
+        // グリッドはセルへの登録をまとめて作り直す
+        if (broadphaseType_ == BroadphaseType::HashGrid) {
+            hashGrid_.Update(threadPool);
+        }
+    }
+
+    void CollisionManager::CheckCollision(ThreadPool* threadPool) {
+        UpdateBroadphase(threadPool);
+
+        // 呼び出し順を総当たりの時と揃えるため登録順の番号を振る
+        uint32_t numColliders = uint32_t(colliders_.size());
+        for (uint32_t i = 0; i < numColliders; ++i) {
+            colliders_[i]->index_ = i;
+        }
+        events_.clear();
+
+        // 動いたコライダーのペアだけ調べ直す
+        if (!movedColliders_.empty()) {
+            RemoveSeparatedPairs();
+
+            size_t numChunks = (movedColliders_.size() + kCollidersPerChunk - 1) / kCollidersPerChunk;
+            size_t numWorkers = 1;
+            if (threadPool && numChunks >= 2) {
+                numWorkers = std::min(threadPool->GetNumThreads() + 1, numChunks);
+            }
+            if (pairBuffers_.size() < numWorkers) {
+                pairBuffers_.resize(numWorkers);
+            }
+            if (numWorkers == 1) {
+                FindNewPairs(0, movedColliders_.size(), pairBuffers_[0]);
+            }
+            else {
+                threadPool->ParallelChunks(numWorkers, numChunks, [&](size_t chunk, size_t worker) {
+                    size_t begin = chunk * kCollidersPerChunk;
+                    FindNewPairs(begin, std::min(movedColliders_.size(), begin + kCollidersPerChunk), pairBuffers_[worker]);
+                    });
+            }
+
+            // どのスレッドが見つけても同じ順番で追加する
+            newPairs_.clear();
+            for (size_t i = 0; i < numWorkers; ++i) {
+                newPairs_.insert(newPairs_.end(), pairBuffers_[i].begin(), pairBuffers_[i].end());
+                pairBuffers_[i].clear();
+            }
+            std::sort(newPairs_.begin(), newPairs_.end());
+            newPairs_.erase(std::unique(newPairs_.begin(), newPairs_.end()), newPairs_.end());
+            for (uint64_t key : newPairs_) {
+                AddPair(key);
+            }
+        }
+
+        // 形状かアクティブ状態が変わったペアだけ詳細判定する
+        evaluatePairs_.clear();
+        for (uint32_t i = 0; i < uint32_t(pairs_.size()); ++i) {
+            Pair& pair = pairs_[i];
+            pair.wasTouching = pair.touching;
+            bool active = pair.collider1->IsActive() && pair.collider2->IsActive();
+            if (pair.isNew || active != pair.active ||
+                pair.collider1->changedFrame_ == frame_ || pair.collider2->changedFrame_ == frame_) {
+                evaluatePairs_.emplace_back(i);
+            }
+        }
+        size_t numChunks = (evaluatePairs_.size() + kPairsPerChunk - 1) / kPairsPerChunk;
+        if (!threadPool || threadPool->GetNumThreads() == 0 || numChunks < 2) {
+            for (uint32_t index : evaluatePairs_) {
+                EvaluatePair(pairs_[index]);
+            }
+        }
+        else {
+            threadPool->ParallelChunks(std::min(threadPool->GetNumThreads() + 1, numChunks), numChunks, [&](size_t chunk, size_t) {
+                size_t end = std::min(evaluatePairs_.size(), (chunk + 1) * kPairsPerChunk);
+                for (size_t i = chunk * kPairsPerChunk; i < end; ++i) {
+                    EvaluatePair(pairs_[evaluatePairs_[i]]);
                 }
+                });
+        }
+
+        for (auto& pair : pairs_) {
+            if (!pair.touching && !pair.wasTouching) { continue; }
+            ContactEventType type = !pair.touching ? ContactEventType::Exit : (pair.wasTouching ? ContactEventType::Stay : ContactEventType::Enter);
+            events_.push_back({ type, pair.collider1, pair.collider2, pair.normal, pair.depth });
+        }
+
+        // コールバックで動かしてレイキャストするとブロードフェーズが更新されるので、先にフレームを進めておく
+        // そこで動いたものは次のチェックで調べ直す
+        movedColliders_.clear();
+        ++frame_;
+        DispatchEvents();
+    }
+
+    void CollisionManager::RemoveSeparatedPairs() {
+        for (size_t i = pairs_.size(); i > 0; --i) {
+            Pair& pair = pairs_[i - 1];
+            if (pair.collider1->movedFrame_ != frame_ && pair.collider2->movedFrame_ != frame_) { continue; }
+            bool overlap = VisitBroadphase([&](auto& broadphase) {
+                return broadphase.GetFatAABB(pair.collider1->proxyId_).Intersects(broadphase.GetFatAABB(pair.collider2->proxyId_));
+                });
+            if (overlap) { continue; }
+            if (pair.touching) {
+                events_.push_back({ ContactEventType::Exit, pair.collider1, pair.collider2, pair.normal, pair.depth });
+            }
+            RemovePair(i - 1);
+        }
+    }
+
+    void CollisionManager::FindNewPairs(size_t begin, size_t end, std::vector<uint64_t>& newPairs) const {
+        VisitBroadphase([&](auto& broadphase) {
+            for (size_t i = begin; i < end; ++i) {
+                Collider* collider1 = movedColliders_[i];
+                int32_t proxyId1 = collider1->proxyId_;
+                broadphase.Query(broadphase.GetFatAABB(proxyId1), [&](int32_t proxyId2) {
+                    if (proxyId2 == proxyId1) { return true; }
+                    // 両方動いた場合は番号が小さい方からのみ
+                    Collider* collider2 = static_cast<Collider*>(broadphase.GetUserData(proxyId2));
+                    if (collider2->movedFrame_ == frame_ && proxyId2 < proxyId1) { return true; }
+                    uint64_t key = MakePairKey(proxyId1, proxyId2);
+                    if (pairIndices_.contains(key)) { return true; }
+                    newPairs.emplace_back(key);
+                    return true;
+                    });
+            }
+            });
+    }
+
+    void CollisionManager::AddPair(uint64_t key) {
+        Pair pair{};
+        pair.key = key;
+        VisitBroadphase([&](auto& broadphase) {
+            pair.collider1 = static_cast<Collider*>(broadphase.GetUserData(int32_t(key >> 32)));
+            pair.collider2 = static_cast<Collider*>(broadphase.GetUserData(int32_t(key & 0xFFFFFFFF)));
+            });
+        pair.isNew = true;
+        pairIndices_.emplace(key, uint32_t(pairs_.size()));
+        pairs_.emplace_back(pair);
+    }
+
+    void CollisionManager::RemovePair(size_t index) {
+        pairIndices_.erase(pairs_[index].key);
+        if (index + 1 != pairs_.size()) {
+            pairs_[index] = pairs_.back();
+            pairIndices_[pairs_[index].key] = uint32_t(index);
+        }
+        pairs_.pop_back();
+    }
+
+    void CollisionManager::EvaluatePair(Pair& pair) const {
+        pair.isNew = false;
+        pair.active = pair.collider1->IsActive() && pair.collider2->IsActive();
+        pair.touching = false;
+        // アクティブじゃなければ通さない
+        if (!pair.active) { return; }
+        // 詳細判定の前に属性とマスクで弾く
+        if (!pair.collider1->CanCollision(pair.collider2)) { return; }
+
+        CollisionInfo collisionInfo;
+        if (pair.collider1->IsCollision(pair.collider2, collisionInfo)) {
+            pair.touching = true;
+            pair.normal = collisionInfo.normal;
+            pair.depth = collisionInfo.depth;
+        }
+    }
+
+    void CollisionManager::DispatchEvents() {
+        // 種類ごとにまとめ、その中は登録順に並べる
+        for (auto& event : events_) {
+            if (event.collider1->index_ > event.collider2->index_) {
+                std::swap(event.collider1, event.collider2);
+                event.normal = -event.normal;
             }
         }
+        std::sort(events_.begin(), events_.end(), [](const ContactEvent& a, const ContactEvent& b) {
+            if (a.type != b.type) { return a.type < b.type; }
+            if (a.collider1->index_ != b.collider1->index_) { return a.collider1->index_ < b.collider1->index_; }
+            return a.collider2->index_ < b.collider2->index_;
+            });
 
+        for (size_t i = 0; i < events_.size(); ++i) {
+            const ContactEvent& event = events_[i];
+            if (!event.collider1 || !event.collider2) { continue; }
+
+            CollisionInfo collisionInfo1{ event.collider2->GetGameObject(), event.normal, event.depth };
+            CollisionInfo collisionInfo2{ event.collider1->GetGameObject(), -event.normal, event.depth };
+            auto Call = [&](void (Collider::*callback)(const CollisionInfo&)) {
+                // コールバックでどちらかが削除されることがある
+                if (event.collider1) { (event.collider1->*callback)(collisionInfo1); }
+                if (event.collider2) { (event.collider2->*callback)(collisionInfo2); }
+                };
+            switch (event.type) {
+            case ContactEventType::Enter:
+                // 毎フレームのコールバックは触れ始めたフレームも呼ぶ
+                Call(&Collider::OnCollisionEnter);
+                Call(&Collider::OnCollision);
+                break;
+            case ContactEventType::Stay: Call(&Collider::OnCollision); break;
+            case ContactEventType::Exit: Call(&Collider::OnCollisionExit); break;
+            }
+        }
+
+        // 削除されたコライダーと触れていた相手 (コールバック中に削除されたものも含む)
+        for (size_t i = 0; i < removedContacts_.size(); ++i) {
+            if (!removedContacts_[i].collider) { continue; }
+            // コールバック中に追加されることがあるのでコピーしておく
+            RemovedContact removedContact = removedContacts_[i];
+            removedContact.collider->OnCollisionExit(removedContact.collisionInfo);
+        }
+        removedContacts_.clear();
     }
 
-    bool CollisionManager::RayCast(const Vector3& origin, const Vector3& diff, uint32_t mask, RayCastInfo* nearest) {
+    bool CollisionManager::RayCast(const Vector3& origin, const Vector3& diff, uint32_t mask, RayCastInfo* nearest, RayCastMode mode) {
+        UpdateBroadphase();
 
         RayCastInfo tmpNearest{};
         tmpNearest.nearest = 1.1f;
 
-        for (auto collider : colliders_) {
-            RayCastInfo info{};
-            info.nearest = FLT_MAX;
-            if (collider->RayCast(origin, diff, mask, info)) {
-                if (info.nearest < tmpNearest.nearest) {
-                    tmpNearest = info;
+        // 手前から調べ、ヒットした位置より奥は探索しない
+        VisitBroadphase([&](auto& broadphase) {
+            broadphase.RayCast(origin, diff, [&](int32_t proxyId, float maxFraction) {
+                Collider* collider = static_cast<Collider*>(broadphase.GetUserData(proxyId));
+                // アクティブじゃなければ通さない
+                if (!collider->IsActive()) { return maxFraction; }
+
+                RayCastInfo info{};
+                info.nearest = FLT_MAX;
+                if (!collider->RayCast(origin, diff, mask, info) || !(info.nearest < tmpNearest.nearest)) {
+                    return maxFraction;
                 }
-            }
-        }
+                tmpNearest = info;
+                tmpNearest.gameObject = collider->GetGameObject();
+                if (mode == RayCastMode::Any && tmpNearest.nearest <= 1.0f) {
+                    return -1.0f;
+                }
+                return std::clamp(tmpNearest.nearest, 0.0f, maxFraction);
+                });
+            });
+
         if (tmpNearest.nearest > 1.0f) {
             return false;
         }
@@ -72,4 +436,85 @@ namespace LIEngine {
         return true;
     }
 
-}
\ No newline at end of file
+    void CollisionManager::RayCastBatch(const RayCastCommand* commands, RayCastResult* results, size_t count, ThreadPool* threadPool) {
+        if (count == 0) { return; }
+        UpdateBroadphase(threadPool);
+
+        // 始点と向きが近いレイを同じパケットに集める
+        Math::AABB bounds(commands[0].origin);
+        for (size_t i = 1; i < count; ++i) {
+            bounds.Merge(commands[i].origin);
+        }
+        Vector3 extent = bounds.Extent();
+        Vector3 scale = {
+            extent.x > 0.0f ? 1023.0f / extent.x : 0.0f,
+            extent.y > 0.0f ? 1023.0f / extent.y : 0.0f,
+            extent.z > 0.0f ? 1023.0f / extent.z : 0.0f };
+        rayKeys_.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            rayKeys_[i] = { MakeRayKey(commands[i], bounds, scale), uint32_t(i) };
+        }
+        std::sort(rayKeys_.begin(), rayKeys_.end());
+        rayOrder_.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            rayOrder_[i] = rayKeys_[i].second;
+        }
+
+        const size_t chunkSize = kPacketsPerChunk * DynamicAABBTree::kPacketSize;
+        size_t numChunks = (count + chunkSize - 1) / chunkSize;
+        if (!threadPool || threadPool->GetNumThreads() == 0 || numChunks < 2) {
+            RayCastPackets(commands, rayOrder_.data(), results, 0, count);
+            return;
+        }
+
+        threadPool->ParallelChunks(std::min(threadPool->GetNumThreads() + 1, numChunks), numChunks, [&](size_t chunk, size_t) {
+            RayCastPackets(commands, rayOrder_.data(), results, chunk * chunkSize, std::min(count, (chunk + 1) * chunkSize));
+            });
+    }
+
+    void CollisionManager::RayCastPackets(const RayCastCommand* commands, const uint32_t* order, RayCastResult* results, size_t begin, size_t end) const {
+        constexpr size_t kPacketSize = DynamicAABBTree::kPacketSize;
+        for (size_t packet = begin; packet < end; packet += kPacketSize) {
+            size_t count = std::min(kPacketSize, end - packet);
+            Vector3 origins[kPacketSize];
+            Vector3 diffs[kPacketSize];
+            float nearest[kPacketSize];
+            Collider* hitColliders[kPacketSize] = {};
+            for (size_t lane = 0; lane < count; ++lane) {
+                const RayCastCommand& command = commands[order[packet + lane]];
+                origins[lane] = command.origin;
+                diffs[lane] = command.diff;
+                nearest[lane] = 1.1f;
+            }
+
+            // 判定はRayCastと同じ
+            VisitBroadphase([&](auto& broadphase) {
+                broadphase.RayCastPacket(origins, diffs, count, [&](int32_t proxyId, size_t lane, float maxFraction) {
+                    const RayCastCommand& command = commands[order[packet + lane]];
+                    Collider* collider = static_cast<Collider*>(broadphase.GetUserData(proxyId));
+                    if (!collider->IsActive()) { return maxFraction; }
+
+                    RayCastInfo info{};
+                    info.nearest = FLT_MAX;
+                    if (!collider->RayCast(command.origin, command.diff, command.mask, info) || !(info.nearest < nearest[lane])) {
+                        return maxFraction;
+                    }
+                    nearest[lane] = info.nearest;
+                    hitColliders[lane] = collider;
+                    if (command.mode == RayCastMode::Any && info.nearest <= 1.0f) {
+                        return -1.0f;
+                    }
+                    return std::clamp(info.nearest, 0.0f, maxFraction);
+                    });
+                });
+
+            for (size_t lane = 0; lane < count; ++lane) {
+                RayCastResult& result = results[order[packet + lane]];
+                result.hit = nearest[lane] <= 1.0f;
+                result.info.nearest = nearest[lane];
+                result.info.gameObject = result.hit ? hitColliders[lane]->GetGameObject() : nullptr;
+            }
+        }
+    }
+
+}
@@ -4,25 +4,83 @@
 
 #pragma once
 
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "Math/MathUtils.h"
 #include "Collider.h"
+#include "DynamicAABBTree.h"
+#include "SpatialHashGrid.h"
 
 namespace LIEngine {
 
+    class ThreadPool;
+
+    /// <summary>
+    /// ブロードフェーズの種類
+    /// </summary>
+    enum class BroadphaseType {
+        // 動的AABBツリー (大きさがばらばらなシーン向け)
+        Tree,
+        // 空間ハッシュグリッド (大きさの揃った小さいコライダーが密集するシーン向け)
+        HashGrid
+    };
+
     class CollisionManager {
     public:
+        /// <summary>
+        /// 接触の変化
+        /// </summary>
+        struct ContactEvent {
+            ContactEventType type;
+            // 登録順で前のコライダー (削除されるとnullptr)
+            Collider* collider1;
+            Collider* collider2;
+            // collider1を押し出す向き
+            Vector3 normal;
+            float depth;
+        };
+
         static CollisionManager* GetInstance();
 
         void AddCollider(Collider* collider);
         void RemoveCollider(Collider* collider);
-        void ClearCollider() { colliders_.clear(); }
+        void ClearCollider();
+        /// <summary>
+        /// 次のチェックまでにブロードフェーズを更新する
+        /// </summary>
+        /// <param name="collider">形状が変わったコライダー</param>
+        void MarkDirty(Collider* collider);
+        /// <summary>
+        /// ブロードフェーズを切り替える
+        /// 登録済みのコライダーは入れなおし、保持しているペアと接触状態は引き継ぐ
+        /// </summary>
+        /// <param name="type">種類</param>
+        /// <param name="cellSize">HashGridのセルの一辺 (コライダーの直径の2倍程度が目安)</param>
+        void SetBroadphase(BroadphaseType type, float cellSize = 2.0f);
+        BroadphaseType GetBroadphaseType() const { return broadphaseType_; }
 
         /// <summary>
         /// 衝突をチェック
+        /// 太らせたAABBが重なるペアをフレームをまたいで保持し、
+        /// 太らせたAABBが変わったコライダーだけツリーを調べ直す
+        /// どちらの形状も変わっていないペアは前回の結果を使う
+        /// Enter、Stay、Exitの順にまとめて、それぞれ登録順にコールバックを呼ぶ
+        /// 削除されたコライダーと触れていた相手のExitは最後に呼ぶ
+        /// スレッド数に関わらず結果と呼び出し順は同じ
+        /// </summary>
+        /// <param name="threadPool">指定すると探索と詳細判定を並列に行う</param>
+        void CheckCollision(ThreadPool* threadPool = nullptr);
+        /// <summary>
+        /// 直前のCheckCollisionで起きた接触の変化
+        /// 次のCheckCollisionまで有効
+        /// </summary>
+        const std::vector<ContactEvent>& GetContactEvents() const { return events_; }
+        /// <summary>
+        /// 保持している太らせたAABBが重なるペアの数
         /// </summary>
-        void CheckCollision();
+        size_t GetNumPairs() const { return pairs_.size(); }
 
         /// <summary>
         /// レイキャスト
@@ -31,10 +89,43 @@ namespace LIEngine {
         /// <param name="diff">ベクトル</param>
         /// <param name="mask">マスク</param>
         /// <param name="nearest">衝突情報</param>
+        /// <param name="mode">Anyの場合は最初に見つかったヒットで終了する</param>
         /// <returns>ヒット有無</returns>
-        bool RayCast(const Vector3& origin, const Vector3& diff, uint32_t mask, RayCastInfo* nearest);
+        bool RayCast(const Vector3& origin, const Vector3& diff, uint32_t mask, RayCastInfo* nearest, RayCastMode mode = RayCastMode::Closest);
+        /// <summary>
+        /// まとめてレイキャスト
+        /// 近いレイを並べ替えてパケット単位でツリーを調べる
+        /// 実行中にコライダーを変更してはいけない
+        /// </summary>
+        /// <param name="commands">レイ</param>
+        /// <param name="results">結果 (commandsと同じ順番)</param>
+        /// <param name="count">レイの数</param>
+        /// <param name="threadPool">指定すると大きいバッチを分割して並列に処理する</param>
+        void RayCastBatch(const RayCastCommand* commands, RayCastResult* results, size_t count, ThreadPool* threadPool = nullptr);
 
     private:
+        // 太らせたAABBが重なるペアと前回の判定結果
+        struct Pair {
+            uint64_t key;
+            // プロキシ番号が小さい方が1
+            Collider* collider1;
+            Collider* collider2;
+            // collider1を押し出す向き
+            Vector3 normal;
+            float depth;
+            bool touching;
+            bool wasTouching;
+            // 判定した時に両方アクティブだったか
+            bool active;
+            bool isNew;
+        };
+        // 削除されたコライダーと触れていた相手に呼ぶExit
+        struct RemovedContact {
+            // 相手も削除されるとnullptr
+            Collider* collider;
+            CollisionInfo collisionInfo;
+        };
+
         CollisionManager() = default;
         ~CollisionManager() = default;
         CollisionManager(const CollisionManager&) = delete;
@@ -42,7 +133,67 @@ namespace LIEngine {
         CollisionManager(CollisionManager&&) = delete;
         CollisionManager& operator=(CollisionManager&&) = delete;
 
+        /// <summary>
+        /// 選んでいるブロードフェーズを渡してfunctionを呼ぶ
+        /// </summary>
+        template<typename Function>
+        decltype(auto) VisitBroadphase(Function&& function);
+        template<typename Function>
+        decltype(auto) VisitBroadphase(Function&& function) const;
+        /// <summary>
+        /// 形状が変わったコライダーをブロードフェーズに反映
+        /// </summary>
+        /// <param name="threadPool">指定するとHashGridのセルを並列に作る</param>
+        void UpdateBroadphase(ThreadPool* threadPool = nullptr);
+        /// <summary>
+        /// 太らせたAABBが離れたペアを消す
+        /// </summary>
+        void RemoveSeparatedPairs();
+        /// <summary>
+        /// 動いたコライダー[begin,end)と新しく重なったペアを探す
+        /// </summary>
+        void FindNewPairs(size_t begin, size_t end, std::vector<uint64_t>& newPairs) const;
+        /// <summary>
+        /// ペアを追加
+        /// </summary>
+        void AddPair(uint64_t key);
+        /// <summary>
+        /// ペアを消す (最後のペアと入れ替える)
+        /// </summary>
+        void RemovePair(size_t index);
+        /// <summary>
+        /// ペアを詳細判定する
+        /// </summary>
+        void EvaluatePair(Pair& pair) const;
+        /// <summary>
+        /// 変化をまとめてコールバックを呼ぶ
+        /// </summary>
+        void DispatchEvents();
+        /// <summary>
+        /// 並べ替え済みのレイをパケットごとに調べる
+        /// </summary>
+        void RayCastPackets(const RayCastCommand* commands, const uint32_t* order, RayCastResult* results, size_t begin, size_t end) const;
+
         std::vector<Collider*> colliders_;
+        std::vector<Collider*> dirtyColliders_;
+        DynamicAABBTree broadphase_;
+        SpatialHashGrid hashGrid_;
+        BroadphaseType broadphaseType_ = BroadphaseType::Tree;
+        // フレームをまたいで保持するペア
+        std::vector<Pair> pairs_;
+        std::unordered_map<uint64_t, uint32_t> pairIndices_;
+        // 前回のチェックから太らせたAABBが変わったコライダー
+        std::vector<Collider*> movedColliders_;
+        // CheckCollisionのスレッドごとの新しいペア
+        std::vector<std::vector<uint64_t>> pairBuffers_;
+        std::vector<uint64_t> newPairs_;
+        std::vector<uint32_t> evaluatePairs_;
+        std::vector<ContactEvent> events_;
+        std::vector<RemovedContact> removedContacts_;
+        uint32_t frame_ = 0;
+        // RayCastBatchの並べ替え用
+        std::vector<std::pair<uint64_t, uint32_t>> rayKeys_;
+        std::vector<uint32_t> rayOrder_;
     };
 
 }
\ No newline at end of file
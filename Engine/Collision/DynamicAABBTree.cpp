@@ -0,0 +1,270 @@
+#include "DynamicAABBTree.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace {
+
+    using namespace LIEngine;
+
+    Math::AABB Union(const Math::AABB& a, const Math::AABB& b) {
+        return { Vector3::Min(a.min, b.min), Vector3::Max(a.max, b.max) };
+    }
+
+}
+
+namespace LIEngine {
+
+    DynamicAABBTree::DynamicAABBTree(float margin) :
+        root_(kNullNode),
+        freeList_(kNullNode),
+        numProxies_(0),
+        margin_(margin) {
+    }
+
+    int32_t DynamicAABBTree::CreateProxy(const Math::AABB& aabb, void* userData) {
+        int32_t proxyId = AllocateNode();
+        Node& node = nodes_[proxyId];
+        Vector3 margin(margin_);
+        node.aabb = { aabb.min - margin, aabb.max + margin };
+        node.userData = userData;
+        node.height = 0;
+        InsertLeaf(proxyId);
+        ++numProxies_;
+        return proxyId;
+    }
+
+    void DynamicAABBTree::DestroyProxy(int32_t proxyId) {
+        assert(0 <= proxyId && proxyId < int32_t(nodes_.size()));
+        assert(nodes_[proxyId].IsLeaf());
+        RemoveLeaf(proxyId);
+        FreeNode(proxyId);
+        --numProxies_;
+    }
+
+    bool DynamicAABBTree::MoveProxy(int32_t proxyId, const Math::AABB& aabb) {
+        assert(0 <= proxyId && proxyId < int32_t(nodes_.size()));
+        assert(nodes_[proxyId].IsLeaf());
+        // 太らせたAABBに収まっていれば木はそのまま
+        if (nodes_[proxyId].aabb.Contains(aabb)) {
+            return false;
+        }
+        RemoveLeaf(proxyId);
+        Vector3 margin(margin_);
+        nodes_[proxyId].aabb = { aabb.min - margin, aabb.max + margin };
+        InsertLeaf(proxyId);
+        return true;
+    }
+
+    void DynamicAABBTree::Clear() {
+        nodes_.clear();
+        root_ = kNullNode;
+        freeList_ = kNullNode;
+        numProxies_ = 0;
+    }
+
+    int32_t DynamicAABBTree::AllocateNode() {
+        int32_t nodeId;
+        if (freeList_ != kNullNode) {
+            nodeId = freeList_;
+            freeList_ = nodes_[nodeId].next;
+        }
+        else {
+            nodeId = int32_t(nodes_.size());
+            nodes_.emplace_back();
+        }
+        Node& node = nodes_[nodeId];
+        node.userData = nullptr;
+        node.parent = kNullNode;
+        node.child1 = kNullNode;
+        node.child2 = kNullNode;
+        node.height = 0;
+        return nodeId;
+    }
+
+    void DynamicAABBTree::FreeNode(int32_t nodeId) {
+        nodes_[nodeId].next = freeList_;
+        nodes_[nodeId].height = -1;
+        freeList_ = nodeId;
+    }
+
+    void DynamicAABBTree::InsertLeaf(int32_t leaf) {
+        if (root_ == kNullNode) {
+            root_ = leaf;
+            nodes_[root_].parent = kNullNode;
+            return;
+        }
+
+        // 表面積が最も増えにくい兄弟を探す
+        const Math::AABB leafAABB = nodes_[leaf].aabb;
+        int32_t index = root_;
+        while (!nodes_[index].IsLeaf()) {
+            const Node& node = nodes_[index];
+            float area = node.aabb.SurfaceArea();
+            float combinedArea = Union(node.aabb, leafAABB).SurfaceArea();
+
+            // ここに兄弟として置くコスト
+            float cost = 2.0f * combinedArea;
+            // 下に降りる場合に祖先が広がるコスト
+            float inheritanceCost = 2.0f * (combinedArea - area);
+
+            auto ChildCost = [&](int32_t child) {
+                const Node& childNode = nodes_[child];
+                float newArea = Union(childNode.aabb, leafAABB).SurfaceArea();
+                if (childNode.IsLeaf()) {
+                    return newArea + inheritanceCost;
+                }
+                return newArea - childNode.aabb.SurfaceArea() + inheritanceCost;
+                };
+            float cost1 = ChildCost(node.child1);
+            float cost2 = ChildCost(node.child2);
+
+            if (cost < cost1 && cost < cost2) { break; }
+            index = cost1 < cost2 ? node.child1 : node.child2;
+        }
+        int32_t sibling = index;
+
+        // 新しい親を作って兄弟と葉をぶら下げる
+        int32_t oldParent = nodes_[sibling].parent;
+        int32_t newParent = AllocateNode();
+        nodes_[newParent].parent = oldParent;
+        nodes_[newParent].aabb = Union(leafAABB, nodes_[sibling].aabb);
+        nodes_[newParent].height = nodes_[sibling].height + 1;
+        nodes_[newParent].child1 = sibling;
+        nodes_[newParent].child2 = leaf;
+        nodes_[sibling].parent = newParent;
+        nodes_[leaf].parent = newParent;
+
+        if (oldParent != kNullNode) {
+            if (nodes_[oldParent].child1 == sibling) {
+                nodes_[oldParent].child1 = newParent;
+            }
+            else {
+                nodes_[oldParent].child2 = newParent;
+            }
+        }
+        else {
+            root_ = newParent;
+        }
+
+        Refit(nodes_[leaf].parent);
+    }
+
+    void DynamicAABBTree::RemoveLeaf(int32_t leaf) {
+        if (leaf == root_) {
+            root_ = kNullNode;
+            return;
+        }
+
+        // 親を消して兄弟を祖父につなぐ
+        int32_t parent = nodes_[leaf].parent;
+        int32_t grandParent = nodes_[parent].parent;
+        int32_t sibling = nodes_[parent].child1 == leaf ? nodes_[parent].child2 : nodes_[parent].child1;
+
+        if (grandParent != kNullNode) {
+            if (nodes_[grandParent].child1 == parent) {
+                nodes_[grandParent].child1 = sibling;
+            }
+            else {
+                nodes_[grandParent].child2 = sibling;
+            }
+            nodes_[sibling].parent = grandParent;
+            FreeNode(parent);
+            Refit(grandParent);
+        }
+        else {
+            root_ = sibling;
+            nodes_[sibling].parent = kNullNode;
+            FreeNode(parent);
+        }
+    }
+
+    void DynamicAABBTree::Refit(int32_t nodeId) {
+        int32_t index = nodeId;
+        while (index != kNullNode) {
+            Node& node = nodes_[index];
+            const Node& child1 = nodes_[node.child1];
+            const Node& child2 = nodes_[node.child2];
+            node.height = 1 + std::max(child1.height, child2.height);
+            node.aabb = Union(child1.aabb, child2.aabb);
+
+            Rotate(index);
+
+            index = nodes_[index].parent;
+        }
+    }
+
+    void DynamicAABBTree::Rotate(int32_t iA) {
+        // Aの子B,Cと孫D,E(Bの子),F,G(Cの子)を入れ替えて
+        // 子の表面積の合計が減るなら採用する
+        // 高さで平衡をとるより探索で訪れるノードが少なくなる
+        Node& A = nodes_[iA];
+        if (A.height < 2) { return; }
+
+        int32_t iB = A.child1;
+        int32_t iC = A.child2;
+        const Node& B = nodes_[iB];
+        const Node& C = nodes_[iC];
+
+        enum Rotation { None, BF, BG, CD, CE, DF, DG };
+        Rotation best = None;
+        float bestCost = 0.0f;
+        auto Consider = [&](Rotation rotation, float cost) {
+            if (cost < bestCost) {
+                bestCost = cost;
+                best = rotation;
+            }
+            };
+
+        if (!C.IsLeaf()) {
+            // BとCの子を入れ替えるとCの範囲だけが変わる
+            float areaC = C.aabb.SurfaceArea();
+            Consider(BF, Union(B.aabb, nodes_[C.child2].aabb).SurfaceArea() - areaC);
+            Consider(BG, Union(B.aabb, nodes_[C.child1].aabb).SurfaceArea() - areaC);
+        }
+        if (!B.IsLeaf()) {
+            float areaB = B.aabb.SurfaceArea();
+            Consider(CD, Union(C.aabb, nodes_[B.child2].aabb).SurfaceArea() - areaB);
+            Consider(CE, Union(C.aabb, nodes_[B.child1].aabb).SurfaceArea() - areaB);
+        }
+        if (!B.IsLeaf() && !C.IsLeaf()) {
+            // 孫同士を入れ替えるとBとC両方が変わる
+            float areaBC = B.aabb.SurfaceArea() + C.aabb.SurfaceArea();
+            const Math::AABB& D = nodes_[B.child1].aabb;
+            const Math::AABB& E = nodes_[B.child2].aabb;
+            const Math::AABB& F = nodes_[C.child1].aabb;
+            const Math::AABB& G = nodes_[C.child2].aabb;
+            Consider(DF, Union(F, E).SurfaceArea() + Union(D, G).SurfaceArea() - areaBC);
+            Consider(DG, Union(G, E).SurfaceArea() + Union(F, D).SurfaceArea() - areaBC);
+        }
+
+        switch (best) {
+        case BF: SwapChildren(iA, 0, iC, 0); break;
+        case BG: SwapChildren(iA, 0, iC, 1); break;
+        case CD: SwapChildren(iA, 1, iB, 0); break;
+        case CE: SwapChildren(iA, 1, iB, 1); break;
+        case DF: SwapChildren(iB, 0, iC, 0); break;
+        case DG: SwapChildren(iB, 0, iC, 1); break;
+        default: return;
+        }
+
+        // 入れ替えたノードを更新
+        for (int32_t index : { iB, iC, iA }) {
+            Node& node = nodes_[index];
+            if (node.IsLeaf()) { continue; }
+            const Node& child1 = nodes_[node.child1];
+            const Node& child2 = nodes_[node.child2];
+            node.height = 1 + std::max(child1.height, child2.height);
+            node.aabb = Union(child1.aabb, child2.aabb);
+        }
+    }
+
+    void DynamicAABBTree::SwapChildren(int32_t parent1, int32_t slot1, int32_t parent2, int32_t slot2) {
+        int32_t& child1 = slot1 == 0 ? nodes_[parent1].child1 : nodes_[parent1].child2;
+        int32_t& child2 = slot2 == 0 ? nodes_[parent2].child1 : nodes_[parent2].child2;
+        std::swap(child1, child2);
+        nodes_[child1].parent = parent1;
+        nodes_[child2].parent = parent2;
+    }
+
+}
@@ -0,0 +1,302 @@
+///
+/// 動的AABBツリー
+///
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "Math/MathUtils.h"
+#include "Math/Geometry.h"
+#include "Math/SIMD.h"
+
+namespace LIEngine {
+
+    /// <summary>
+    /// 動くオブジェクト用のAABBの二分木
+    /// 葉には少し太らせたAABBを持たせ、はみ出したときだけ入れなおす
+    /// </summary>
+    class DynamicAABBTree {
+    public:
+        static constexpr int32_t kNullNode = -1;
+
+        /// <summary>
+        /// コンストラクタ
+        /// </summary>
+        /// <param name="margin">AABBを太らせる量</param>
+        explicit DynamicAABBTree(float margin = 0.2f);
+
+        /// <summary>
+        /// 葉を作成
+        /// </summary>
+        /// <param name="aabb">AABB</param>
+        /// <param name="userData">ユーザーデータ</param>
+        /// <returns>プロキシID</returns>
+        int32_t CreateProxy(const Math::AABB& aabb, void* userData);
+        /// <summary>
+        /// 葉を削除
+        /// </summary>
+        /// <param name="proxyId">プロキシID</param>
+        void DestroyProxy(int32_t proxyId);
+        /// <summary>
+        /// 葉を動かす
+        /// 太らせたAABBに収まっている間は何もしない
+        /// </summary>
+        /// <param name="proxyId">プロキシID</param>
+        /// <param name="aabb">新しいAABB</param>
+        /// <returns>入れなおした場合true</returns>
+        bool MoveProxy(int32_t proxyId, const Math::AABB& aabb);
+        /// <summary>
+        /// 全て削除
+        /// </summary>
+        void Clear();
+
+        void* GetUserData(int32_t proxyId) const { return nodes_[proxyId].userData; }
+        const Math::AABB& GetFatAABB(int32_t proxyId) const { return nodes_[proxyId].aabb; }
+        int32_t GetHeight() const { return root_ == kNullNode ? 0 : nodes_[root_].height; }
+        size_t GetNumProxies() const { return numProxies_; }
+
+        /// <summary>
+        /// AABBと重なる葉を列挙
+        /// スレッドセーフ(ツリーを書き換えない間)
+        /// </summary>
+        /// <param name="aabb">AABB</param>
+        /// <param name="callback">bool(int32_t proxyId) falseで打ち切り</param>
+        template<typename Callback>
+        void Query(const Math::AABB& aabb, Callback&& callback) const;
+        /// <summary>
+        /// 線分と重なる葉を手前から列挙
+        /// コールバックの戻り値で以降の探索範囲を縮める
+        /// </summary>
+        /// <param name="origin">始点</param>
+        /// <param name="diff">始点から終点までのベクトル</param>
+        /// <param name="callback">float(int32_t proxyId, float maxFraction)
+        /// maxFractionを返すとそのまま続行、小さい値で範囲を縮め、負の値で打ち切り</param>
+        template<typename Callback>
+        void RayCast(const Vector3& origin, const Vector3& diff, Callback&& callback) const;
+
+        // まとめて調べられるレイの数
+        static constexpr size_t kPacketSize = SIMD::FloatV::kWidth;
+
+        /// <summary>
+        /// 複数の線分をまとめて調べる
+        /// ノードとの交差判定をSIMDで同時に行う
+        /// 向きと位置が揃ったレイをまとめると効率が良い
+        /// </summary>
+        /// <param name="origins">始点</param>
+        /// <param name="diffs">始点から終点までのベクトル</param>
+        /// <param name="count">kPacketSize以下</param>
+        /// <param name="callback">float(int32_t proxyId, size_t rayIndex, float maxFraction) 戻り値はRayCastと同じ</param>
+        template<typename Callback>
+        void RayCastPacket(const Vector3* origins, const Vector3* diffs, size_t count, Callback&& callback) const;
+
+    private:
+        struct Node {
+            bool IsLeaf() const { return child1 == kNullNode; }
+
+            Math::AABB aabb;
+            void* userData;
+            union {
+                int32_t parent;
+                int32_t next;
+            };
+            int32_t child1;
+            int32_t child2;
+            // 葉は0、空きは-1
+            int32_t height;
+        };
+
+        /// <summary>
+        /// 探索用のスタック
+        /// 普段は固定長で足り、深い木のときだけヒープを使う
+        /// </summary>
+        class TraversalStack {
+        public:
+            TraversalStack() = default;
+            TraversalStack(const TraversalStack&) = delete;
+            TraversalStack& operator=(const TraversalStack&) = delete;
+
+            void Push(int32_t nodeId) {
+                if (size_ == capacity_) { Grow(); }
+                data_[size_++] = nodeId;
+            }
+            int32_t Pop() { return data_[--size_]; }
+            bool IsEmpty() const { return size_ == 0; }
+
+        private:
+            void Grow() {
+                std::vector<int32_t> grown(size_t(capacity_) * 2);
+                std::copy(data_, data_ + size_, grown.begin());
+                heap_.swap(grown);
+                data_ = heap_.data();
+                capacity_ *= 2;
+            }
+
+            int32_t local_[64];
+            std::vector<int32_t> heap_;
+            int32_t* data_ = local_;
+            int32_t size_ = 0;
+            int32_t capacity_ = 64;
+        };
+
+        /// <summary>
+        /// 線分とAABBの交差
+        /// </summary>
+        /// <returns>入る位置の割合、交差しない場合は負</returns>
+        static float IntersectRay(const Math::AABB& aabb, const Vector3& origin, const Vector3& inverseDiff, float maxFraction);
+
+        int32_t AllocateNode();
+        void FreeNode(int32_t nodeId);
+        void InsertLeaf(int32_t leaf);
+        void RemoveLeaf(int32_t leaf);
+        // 親をたどりながら高さとAABBを更新
+        void Refit(int32_t nodeId);
+        // 表面積が減るように子と孫を入れ替える
+        void Rotate(int32_t nodeId);
+        void SwapChildren(int32_t parent1, int32_t slot1, int32_t parent2, int32_t slot2);
+
+        std::vector<Node> nodes_;
+        int32_t root_;
+        int32_t freeList_;
+        size_t numProxies_;
+        float margin_;
+    };
+
+    template<typename Callback>
+    void DynamicAABBTree::Query(const Math::AABB& aabb, Callback&& callback) const {
+        if (root_ == kNullNode) { return; }
+        TraversalStack stack;
+        stack.Push(root_);
+        while (!stack.IsEmpty()) {
+            int32_t nodeId = stack.Pop();
+            const Node& node = nodes_[nodeId];
+            if (!node.aabb.Intersects(aabb)) { continue; }
+            if (node.IsLeaf()) {
+                if (!callback(nodeId)) { return; }
+                continue;
+            }
+            stack.Push(node.child1);
+            stack.Push(node.child2);
+        }
+    }
+
+    template<typename Callback>
+    void DynamicAABBTree::RayCast(const Vector3& origin, const Vector3& diff, Callback&& callback) const {
+        if (root_ == kNullNode) { return; }
+        // 0除算でNaNにならないよう平行な軸は十分大きい値にする
+        Vector3 inverseDiff;
+        for (size_t i = 0; i < 3; ++i) {
+            inverseDiff[i] = diff[i] != 0.0f ? 1.0f / diff[i] : std::copysign(FLT_MAX, diff[i]);
+        }
+
+        float maxFraction = 1.0f;
+        TraversalStack stack;
+        stack.Push(root_);
+        while (!stack.IsEmpty()) {
+            int32_t nodeId = stack.Pop();
+            const Node& node = nodes_[nodeId];
+            // 積んだ後に範囲が縮んでいることがあるので取り出してから調べる
+            if (IntersectRay(node.aabb, origin, inverseDiff, maxFraction) < 0.0f) { continue; }
+            if (node.IsLeaf()) {
+                maxFraction = callback(nodeId, maxFraction);
+                if (maxFraction < 0.0f) { return; }
+                continue;
+            }
+            // 近い方を先に調べると早く範囲が縮まる
+            float t1 = IntersectRay(nodes_[node.child1].aabb, origin, inverseDiff, maxFraction);
+            float t2 = IntersectRay(nodes_[node.child2].aabb, origin, inverseDiff, maxFraction);
+            if (t1 >= 0.0f && t2 >= 0.0f) {
+                stack.Push(t1 <= t2 ? node.child2 : node.child1);
+                stack.Push(t1 <= t2 ? node.child1 : node.child2);
+            }
+            else if (t1 >= 0.0f) {
+                stack.Push(node.child1);
+            }
+            else if (t2 >= 0.0f) {
+                stack.Push(node.child2);
+            }
+        }
+    }
+
+    inline float DynamicAABBTree::IntersectRay(const Math::AABB& aabb, const Vector3& origin, const Vector3& inverseDiff, float maxFraction) {
+        float tMin = 0.0f;
+        float tMax = maxFraction;
+        for (size_t i = 0; i < 3; ++i) {
+            float t1 = (aabb.min[i] - origin[i]) * inverseDiff[i];
+            float t2 = (aabb.max[i] - origin[i]) * inverseDiff[i];
+            tMin = std::max(tMin, std::min(t1, t2));
+            tMax = std::min(tMax, std::max(t1, t2));
+        }
+        return tMin <= tMax ? tMin : -1.0f;
+    }
+
+    template<typename Callback>
+    void DynamicAABBTree::RayCastPacket(const Vector3* origins, const Vector3* diffs, size_t count, Callback&& callback) const {
+        using V = SIMD::FloatV;
+        assert(count <= kPacketSize);
+        if (root_ == kNullNode || count == 0) { return; }
+
+        float origin[3][kPacketSize];
+        float inverseDiff[3][kPacketSize];
+        float maxFraction[kPacketSize];
+        // 子を調べる順番を決める代表方向
+        Vector3 direction = Vector3::zero;
+        for (size_t lane = 0; lane < kPacketSize; ++lane) {
+            // 余ったレーンは範囲を負にしてどこにも当たらないようにする
+            size_t ray = lane < count ? lane : 0;
+            for (size_t i = 0; i < 3; ++i) {
+                origin[i][lane] = origins[ray][i];
+                inverseDiff[i][lane] = diffs[ray][i] != 0.0f ? 1.0f / diffs[ray][i] : std::copysign(FLT_MAX, diffs[ray][i]);
+            }
+            maxFraction[lane] = lane < count ? 1.0f : -1.0f;
+            if (lane < count) { direction += diffs[lane]; }
+        }
+        V o[3], inv[3];
+        for (size_t i = 0; i < 3; ++i) {
+            o[i] = V::Load(origin[i]);
+            inv[i] = V::Load(inverseDiff[i]);
+        }
+        const V zero = V::Set(0.0f);
+
+        auto Intersect = [&](const Math::AABB& aabb) {
+            V tMin = zero;
+            V tMax = V::Load(maxFraction);
+            for (size_t i = 0; i < 3; ++i) {
+                V t1 = (V::Set(aabb.min[i]) - o[i]) * inv[i];
+                V t2 = (V::Set(aabb.max[i]) - o[i]) * inv[i];
+                tMin = Max(tMin, Min(t1, t2));
+                tMax = Min(tMax, Max(t1, t2));
+            }
+            return LessEqualMask(tMin, tMax);
+            };
+
+        TraversalStack stack;
+        stack.Push(root_);
+        while (!stack.IsEmpty()) {
+            int32_t nodeId = stack.Pop();
+            const Node& node = nodes_[nodeId];
+            uint32_t mask = Intersect(node.aabb);
+            if (mask == 0) { continue; }
+            if (node.IsLeaf()) {
+                for (size_t lane = 0; lane < count; ++lane) {
+                    if (mask & (1u << lane)) {
+                        // 負の値が返ればそのレーンは以降どこにも当たらない
+                        maxFraction[lane] = callback(nodeId, lane, maxFraction[lane]);
+                    }
+                }
+                continue;
+            }
+            // 代表方向で手前の子を先に調べる
+            float distance1 = Dot(nodes_[node.child1].aabb.Center(), direction);
+            float distance2 = Dot(nodes_[node.child2].aabb.Center(), direction);
+            stack.Push(distance1 <= distance2 ? node.child2 : node.child1);
+            stack.Push(distance1 <= distance2 ? node.child1 : node.child2);
+        }
+    }
+
+}
@@ -0,0 +1,388 @@
+#include "MeshBVH.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+
+namespace {
+
+    using namespace LIEngine;
+
+    // SAHで分割位置を探す区間数
+    const uint32_t kNumBins = 16;
+    // 三角形の判定に対するノードを辿るコスト
+    const float kTraversalCost = 1.0f;
+    // これより深くは分割しない (探索用スタックの大きさ)
+    const uint32_t kMaxDepth = 60;
+    const uint32_t kStackSize = 64;
+
+    // 当たらなければFLT_MAX
+    float IntersectRayAABB(const Math::AABB& aabb, const Vector3& origin, const Vector3& inverseDiff, float maxFraction) {
+        float tMin = 0.0f;
+        float tMax = maxFraction;
+        for (size_t i = 0; i < 3; ++i) {
+            float t1 = (aabb.min[i] - origin[i]) * inverseDiff[i];
+            float t2 = (aabb.max[i] - origin[i]) * inverseDiff[i];
+            tMin = std::max(tMin, std::min(t1, t2));
+            tMax = std::min(tMax, std::max(t1, t2));
+        }
+        return tMin <= tMax ? tMin : FLT_MAX;
+    }
+
+    // 両面の三角形とレイ (当たらなければ負)
+    float IntersectRayTriangle(const Vector3& origin, const Vector3& diff, const Vector3& vertex, const Vector3& edge1, const Vector3& edge2) {
+        Vector3 p = Cross(diff, edge2);
+        float determinant = Dot(edge1, p);
+        if (determinant == 0.0f) { return -1.0f; }
+        float inverseDeterminant = 1.0f / determinant;
+        Vector3 s = origin - vertex;
+        float u = Dot(s, p) * inverseDeterminant;
+        if (u < 0.0f || u > 1.0f) { return -1.0f; }
+        Vector3 q = Cross(s, edge1);
+        float v = Dot(diff, q) * inverseDeterminant;
+        if (v < 0.0f || u + v > 1.0f) { return -1.0f; }
+        return Dot(edge2, q) * inverseDeterminant;
+    }
+
+    // 三角形上の最も近い点
+    Vector3 ClosestPointOnTriangle(const Vector3& point, const Vector3& a, const Vector3& ab, const Vector3& ac) {
+        Vector3 ap = point - a;
+        float d1 = Dot(ab, ap);
+        float d2 = Dot(ac, ap);
+        if (d1 <= 0.0f && d2 <= 0.0f) { return a; }
+
+        Vector3 bp = ap - ab;
+        float d3 = Dot(ab, bp);
+        float d4 = Dot(ac, bp);
+        if (d3 >= 0.0f && d4 <= d3) { return a + ab; }
+
+        float vc = d1 * d4 - d3 * d2;
+        if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) { return a + ab * (d1 / (d1 - d3)); }
+
+        Vector3 cp = ap - ac;
+        float d5 = Dot(ab, cp);
+        float d6 = Dot(ac, cp);
+        if (d6 >= 0.0f && d5 <= d6) { return a + ac; }
+
+        float vb = d5 * d2 - d1 * d6;
+        if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) { return a + ac * (d2 / (d2 - d6)); }
+
+        float va = d3 * d6 - d5 * d4;
+        if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+            return a + ab + (ac - ab) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+        }
+
+        float denominator = 1.0f / (va + vb + vc);
+        return a + ab * (vb * denominator) + ac * (vc * denominator);
+    }
+
+    uint32_t GetBin(float centroid, float min, float scale) {
+        return std::min(kNumBins - 1, uint32_t((centroid - min) * scale));
+    }
+
+}
+
+namespace LIEngine {
+
+    MeshBVH::MeshBVH(const std::vector<Vector3>& positions, const std::vector<uint32_t>& indices) {
+        assert(indices.size() % 3 == 0);
+        uint32_t numTriangles = uint32_t(indices.size() / 3);
+        if (numTriangles == 0) { return; }
+
+        std::vector<BuildTriangle> buildTriangles(numTriangles);
+        for (uint32_t i = 0; i < numTriangles; ++i) {
+            const Vector3& v0 = positions[indices[i * 3 + 0]];
+            const Vector3& v1 = positions[indices[i * 3 + 1]];
+            const Vector3& v2 = positions[indices[i * 3 + 2]];
+            BuildTriangle& buildTriangle = buildTriangles[i];
+            buildTriangle.bounds = Math::AABB(v0);
+            buildTriangle.bounds.Merge(v1);
+            buildTriangle.bounds.Merge(v2);
+            buildTriangle.centroid = (v0 + v1 + v2) * (1.0f / 3.0f);
+            buildTriangle.index = i;
+        }
+
+        // 節の数は葉の数の2倍弱
+        nodes_.reserve(numTriangles * 2 / kMaxLeafTriangles + 1);
+        BuildNode(buildTriangles, 0, numTriangles, 0);
+        nodes_.shrink_to_fit();
+        bounds_ = nodes_[0].bounds;
+
+        // 葉から順に読めるよう並べ替えた順で持つ
+        triangles_.resize(numTriangles);
+        for (uint32_t i = 0; i < numTriangles; ++i) {
+            uint32_t index = buildTriangles[i].index;
+            const Vector3& v0 = positions[indices[index * 3 + 0]];
+            const Vector3& v1 = positions[indices[index * 3 + 1]];
+            const Vector3& v2 = positions[indices[index * 3 + 2]];
+            triangles_[i] = { v0, v1 - v0, v2 - v0, index };
+        }
+    }
+
+    uint32_t MeshBVH::BuildNode(std::vector<BuildTriangle>& buildTriangles, uint32_t begin, uint32_t end, uint32_t depth) {
+        uint32_t nodeIndex = uint32_t(nodes_.size());
+        nodes_.emplace_back();
+
+        Math::AABB bounds = buildTriangles[begin].bounds;
+        Math::AABB centroidBounds(buildTriangles[begin].centroid);
+        for (uint32_t i = begin + 1; i < end; ++i) {
+            bounds.Merge(buildTriangles[i].bounds);
+            centroidBounds.Merge(buildTriangles[i].centroid);
+        }
+        nodes_[nodeIndex].bounds = bounds;
+
+        uint32_t count = end - begin;
+        auto MakeLeaf = [&]() {
+            nodes_[nodeIndex].offset = begin;
+            nodes_[nodeIndex].count = count;
+            return nodeIndex;
+            };
+        if (count <= 1 || depth >= kMaxDepth) {
+            return MakeLeaf();
+        }
+
+        // 重心を区間に分けて、表面積×三角形数が最小になる位置を探す
+        float bestCost = FLT_MAX;
+        uint32_t bestAxis = 3;
+        uint32_t bestSplit = 0;
+        for (uint32_t axis = 0; axis < 3; ++axis) {
+            float extent = centroidBounds.Extent(axis);
+            if (extent <= 0.0f) { continue; }
+            float scale = float(kNumBins) / extent;
+
+            Math::AABB binBounds[kNumBins];
+            uint32_t binCounts[kNumBins] = {};
+            for (uint32_t i = begin; i < end; ++i) {
+                uint32_t bin = GetBin(buildTriangles[i].centroid[axis], centroidBounds.min[axis], scale);
+                if (binCounts[bin]++ == 0) { binBounds[bin] = buildTriangles[i].bounds; }
+                else { binBounds[bin].Merge(buildTriangles[i].bounds); }
+            }
+
+            // 右から累積したコスト
+            float rightCosts[kNumBins] = {};
+            Math::AABB rightBounds;
+            uint32_t rightCount = 0;
+            for (uint32_t bin = kNumBins - 1; bin > 0; --bin) {
+                if (binCounts[bin] > 0) {
+                    if (rightCount == 0) { rightBounds = binBounds[bin]; }
+                    else { rightBounds.Merge(binBounds[bin]); }
+                    rightCount += binCounts[bin];
+                }
+                rightCosts[bin] = rightCount > 0 ? rightBounds.SurfaceArea() * float(rightCount) : 0.0f;
+            }
+
+            Math::AABB leftBounds;
+            uint32_t leftCount = 0;
+            for (uint32_t split = 1; split < kNumBins; ++split) {
+                uint32_t bin = split - 1;
+                if (binCounts[bin] > 0) {
+                    if (leftCount == 0) { leftBounds = binBounds[bin]; }
+                    else { leftBounds.Merge(binBounds[bin]); }
+                    leftCount += binCounts[bin];
+                }
+                // 片側が空になる位置は分割にならない
+                if (leftCount == 0 || leftCount == count) { continue; }
+                float cost = leftBounds.SurfaceArea() * float(leftCount) + rightCosts[split];
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = split;
+                }
+            }
+        }
+
+        uint32_t middle = begin + count / 2;
+        if (bestAxis < 3) {
+            float area = bounds.SurfaceArea();
+            float splitCost = kTraversalCost + (area > 0.0f ? bestCost / area : 0.0f);
+            // 分けても得をしない場合は葉にする
+            if (count <= kMaxLeafTriangles && splitCost >= float(count)) {
+                return MakeLeaf();
+            }
+            float min = centroidBounds.min[bestAxis];
+            float scale = float(kNumBins) / centroidBounds.Extent(bestAxis);
+            auto iter = std::partition(buildTriangles.begin() + begin, buildTriangles.begin() + end, [&](const BuildTriangle& buildTriangle) {
+                return GetBin(buildTriangle.centroid[bestAxis], min, scale) < bestSplit;
+                });
+            middle = uint32_t(iter - buildTriangles.begin());
+        }
+        else if (count <= kMaxLeafTriangles) {
+            return MakeLeaf();
+        }
+        // 重心がすべて同じ場合は半分に分ける
+        if (middle == begin || middle == end) {
+            middle = begin + count / 2;
+        }
+
+        BuildNode(buildTriangles, begin, middle, depth + 1);
+        uint32_t secondChild = BuildNode(buildTriangles, middle, end, depth + 1);
+        nodes_[nodeIndex].offset = secondChild;
+        nodes_[nodeIndex].count = 0;
+        return nodeIndex;
+    }
+
+    bool MeshBVH::RayCast(const Vector3& origin, const Vector3& diff, float maxFraction, RayHit& hit) const {
+        if (nodes_.empty()) { return false; }
+
+        // 0で割らないよう軸に平行な成分は大きな値にする
+        Vector3 inverseDiff;
+        for (size_t i = 0; i < 3; ++i) {
+            inverseDiff[i] = diff[i] != 0.0f ? 1.0f / diff[i] : std::copysign(FLT_MAX, diff[i]);
+        }
+
+        float nearest = maxFraction;
+        bool found = false;
+        if (IntersectRayAABB(nodes_[0].bounds, origin, inverseDiff, nearest) == FLT_MAX) { return false; }
+
+        // スタックには入口の割合も積み、ヒットより奥なら取り出した時に捨てる
+        std::pair<uint32_t, float> stack[kStackSize];
+        uint32_t stackSize = 0;
+        stack[stackSize++] = { 0, 0.0f };
+        while (stackSize > 0) {
+            auto [nodeIndex, entry] = stack[--stackSize];
+            if (entry > nearest) { continue; }
+            const Node& node = nodes_[nodeIndex];
+
+            if (node.IsLeaf()) {
+                for (uint32_t i = node.offset; i < node.offset + node.count; ++i) {
+                    const Triangle& triangle = triangles_[i];
+                    float t = IntersectRayTriangle(origin, diff, triangle.vertex, triangle.edge1, triangle.edge2);
+                    if (t >= 0.0f && t <= nearest) {
+                        nearest = t;
+                        hit.fraction = t;
+                        hit.triangle = triangle.index;
+                        found = true;
+                    }
+                }
+                continue;
+            }
+
+            // 近い子を後に積んで先に調べる
+            uint32_t child1 = nodeIndex + 1;
+            uint32_t child2 = node.offset;
+            float t1 = IntersectRayAABB(nodes_[child1].bounds, origin, inverseDiff, nearest);
+            float t2 = IntersectRayAABB(nodes_[child2].bounds, origin, inverseDiff, nearest);
+            if (t1 > t2) {
+                std::swap(child1, child2);
+                std::swap(t1, t2);
+            }
+            assert(stackSize + 2 <= kStackSize);
+            if (t2 != FLT_MAX) { stack[stackSize++] = { child2, t2 }; }
+            if (t1 != FLT_MAX) { stack[stackSize++] = { child1, t1 }; }
+        }
+        return found;
+    }
+
+    template<typename Callback>
+    void MeshBVH::QueryTriangles(const Math::AABB& aabb, Callback&& callback) const {
+        if (nodes_.empty()) { return; }
+
+        uint32_t stack[kStackSize];
+        uint32_t stackSize = 0;
+        stack[stackSize++] = 0;
+        while (stackSize > 0) {
+            uint32_t nodeIndex = stack[--stackSize];
+            const Node& node = nodes_[nodeIndex];
+            if (!node.bounds.Intersects(aabb)) { continue; }
+
+            if (node.IsLeaf()) {
+                for (uint32_t i = node.offset; i < node.offset + node.count; ++i) {
+                    callback(triangles_[i]);
+                }
+                continue;
+            }
+            assert(stackSize + 2 <= kStackSize);
+            stack[stackSize++] = node.offset;
+            stack[stackSize++] = nodeIndex + 1;
+        }
+    }
+
+    bool MeshBVH::Collide(const Math::Sphere& sphere, Narrowphase::Contact& contact) const {
+        Vector3 radius(sphere.radius);
+        float radiusSquare = sphere.radius * sphere.radius;
+        float deepest = -1.0f;
+        QueryTriangles(Math::AABB(sphere.center - radius, sphere.center + radius), [&](const Triangle& triangle) {
+            Vector3 point = ClosestPointOnTriangle(sphere.center, triangle.vertex, triangle.edge1, triangle.edge2);
+            Vector3 diff = point - sphere.center;
+            float lengthSquare = diff.LengthSquare();
+            if (lengthSquare > radiusSquare) { return; }
+            float length = std::sqrt(lengthSquare);
+            float depth = sphere.radius - length;
+            if (depth <= deepest) { return; }
+            // 中心が面上にある場合は面の裏向きへ
+            Vector3 normal = length > 0.0f ? diff / length : -Cross(triangle.edge1, triangle.edge2).Normalized();
+            deepest = depth;
+            contact.normal = normal;
+            contact.depth = depth;
+            });
+        return deepest >= 0.0f;
+    }
+
+    bool MeshBVH::Collide(const Math::Capsule& capsule, Narrowphase::Contact& contact) const {
+        const Math::Segment& segment = capsule.segment;
+        Vector3 start = segment.origin;
+        Vector3 end = segment.origin + segment.diff;
+        Vector3 radius(capsule.radius);
+        Math::AABB aabb(Vector3::Min(start, end) - radius, Vector3::Max(start, end) + radius);
+        float radiusSquare = capsule.radius * capsule.radius;
+
+        float deepest = -1.0f;
+        QueryTriangles(aabb, [&](const Triangle& triangle) {
+            Vector3 faceNormal = Cross(triangle.edge1, triangle.edge2);
+            float faceNormalLength = faceNormal.Length();
+            // 面積のない三角形は無視
+            if (faceNormalLength == 0.0f) { return; }
+            faceNormal /= faceNormalLength;
+
+            // 芯が面を貫いている
+            float distance0 = Dot(start - triangle.vertex, faceNormal);
+            float distance1 = Dot(end - triangle.vertex, faceNormal);
+            if (distance0 * distance1 < 0.0f &&
+                IntersectRayTriangle(start, segment.diff, triangle.vertex, triangle.edge1, triangle.edge2) >= 0.0f) {
+                float above = std::max(distance0, distance1);
+                float below = -std::min(distance0, distance1);
+                float depth = capsule.radius + std::min(above, below);
+                if (depth > deepest) {
+                    deepest = depth;
+                    contact.normal = above >= below ? -faceNormal : faceNormal;
+                    contact.depth = depth;
+                }
+                return;
+            }
+
+            // 端点と面、芯と辺の中で最も近い組
+            Vector3 bestSegmentPoint = start;
+            Vector3 bestTrianglePoint = ClosestPointOnTriangle(start, triangle.vertex, triangle.edge1, triangle.edge2);
+            float bestLengthSquare = (bestTrianglePoint - start).LengthSquare();
+            auto Consider = [&](const Vector3& segmentPoint, const Vector3& trianglePoint) {
+                float lengthSquare = (trianglePoint - segmentPoint).LengthSquare();
+                if (lengthSquare < bestLengthSquare) {
+                    bestLengthSquare = lengthSquare;
+                    bestSegmentPoint = segmentPoint;
+                    bestTrianglePoint = trianglePoint;
+                }
+                };
+            Consider(end, ClosestPointOnTriangle(end, triangle.vertex, triangle.edge1, triangle.edge2));
+            const Math::Segment edges[3] = {
+                { triangle.vertex, triangle.edge1 },
+                { triangle.vertex + triangle.edge1, triangle.edge2 - triangle.edge1 },
+                { triangle.vertex + triangle.edge2, -triangle.edge2 } };
+            for (const Math::Segment& edge : edges) {
+                float t1, t2;
+                Narrowphase::ClosestFractions(segment, edge, t1, t2);
+                Consider(segment.origin + segment.diff * t1, edge.origin + edge.diff * t2);
+            }
+            if (bestLengthSquare > radiusSquare) { return; }
+
+            float length = std::sqrt(bestLengthSquare);
+            float depth = capsule.radius - length;
+            if (depth <= deepest) { return; }
+            deepest = depth;
+            contact.normal = length > 0.0f ? (bestTrianglePoint - bestSegmentPoint) / length : -faceNormal;
+            contact.depth = depth;
+            });
+        return deepest >= 0.0f;
+    }
+
+}
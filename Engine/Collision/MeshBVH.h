@@ -0,0 +1,112 @@
+///
+/// 三角形メッシュのBVH
+///
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Math/MathUtils.h"
+#include "Math/Geometry.h"
+#include "Narrowphase.h"
+
+namespace LIEngine {
+
+    /// <summary>
+    /// 静的な三角形メッシュ用のBVH
+    /// SAHで分割し、ノードは深さ優先で一列に並べる
+    /// 構築後は変更しないので複数スレッドから同時に参照できる
+    /// </summary>
+    class MeshBVH {
+    public:
+        // 葉に入れる三角形の最大数
+        static constexpr uint32_t kMaxLeafTriangles = 4;
+
+        struct RayHit {
+            // diffに対する割合
+            float fraction;
+            // 元のインデックス列での三角形番号
+            uint32_t triangle;
+        };
+
+        /// <summary>
+        /// 構築
+        /// </summary>
+        /// <param name="positions">頂点座標</param>
+        /// <param name="indices">三角形リストのインデックス</param>
+        MeshBVH(const std::vector<Vector3>& positions, const std::vector<uint32_t>& indices);
+
+        /// <summary>
+        /// 最も近い三角形とのレイキャスト (両面)
+        /// </summary>
+        /// <param name="origin">原点</param>
+        /// <param name="diff">ベクトル</param>
+        /// <param name="maxFraction">これより遠いヒットは無視する</param>
+        /// <param name="hit">ヒットした場合のみ書き込む</param>
+        /// <returns>ヒット有無</returns>
+        bool RayCast(const Vector3& origin, const Vector3& diff, float maxFraction, RayHit& hit) const;
+        /// <summary>
+        /// 球との判定
+        /// 最もめり込んでいる三角形の結果を返す
+        /// </summary>
+        /// <param name="sphere"></param>
+        /// <param name="contact">法線は球からメッシュへ</param>
+        /// <returns>衝突しているか</returns>
+        bool Collide(const Math::Sphere& sphere, Narrowphase::Contact& contact) const;
+        /// <summary>
+        /// カプセルとの判定
+        /// 芯が三角形を貫いている場合は端点の浅い側へ押し出す
+        /// </summary>
+        /// <param name="capsule"></param>
+        /// <param name="contact">法線はカプセルからメッシュへ</param>
+        /// <returns>衝突しているか</returns>
+        bool Collide(const Math::Capsule& capsule, Narrowphase::Contact& contact) const;
+
+        const Math::AABB& GetBounds() const { return bounds_; }
+        size_t GetNumTriangles() const { return triangles_.size(); }
+        size_t GetNumNodes() const { return nodes_.size(); }
+
+    private:
+        struct Node {
+            Math::AABB bounds;
+            // 葉: 最初の三角形, 節: 二つ目の子 (一つ目の子は直後)
+            uint32_t offset;
+            // 葉の三角形数 (0なら節)
+            uint32_t count;
+
+            bool IsLeaf() const { return count != 0; }
+        };
+
+        // 交差判定で使う形で持つ
+        struct Triangle {
+            Vector3 vertex;
+            Vector3 edge1;
+            Vector3 edge2;
+            uint32_t index;
+        };
+
+        // 構築中の三角形
+        struct BuildTriangle {
+            Math::AABB bounds;
+            Vector3 centroid;
+            uint32_t index;
+        };
+
+        /// <summary>
+        /// [begin,end)の三角形でノードを作り、再帰的に分割する
+        /// </summary>
+        /// <returns>ノード番号</returns>
+        uint32_t BuildNode(std::vector<BuildTriangle>& buildTriangles, uint32_t begin, uint32_t end, uint32_t depth);
+        /// <summary>
+        /// AABBと重なる葉の三角形を順に渡す
+        /// </summary>
+        template<typename Callback>
+        void QueryTriangles(const Math::AABB& aabb, Callback&& callback) const;
+
+        std::vector<Node> nodes_;
+        std::vector<Triangle> triangles_;
+        Math::AABB bounds_{ Vector3::zero, Vector3::zero };
+    };
+
+}
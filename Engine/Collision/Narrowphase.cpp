@@ -0,0 +1,281 @@
+#include "Narrowphase.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace {
+
+    using namespace LIEngine;
+
+    const float kEpsilon = 1.0e-6f;
+    // カプセルと箱の最近点を求める反復回数の上限
+    const size_t kMaxClosestIterations = 8;
+
+    // 箱のローカル空間での球と箱の判定 (法線は球から箱へ)
+    bool CollideSphereBoxLocal(const Vector3& center, float radius, const Vector3& halfSize, Narrowphase::Contact& contact) {
+        Vector3 point = Vector3::Clamp(center, -halfSize, halfSize);
+        Vector3 diff = point - center;
+        float lengthSquare = diff.LengthSquare();
+        if (lengthSquare > radius * radius) {
+            return false;
+        }
+
+        if (lengthSquare > 0.0f) {
+            float length = std::sqrt(lengthSquare);
+            contact.normal = diff / length;
+            contact.depth = radius - length;
+            return true;
+        }
+
+        // 中心が箱の中にある場合は最も近い面から押し出す
+        size_t axis = 0;
+        float minDistance = FLT_MAX;
+        for (size_t i = 0; i < 3; ++i) {
+            float distance = halfSize[i] - std::abs(center[i]);
+            if (distance < minDistance) {
+                minDistance = distance;
+                axis = i;
+            }
+        }
+        contact.normal = Vector3::zero;
+        contact.normal[axis] = center[axis] >= 0.0f ? -1.0f : 1.0f;
+        contact.depth = radius + minDistance;
+        return true;
+    }
+
+    // 箱のローカル空間でのカプセルと箱の判定
+    bool CollideCapsuleBoxLocal(const Math::Segment& segment, float radius, const Vector3& halfSize, Narrowphase::Contact& contact) {
+        // 線分上の点と箱上の点を交互に射影して最近点に近づける
+        float t = Narrowphase::ClosestFraction(segment, Vector3::zero);
+        for (size_t i = 0; i < kMaxClosestIterations; ++i) {
+            Vector3 boxPoint = Vector3::Clamp(segment.origin + segment.diff * t, -halfSize, halfSize);
+            float next = Narrowphase::ClosestFraction(segment, boxPoint);
+            if (std::abs(next - t) <= kEpsilon) { break; }
+            t = next;
+        }
+        return CollideSphereBoxLocal(segment.origin + segment.diff * t, radius, halfSize, contact);
+    }
+
+    // ワールドからOBBのローカルへ
+    Vector3 ToLocal(const Math::OBB& obb, const Vector3& point) {
+        Vector3 diff = point - obb.center;
+        return { Dot(diff, obb.orientations[0]), Dot(diff, obb.orientations[1]), Dot(diff, obb.orientations[2]) };
+    }
+
+    Vector3 ToWorldDirection(const Math::OBB& obb, const Vector3& direction) {
+        return obb.orientations[0] * direction.x + obb.orientations[1] * direction.y + obb.orientations[2] * direction.z;
+    }
+
+    Math::OBB ToOBB(const Math::AABB& aabb) {
+        return { aabb.Center(), { Vector3::unitX, Vector3::unitY, Vector3::unitZ }, aabb.Extent() };
+    }
+
+}
+
+namespace LIEngine {
+
+    namespace Narrowphase {
+
+        float ClosestFraction(const Math::Segment& segment, const Vector3& point) {
+            float lengthSquare = segment.diff.LengthSquare();
+            if (lengthSquare <= kEpsilon) { return 0.0f; }
+            return std::clamp(Dot(point - segment.origin, segment.diff) / lengthSquare, 0.0f, 1.0f);
+        }
+
+        void ClosestFractions(const Math::Segment& segment1, const Math::Segment& segment2, float& t1, float& t2) {
+            const Vector3& d1 = segment1.diff;
+            const Vector3& d2 = segment2.diff;
+            Vector3 r = segment1.origin - segment2.origin;
+            float a = Dot(d1, d1);
+            float e = Dot(d2, d2);
+            float f = Dot(d2, r);
+
+            // どちらかが点に縮退している
+            if (a <= kEpsilon && e <= kEpsilon) {
+                t1 = t2 = 0.0f;
+                return;
+            }
+            if (a <= kEpsilon) {
+                t1 = 0.0f;
+                t2 = std::clamp(f / e, 0.0f, 1.0f);
+                return;
+            }
+            float c = Dot(d1, r);
+            if (e <= kEpsilon) {
+                t2 = 0.0f;
+                t1 = std::clamp(-c / a, 0.0f, 1.0f);
+                return;
+            }
+
+            float b = Dot(d1, d2);
+            float denominator = a * e - b * b;
+            // 平行なら始点から
+            t1 = denominator != 0.0f ? std::clamp((b * f - c * e) / denominator, 0.0f, 1.0f) : 0.0f;
+            t2 = (b * t1 + f) / e;
+            if (t2 < 0.0f) {
+                t2 = 0.0f;
+                t1 = std::clamp(-c / a, 0.0f, 1.0f);
+            }
+            else if (t2 > 1.0f) {
+                t2 = 1.0f;
+                t1 = std::clamp((b - c) / a, 0.0f, 1.0f);
+            }
+        }
+
+        bool Collide(const Math::Sphere& a, const Math::Sphere& b, Contact& contact) {
+            Vector3 diff = b.center - a.center;
+            float hitRange = a.radius + b.radius;
+            float lengthSquare = diff.LengthSquare();
+            if (lengthSquare > hitRange * hitRange) {
+                return false;
+            }
+            float length = std::sqrt(lengthSquare);
+            contact.normal = length != 0.0f ? diff / length : Vector3::zero;
+            contact.depth = hitRange - length;
+            return true;
+        }
+
+        bool Collide(const Math::Sphere& a, const Math::AABB& b, Contact& contact) {
+            return CollideSphereBoxLocal(a.center - b.Center(), a.radius, b.Extent() * 0.5f, contact);
+        }
+
+        bool Collide(const Math::Sphere& a, const Math::OBB& b, Contact& contact) {
+            if (!CollideSphereBoxLocal(ToLocal(b, a.center), a.radius, b.size * 0.5f, contact)) {
+                return false;
+            }
+            contact.normal = ToWorldDirection(b, contact.normal);
+            return true;
+        }
+
+        bool Collide(const Math::Sphere& a, const Math::Capsule& b, Contact& contact) {
+            float t = ClosestFraction(b.segment, a.center);
+            return Collide(a, Math::Sphere{ b.segment.origin + b.segment.diff * t, b.radius }, contact);
+        }
+
+        bool Collide(const Math::Capsule& a, const Math::Capsule& b, Contact& contact) {
+            float t1, t2;
+            ClosestFractions(a.segment, b.segment, t1, t2);
+            return Collide(
+                Math::Sphere{ a.segment.origin + a.segment.diff * t1, a.radius },
+                Math::Sphere{ b.segment.origin + b.segment.diff * t2, b.radius },
+                contact);
+        }
+
+        bool Collide(const Math::Capsule& a, const Math::AABB& b, Contact& contact) {
+            Vector3 center = b.Center();
+            return CollideCapsuleBoxLocal({ a.segment.origin - center, a.segment.diff }, a.radius, b.Extent() * 0.5f, contact);
+        }
+
+        bool Collide(const Math::Capsule& a, const Math::OBB& b, Contact& contact) {
+            Math::Segment localSegment = {
+                ToLocal(b, a.segment.origin),
+                { Dot(a.segment.diff, b.orientations[0]), Dot(a.segment.diff, b.orientations[1]), Dot(a.segment.diff, b.orientations[2]) } };
+            if (!CollideCapsuleBoxLocal(localSegment, a.radius, b.size * 0.5f, contact)) {
+                return false;
+            }
+            contact.normal = ToWorldDirection(b, contact.normal);
+            return true;
+        }
+
+        bool Collide(const Math::AABB& a, const Math::AABB& b, Contact& contact) {
+            Vector3 distance = b.Center() - a.Center();
+            Vector3 halfSum = (a.Extent() + b.Extent()) * 0.5f;
+            float minOverlap = FLT_MAX;
+            size_t minAxis = 0;
+            for (size_t i = 0; i < 3; ++i) {
+                float overlap = halfSum[i] - std::abs(distance[i]);
+                if (overlap < 0.0f) { return false; }
+                if (overlap < minOverlap) {
+                    minOverlap = overlap;
+                    minAxis = i;
+                }
+            }
+            contact.normal = Vector3::zero;
+            contact.normal[minAxis] = distance[minAxis] >= 0.0f ? 1.0f : -1.0f;
+            contact.depth = minOverlap;
+            return true;
+        }
+
+        bool Collide(const Math::AABB& a, const Math::OBB& b, Contact& contact) {
+            return Collide(ToOBB(a), b, contact);
+        }
+
+        bool Collide(const Math::OBB& a, const Math::OBB& b, Contact& contact) {
+            // aのローカル空間で分離軸判定を行う
+            const Vector3* axesA = a.orientations;
+            const Vector3* axesB = b.orientations;
+            Vector3 halfA = a.size * 0.5f;
+            Vector3 halfB = b.size * 0.5f;
+
+            // bの軸をaの軸で表した回転
+            // 平行な辺の外積が0に近くなって誤判定しないよう絶対値に誤差分を足す
+            float r[3][3], absR[3][3];
+            for (size_t i = 0; i < 3; ++i) {
+                for (size_t j = 0; j < 3; ++j) {
+                    r[i][j] = Dot(axesA[i], axesB[j]);
+                    absR[i][j] = std::abs(r[i][j]) + kEpsilon;
+                }
+            }
+            Vector3 distanceWorld = b.center - a.center;
+            Vector3 distance = { Dot(distanceWorld, axesA[0]), Dot(distanceWorld, axesA[1]), Dot(distanceWorld, axesA[2]) };
+
+            float minOverlap = FLT_MAX;
+            Vector3 minAxis = Vector3::zero;
+            // 重なりを軸の長さで割って比較する
+            auto Accept = [&](float overlap, float projectedDistance, const Vector3& axis, float axisLength) {
+                overlap /= axisLength;
+                if (overlap < minOverlap) {
+                    minOverlap = overlap;
+                    minAxis = (projectedDistance >= 0.0f ? 1.0f : -1.0f) / axisLength * axis;
+                }
+                };
+
+            // aの面
+            for (size_t i = 0; i < 3; ++i) {
+                float rb = halfB.x * absR[i][0] + halfB.y * absR[i][1] + halfB.z * absR[i][2];
+                float overlap = halfA[i] + rb - std::abs(distance[i]);
+                if (overlap < 0.0f) { return false; }
+                Accept(overlap, distance[i], axesA[i], 1.0f);
+            }
+            // bの面
+            for (size_t j = 0; j < 3; ++j) {
+                float ra = halfA.x * absR[0][j] + halfA.y * absR[1][j] + halfA.z * absR[2][j];
+                float projectedDistance = distance.x * r[0][j] + distance.y * r[1][j] + distance.z * r[2][j];
+                float overlap = ra + halfB[j] - std::abs(projectedDistance);
+                if (overlap < 0.0f) { return false; }
+                Accept(overlap, projectedDistance, axesB[j], 1.0f);
+            }
+
+            // 辺同士の9軸は分岐なしでまとめて求めてから調べる
+            float overlaps[9], projectedDistances[9];
+            for (size_t i = 0; i < 3; ++i) {
+                size_t i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+                for (size_t j = 0; j < 3; ++j) {
+                    size_t j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+                    float ra = halfA[i1] * absR[i2][j] + halfA[i2] * absR[i1][j];
+                    float rb = halfB[j1] * absR[i][j2] + halfB[j2] * absR[i][j1];
+                    float projectedDistance = distance[i2] * r[i1][j] - distance[i1] * r[i2][j];
+                    projectedDistances[i * 3 + j] = projectedDistance;
+                    overlaps[i * 3 + j] = ra + rb - std::abs(projectedDistance);
+                }
+            }
+            for (size_t k = 0; k < 9; ++k) {
+                if (overlaps[k] < 0.0f) { return false; }
+            }
+            for (size_t k = 0; k < 9; ++k) {
+                Vector3 axis = Cross(axesA[k / 3], axesB[k % 3]);
+                float axisLength = axis.Length();
+                // 平行な辺は面の軸で判定済み
+                if (axisLength <= kEpsilon) { continue; }
+                Accept(overlaps[k], projectedDistances[k], axis, axisLength);
+            }
+
+            contact.normal = minAxis;
+            contact.depth = minOverlap;
+            return true;
+        }
+
+    }
+
+}
@@ -0,0 +1,79 @@
+///
+/// 詳細判定
+///
+
+#pragma once
+
+#include "Math/MathUtils.h"
+#include "Math/Geometry.h"
+
+namespace LIEngine {
+
+    namespace Narrowphase {
+
+        /// <summary>
+        /// 衝突情報
+        /// </summary>
+        struct Contact {
+            // aからbへ向かう法線 (bをこの向きに押し出すと離れる)
+            Vector3 normal;
+            // めり込み量
+            float depth;
+        };
+
+        /// <summary>
+        /// 形状同士の詳細判定
+        /// ヒープを使わず、分離が分かった時点で打ち切る
+        /// OBBの軸は正規直交、sizeは全体の大きさ
+        /// </summary>
+        /// <param name="a"></param>
+        /// <param name="b"></param>
+        /// <param name="contact">衝突した場合のみ書き込む</param>
+        /// <returns>衝突しているか</returns>
+        bool Collide(const Math::Sphere& a, const Math::Sphere& b, Contact& contact);
+        bool Collide(const Math::Sphere& a, const Math::AABB& b, Contact& contact);
+        bool Collide(const Math::Sphere& a, const Math::OBB& b, Contact& contact);
+        bool Collide(const Math::Sphere& a, const Math::Capsule& b, Contact& contact);
+        bool Collide(const Math::Capsule& a, const Math::Capsule& b, Contact& contact);
+        bool Collide(const Math::Capsule& a, const Math::AABB& b, Contact& contact);
+        bool Collide(const Math::Capsule& a, const Math::OBB& b, Contact& contact);
+        bool Collide(const Math::AABB& a, const Math::AABB& b, Contact& contact);
+        bool Collide(const Math::AABB& a, const Math::OBB& b, Contact& contact);
+        bool Collide(const Math::OBB& a, const Math::OBB& b, Contact& contact);
+
+        /// <summary>
+        /// 引数を入れ替えた判定
+        /// 法線を反転する
+        /// </summary>
+        template<typename A, typename B>
+        inline bool CollideReversed(const A& a, const B& b, Contact& contact) {
+            if (!Collide(b, a, contact)) { return false; }
+            contact.normal = -contact.normal;
+            return true;
+        }
+        inline bool Collide(const Math::AABB& a, const Math::Sphere& b, Contact& contact) { return CollideReversed(a, b, contact); }
+        inline bool Collide(const Math::OBB& a, const Math::Sphere& b, Contact& contact) { return CollideReversed(a, b, contact); }
+        inline bool Collide(const Math::Capsule& a, const Math::Sphere& b, Contact& contact) { return CollideReversed(a, b, contact); }
+        inline bool Collide(const Math::AABB& a, const Math::Capsule& b, Contact& contact) { return CollideReversed(a, b, contact); }
+        inline bool Collide(const Math::OBB& a, const Math::Capsule& b, Contact& contact) { return CollideReversed(a, b, contact); }
+        inline bool Collide(const Math::OBB& a, const Math::AABB& b, Contact& contact) { return CollideReversed(a, b, contact); }
+
+        /// <summary>
+        /// 線分上の点に最も近い位置の割合
+        /// </summary>
+        /// <param name="segment"></param>
+        /// <param name="point"></param>
+        /// <returns>[0,1]</returns>
+        float ClosestFraction(const Math::Segment& segment, const Vector3& point);
+        /// <summary>
+        /// 二つの線分の最も近い位置の割合
+        /// </summary>
+        /// <param name="segment1"></param>
+        /// <param name="segment2"></param>
+        /// <param name="t1">segment1上の割合</param>
+        /// <param name="t2">segment2上の割合</param>
+        void ClosestFractions(const Math::Segment& segment1, const Math::Segment& segment2, float& t1, float& t2);
+
+    }
+
+}
@@ -0,0 +1,198 @@
+#include "SpatialHashGrid.h"
+
+#include <atomic>
+
+#include "Framework/ThreadPool.h"
+
+namespace {
+
+    // 1タスクが一度に登録するプロキシ数
+    const size_t kProxiesPerChunk = 256;
+    // 1タスクが一度に並べ替えるエントリ数
+    const size_t kEntriesPerChunk = 1024;
+    // 1タスクが一度に整えるバケット数
+    const size_t kBucketsPerChunk = 1024;
+    // 最小のバケット数
+    const uint32_t kMinBuckets = 64;
+
+}
+
+namespace LIEngine {
+
+    SpatialHashGrid::SpatialHashGrid(float cellSize, float margin) :
+        freeList_(kNullProxy),
+        numProxies_(0),
+        cellSize_(cellSize),
+        inverseCellSize_(1.0f / cellSize),
+        margin_(margin),
+        isDirty_(false),
+        bucketMask_(0) {
+        assert(cellSize > 0.0f);
+    }
+
+    int32_t SpatialHashGrid::CreateProxy(const Math::AABB& aabb, void* userData) {
+        int32_t proxyId;
+        if (freeList_ != kNullProxy) {
+            proxyId = freeList_;
+            freeList_ = proxies_[proxyId].next;
+        }
+        else {
+            proxyId = int32_t(proxies_.size());
+            proxies_.emplace_back();
+        }
+        Proxy& proxy = proxies_[proxyId];
+        Vector3 margin(margin_);
+        proxy.aabb = { aabb.min - margin, aabb.max + margin };
+        proxy.userData = userData;
+        proxy.next = kNullProxy;
+        proxy.isFree = false;
+        ++numProxies_;
+        isDirty_ = true;
+        return proxyId;
+    }
+
+    void SpatialHashGrid::DestroyProxy(int32_t proxyId) {
+        assert(0 <= proxyId && proxyId < int32_t(proxies_.size()));
+        assert(!proxies_[proxyId].isFree);
+        Proxy& proxy = proxies_[proxyId];
+        proxy.userData = nullptr;
+        proxy.next = freeList_;
+        proxy.isFree = true;
+        freeList_ = proxyId;
+        --numProxies_;
+        isDirty_ = true;
+    }
+
+    bool SpatialHashGrid::MoveProxy(int32_t proxyId, const Math::AABB& aabb) {
+        assert(0 <= proxyId && proxyId < int32_t(proxies_.size()));
+        assert(!proxies_[proxyId].isFree);
+        // 太らせたAABBに収まっていればセルはそのまま
+        if (proxies_[proxyId].aabb.Contains(aabb)) {
+            return false;
+        }
+        Vector3 margin(margin_);
+        proxies_[proxyId].aabb = { aabb.min - margin, aabb.max + margin };
+        isDirty_ = true;
+        return true;
+    }
+
+    void SpatialHashGrid::Clear() {
+        proxies_.clear();
+        freeList_ = kNullProxy;
+        numProxies_ = 0;
+        cells_.clear();
+        largeProxies_.clear();
+        isDirty_ = false;
+    }
+
+    void SpatialHashGrid::SetCellSize(float cellSize) {
+        assert(cellSize > 0.0f);
+        cellSize_ = cellSize;
+        inverseCellSize_ = 1.0f / cellSize;
+        isDirty_ = true;
+    }
+
+    void SpatialHashGrid::Update(ThreadPool* threadPool) {
+        if (!isDirty_) { return; }
+        isDirty_ = false;
+
+        bool isParallel = threadPool && threadPool->GetNumThreads() > 0;
+        // [0,count)を塊に分けてwork(begin, end)を呼ぶ
+        auto ForChunks = [&](size_t count, size_t chunkSize, auto&& work) {
+            size_t numChunks = (count + chunkSize - 1) / chunkSize;
+            auto Run = [&](size_t chunk, size_t) {
+                work(chunk * chunkSize, std::min(count, (chunk + 1) * chunkSize));
+                };
+            if (!isParallel || numChunks < 2) {
+                for (size_t chunk = 0; chunk < numChunks; ++chunk) { Run(chunk, 0); }
+                return;
+            }
+            threadPool->ParallelChunks(std::min(threadPool->GetNumThreads() + 1, numChunks), numChunks, Run);
+            };
+
+        // プロキシごとに入るセルの数を数える
+        size_t numSlots = proxies_.size();
+        entryOffsets_.resize(numSlots + 1);
+        ForChunks(numSlots, kProxiesPerChunk, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const Proxy& proxy = proxies_[i];
+                uint64_t numCells = proxy.isFree ? 0 : GetCellRange(proxy.aabb).GetNumCells();
+                entryOffsets_[i] = numCells > kMaxCellsPerProxy ? 0 : uint32_t(numCells);
+            }
+            });
+
+        // 書き込み位置を決める
+        largeProxies_.clear();
+        uint32_t numEntries = 0;
+        for (size_t i = 0; i < numSlots; ++i) {
+            uint32_t numCells = entryOffsets_[i];
+            entryOffsets_[i] = numEntries;
+            numEntries += numCells;
+            // 空きでないのに0なら大きすぎてセルに入れないもの
+            if (!proxies_[i].isFree && numCells == 0) {
+                largeProxies_.emplace_back(int32_t(i));
+            }
+        }
+        entryOffsets_[numSlots] = numEntries;
+
+        // バケットはエントリ数以上の2の累乗
+        uint32_t numBuckets = kMinBuckets;
+        while (numBuckets < numEntries) { numBuckets <<= 1; }
+        bucketMask_ = numBuckets - 1;
+        bucketCursors_.assign(numBuckets, 0);
+
+        // セルに登録し、バケットごとの数を数える
+        unsortedCells_.resize(numEntries);
+        ForChunks(numSlots, kProxiesPerChunk, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                if (entryOffsets_[i] == entryOffsets_[i + 1]) { continue; }
+                CellRange range = GetCellRange(proxies_[i].aabb);
+                CellEntry* entry = unsortedCells_.data() + entryOffsets_[i];
+                Cell cell;
+                for (cell.z = range.min.z; cell.z <= range.max.z; ++cell.z) {
+                    for (cell.y = range.min.y; cell.y <= range.max.y; ++cell.y) {
+                        for (cell.x = range.min.x; cell.x <= range.max.x; ++cell.x) {
+                            *entry++ = { cell, int32_t(i) };
+                            std::atomic_ref<uint32_t>(bucketCursors_[Hash(cell) & bucketMask_]).fetch_add(1, std::memory_order_relaxed);
+                        }
+                    }
+                }
+            }
+            });
+
+        bucketStarts_.resize(size_t(numBuckets) + 1);
+        uint32_t start = 0;
+        for (uint32_t bucket = 0; bucket < numBuckets; ++bucket) {
+            bucketStarts_[bucket] = start;
+            start += bucketCursors_[bucket];
+            bucketCursors_[bucket] = bucketStarts_[bucket];
+        }
+        bucketStarts_[numBuckets] = start;
+
+        // バケット順に並べる
+        cells_.resize(numEntries);
+        ForChunks(numEntries, kEntriesPerChunk, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const CellEntry& entry = unsortedCells_[i];
+                uint32_t index = std::atomic_ref<uint32_t>(bucketCursors_[Hash(entry.cell) & bucketMask_]).fetch_add(1, std::memory_order_relaxed);
+                cells_[index] = entry;
+            }
+            });
+
+        // 並列に書き込むとバケットの中の順番が変わるので、
+        // 探索で渡す順番がスレッド数によらないよう並べなおす
+        if (isParallel) {
+            ForChunks(numBuckets, kBucketsPerChunk, [&](size_t begin, size_t end) {
+                for (size_t bucket = begin; bucket < end; ++bucket) {
+                    std::sort(cells_.begin() + bucketStarts_[bucket], cells_.begin() + bucketStarts_[bucket + 1], [](const CellEntry& a, const CellEntry& b) {
+                        return a.proxyId != b.proxyId ? a.proxyId < b.proxyId :
+                            a.cell.z != b.cell.z ? a.cell.z < b.cell.z :
+                            a.cell.y != b.cell.y ? a.cell.y < b.cell.y :
+                            a.cell.x < b.cell.x;
+                        });
+                }
+                });
+        }
+    }
+
+}
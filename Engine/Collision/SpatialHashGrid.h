@@ -0,0 +1,317 @@
+///
+/// 空間ハッシュグリッド
+///
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "Math/MathUtils.h"
+#include "Math/Geometry.h"
+
+namespace LIEngine {
+
+    class ThreadPool;
+
+    /// <summary>
+    /// 一様なセルで区切り、セル座標のハッシュで引く
+    /// 大きさの揃った小さいオブジェクトが密集している場面向け
+    /// プロキシの扱いはDynamicAABBTreeと同じで、太らせたAABBからはみ出したときだけ入れなおす
+    /// セルへの登録はUpdateでまとめて作り直す
+    /// </summary>
+    class SpatialHashGrid {
+    public:
+        static constexpr int32_t kNullProxy = -1;
+        // これより多くのセルにまたがるプロキシはセルに入れず、常に調べる
+        static constexpr uint32_t kMaxCellsPerProxy = 64;
+
+        /// <summary>
+        /// コンストラクタ
+        /// </summary>
+        /// <param name="cellSize">セルの一辺 (太らせたAABBが2セル程度に収まる大きさが目安)</param>
+        /// <param name="margin">AABBを太らせる量</param>
+        explicit SpatialHashGrid(float cellSize = 2.0f, float margin = 0.2f);
+
+        /// <summary>
+        /// 葉を作成
+        /// </summary>
+        /// <param name="aabb">AABB</param>
+        /// <param name="userData">ユーザーデータ</param>
+        /// <returns>プロキシID</returns>
+        int32_t CreateProxy(const Math::AABB& aabb, void* userData);
+        /// <summary>
+        /// 葉を削除
+        /// </summary>
+        /// <param name="proxyId">プロキシID</param>
+        void DestroyProxy(int32_t proxyId);
+        /// <summary>
+        /// 葉を動かす
+        /// 太らせたAABBに収まっている間は何もしない
+        /// </summary>
+        /// <param name="proxyId">プロキシID</param>
+        /// <param name="aabb">新しいAABB</param>
+        /// <returns>入れなおした場合true</returns>
+        bool MoveProxy(int32_t proxyId, const Math::AABB& aabb);
+        /// <summary>
+        /// 全て削除
+        /// </summary>
+        void Clear();
+        /// <summary>
+        /// セルの大きさを変える
+        /// 次のUpdateで作り直す
+        /// </summary>
+        void SetCellSize(float cellSize);
+        /// <summary>
+        /// 変更があればセルを作り直す
+        /// 探索の前に呼ぶ
+        /// </summary>
+        /// <param name="threadPool">指定すると並列に登録する</param>
+        void Update(ThreadPool* threadPool = nullptr);
+
+        void* GetUserData(int32_t proxyId) const { return proxies_[proxyId].userData; }
+        const Math::AABB& GetFatAABB(int32_t proxyId) const { return proxies_[proxyId].aabb; }
+        float GetCellSize() const { return cellSize_; }
+        size_t GetNumProxies() const { return numProxies_; }
+        size_t GetNumCellEntries() const { return cells_.size(); }
+
+        /// <summary>
+        /// AABBと重なる葉を列挙
+        /// スレッドセーフ(グリッドを書き換えない間)
+        /// </summary>
+        /// <param name="aabb">AABB</param>
+        /// <param name="callback">bool(int32_t proxyId) falseで打ち切り</param>
+        template<typename Callback>
+        void Query(const Math::AABB& aabb, Callback&& callback) const;
+        /// <summary>
+        /// 線分と重なる葉を列挙
+        /// セルを手前からたどるので、コールバックの戻り値で以降の探索範囲を縮められる
+        /// </summary>
+        /// <param name="origin">始点</param>
+        /// <param name="diff">始点から終点までのベクトル</param>
+        /// <param name="callback">float(int32_t proxyId, float maxFraction) 戻り値はDynamicAABBTree::RayCastと同じ</param>
+        template<typename Callback>
+        void RayCast(const Vector3& origin, const Vector3& diff, Callback&& callback) const;
+        /// <summary>
+        /// 複数の線分を調べる
+        /// DynamicAABBTreeと同じ形で呼べるようにしたもので、中身は一本ずつ調べる
+        /// </summary>
+        /// <param name="callback">float(int32_t proxyId, size_t rayIndex, float maxFraction)</param>
+        template<typename Callback>
+        void RayCastPacket(const Vector3* origins, const Vector3* diffs, size_t count, Callback&& callback) const;
+
+    private:
+        struct Proxy {
+            Math::AABB aabb;
+            void* userData;
+            // 空きリスト
+            int32_t next;
+            bool isFree;
+        };
+
+        struct Cell {
+            int32_t x, y, z;
+        };
+
+        // セルに登録したプロキシ
+        struct CellEntry {
+            Cell cell;
+            int32_t proxyId;
+        };
+
+        struct CellRange {
+            Cell min;
+            Cell max;
+
+            // あふれないよう上限で止める
+            uint64_t GetNumCells() const {
+                uint64_t xy = uint64_t(int64_t(max.x) - min.x + 1) * uint64_t(int64_t(max.y) - min.y + 1);
+                uint64_t z = uint64_t(int64_t(max.z) - min.z + 1);
+                return xy > UINT32_MAX || z > UINT32_MAX ? UINT64_MAX : xy * z;
+            }
+            bool Contains(const Cell& cell) const {
+                return
+                    min.x <= cell.x && cell.x <= max.x &&
+                    min.y <= cell.y && cell.y <= max.y &&
+                    min.z <= cell.z && cell.z <= max.z;
+            }
+        };
+
+        static uint32_t Hash(const Cell& cell) {
+            return (uint32_t(cell.x) * 73856093u) ^ (uint32_t(cell.y) * 19349663u) ^ (uint32_t(cell.z) * 83492791u);
+        }
+        static float IntersectRay(const Math::AABB& aabb, const Vector3& origin, const Vector3& inverseDiff, float maxFraction);
+
+        int32_t GetCoordinate(float value) const {
+            // 遠すぎる座標でintがあふれないようにする
+            return int32_t(std::floor(std::clamp(value * inverseCellSize_, -1.0e9f, 1.0e9f)));
+        }
+        Cell GetCell(const Vector3& position) const {
+            return { GetCoordinate(position.x), GetCoordinate(position.y), GetCoordinate(position.z) };
+        }
+        CellRange GetCellRange(const Math::AABB& aabb) const {
+            return { GetCell(aabb.min), GetCell(aabb.max) };
+        }
+        // セルに入っているエントリの範囲
+        const CellEntry* GetBucketBegin(const Cell& cell) const { return cells_.data() + bucketStarts_[Hash(cell) & bucketMask_]; }
+        const CellEntry* GetBucketEnd(const Cell& cell) const { return cells_.data() + bucketStarts_[(Hash(cell) & bucketMask_) + 1]; }
+
+        std::vector<Proxy> proxies_;
+        int32_t freeList_;
+        size_t numProxies_;
+        float cellSize_;
+        float inverseCellSize_;
+        float margin_;
+        bool isDirty_;
+
+        // Updateで作る
+        // ハッシュの値で並べたエントリとバケットごとの開始位置
+        std::vector<CellEntry> cells_;
+        std::vector<uint32_t> bucketStarts_;
+        uint32_t bucketMask_;
+        // セルに入れないプロキシ
+        std::vector<int32_t> largeProxies_;
+        // 構築用
+        std::vector<uint32_t> entryOffsets_;
+        std::vector<CellEntry> unsortedCells_;
+        std::vector<uint32_t> bucketCursors_;
+    };
+
+    template<typename Callback>
+    void SpatialHashGrid::Query(const Math::AABB& aabb, Callback&& callback) const {
+        assert(!isDirty_);
+        for (int32_t proxyId : largeProxies_) {
+            if (proxies_[proxyId].aabb.Intersects(aabb) && !callback(proxyId)) { return; }
+        }
+        if (cells_.empty()) { return; }
+
+        CellRange range = GetCellRange(aabb);
+        // 広すぎる範囲はセルをたどるより全部調べた方が早い
+        if (range.GetNumCells() > cells_.size()) {
+            for (int32_t proxyId = 0; proxyId < int32_t(proxies_.size()); ++proxyId) {
+                const Proxy& proxy = proxies_[proxyId];
+                if (proxy.isFree || !proxy.aabb.Intersects(aabb)) { continue; }
+                // セルに入れていないものは先に調べた
+                if (GetCellRange(proxy.aabb).GetNumCells() > kMaxCellsPerProxy) { continue; }
+                if (!callback(proxyId)) { return; }
+            }
+            return;
+        }
+
+        Cell cell;
+        for (cell.z = range.min.z; cell.z <= range.max.z; ++cell.z) {
+            for (cell.y = range.min.y; cell.y <= range.max.y; ++cell.y) {
+                for (cell.x = range.min.x; cell.x <= range.max.x; ++cell.x) {
+                    const CellEntry* end = GetBucketEnd(cell);
+                    for (const CellEntry* entry = GetBucketBegin(cell); entry != end; ++entry) {
+                        if (entry->cell.x != cell.x || entry->cell.y != cell.y || entry->cell.z != cell.z) { continue; }
+                        const Proxy& proxy = proxies_[entry->proxyId];
+                        // 複数のセルに入っているので、範囲が重なる最初のセルでだけ渡す
+                        Cell first = GetCell(proxy.aabb.min);
+                        if (std::max(first.x, range.min.x) != cell.x ||
+                            std::max(first.y, range.min.y) != cell.y ||
+                            std::max(first.z, range.min.z) != cell.z) {
+                            continue;
+                        }
+                        if (!proxy.aabb.Intersects(aabb)) { continue; }
+                        if (!callback(entry->proxyId)) { return; }
+                    }
+                }
+            }
+        }
+    }
+
+    template<typename Callback>
+    void SpatialHashGrid::RayCast(const Vector3& origin, const Vector3& diff, Callback&& callback) const {
+        assert(!isDirty_);
+        // 0除算でNaNにならないよう平行な軸は十分大きい値にする
+        Vector3 inverseDiff;
+        for (size_t i = 0; i < 3; ++i) {
+            inverseDiff[i] = diff[i] != 0.0f ? 1.0f / diff[i] : std::copysign(FLT_MAX, diff[i]);
+        }
+
+        float maxFraction = 1.0f;
+        for (int32_t proxyId : largeProxies_) {
+            if (IntersectRay(proxies_[proxyId].aabb, origin, inverseDiff, maxFraction) < 0.0f) { continue; }
+            maxFraction = callback(proxyId, maxFraction);
+            if (maxFraction < 0.0f) { return; }
+        }
+        if (cells_.empty()) { return; }
+
+        // 線分が通るセルを手前から順にたどる
+        Cell cell = GetCell(origin);
+        Cell last = GetCell(origin + diff);
+        int32_t step[3];
+        float nextFraction[3];
+        float deltaFraction[3];
+        for (size_t i = 0; i < 3; ++i) {
+            int32_t coordinate = (&cell.x)[i];
+            if (diff[i] == 0.0f) {
+                step[i] = 0;
+                nextFraction[i] = FLT_MAX;
+                deltaFraction[i] = FLT_MAX;
+                continue;
+            }
+            step[i] = diff[i] > 0.0f ? 1 : -1;
+            float boundary = float(diff[i] > 0.0f ? coordinate + 1 : coordinate) * cellSize_;
+            nextFraction[i] = (boundary - origin[i]) * inverseDiff[i];
+            deltaFraction[i] = cellSize_ * std::abs(inverseDiff[i]);
+        }
+        // 誤差で終点のセルを越えないよう歩数で止める
+        int64_t numSteps =
+            std::abs(int64_t(last.x) - cell.x) +
+            std::abs(int64_t(last.y) - cell.y) +
+            std::abs(int64_t(last.z) - cell.z);
+
+        Cell previous = cell;
+        for (int64_t i = 0; ; ++i) {
+            const CellEntry* end = GetBucketEnd(cell);
+            for (const CellEntry* entry = GetBucketBegin(cell); entry != end; ++entry) {
+                if (entry->cell.x != cell.x || entry->cell.y != cell.y || entry->cell.z != cell.z) { continue; }
+                const Proxy& proxy = proxies_[entry->proxyId];
+                // 通ってきたセルは連続しているので、前のセルにも入っていれば調べ済み
+                if (i > 0 && GetCellRange(proxy.aabb).Contains(previous)) { continue; }
+                if (IntersectRay(proxy.aabb, origin, inverseDiff, maxFraction) < 0.0f) { continue; }
+                maxFraction = callback(entry->proxyId, maxFraction);
+                if (maxFraction < 0.0f) { return; }
+            }
+
+            if (i >= numSteps) { break; }
+            size_t axis = nextFraction[0] < nextFraction[1] ?
+                (nextFraction[0] < nextFraction[2] ? 0 : 2) :
+                (nextFraction[1] < nextFraction[2] ? 1 : 2);
+            // 次のセルが見つかったヒットより奥なら終わり
+            if (nextFraction[axis] > maxFraction) { break; }
+            previous = cell;
+            (&cell.x)[axis] += step[axis];
+            nextFraction[axis] += deltaFraction[axis];
+        }
+    }
+
+    template<typename Callback>
+    void SpatialHashGrid::RayCastPacket(const Vector3* origins, const Vector3* diffs, size_t count, Callback&& callback) const {
+        for (size_t lane = 0; lane < count; ++lane) {
+            RayCast(origins[lane], diffs[lane], [&](int32_t proxyId, float maxFraction) {
+                return callback(proxyId, lane, maxFraction);
+                });
+        }
+    }
+
+    inline float SpatialHashGrid::IntersectRay(const Math::AABB& aabb, const Vector3& origin, const Vector3& inverseDiff, float maxFraction) {
+        float tMin = 0.0f;
+        float tMax = maxFraction;
+        for (size_t i = 0; i < 3; ++i) {
+            float t1 = (aabb.min[i] - origin[i]) * inverseDiff[i];
+            float t2 = (aabb.max[i] - origin[i]) * inverseDiff[i];
+            tMin = std::max(tMin, std::min(t1, t2));
+            tMax = std::min(tMax, std::max(t1, t2));
+        }
+        return tMin <= tMax ? tMin : -1.0f;
+    }
+
+}
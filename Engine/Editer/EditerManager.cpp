@@ -249,6 +249,11 @@ namespace LIEngine {
                 SettingMenu();
                 WindowMenu();
                 HelpMenu();
+                // シーンの読み込み中は進み具合を出す
+                if (SceneIO::IsLoading()) {
+                    auto progress = SceneIO::GetProgress();
+                    ImGui::Text("Loading scene %zu/%zu", progress.numCompleted, progress.numTasks);
+                }
                 ImGui::EndMenuBar();
             }
 
@@ -316,6 +321,17 @@ namespace LIEngine {
                     RenderManager::GetInstance()->GetSky().DrawImGui();
                     ImGui::EndMenu();
                 }
+                if (ImGui::BeginMenu("Culling")) {
+                    auto& modelSorter = RenderManager::GetInstance()->GetModelSorter();
+                    bool enableCulling = modelSorter.IsEnableCulling();
+                    ImGui::Checkbox("Frustum culling", &enableCulling);
+                    modelSorter.SetEnableCulling(enableCulling);
+                    auto& statistics = modelSorter.GetStatistics();
+                    ImGui::Text("Tested : %zu", statistics.numTested);
+                    ImGui::Text("Culled : %zu", statistics.numCulled);
+                    ImGui::Text("Drawn  : %zu / %zu", modelSorter.GetVisibleModels().size(), modelSorter.GetDrawModels().size());
+                    ImGui::EndMenu();
+                }
                 bool pathtracing = !sceneView_->SetUseMainImage();
                 ImGui::Checkbox("Pathtracing", &pathtracing);
                 sceneView_->SetUseMainImage(!pathtracing);
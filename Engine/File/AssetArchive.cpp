@@ -0,0 +1,271 @@
+#include "AssetArchive.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <string_view>
+
+#include "ContentHash.h"
+#include "LZ4.h"
+
+namespace {
+    using namespace LIEngine;
+
+    const uint32_t kArchiveMagic = 0x4B50494C; // "LIPK"
+    const uint32_t kArchiveVersion = 1;
+    // 圧縮してもこれより縮まなければそのまま入れる
+    const double kMinCompressionRatio = 0.9;
+
+    struct ArchiveHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t numEntries;
+        uint64_t tocOffset;
+        uint64_t stringsOffset;
+        uint64_t stringsSize;
+    };
+
+    uint64_t HashPath(std::string_view path) {
+        return ContentHash::Compute(path.data(), path.size());
+    }
+
+    // チャンクごとに圧縮する
+    // 先頭にチャンクごとの圧縮後のサイズを並べ、縮まなかったチャンクはそのまま入れる
+    bool CompressChunks(const uint8_t* data, size_t size, uint32_t chunkSize, std::vector<uint8_t>& compressed) {
+        size_t numChunks = (size + chunkSize - 1) / chunkSize;
+        compressed.assign(numChunks * sizeof(uint32_t), 0);
+        std::vector<uint8_t> chunk(LZ4::CompressBound(chunkSize));
+        for (size_t i = 0; i < numChunks; ++i) {
+            size_t begin = i * chunkSize;
+            size_t originalSize = std::min<size_t>(chunkSize, size - begin);
+            size_t compressedSize = LZ4::Compress(data + begin, originalSize, chunk.data(), chunk.size());
+            uint32_t storedSize = 0;
+            if (compressedSize > 0 && compressedSize < originalSize) {
+                storedSize = static_cast<uint32_t>(compressedSize);
+                compressed.insert(compressed.end(), chunk.data(), chunk.data() + compressedSize);
+            }
+            else {
+                storedSize = static_cast<uint32_t>(originalSize);
+                compressed.insert(compressed.end(), data + begin, data + begin + originalSize);
+            }
+            std::memcpy(compressed.data() + i * sizeof(uint32_t), &storedSize, sizeof(storedSize));
+        }
+        return compressed.size() < size_t(double(size) * kMinCompressionRatio);
+    }
+
+}
+
+namespace LIEngine {
+
+    bool AssetArchive::Build(const std::filesystem::path& directory, const std::filesystem::path& archivePath, const BuildOptions& options) {
+        assert(options.alignment > 0 && options.chunkSize > 0);
+
+        std::error_code errorCode;
+        std::vector<std::filesystem::path> files;
+        for (auto& directoryEntry : std::filesystem::recursive_directory_iterator(directory, errorCode)) {
+            if (directoryEntry.is_regular_file()) {
+                files.emplace_back(directoryEntry.path());
+            }
+        }
+        if (errorCode) {
+            return false;
+        }
+        // 同じ中身なら同じアーカイブになるように
+        std::sort(files.begin(), files.end());
+
+        std::filesystem::path tempPath = archivePath;
+        tempPath += ".tmp";
+        std::ofstream output(tempPath, std::ios::binary | std::ios::trunc);
+        if (!output) {
+            return false;
+        }
+        uint64_t offset = 0;
+        auto Write = [&](const void* data, size_t size) {
+            output.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+            offset += size;
+            };
+        auto Pad = [&](size_t alignment) {
+            static const char kZeros[256] = {};
+            size_t padding = (alignment - offset % alignment) % alignment;
+            for (; padding > 0; padding -= std::min(padding, sizeof(kZeros))) {
+                Write(kZeros, std::min(padding, sizeof(kZeros)));
+            }
+            };
+
+        ArchiveHeader header{};
+        Write(&header, sizeof(header));
+
+        std::vector<Entry> entries;
+        std::string strings;
+        std::vector<uint8_t> compressed;
+        for (auto& file : files) {
+            // 書き出し先がディレクトリ内にある場合
+            if (NormalizePath(file) == NormalizePath(archivePath) || NormalizePath(file) == NormalizePath(tempPath)) {
+                continue;
+            }
+            MappedFile source;
+            if (!source.Open(file)) {
+                output.close();
+                std::filesystem::remove(tempPath, errorCode);
+                return false;
+            }
+            std::string path = NormalizePath(file);
+
+            Entry entry{};
+            entry.pathHash = HashPath(path);
+            entry.contentHash = ContentHash::Compute(source.GetData(), source.GetSize());
+            entry.size = source.GetSize();
+            entry.pathOffset = static_cast<uint32_t>(strings.size());
+            entry.pathLength = static_cast<uint32_t>(path.size());
+            strings += path;
+
+            const uint8_t* stored = source.GetData();
+            entry.storedSize = entry.size;
+            if (options.compress && entry.size > 0 && CompressChunks(source.GetData(), source.GetSize(), options.chunkSize, compressed)) {
+                stored = compressed.data();
+                entry.storedSize = compressed.size();
+                entry.chunkSize = options.chunkSize;
+            }
+
+            Pad(options.alignment);
+            entry.offset = offset;
+            Write(stored, static_cast<size_t>(entry.storedSize));
+            entries.emplace_back(entry);
+        }
+
+        // 目次はパスのハッシュ順
+        std::sort(entries.begin(), entries.end(), [&](const Entry& a, const Entry& b) {
+            if (a.pathHash != b.pathHash) { return a.pathHash < b.pathHash; }
+            return strings.compare(a.pathOffset, a.pathLength, strings, b.pathOffset, b.pathLength) < 0;
+            });
+        Pad(alignof(Entry));
+        header.magic = kArchiveMagic;
+        header.version = kArchiveVersion;
+        header.numEntries = entries.size();
+        header.tocOffset = offset;
+        Write(entries.data(), entries.size() * sizeof(Entry));
+        header.stringsOffset = offset;
+        header.stringsSize = strings.size();
+        Write(strings.data(), strings.size());
+
+        output.seekp(0);
+        output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        output.close();
+        if (!output) {
+            std::filesystem::remove(tempPath, errorCode);
+            return false;
+        }
+        std::filesystem::rename(tempPath, archivePath, errorCode);
+        if (errorCode) {
+            std::filesystem::remove(tempPath, errorCode);
+            return false;
+        }
+        return true;
+    }
+
+    std::string AssetArchive::NormalizePath(const std::filesystem::path& path) {
+        std::string result = path.lexically_normal().generic_string();
+        // Windowsと同じく大文字小文字を区別しない
+        for (auto& c : result) {
+            if (c >= 'A' && c <= 'Z') { c = static_cast<char>(c - 'A' + 'a'); }
+        }
+        return result;
+    }
+
+    bool AssetArchive::Open(const std::filesystem::path& archivePath) {
+        entries_ = nullptr;
+        numEntries_ = 0;
+        strings_ = nullptr;
+        stringsSize_ = 0;
+        if (!file_.Open(archivePath)) {
+            return false;
+        }
+        path_ = archivePath;
+
+        size_t fileSize = file_.GetSize();
+        if (fileSize < sizeof(ArchiveHeader)) {
+            return false;
+        }
+        ArchiveHeader header;
+        std::memcpy(&header, file_.GetData(), sizeof(header));
+        if (header.magic != kArchiveMagic ||
+            header.version != kArchiveVersion ||
+            header.tocOffset % alignof(Entry) != 0 ||
+            header.tocOffset > fileSize ||
+            header.numEntries > (fileSize - header.tocOffset) / sizeof(Entry) ||
+            header.stringsOffset > fileSize ||
+            header.stringsSize > fileSize - header.stringsOffset) {
+            return false;
+        }
+        const Entry* entries = reinterpret_cast<const Entry*>(file_.GetData() + header.tocOffset);
+        // 壊れた目次で範囲外を読まないよう、開くときに一度だけ確かめる
+        for (size_t i = 0; i < header.numEntries; ++i) {
+            const Entry& entry = entries[i];
+            if (entry.offset > fileSize || entry.storedSize > fileSize - entry.offset ||
+                uint64_t(entry.pathOffset) + entry.pathLength > header.stringsSize) {
+                return false;
+            }
+        }
+        entries_ = entries;
+        numEntries_ = static_cast<size_t>(header.numEntries);
+        strings_ = reinterpret_cast<const char*>(file_.GetData() + header.stringsOffset);
+        stringsSize_ = static_cast<size_t>(header.stringsSize);
+        return true;
+    }
+
+    const AssetArchive::Entry* AssetArchive::Find(const std::string& normalizedPath) const {
+        uint64_t pathHash = HashPath(normalizedPath);
+        const Entry* end = entries_ + numEntries_;
+        const Entry* entry = std::lower_bound(entries_, end, pathHash, [](const Entry& a, uint64_t hash) { return a.pathHash < hash; });
+        for (; entry != end && entry->pathHash == pathHash; ++entry) {
+            if (std::string_view(strings_ + entry->pathOffset, entry->pathLength) == normalizedPath) {
+                return entry;
+            }
+        }
+        return nullptr;
+    }
+
+    bool AssetArchive::Read(const Entry& entry, FileData& fileData) const {
+        const uint8_t* stored = file_.GetData() + entry.offset;
+        if (entry.chunkSize == 0) {
+            if (entry.storedSize != entry.size) {
+                return false;
+            }
+            // マップしたメモリをそのまま指す
+            fileData = FileData(shared_from_this(), stored, static_cast<size_t>(entry.size));
+            return true;
+        }
+
+        size_t size = static_cast<size_t>(entry.size);
+        size_t numChunks = (size + entry.chunkSize - 1) / entry.chunkSize;
+        if (entry.storedSize < numChunks * sizeof(uint32_t)) {
+            return false;
+        }
+        auto buffer = std::make_shared<std::vector<uint8_t>>(size);
+        const uint8_t* chunk = stored + numChunks * sizeof(uint32_t);
+        size_t remaining = static_cast<size_t>(entry.storedSize) - numChunks * sizeof(uint32_t);
+        for (size_t i = 0; i < numChunks; ++i) {
+            uint32_t storedSize = 0;
+            std::memcpy(&storedSize, stored + i * sizeof(uint32_t), sizeof(storedSize));
+            size_t begin = i * entry.chunkSize;
+            size_t originalSize = std::min<size_t>(entry.chunkSize, size - begin);
+            if (storedSize > remaining || storedSize > originalSize) {
+                return false;
+            }
+            // 縮まなかったチャンクはそのまま
+            if (storedSize == originalSize) {
+                std::memcpy(buffer->data() + begin, chunk, originalSize);
+            }
+            else if (!LZ4::Decompress(chunk, storedSize, buffer->data() + begin, originalSize)) {
+                return false;
+            }
+            chunk += storedSize;
+            remaining -= storedSize;
+        }
+        const uint8_t* data = buffer->data();
+        fileData = FileData(std::move(buffer), data, size);
+        return true;
+    }
+
+}
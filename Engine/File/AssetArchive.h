@@ -0,0 +1,112 @@
+///
+/// アセットをまとめたアーカイブ
+///
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "MappedFile.h"
+
+namespace LIEngine {
+
+    /// <summary>
+    /// 読み込んだファイルの中身
+    /// アーカイブ内の圧縮していないものはマップしたメモリをそのまま指し、コピーしない
+    /// </summary>
+    class FileData {
+    public:
+        FileData() = default;
+        FileData(std::shared_ptr<const void> owner, const uint8_t* data, size_t size) : owner_(std::move(owner)), data_(data), size_(size) {}
+
+        bool IsValid() const { return owner_ != nullptr; }
+        const uint8_t* GetData() const { return data_; }
+        size_t GetSize() const { return size_; }
+
+    private:
+        // 中身を持っているもの (アーカイブ、マップしたファイル、展開したバッファ)
+        std::shared_ptr<const void> owner_;
+        const uint8_t* data_ = nullptr;
+        size_t size_ = 0;
+    };
+
+    /// <summary>
+    /// 多数の小さなファイルを1つにまとめたもの
+    /// 目次はパスのハッシュで並べてあり二分探索で引く
+    /// 各ファイルの先頭はそろえてあり、圧縮したものはチャンクごとにLZ4で展開する
+    /// </summary>
+    class AssetArchive :
+        public std::enable_shared_from_this<AssetArchive> {
+    public:
+        struct BuildOptions {
+            // 各ファイルの先頭をそろえる
+            uint32_t alignment = 16;
+            // LZ4で圧縮する (縮まないものはそのまま入れる)
+            bool compress = true;
+            // 圧縮する単位
+            uint32_t chunkSize = 64 * 1024;
+        };
+
+        struct Entry {
+            uint64_t pathHash;
+            // 元のファイルの中身のハッシュ (派生データのキャッシュの確認用)
+            uint64_t contentHash;
+            uint64_t offset;
+            uint64_t storedSize;
+            uint64_t size;
+            uint32_t pathOffset;
+            uint32_t pathLength;
+            // 0なら圧縮なし
+            uint32_t chunkSize;
+            uint32_t reserved;
+        };
+
+        /// <summary>
+        /// ディレクトリ以下のファイルをまとめる
+        /// アーカイブ内のパスは "directory/相対パス" になる
+        /// </summary>
+        /// <returns>書き出せなければfalse</returns>
+        static bool Build(const std::filesystem::path& directory, const std::filesystem::path& archivePath, const BuildOptions& options);
+        static bool Build(const std::filesystem::path& directory, const std::filesystem::path& archivePath) { return Build(directory, archivePath, BuildOptions()); }
+        /// <summary>
+        /// アーカイブ内のパスの形にそろえる (正規化、区切りは/、小文字)
+        /// </summary>
+        static std::string NormalizePath(const std::filesystem::path& path);
+
+        /// <summary>
+        /// 開く
+        /// </summary>
+        /// <returns>アーカイブでなければfalse</returns>
+        bool Open(const std::filesystem::path& archivePath);
+
+        /// <summary>
+        /// 探す
+        /// </summary>
+        /// <param name="normalizedPath">NormalizePath済みのパス</param>
+        /// <returns>なければnullptr</returns>
+        const Entry* Find(const std::string& normalizedPath) const;
+        /// <summary>
+        /// 読み込む
+        /// 圧縮したものは展開し、他はコピーせずにマップしたメモリを指す
+        /// </summary>
+        /// <returns>壊れていればfalse</returns>
+        bool Read(const Entry& entry, FileData& fileData) const;
+
+        const std::filesystem::path& GetPath() const { return path_; }
+        size_t GetNumEntries() const { return numEntries_; }
+
+    private:
+        std::filesystem::path path_;
+        MappedFile file_;
+        const Entry* entries_ = nullptr;
+        size_t numEntries_ = 0;
+        const char* strings_ = nullptr;
+        size_t stringsSize_ = 0;
+    };
+
+}
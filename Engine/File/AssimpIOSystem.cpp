@@ -0,0 +1,78 @@
+#include "AssimpIOSystem.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+#include <assimp/IOStream.hpp>
+
+#include "VirtualFileSystem.h"
+
+namespace {
+    using namespace LIEngine;
+
+    // 読み込んだ中身を読むだけのストリーム
+    class FileDataIOStream :
+        public Assimp::IOStream {
+    public:
+        explicit FileDataIOStream(FileData&& fileData) : fileData_(std::move(fileData)) {}
+
+        size_t Read(void* buffer, size_t size, size_t count) override {
+            if (size == 0) { return 0; }
+            size_t numElements = std::min(count, (fileData_.GetSize() - position_) / size);
+            std::memcpy(buffer, fileData_.GetData() + position_, numElements * size);
+            position_ += numElements * size;
+            return numElements;
+        }
+        size_t Write(const void*, size_t, size_t) override { return 0; }
+        aiReturn Seek(size_t offset, aiOrigin origin) override {
+            size_t size = fileData_.GetSize();
+            // Assimp::MemoryIOStreamと同じく、ENDは末尾から戻る距離
+            if (origin == aiOrigin_END) {
+                if (offset > size) {
+                    return aiReturn_FAILURE;
+                }
+                position_ = size - offset;
+                return aiReturn_SUCCESS;
+            }
+            size_t base = origin == aiOrigin_SET ? 0 : position_;
+            if (offset > size - base) {
+                return aiReturn_FAILURE;
+            }
+            position_ = base + offset;
+            return aiReturn_SUCCESS;
+        }
+        size_t Tell() const override { return position_; }
+        size_t FileSize() const override { return fileData_.GetSize(); }
+        void Flush() override {}
+
+    private:
+        FileData fileData_;
+        size_t position_ = 0;
+    };
+
+}
+
+namespace LIEngine {
+
+    bool AssimpIOSystem::Exists(const char* file) const {
+        return VirtualFileSystem::Exists(file);
+    }
+
+    Assimp::IOStream* AssimpIOSystem::Open(const char* file, const char* mode) {
+        // 書き込みはしない
+        if (std::string_view(mode).find_first_of("wa+") != std::string_view::npos) {
+            return nullptr;
+        }
+        FileData fileData;
+        if (!VirtualFileSystem::ReadFile(file, fileData)) {
+            return nullptr;
+        }
+        return new FileDataIOStream(std::move(fileData));
+    }
+
+    void AssimpIOSystem::Close(Assimp::IOStream* stream) {
+        delete stream;
+    }
+
+}
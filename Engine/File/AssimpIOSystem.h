@@ -0,0 +1,24 @@
+///
+/// Assimpの読み込みをVirtualFileSystem経由にする
+///
+
+#pragma once
+
+#include <assimp/IOSystem.hpp>
+
+namespace LIEngine {
+
+    /// <summary>
+    /// Assimp::Importer::SetIOHandlerに渡す (Importerが破棄する)
+    /// gltfのバッファなど、モデルから参照するファイルもアーカイブから読む
+    /// </summary>
+    class AssimpIOSystem :
+        public Assimp::IOSystem {
+    public:
+        bool Exists(const char* file) const override;
+        char getOsSeparator() const override { return '/'; }
+        Assimp::IOStream* Open(const char* file, const char* mode) override;
+        void Close(Assimp::IOStream* stream) override;
+    };
+
+}
@@ -0,0 +1,84 @@
+#include "BinaryStream.h"
+
+#include <fstream>
+#include <functional>
+#include <thread>
+
+namespace LIEngine {
+
+    void BinaryWriter::WriteBytes(const void* data, size_t size) {
+        if (size == 0) {
+            return;
+        }
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        buffer_.insert(buffer_.end(), bytes, bytes + size);
+    }
+
+    void BinaryWriter::WriteString(const std::string& str) {
+        Write<uint32_t>(static_cast<uint32_t>(str.size()));
+        WriteBytes(str.data(), str.size());
+    }
+
+    void BinaryWriter::Align(size_t alignment) {
+        size_t padding = (alignment - buffer_.size() % alignment) % alignment;
+        buffer_.resize(buffer_.size() + padding, 0);
+    }
+
+    bool BinaryWriter::SaveFile(const std::filesystem::path& path) const {
+        std::error_code errorCode;
+        if (path.has_parent_path()) {
+            std::filesystem::create_directories(path.parent_path(), errorCode);
+        }
+        // 同じファイルを複数のスレッドが書き出しても混ざらないよう、一時ファイルはスレッドごとに分ける
+        std::filesystem::path tempPath = path;
+        tempPath += ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!file) {
+                return false;
+            }
+            file.write(reinterpret_cast<const char*>(buffer_.data()), static_cast<std::streamsize>(buffer_.size()));
+            if (!file) {
+                file.close();
+                std::filesystem::remove(tempPath, errorCode);
+                return false;
+            }
+        }
+        // 読み込み中で置き換えられなければ、今あるものを使ってもらう
+        std::filesystem::rename(tempPath, path, errorCode);
+        if (errorCode) {
+            std::filesystem::remove(tempPath, errorCode);
+            return false;
+        }
+        return true;
+    }
+
+    const void* BinaryReader::ReadBytes(size_t size) {
+        if (!isValid_ || size > size_ - offset_) {
+            isValid_ = false;
+            return nullptr;
+        }
+        const void* result = data_ + offset_;
+        offset_ += size;
+        return result;
+    }
+
+    std::string BinaryReader::ReadString() {
+        uint32_t length = Read<uint32_t>();
+        const char* str = static_cast<const char*>(ReadBytes(length));
+        return str ? std::string(str, length) : std::string();
+    }
+
+    void BinaryReader::Align(size_t alignment) {
+        Seek(offset_ + (alignment - offset_ % alignment) % alignment);
+    }
+
+    void BinaryReader::Seek(size_t offset) {
+        if (offset > size_) {
+            isValid_ = false;
+            return;
+        }
+        offset_ = offset;
+    }
+
+}
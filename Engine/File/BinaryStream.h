@@ -0,0 +1,111 @@
+///
+/// キャッシュ用のバイナリの読み書き
+///
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace LIEngine {
+
+    /// <summary>
+    /// メモリ上にバイナリを組み立てて、最後にファイルに書き出す
+    /// </summary>
+    class BinaryWriter {
+    public:
+        template<class T>
+        void Write(const T& value) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            WriteBytes(&value, sizeof(T));
+        }
+        void WriteBytes(const void* data, size_t size);
+        // 長さ(uint32_t)と文字列
+        void WriteString(const std::string& str);
+        // 要素数(uint64_t)と中身
+        template<class T>
+        void WriteArray(const std::vector<T>& values) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            Write<uint64_t>(values.size());
+            WriteBytes(values.data(), values.size() * sizeof(T));
+        }
+        // 0で埋めてalignmentの倍数の位置に進める
+        void Align(size_t alignment);
+        // 書き込み済みの場所を書き換える (ヘッダーの後埋め用)
+        template<class T>
+        void Overwrite(size_t offset, const T& value) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            assert(offset + sizeof(T) <= buffer_.size());
+            std::memcpy(buffer_.data() + offset, &value, sizeof(T));
+        }
+
+        /// <summary>
+        /// ファイルに書き出す
+        /// 一時ファイルに書いてから置き換えるので、読み込み中に途中までのファイルが見えることはない
+        /// </summary>
+        /// <returns>書き出せなければfalse</returns>
+        bool SaveFile(const std::filesystem::path& path) const;
+
+        size_t GetSize() const { return buffer_.size(); }
+        const std::vector<uint8_t>& GetBuffer() const { return buffer_; }
+
+    private:
+        std::vector<uint8_t> buffer_;
+    };
+
+    /// <summary>
+    /// メモリ上のバイナリを先頭から読む
+    /// 壊れたキャッシュで止まらないよう、範囲外を読むとIsValidがfalseになり以降は0を返す
+    /// </summary>
+    class BinaryReader {
+    public:
+        BinaryReader(const void* data, size_t size) : data_(static_cast<const uint8_t*>(data)), size_(size) {}
+
+        template<class T>
+        T Read() {
+            static_assert(std::is_trivially_copyable_v<T>);
+            T value{};
+            if (const void* src = ReadBytes(sizeof(T))) {
+                std::memcpy(&value, src, sizeof(T));
+            }
+            return value;
+        }
+        // 中身をコピーせずにポインタを返す
+        // 範囲外ならnullptr
+        const void* ReadBytes(size_t size);
+        std::string ReadString();
+        template<class T>
+        std::vector<T> ReadArray() {
+            static_assert(std::is_trivially_copyable_v<T>);
+            uint64_t count = Read<uint64_t>();
+            if (count > (size_ - offset_) / sizeof(T)) {
+                isValid_ = false;
+                return {};
+            }
+            std::vector<T> values(static_cast<size_t>(count));
+            if (const void* src = ReadBytes(values.size() * sizeof(T))) {
+                std::memcpy(values.data(), src, values.size() * sizeof(T));
+            }
+            return values;
+        }
+        void Align(size_t alignment);
+        void Seek(size_t offset);
+
+        bool IsValid() const { return isValid_; }
+        size_t GetOffset() const { return offset_; }
+        // 残りのバイト数 (要素数を信じて確保する前に確かめる)
+        size_t GetRemainingSize() const { return size_ - offset_; }
+
+    private:
+        const uint8_t* data_;
+        size_t size_;
+        size_t offset_ = 0;
+        bool isValid_ = true;
+    };
+
+}
@@ -0,0 +1,74 @@
+#include "ContentHash.h"
+
+#include <cstring>
+
+#include "MappedFile.h"
+
+namespace {
+
+    // MurmurHash64Aと同じ定数
+    const uint64_t kMultiplier = 0xc6a4a7935bd1e995ull;
+    const int kShift = 47;
+
+}
+
+namespace LIEngine {
+
+    namespace ContentHash {
+
+        uint64_t Compute(const void* data, size_t size, uint64_t seed) {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            uint64_t hash = seed ^ (size * kMultiplier);
+
+            // 8バイトずつ混ぜる
+            size_t numBlocks = size / sizeof(uint64_t);
+            for (size_t i = 0; i < numBlocks; ++i) {
+                uint64_t block;
+                std::memcpy(&block, bytes + i * sizeof(uint64_t), sizeof(block));
+                block *= kMultiplier;
+                block ^= block >> kShift;
+                block *= kMultiplier;
+                hash ^= block;
+                hash *= kMultiplier;
+            }
+
+            // 残り
+            const uint8_t* tail = bytes + numBlocks * sizeof(uint64_t);
+            size_t tailSize = size & (sizeof(uint64_t) - 1);
+            if (tailSize > 0) {
+                uint64_t block = 0;
+                std::memcpy(&block, tail, tailSize);
+                hash ^= block;
+                hash *= kMultiplier;
+            }
+
+            hash ^= hash >> kShift;
+            hash *= kMultiplier;
+            hash ^= hash >> kShift;
+            return hash;
+        }
+
+        uint64_t ComputeFile(const std::filesystem::path& path, uint64_t seed) {
+            MappedFile file;
+            if (!file.Open(path)) {
+                return 0;
+            }
+            return Compute(file.GetData(), file.GetSize(), seed);
+        }
+
+        uint64_t Combine(uint64_t hash, uint64_t value) {
+            return Compute(&value, sizeof(value), hash);
+        }
+
+        std::string ToString(uint64_t hash) {
+            const char kDigits[] = "0123456789abcdef";
+            std::string result(16, '0');
+            for (size_t i = 0; i < 16; ++i) {
+                result[15 - i] = kDigits[(hash >> (i * 4)) & 0xF];
+            }
+            return result;
+        }
+
+    }
+
+}
@@ -0,0 +1,34 @@
+///
+/// ファイルの中身のハッシュ
+///
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace LIEngine {
+
+    namespace ContentHash {
+        /// <summary>
+        /// バイト列の64bitハッシュ
+        /// 暗号用ではない、キャッシュの無効化用
+        /// </summary>
+        uint64_t Compute(const void* data, size_t size, uint64_t seed = 0);
+        /// <summary>
+        /// ファイルの中身のハッシュ
+        /// </summary>
+        /// <returns>開けなければ0</returns>
+        uint64_t ComputeFile(const std::filesystem::path& path, uint64_t seed = 0);
+        /// <summary>
+        /// 2つのハッシュを混ぜる
+        /// </summary>
+        uint64_t Combine(uint64_t hash, uint64_t value);
+        /// <summary>
+        /// 16桁の16進数にする (キャッシュのファイル名用)
+        /// </summary>
+        std::string ToString(uint64_t hash);
+    }
+
+}
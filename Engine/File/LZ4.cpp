@@ -0,0 +1,205 @@
+#include "LZ4.h"
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+    // 形式で決まっている値
+    const size_t kMinMatch = 4;
+    // 最後の5バイトは必ずリテラル
+    const size_t kLastLiterals = 5;
+    // 一致はブロックの終わりの12バイトより前から始める
+    const size_t kMatchFindLimit = 12;
+    const size_t kMaxOffset = 65535;
+    const uint32_t kRunMask = 15;
+
+    const uint32_t kHashBits = 16;
+    // 一致が見つからない間は進む幅を広げる (圧縮できないデータを速く通り過ぎる)
+    const uint32_t kSkipTrigger = 6;
+    // 展開時、この分の余裕が出力と入力にあれば境界を気にせずまとめてコピーする
+    const size_t kWildCopyLength = 16;
+
+    uint32_t Read32(const uint8_t* p) {
+        uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    uint64_t Read64(const uint8_t* p) {
+        uint64_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    uint32_t Hash(uint32_t sequence) {
+        return (sequence * 2654435761u) >> (32 - kHashBits);
+    }
+
+    // 一致する長さ (8バイトずつ比べる)
+    size_t CountMatch(const uint8_t* ip, const uint8_t* match, const uint8_t* limit) {
+        const uint8_t* start = ip;
+        while (ip + sizeof(uint64_t) <= limit) {
+            uint64_t diff = Read64(ip) ^ Read64(match);
+            if (diff != 0) {
+                return size_t(ip - start) + std::countr_zero(diff) / 8;
+            }
+            ip += sizeof(uint64_t);
+            match += sizeof(uint64_t);
+        }
+        while (ip < limit && *ip == *match) {
+            ++ip;
+            ++match;
+        }
+        return size_t(ip - start);
+    }
+
+    // 15以上の長さの続き
+    bool WriteLength(uint8_t*& op, const uint8_t* oend, size_t length) {
+        for (; length >= 255; length -= 255) {
+            if (op >= oend) { return false; }
+            *op++ = 255;
+        }
+        if (op >= oend) { return false; }
+        *op++ = static_cast<uint8_t>(length);
+        return true;
+    }
+
+    bool ReadLength(const uint8_t*& ip, const uint8_t* iend, size_t& length) {
+        uint8_t value = 0;
+        do {
+            if (ip >= iend) { return false; }
+            value = *ip++;
+            length += value;
+        } while (value == 255);
+        return true;
+    }
+
+    // リテラルと一致を1組書く (一致の長さが0なら最後の組)
+    bool WriteSequence(uint8_t*& op, const uint8_t* oend, const uint8_t* literals, size_t numLiterals, size_t offset, size_t matchLength) {
+        if (op >= oend) { return false; }
+        uint8_t* token = op++;
+        *token = static_cast<uint8_t>((numLiterals >= kRunMask ? kRunMask : numLiterals) << 4);
+        if (numLiterals >= kRunMask && !WriteLength(op, oend, numLiterals - kRunMask)) { return false; }
+        if (numLiterals > size_t(oend - op)) { return false; }
+        std::memcpy(op, literals, numLiterals);
+        op += numLiterals;
+        if (matchLength == 0) { return true; }
+
+        if (oend - op < 2) { return false; }
+        *op++ = static_cast<uint8_t>(offset & 0xFF);
+        *op++ = static_cast<uint8_t>(offset >> 8);
+        size_t length = matchLength - kMinMatch;
+        *token |= static_cast<uint8_t>(length >= kRunMask ? kRunMask : length);
+        return length < kRunMask || WriteLength(op, oend, length - kRunMask);
+    }
+
+}
+
+namespace LIEngine {
+
+    namespace LZ4 {
+
+        size_t CompressBound(size_t srcSize) {
+            return srcSize + srcSize / 255 + 16;
+        }
+
+        size_t Compress(const void* src, size_t srcSize, void* dst, size_t dstCapacity) {
+            const uint8_t* base = static_cast<const uint8_t*>(src);
+            const uint8_t* ip = base;
+            const uint8_t* anchor = base;
+            const uint8_t* iend = base + srcSize;
+            uint8_t* op = static_cast<uint8_t*>(dst);
+            uint8_t* oend = op + dstCapacity;
+
+            if (srcSize > kMatchFindLimit) {
+                const uint8_t* matchLimit = iend - kLastLiterals;
+                const uint8_t* findLimit = iend - kMatchFindLimit;
+                // 4バイトのハッシュから最後に出てきた位置
+                // 呼ぶたびに確保しないようスレッドごとに使いまわす
+                thread_local std::vector<uint32_t> table;
+                table.assign(size_t(1) << kHashBits, UINT32_MAX);
+
+                uint32_t numMisses = 1 << kSkipTrigger;
+                while (ip < findLimit) {
+                    uint32_t sequence = Read32(ip);
+                    uint32_t& entry = table[Hash(sequence)];
+                    const uint8_t* match = entry == UINT32_MAX ? nullptr : base + entry;
+                    entry = static_cast<uint32_t>(ip - base);
+                    if (!match || size_t(ip - match) > kMaxOffset || Read32(match) != sequence) {
+                        ip += numMisses++ >> kSkipTrigger;
+                        continue;
+                    }
+                    numMisses = 1 << kSkipTrigger;
+
+                    size_t matchLength = kMinMatch + CountMatch(ip + kMinMatch, match + kMinMatch, matchLimit);
+                    if (!WriteSequence(op, oend, anchor, size_t(ip - anchor), size_t(ip - match), matchLength)) {
+                        return 0;
+                    }
+                    ip += matchLength;
+                    anchor = ip;
+                }
+            }
+
+            if (!WriteSequence(op, oend, anchor, size_t(iend - anchor), 0, 0)) {
+                return 0;
+            }
+            return size_t(op - static_cast<uint8_t*>(dst));
+        }
+
+        bool Decompress(const void* src, size_t srcSize, void* dst, size_t dstSize) {
+            const uint8_t* ip = static_cast<const uint8_t*>(src);
+            const uint8_t* iend = ip + srcSize;
+            uint8_t* const obegin = static_cast<uint8_t*>(dst);
+            uint8_t* op = obegin;
+            uint8_t* const oend = op + dstSize;
+
+            while (ip < iend) {
+                uint32_t token = *ip++;
+
+                size_t numLiterals = token >> 4;
+                if (numLiterals == kRunMask && !ReadLength(ip, iend, numLiterals)) { return false; }
+                if (numLiterals > size_t(iend - ip) || numLiterals > size_t(oend - op)) { return false; }
+                // 短いリテラルは余裕があれば長さを気にせず16バイトコピー
+                if (numLiterals <= kWildCopyLength && size_t(iend - ip) >= kWildCopyLength && size_t(oend - op) >= kWildCopyLength) {
+                    std::memcpy(op, ip, kWildCopyLength);
+                }
+                else {
+                    std::memcpy(op, ip, numLiterals);
+                }
+                ip += numLiterals;
+                op += numLiterals;
+                // 最後の組は一致を持たない
+                if (ip == iend) { break; }
+
+                if (iend - ip < 2) { return false; }
+                size_t offset = size_t(ip[0]) | size_t(ip[1]) << 8;
+                ip += 2;
+                if (offset == 0 || offset > size_t(op - obegin)) { return false; }
+
+                size_t matchLength = token & kRunMask;
+                if (matchLength == kRunMask && !ReadLength(ip, iend, matchLength)) { return false; }
+                matchLength += kMinMatch;
+                if (matchLength > size_t(oend - op)) { return false; }
+                const uint8_t* match = op - offset;
+                uint8_t* matchEnd = op + matchLength;
+                // 8バイト以上離れていれば8バイトずつコピーしても読む前に上書きしない
+                if (offset >= sizeof(uint64_t) && size_t(oend - matchEnd) >= sizeof(uint64_t)) {
+                    for (; op < matchEnd; op += sizeof(uint64_t), match += sizeof(uint64_t)) {
+                        std::memcpy(op, match, sizeof(uint64_t));
+                    }
+                    op = matchEnd;
+                }
+                else {
+                    // 重なっていることがあるので1バイトずつ
+                    for (; op < matchEnd; ++op, ++match) { *op = *match; }
+                }
+            }
+            return op == oend;
+        }
+
+    }
+
+}
@@ -0,0 +1,33 @@
+///
+/// LZ4ブロック形式の圧縮と展開
+///
+
+#pragma once
+
+#include <cstddef>
+
+namespace LIEngine {
+
+    /// <summary>
+    /// LZ4のブロック形式 (フレームヘッダー無し) と互換
+    /// 圧縮は貪欲法のみで圧縮率より速さ優先、展開は壊れた入力でも範囲外を読み書きしない
+    /// </summary>
+    namespace LZ4 {
+        /// <summary>
+        /// 圧縮後の最大サイズ
+        /// </summary>
+        size_t CompressBound(size_t srcSize);
+        /// <summary>
+        /// 圧縮
+        /// </summary>
+        /// <returns>圧縮後のサイズ、dstに収まらなければ0</returns>
+        size_t Compress(const void* src, size_t srcSize, void* dst, size_t dstCapacity);
+        /// <summary>
+        /// 展開
+        /// </summary>
+        /// <param name="dstSize">展開後のサイズ (ちょうど)</param>
+        /// <returns>壊れていればfalse</returns>
+        bool Decompress(const void* src, size_t srcSize, void* dst, size_t dstSize);
+    }
+
+}
@@ -0,0 +1,47 @@
+///
+/// 読み込み専用のメモリマップドファイル
+///
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+namespace LIEngine {
+
+    /// <summary>
+    /// ファイル全体を読み込み専用でメモリにマップする
+    /// 読み込むページはOSが必要になった時に読むので、中身をコピーせずにそのまま使える
+    /// </summary>
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        ~MappedFile() { Close(); }
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        /// <summary>
+        /// 開く
+        /// </summary>
+        /// <returns>開けなければfalse</returns>
+        bool Open(const std::filesystem::path& path);
+        void Close();
+
+        bool IsOpen() const { return isOpen_; }
+        // 空のファイルはnullptr
+        const uint8_t* GetData() const { return data_; }
+        size_t GetSize() const { return size_; }
+
+    private:
+        const uint8_t* data_ = nullptr;
+        size_t size_ = 0;
+        bool isOpen_ = false;
+#ifdef _WIN32
+        void* file_ = nullptr;
+        void* mapping_ = nullptr;
+#endif // _WIN32
+    };
+
+}
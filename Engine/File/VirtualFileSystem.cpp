@@ -0,0 +1,116 @@
+#include "VirtualFileSystem.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+#include "ContentHash.h"
+
+namespace {
+    using namespace LIEngine;
+
+    std::shared_mutex g_mutex;
+    // 後からマウントしたものが後ろ
+    std::vector<std::shared_ptr<AssetArchive>> g_archives;
+
+    // 探す
+    bool FindInArchives(const std::filesystem::path& path, std::shared_ptr<AssetArchive>& archive, const AssetArchive::Entry*& entry) {
+        std::shared_lock lock(g_mutex);
+        if (g_archives.empty()) {
+            return false;
+        }
+        std::string normalizedPath = AssetArchive::NormalizePath(path);
+        for (auto iter = g_archives.rbegin(); iter != g_archives.rend(); ++iter) {
+            if (const AssetArchive::Entry* found = (*iter)->Find(normalizedPath)) {
+                archive = *iter;
+                entry = found;
+                return true;
+            }
+        }
+        return false;
+    }
+
+}
+
+namespace LIEngine {
+
+    namespace VirtualFileSystem {
+
+        bool Mount(const std::filesystem::path& archivePath) {
+            auto archive = std::make_shared<AssetArchive>();
+            if (!archive->Open(archivePath)) {
+                return false;
+            }
+            std::unique_lock lock(g_mutex);
+            g_archives.emplace_back(std::move(archive));
+            return true;
+        }
+
+        void Unmount(const std::filesystem::path& archivePath) {
+            std::unique_lock lock(g_mutex);
+            // 読み込んだFileDataが残っていれば、それが無くなるまでマップは残る
+            std::erase_if(g_archives, [&](const auto& archive) { return archive->GetPath() == archivePath; });
+        }
+
+        void UnmountAll() {
+            std::unique_lock lock(g_mutex);
+            g_archives.clear();
+        }
+
+        bool Exists(const std::filesystem::path& path) {
+            FileInfo fileInfo;
+            return GetFileInfo(path, fileInfo);
+        }
+
+        bool GetFileInfo(const std::filesystem::path& path, FileInfo& fileInfo) {
+            std::shared_ptr<AssetArchive> archive;
+            const AssetArchive::Entry* entry = nullptr;
+            if (FindInArchives(path, archive, entry)) {
+                fileInfo = FileInfo();
+                fileInfo.size = entry->size;
+                fileInfo.contentHash = entry->contentHash;
+                fileInfo.isInArchive = true;
+                return true;
+            }
+
+            std::error_code errorCode;
+            if (!std::filesystem::is_regular_file(path, errorCode)) {
+                return false;
+            }
+            fileInfo = FileInfo();
+            fileInfo.size = static_cast<uint64_t>(std::filesystem::file_size(path, errorCode));
+            fileInfo.writeTime = static_cast<int64_t>(std::filesystem::last_write_time(path, errorCode).time_since_epoch().count());
+            return !errorCode;
+        }
+
+        bool ReadFile(const std::filesystem::path& path, FileData& fileData) {
+            std::shared_ptr<AssetArchive> archive;
+            const AssetArchive::Entry* entry = nullptr;
+            if (FindInArchives(path, archive, entry)) {
+                return archive->Read(*entry, fileData);
+            }
+
+            auto file = std::make_shared<MappedFile>();
+            if (!file->Open(path)) {
+                return false;
+            }
+            const uint8_t* data = file->GetData();
+            size_t size = file->GetSize();
+            fileData = FileData(std::move(file), data, size);
+            return true;
+        }
+
+        uint64_t ComputeContentHash(const std::filesystem::path& path) {
+            std::shared_ptr<AssetArchive> archive;
+            const AssetArchive::Entry* entry = nullptr;
+            if (FindInArchives(path, archive, entry)) {
+                return entry->contentHash;
+            }
+            return ContentHash::ComputeFile(path);
+        }
+
+    }
+
+}
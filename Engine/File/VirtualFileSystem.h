@@ -0,0 +1,56 @@
+///
+/// アーカイブとディスクをまとめて読むファイルシステム
+///
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+#include "AssetArchive.h"
+
+namespace LIEngine {
+
+    /// <summary>
+    /// 読み込みはマウントしたアーカイブ (後からマウントしたもの優先)、無ければディスクの順に探す
+    /// 読み込みはどのスレッドからでも並列に呼べる
+    /// </summary>
+    namespace VirtualFileSystem {
+        struct FileInfo {
+            uint64_t size = 0;
+            // ディスクのファイルのみ
+            int64_t writeTime = 0;
+            // アーカイブ内のファイルのみ (ディスクのファイルは0)
+            uint64_t contentHash = 0;
+            bool isInArchive = false;
+        };
+
+        /// <summary>
+        /// アーカイブをマウント
+        /// </summary>
+        /// <returns>開けなければfalse</returns>
+        bool Mount(const std::filesystem::path& archivePath);
+        void Unmount(const std::filesystem::path& archivePath);
+        void UnmountAll();
+
+        bool Exists(const std::filesystem::path& path);
+        /// <summary>
+        /// 読み込まずに大きさなどを取得
+        /// </summary>
+        /// <returns>無ければfalse</returns>
+        bool GetFileInfo(const std::filesystem::path& path, FileInfo& fileInfo);
+        /// <summary>
+        /// 読み込む
+        /// アーカイブ内の圧縮していないものとディスクのファイルはマップするだけでコピーしない
+        /// </summary>
+        /// <returns>無ければfalse</returns>
+        bool ReadFile(const std::filesystem::path& path, FileData& fileData);
+        /// <summary>
+        /// 中身のハッシュ
+        /// アーカイブ内のものは目次に入っているので読まない
+        /// </summary>
+        /// <returns>無ければ0</returns>
+        uint64_t ComputeContentHash(const std::filesystem::path& path);
+    }
+
+}
@@ -4,37 +4,99 @@
 #include <thread>
 
 #include "Engine.h"
+#include "AssetManager.h"
 #include "ThreadPool.h"
 #include "Graphics/ImGuiManager.h"
 
 namespace LIEngine {
 
+    std::atomic<uint64_t> Asset::currentFrame_ = 0;
+
     void Asset::Load(const std::filesystem::path& path, const std::string& name) {
         assert(!path.empty());
 
+        // 前の読み込みがパスと名前を読み終わるまで書き換えない
+        StopLoad();
+
         path_ = path;
-        // 名前が指定されていない場合はパスの拡張子を除いた名前を使用
-        SetName(name.empty() ? path.stem().string() : name);
+        // 名前が指定されていない場合は今の名前のまま (表の索引とずれないように)
+        // 名前がまだ無ければパスの拡張子を除いた名前を使用
+        if (!name.empty()) {
+            SetName(name);
+        }
+        else if (name_.empty()) {
+            SetName(path.stem().string());
+        }
+
+        StartLoad();
+    }
+
+    void Asset::Load() {
+        assert(!path_.empty());
+        StopLoad();
+        StartLoad();
+    }
+
+    void Asset::SetPath(const std::filesystem::path& path) {
+        // 読み込み中のタスクが読んでいる
+        assert(state_ != State::Loading);
+        path_ = path;
+    }
+
+    void Asset::WaitForLoad() const {
+        if (loadTask_.IsValid()) {
+            loadTask_.Wait();
+        }
+    }
+
+    void Asset::CancelLoad() {
+        if (!loadTask_.IsValid()) { return; }
+        loadTask_.Cancel();
+        // 始まる前に止まった
+        if (loadTask_.IsReady() && !loadTask_.HasResult()) {
+            state_ = State::Unloaded;
+        }
+    }
+
+    void Asset::Unload() {
+        // 読み込み中は止めない
+        if (state_ != State::Loaded) { return; }
+        state_ = State::Unloaded;
+        InternalUnload();
+        SetMemorySize(0, 0);
+    }
+
+    void Asset::StopLoad() {
+        // 読み込み中のものはキャンセルして読みなおす
+        if (loadTask_.IsValid()) {
+            CancelLoad();
+            WaitForLoad();
+        }
+    }
 
+    void Asset::StartLoad() {
         // 非同期読み込み
-        Engine::GetThreadPool()->PushTask([this]() {
-            state_ = State::Loading;
+        state_ = State::Loading;
+        Touch();
+        loadTask_ = Engine::GetThreadPool()->Submit([this]() {
+            // GPUへの転送はInternalLoadの中で終わるまで待つ
             InternalLoad();
-            // GPUが終わってない場合、この状態遷移はエラーの原因
-            // 要修正
             state_ = State::Loaded;
-            });
+            }, TaskPriority::Background);
     }
 
     void Asset::RenderInInspectorView() {
 #ifdef ENABLE_IMGUI
         if (ImGui::InputText("##Name", &editingName_, ImGuiInputTextFlags_EnterReturnsTrue)) {
-            name_ = editingName_;
+            // 表の索引も変える
+            Engine::GetAssetManager()->Rename(*this, editingName_);
         }
         std::string type[] = { "None", "Texture", "Model", "Material", "Animation", "Sound", };
         ImGui::Text("Type  : %s", type[static_cast<uint32_t>(type_)].c_str());
         std::string state[] = { "Unloaded", "Loading", "Loaded" };
-        ImGui::Text("State : %s", state[static_cast<uint32_t>(state_)].c_str());
+        ImGui::Text("State : %s", state[static_cast<uint32_t>(GetState())].c_str());
+        ImGui::Text("CPU   : %.2f MB", double(GetCPUMemorySize()) / (1024.0 * 1024.0));
+        ImGui::Text("GPU   : %.2f MB", double(GetGPUMemorySize()) / (1024.0 * 1024.0));
 #endif // ENABLE_IMGUI
     }
 
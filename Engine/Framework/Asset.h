@@ -4,15 +4,19 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <filesystem>
 
 #include "Editer/EditerInterface.h"
 #include "Graphics/ImGuiManager.h"
+#include "TaskFuture.h"
 
 namespace LIEngine {
 
+    class AssetResidency;
+
 #ifdef ENABLE_IMGUI
     struct ThumbnailData {
         ImTextureID image = nullptr;
@@ -22,6 +26,7 @@ namespace LIEngine {
 
     class Asset :
         public Editer::SelectableInEditer {
+        friend class AssetResidency;
     public:
         enum class Type {
             None,
@@ -51,10 +56,42 @@ namespace LIEngine {
 
         /// <summary>
         /// 読み込み
+        /// スレッドプールでBackgroundとして読み込むので、フレーム内の並列処理を妨げない
         /// </summary>
         /// <param name="path">ファイルのパス</param>
-        /// <param name="name">アセットの名前</param>
+        /// <param name="name">アセットの名前 (空なら今の名前のまま、名前が無ければパスの拡張子を除いた名前)</param>
         void Load(const std::filesystem::path& path, const std::string& name = "");
+        /// <summary>
+        /// GetPath()から読み込み
+        /// パスと名前を書き換えないので、表に登録済みのアセットを別のスレッドから読み込める
+        /// </summary>
+        void Load();
+        /// <summary>
+        /// 読み込みが終わるまで待つ
+        /// 始まっていなければ呼び出したスレッドで読み込む
+        /// </summary>
+        void WaitForLoad() const;
+        /// <summary>
+        /// 読み込みをキャンセル
+        /// 始まっていなければ読み込まずにUnloadedに戻る (始まっていれば最後まで読み込む)
+        /// </summary>
+        void CancelLoad();
+        /// <summary>
+        /// 読み込んだデータを解放してUnloadedに戻す
+        /// 表の名前とハンドルは残るので、Load(GetPath())で名前を変えずに読みなおせる
+        /// </summary>
+        void Unload();
+        /// <summary>
+        /// 使ったことを記録する
+        /// AssetMapから取得すると呼ばれ、AssetResidencyが古いものから追い出すのに使う
+        /// </summary>
+        void Touch() const {
+            uint64_t frame = currentFrame_.load(std::memory_order_relaxed);
+            // 同じフレームに何度も書き込まない
+            if (lastUsedFrame_.load(std::memory_order_relaxed) != frame) {
+                lastUsedFrame_.store(frame, std::memory_order_relaxed);
+            }
+        }
 
         virtual void RenderInInspectorView() override;
 
@@ -66,6 +103,12 @@ namespace LIEngine {
 #endif // ENABLE_IMGUI
         }
 
+        /// <summary>
+        /// 読み込まずにパスだけ設定する (読み込み中は変えられない)
+        /// </summary>
+        /// <param name="path">ファイルのパス</param>
+        void SetPath(const std::filesystem::path& path);
+
         // ゲッター
 
         const std::filesystem::path& GetPath() const { return path_; }
@@ -79,15 +122,41 @@ namespace LIEngine {
         /// <returns></returns>
         bool IsReady() const { return state_ == State::Loaded; }
 
+        // 読み込んだデータのメモリ使用量 (バイト)
+        size_t GetCPUMemorySize() const { return cpuMemorySize_.load(std::memory_order_relaxed); }
+        size_t GetGPUMemorySize() const { return gpuMemorySize_.load(std::memory_order_relaxed); }
+        uint64_t GetLastUsedFrame() const { return lastUsedFrame_.load(std::memory_order_relaxed); }
+
     protected:
         virtual void InternalLoad() = 0;
+        // 読み込んだデータを解放する
+        virtual void InternalUnload() {}
+        // 読み込んだデータをアセットの外から参照しているか (参照されていれば追い出さない)
+        virtual bool IsReferenced() const { return false; }
+        // 読み込んだ後にメモリ使用量を設定する
+        void SetMemorySize(size_t cpuBytes, size_t gpuBytes) {
+            cpuMemorySize_.store(cpuBytes, std::memory_order_relaxed);
+            gpuMemorySize_.store(gpuBytes, std::memory_order_relaxed);
+        }
 
         std::filesystem::path path_;
         std::string name_;
         Type type_ = Type::None;
-        State state_ = State::Unloaded;
+        std::atomic<State> state_ = State::Unloaded;
 
     private:
+        // 読み込み中のものを止めて終わるまで待つ
+        void StopLoad();
+        // path_から非同期に読み込み始める
+        void StartLoad();
+
+        // AssetResidencyがフレームごとに進める
+        static std::atomic<uint64_t> currentFrame_;
+
+        TaskFuture<void> loadTask_;
+        std::atomic<size_t> cpuMemorySize_ = 0;
+        std::atomic<size_t> gpuMemorySize_ = 0;
+        mutable std::atomic<uint64_t> lastUsedFrame_ = 0;
 #ifdef ENABLE_IMGUI
         std::string editingName_;
 #endif
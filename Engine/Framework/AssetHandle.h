@@ -0,0 +1,39 @@
+///
+/// アセットのハンドル
+///
+
+#pragma once
+
+#include <cstdint>
+
+namespace LIEngine {
+
+    template<class T>
+    class AssetMap;
+
+    /// <summary>
+    /// AssetMapに登録したアセットを指す番号
+    /// 削除されると世代が変わり、古いハンドルからは取得できなくなる
+    /// 毎フレーム使うものは名前ではなくこれを持つ
+    /// </summary>
+    template<class T>
+    class AssetHandle {
+        friend class AssetMap<T>;
+    public:
+        AssetHandle() = default;
+
+        bool IsValid() const { return generation_ != 0; }
+        explicit operator bool() const { return IsValid(); }
+
+        bool operator==(const AssetHandle& other) const { return index_ == other.index_ && generation_ == other.generation_; }
+        bool operator!=(const AssetHandle& other) const { return !(*this == other); }
+
+    private:
+        AssetHandle(uint32_t index, uint32_t generation) : index_(index), generation_(generation) {}
+
+        uint32_t index_ = 0;
+        // 0は無効
+        uint32_t generation_ = 0;
+    };
+
+}
@@ -0,0 +1,84 @@
+#include "AssetLoadGraph.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "ThreadPool.h"
+
+namespace LIEngine {
+
+    AssetLoadGraph::~AssetLoadGraph() {
+        // 実行中のタスクがグラフを触らなくなるまで
+        if (IsStarted()) {
+            Wait();
+        }
+    }
+
+    AssetLoadGraph::TaskHandle AssetLoadGraph::AddTask(const std::string& name, std::function<void()> function, std::initializer_list<TaskHandle> dependencies) {
+        assert(!IsStarted());
+        assert(function);
+        TaskHandle handle = TaskHandle(tasks_.size());
+        auto& task = tasks_.emplace_back(std::make_unique<Task>());
+        task->name = name;
+        task->function = std::move(function);
+        for (TaskHandle dependency : dependencies) {
+            AddDependency(handle, dependency);
+        }
+        return handle;
+    }
+
+    void AssetLoadGraph::AddDependency(TaskHandle task, TaskHandle dependency) {
+        assert(!IsStarted());
+        assert(task < tasks_.size());
+        // 先に追加したものにしか依存できない
+        assert(dependency < task);
+        auto& successors = tasks_[dependency]->successors;
+        if (std::find(successors.begin(), successors.end(), task) != successors.end()) {
+            return;
+        }
+        successors.emplace_back(task);
+        tasks_[task]->remainingDependencies.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void AssetLoadGraph::Start(ThreadPool& threadPool) {
+        assert(!IsStarted());
+        threadPool_ = &threadPool;
+        // 積んだタスクが終わって後続を積み始める前に、依存のないものを数えておく
+        std::vector<TaskHandle> roots;
+        for (TaskHandle handle = 0; handle < TaskHandle(tasks_.size()); ++handle) {
+            if (tasks_[handle]->remainingDependencies.load(std::memory_order_relaxed) == 0) {
+                roots.emplace_back(handle);
+            }
+        }
+        for (TaskHandle root : roots) {
+            Schedule(root);
+        }
+    }
+
+    void AssetLoadGraph::Wait() const {
+        assert(IsStarted());
+        // 読み込みはBackgroundなのでワーカーに任せ、その間はフレームのタスクを手伝う
+        threadPool_->WaitUntil([this]() { return IsReady(); });
+    }
+
+    void AssetLoadGraph::Schedule(TaskHandle task) {
+        threadPool_->PushTask([this, task]() { Execute(task); }, TaskPriority::Background);
+    }
+
+    void AssetLoadGraph::Execute(TaskHandle task) {
+        {
+            // 名前はグラフが破棄されるまで有効
+            ThreadPool::ProfileScope scope(*threadPool_, tasks_[task]->name.c_str());
+            tasks_[task]->function();
+        }
+        for (TaskHandle successor : tasks_[task]->successors) {
+            // 最後に終わった依存先が積む
+            if (tasks_[successor]->remainingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                Schedule(successor);
+            }
+        }
+        // これ以降はグラフが破棄されているかもしれない
+        numCompleted_.fetch_add(1, std::memory_order_release);
+    }
+
+}
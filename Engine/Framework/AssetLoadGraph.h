@@ -0,0 +1,85 @@
+///
+/// アセットの読み込みグラフ
+///
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace LIEngine {
+
+    class ThreadPool;
+
+    /// <summary>
+    /// 依存関係のある読み込みの集まり
+    /// TaskGraphと違いStartはすぐ戻り、タスクはBackgroundで積むのでフレームを止めない
+    /// 終わった数で進み具合がわかる
+    /// </summary>
+    class AssetLoadGraph {
+    public:
+        using TaskHandle = uint32_t;
+
+        struct Progress {
+            size_t numCompleted = 0;
+            size_t numTasks = 0;
+        };
+
+        AssetLoadGraph() = default;
+        ~AssetLoadGraph();
+        AssetLoadGraph(const AssetLoadGraph&) = delete;
+        AssetLoadGraph& operator=(const AssetLoadGraph&) = delete;
+
+        /// <summary>
+        /// タスクを追加
+        /// 依存先は先に追加したタスクのみなので循環しない
+        /// </summary>
+        /// <param name="name">名前</param>
+        /// <param name="function">void()</param>
+        /// <param name="dependencies">終わってから実行するタスク</param>
+        /// <returns>タスクのハンドル</returns>
+        TaskHandle AddTask(const std::string& name, std::function<void()> function, std::initializer_list<TaskHandle> dependencies = {});
+        /// <summary>
+        /// 依存関係を追加
+        /// </summary>
+        /// <param name="task">後に実行するタスク</param>
+        /// <param name="dependency">先に実行するタスク</param>
+        void AddDependency(TaskHandle task, TaskHandle dependency);
+        /// <summary>
+        /// 依存のないタスクから積み、終わるのを待たずに戻る
+        /// 一度だけ呼べる
+        /// </summary>
+        void Start(ThreadPool& threadPool);
+        /// <summary>
+        /// すべて終わるまで待つ
+        /// </summary>
+        void Wait() const;
+
+        bool IsStarted() const { return threadPool_ != nullptr; }
+        bool IsReady() const { return numCompleted_.load(std::memory_order_acquire) == tasks_.size(); }
+        Progress GetProgress() const { return { numCompleted_.load(std::memory_order_acquire), tasks_.size() }; }
+        size_t GetNumTasks() const { return tasks_.size(); }
+        const std::string& GetName(TaskHandle task) const { return tasks_[task]->name; }
+
+    private:
+        struct Task {
+            std::string name;
+            std::function<void()> function;
+            // このタスクを待っているタスク
+            std::vector<TaskHandle> successors;
+            std::atomic<uint32_t> remainingDependencies = 0;
+        };
+
+        void Schedule(TaskHandle task);
+        void Execute(TaskHandle task);
+
+        std::vector<std::unique_ptr<Task>> tasks_;
+        ThreadPool* threadPool_ = nullptr;
+        std::atomic<size_t> numCompleted_ = 0;
+    };
+
+}
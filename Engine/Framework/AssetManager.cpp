@@ -15,4 +15,20 @@ namespace LIEngine {
         soundMap.Clear();
     }
 
+    void AssetManager::Rename(Asset& asset, const std::string& name) {
+        bool isAdded = false;
+        switch (asset.GetType()) {
+        case Asset::Type::Texture: isAdded = textureMap.Rename(asset, name); break;
+        case Asset::Type::Model: isAdded = modelMap.Rename(asset, name); break;
+        case Asset::Type::Material: isAdded = materialMap.Rename(asset, name); break;
+        case Asset::Type::Animation: isAdded = animationMap.Rename(asset, name); break;
+        case Asset::Type::Sound: isAdded = soundMap.Rename(asset, name); break;
+        default: break;
+        }
+        // 追加されていなければ名前だけ変える
+        if (!isAdded) {
+            asset.SetName(name);
+        }
+    }
+
 }
\ No newline at end of file
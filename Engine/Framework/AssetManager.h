@@ -4,13 +4,12 @@
 
 #pragma once
 
-#include <map>
 #include <memory>
-#include <mutex>
 #include <string>
-#include <functional>
 
 #include "Asset.h"
+#include "AssetMap.h"
+#include "AssetResidency.h"
 #include "TextureAsset.h"
 #include "ModelAsset.h"
 #include "MaterialAsset.h"
@@ -24,68 +23,6 @@ namespace LIEngine {
     class Sound;
     class Animation;
 
-    template<class T>
-    class AssetMap {
-        static_assert(std::is_base_of<Asset, T>::value, "継承されていません。");
-    public:
-        /// <summary>
-        /// 追加
-        /// </summary>
-        /// <param name="asset"></param>
-        void Add(const std::shared_ptr<T>& asset) {
-            std::lock_guard<std::mutex> lock(mutex_);
-            list_.emplace_back(asset);
-        }
-
-        /// <summary>
-        /// 取得
-        /// </summary>
-        /// <param name="name"></param>
-        /// <returns></returns>
-        std::shared_ptr<T> Get(const std::string& name) const {
-            std::shared_ptr<T> ptr;
-            auto iter = std::find_if(list_.begin(), list_.end(),
-                [name](auto asset) {return name == asset->GetName(); });
-            if (iter != list_.end()) {
-                ptr = *iter;
-            }
-            return ptr;
-        }
-
-        /// <summary>
-        /// マップに対して関数を適用
-        /// </summary>
-        /// <param name="func"></param>
-        void ForEach(std::function<void(const std::shared_ptr<T>&)> func) {
-            std::lock_guard<std::mutex> lock(mutex_);
-            for (auto& iter : list_) {
-                func(iter);
-            }
-        }
-
-        /// <summary>
-        /// 削除
-        /// </summary>
-        /// <param name="asset"></param>
-        void Remove(const std::shared_ptr<T>& asset) {
-            std::lock_guard<std::mutex> lock(mutex_);
-            list_.remove(asset);
-        }
-
-        /// <summary>
-        /// クリア
-        /// </summary>
-        void Clear() {
-            std::lock_guard<std::mutex> lock(mutex_);
-            list_.clear();
-        }
-
-    private:
-        std::mutex mutex_;
-        std::list<std::shared_ptr<T>> list_;
-
-    };
-
     class AssetManager {
     public:
         /// <summary>
@@ -98,12 +35,20 @@ namespace LIEngine {
         /// クリア
         /// </summary>
         void Clear();
+        /// <summary>
+        /// 種類に合った表で名前を変更
+        /// </summary>
+        /// <param name="asset"></param>
+        /// <param name="name"></param>
+        void Rename(Asset& asset, const std::string& name);
 
         AssetMap<TextureAsset> textureMap;
         AssetMap<ModelAsset> modelMap;
         AssetMap<MaterialAsset> materialMap;
         AssetMap<AnimationAsset> animationMap;
         AssetMap<SoundAsset> soundMap;
+        // メモリ予算と追い出し
+        AssetResidency residency;
 
     private:
         AssetManager() = default;
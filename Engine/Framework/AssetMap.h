@@ -0,0 +1,333 @@
+///
+/// アセットの表
+///
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "Asset.h"
+#include "AssetHandle.h"
+#include "AssetName.h"
+#include "ConcurrentIndex.h"
+
+namespace LIEngine {
+
+    /// <summary>
+    /// 種類ごとのアセットの表
+    /// 名前とハンドルからの取得はロックせず、どのスレッドからでも毎フレーム呼んでいい
+    /// 追加、削除、名前の変更はロックする
+    /// アセットは動かない場所に置き、世代で削除済みかを見分ける
+    /// </summary>
+    template<class T>
+    class AssetMap {
+        static_assert(std::is_base_of<Asset, T>::value, "継承されていません。");
+    public:
+        AssetMap() : numSlots_(0) {}
+        AssetMap(const AssetMap&) = delete;
+        AssetMap& operator=(const AssetMap&) = delete;
+
+        /// <summary>
+        /// 追加
+        /// 同じ名前が既にあれば、名前からは先に追加したものを取得する
+        /// </summary>
+        /// <param name="asset"></param>
+        /// <returns>ハンドル</returns>
+        AssetHandle<T> Add(const std::shared_ptr<T>& asset);
+
+        /// <summary>
+        /// 取得
+        /// </summary>
+        /// <param name="name"></param>
+        /// <returns>なければnullptr</returns>
+        std::shared_ptr<T> Get(const std::string& name) const { return Get(FindHandle(AssetName::Find(name))); }
+        std::shared_ptr<T> Get(AssetName name) const { return Get(FindHandle(name)); }
+        /// <summary>
+        /// ハンドルから取得
+        /// 取得したアセットは使用済みとして記録する (Asset::Touch)
+        /// </summary>
+        /// <returns>削除済みならnullptr</returns>
+        std::shared_ptr<T> Get(AssetHandle<T> handle) const;
+        /// <summary>
+        /// 名前からハンドルを取得
+        /// </summary>
+        /// <returns>なければ無効なハンドル</returns>
+        AssetHandle<T> FindHandle(const std::string& name) const { return FindHandle(AssetName::Find(name)); }
+        AssetHandle<T> FindHandle(AssetName name) const;
+
+        /// <summary>
+        /// マップに対して関数を適用
+        /// </summary>
+        /// <param name="func"></param>
+        void ForEach(std::function<void(const std::shared_ptr<T>&)> func);
+
+        /// <summary>
+        /// 削除
+        /// </summary>
+        /// <param name="asset"></param>
+        void Remove(const std::shared_ptr<T>& asset);
+        void Remove(AssetHandle<T> handle);
+
+        /// <summary>
+        /// 名前を変更
+        /// 追加したアセットの名前はこれで変える
+        /// </summary>
+        /// <param name="asset">追加したアセット</param>
+        /// <param name="name">新しい名前</param>
+        /// <returns>追加されていたか</returns>
+        bool Rename(const Asset& asset, const std::string& name);
+
+        /// <summary>
+        /// クリア
+        /// 古い索引を破棄するので、他のスレッドが取得している間に呼ばない
+        /// </summary>
+        void Clear();
+
+        /// <summary>
+        /// 追加されている数
+        /// </summary>
+        size_t GetSize() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return numSlots_ - freeSlots_.size();
+        }
+
+    private:
+        // 1度に確保する場所の数と、確保できる回数
+        static constexpr uint32_t kSlotChunkSize = 256;
+        static constexpr uint32_t kMaxSlotChunks = 4096;
+
+        struct Slot {
+            // 使用中は奇数、空いている間は偶数
+            std::atomic<uint32_t> generation = 0;
+            std::atomic<uint32_t> nameId = 0;
+            std::atomic<std::shared_ptr<T>> asset;
+            // 以下はロック中のみ
+            // 名前の索引に載っているか (同じ名前が先にあれば載らない)
+            bool isIndexed = false;
+        };
+
+        // 名前の番号は連番なので混ぜる
+        struct NameHash {
+            uint64_t operator()(uint32_t id) const { return (uint64_t(id) * 0x9E3779B97F4A7C15ull) >> 32; }
+        };
+
+        const Slot* FindSlot(uint32_t index) const {
+            if (index / kSlotChunkSize >= kMaxSlotChunks) { return nullptr; }
+            const Slot* chunk = chunks_[index / kSlotChunkSize].load(std::memory_order_acquire);
+            return chunk ? &chunk[index % kSlotChunkSize] : nullptr;
+        }
+        Slot& GetSlot(uint32_t index) {
+            return chunks_[index / kSlotChunkSize].load(std::memory_order_relaxed)[index % kSlotChunkSize];
+        }
+        // 以下はロック中のみ
+        uint32_t AllocateSlot();
+        void FreeSlot(uint32_t index);
+        // 同じ名前が載っていなければ索引に載せる
+        void IndexSlot(uint32_t index);
+        // 索引から外し、同じ名前の他のものがあれば代わりに載せる
+        void UnindexSlot(uint32_t index);
+        // 使用中の場所から探す
+        bool FindSlotIndex(const Asset* asset, uint32_t& index);
+
+        std::array<std::atomic<Slot*>, kMaxSlotChunks> chunks_{};
+        std::vector<std::unique_ptr<Slot[]>> chunkStorage_;
+        // 名前の番号から場所の番号
+        ConcurrentIndex<NameHash> index_;
+        mutable std::mutex mutex_;
+        std::vector<uint32_t> freeSlots_;
+        uint32_t numSlots_;
+    };
+
+    template<class T>
+    AssetHandle<T> AssetMap<T>::Add(const std::shared_ptr<T>& asset) {
+        assert(asset);
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint32_t index = AllocateSlot();
+        Slot& slot = GetSlot(index);
+        // 読む側は世代が奇数になってから名前とアセットを読む
+        slot.nameId.store(AssetName(asset->GetName()).GetId(), std::memory_order_release);
+        slot.asset.store(asset, std::memory_order_release);
+        uint32_t generation = slot.generation.load(std::memory_order_relaxed) + 1;
+        slot.generation.store(generation, std::memory_order_release);
+        IndexSlot(index);
+        return AssetHandle<T>(index, generation);
+    }
+
+    template<class T>
+    std::shared_ptr<T> AssetMap<T>::Get(AssetHandle<T> handle) const {
+        if (!handle.IsValid()) { return nullptr; }
+        const Slot* slot = FindSlot(handle.index_);
+        if (!slot || slot->generation.load(std::memory_order_acquire) != handle.generation_) {
+            return nullptr;
+        }
+        std::shared_ptr<T> asset = slot->asset.load(std::memory_order_acquire);
+        // 読んでいる間に削除された
+        if (slot->generation.load(std::memory_order_acquire) != handle.generation_) {
+            return nullptr;
+        }
+        asset->Touch();
+        return asset;
+    }
+
+    template<class T>
+    AssetHandle<T> AssetMap<T>::FindHandle(AssetName name) const {
+        if (name.IsEmpty()) { return AssetHandle<T>(); }
+        uint32_t index = 0;
+        if (!index_.Find(NameHash()(name.GetId()), [&](uint32_t key) { return key == name.GetId(); }, index)) {
+            return AssetHandle<T>();
+        }
+        // 索引を読んだ後に削除や名前の変更があれば世代か名前が変わっている
+        const Slot* slot = FindSlot(index);
+        uint32_t generation = slot->generation.load(std::memory_order_acquire);
+        if ((generation & 1) == 0 ||
+            slot->nameId.load(std::memory_order_acquire) != name.GetId() ||
+            slot->generation.load(std::memory_order_acquire) != generation) {
+            return AssetHandle<T>();
+        }
+        return AssetHandle<T>(index, generation);
+    }
+
+    template<class T>
+    void AssetMap<T>::ForEach(std::function<void(const std::shared_ptr<T>&)> func) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (uint32_t i = 0; i < numSlots_; ++i) {
+            Slot& slot = GetSlot(i);
+            if (slot.generation.load(std::memory_order_relaxed) & 1) {
+                func(slot.asset.load(std::memory_order_relaxed));
+            }
+        }
+    }
+
+    template<class T>
+    void AssetMap<T>::Remove(const std::shared_ptr<T>& asset) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint32_t index = 0;
+        if (FindSlotIndex(asset.get(), index)) {
+            FreeSlot(index);
+        }
+    }
+
+    template<class T>
+    void AssetMap<T>::Remove(AssetHandle<T> handle) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!handle.IsValid() || handle.index_ >= numSlots_) { return; }
+        if (GetSlot(handle.index_).generation.load(std::memory_order_relaxed) == handle.generation_) {
+            FreeSlot(handle.index_);
+        }
+    }
+
+    template<class T>
+    bool AssetMap<T>::Rename(const Asset& asset, const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint32_t index = 0;
+        if (!FindSlotIndex(&asset, index)) {
+            return false;
+        }
+        Slot& slot = GetSlot(index);
+        UnindexSlot(index);
+        slot.asset.load(std::memory_order_relaxed)->SetName(name);
+        slot.nameId.store(AssetName(name).GetId(), std::memory_order_release);
+        IndexSlot(index);
+        return true;
+    }
+
+    template<class T>
+    void AssetMap<T>::Clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (uint32_t i = 0; i < numSlots_; ++i) {
+            Slot& slot = GetSlot(i);
+            uint32_t generation = slot.generation.load(std::memory_order_relaxed);
+            if (generation & 1) {
+                slot.generation.store(generation + 1, std::memory_order_release);
+                slot.asset.store(nullptr, std::memory_order_release);
+                slot.isIndexed = false;
+            }
+        }
+        // 場所は残して世代を引き継ぐ (古いハンドルが新しいアセットを指さないように)
+        freeSlots_.clear();
+        for (uint32_t i = numSlots_; i > 0; --i) {
+            freeSlots_.emplace_back(i - 1);
+        }
+        index_.Clear();
+    }
+
+    template<class T>
+    uint32_t AssetMap<T>::AllocateSlot() {
+        if (!freeSlots_.empty()) {
+            uint32_t index = freeSlots_.back();
+            freeSlots_.pop_back();
+            return index;
+        }
+        uint32_t index = numSlots_++;
+        uint32_t chunkIndex = index / kSlotChunkSize;
+        assert(chunkIndex < kMaxSlotChunks);
+        if (!chunks_[chunkIndex].load(std::memory_order_relaxed)) {
+            chunkStorage_.emplace_back(std::make_unique<Slot[]>(kSlotChunkSize));
+            chunks_[chunkIndex].store(chunkStorage_.back().get(), std::memory_order_release);
+        }
+        return index;
+    }
+
+    template<class T>
+    void AssetMap<T>::FreeSlot(uint32_t index) {
+        Slot& slot = GetSlot(index);
+        // 先に世代を変えて、読んでいる側に削除を知らせる
+        slot.generation.store(slot.generation.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        UnindexSlot(index);
+        slot.asset.store(nullptr, std::memory_order_release);
+        freeSlots_.emplace_back(index);
+    }
+
+    template<class T>
+    void AssetMap<T>::IndexSlot(uint32_t index) {
+        Slot& slot = GetSlot(index);
+        uint32_t nameId = slot.nameId.load(std::memory_order_relaxed);
+        if (nameId == 0) { return; }
+        uint64_t hash = NameHash()(nameId);
+        uint32_t existing = 0;
+        if (index_.Find(hash, [&](uint32_t key) { return key == nameId; }, existing)) {
+            return;
+        }
+        index_.Insert(hash, nameId, index);
+        slot.isIndexed = true;
+    }
+
+    template<class T>
+    void AssetMap<T>::UnindexSlot(uint32_t index) {
+        Slot& slot = GetSlot(index);
+        if (!slot.isIndexed) { return; }
+        uint32_t nameId = slot.nameId.load(std::memory_order_relaxed);
+        index_.Erase(NameHash()(nameId), nameId);
+        slot.isIndexed = false;
+        // 同じ名前で追加された次のもの
+        for (uint32_t i = 0; i < numSlots_; ++i) {
+            Slot& other = GetSlot(i);
+            if (i != index && (other.generation.load(std::memory_order_relaxed) & 1) && other.nameId.load(std::memory_order_relaxed) == nameId) {
+                index_.Insert(NameHash()(nameId), nameId, i);
+                other.isIndexed = true;
+                break;
+            }
+        }
+    }
+
+    template<class T>
+    bool AssetMap<T>::FindSlotIndex(const Asset* asset, uint32_t& index) {
+        for (uint32_t i = 0; i < numSlots_; ++i) {
+            Slot& slot = GetSlot(i);
+            if ((slot.generation.load(std::memory_order_relaxed) & 1) && slot.asset.load(std::memory_order_relaxed).get() == asset) {
+                index = i;
+                return true;
+            }
+        }
+        return false;
+    }
+
+}
@@ -0,0 +1,127 @@
+#include "AssetName.h"
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <memory>
+#include <mutex>
+
+#include "ConcurrentIndex.h"
+
+namespace {
+
+    using namespace LIEngine;
+
+    // 1度に確保する名前の数と、確保できる回数
+    const size_t kChunkSize = 1024;
+    const size_t kMaxChunks = 1024;
+
+    struct NameEntry {
+        std::string string;
+        uint64_t hash = 0;
+    };
+
+    /// <summary>
+    /// 登録された名前の表
+    /// 名前は塊ごとに確保して動かさないので、番号から読むときにロックしない
+    /// </summary>
+    class NameTable {
+    public:
+        static NameTable& GetInstance() {
+            static NameTable instance;
+            return instance;
+        }
+
+        uint32_t Intern(std::string_view name) {
+            uint64_t hash = Hash(name);
+            uint32_t id = Find(name, hash);
+            if (id != 0) {
+                return id;
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            // ロックを待つ間に登録されたかもしれない
+            id = Find(name, hash);
+            if (id != 0) {
+                return id;
+            }
+            size_t index = numNames_;
+            size_t chunkIndex = index / kChunkSize;
+            assert(chunkIndex < kMaxChunks);
+            if (!chunks_[chunkIndex].load(std::memory_order_relaxed)) {
+                chunkStorage_[chunkIndex] = std::make_unique<NameEntry[]>(kChunkSize);
+                chunks_[chunkIndex].store(chunkStorage_[chunkIndex].get(), std::memory_order_release);
+            }
+            NameEntry& entry = chunks_[chunkIndex].load(std::memory_order_relaxed)[index % kChunkSize];
+            entry.string = name;
+            entry.hash = hash;
+            ++numNames_;
+            id = uint32_t(index + 1);
+            // 書き終えた名前を索引に載せる
+            index_.Insert(hash, id, id);
+            return id;
+        }
+
+        uint32_t Find(std::string_view name) const {
+            return Find(name, Hash(name));
+        }
+
+        const NameEntry& GetEntry(uint32_t id) const {
+            assert(id != 0);
+            size_t index = id - 1;
+            return chunks_[index / kChunkSize].load(std::memory_order_acquire)[index % kChunkSize];
+        }
+
+    private:
+        // 作り直すときは登録したハッシュを使う
+        struct IdHash {
+            const NameTable* table;
+            uint64_t operator()(uint32_t id) const { return table->GetEntry(id).hash; }
+        };
+
+        NameTable() : index_(IdHash{ this }), numNames_(0) {}
+
+        static uint64_t Hash(std::string_view name) {
+            return std::hash<std::string_view>()(name);
+        }
+
+        uint32_t Find(std::string_view name, uint64_t hash) const {
+            uint32_t id = 0;
+            index_.Find(hash, [&](uint32_t key) {
+                const NameEntry& entry = GetEntry(key);
+                return entry.hash == hash && entry.string == name;
+                }, id);
+            return id;
+        }
+
+        std::array<std::atomic<NameEntry*>, kMaxChunks> chunks_{};
+        std::array<std::unique_ptr<NameEntry[]>, kMaxChunks> chunkStorage_;
+        ConcurrentIndex<IdHash> index_;
+        std::mutex mutex_;
+        size_t numNames_;
+    };
+
+    const std::string kEmptyString;
+
+}
+
+namespace LIEngine {
+
+    AssetName::AssetName(std::string_view name) :
+        id_(name.empty() ? 0 : NameTable::GetInstance().Intern(name)) {
+    }
+
+    AssetName AssetName::Find(std::string_view name) {
+        if (name.empty()) {
+            return AssetName();
+        }
+        return AssetName(NameTable::GetInstance().Find(name));
+    }
+
+    const std::string& AssetName::GetString() const {
+        if (IsEmpty()) {
+            return kEmptyString;
+        }
+        return NameTable::GetInstance().GetEntry(id_).string;
+    }
+
+}
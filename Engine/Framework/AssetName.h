@@ -0,0 +1,56 @@
+///
+/// アセットの名前
+///
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace LIEngine {
+
+    /// <summary>
+    /// 文字列を1度だけ登録して番号で扱う名前
+    /// 比較とハッシュは番号で行い、同じ文字列は同じ番号になる
+    /// 登録した文字列は終了まで残る
+    /// </summary>
+    class AssetName {
+    public:
+        AssetName() = default;
+        /// <summary>
+        /// 登録して取得 (登録済みなら同じ番号)
+        /// </summary>
+        explicit AssetName(std::string_view name);
+
+        /// <summary>
+        /// 登録済みの名前を探す (登録はしない)
+        /// ロックしないので毎フレーム呼んでいい
+        /// </summary>
+        /// <returns>なければ空</returns>
+        static AssetName Find(std::string_view name);
+
+        /// <summary>
+        /// 登録した文字列 (空なら空文字列)
+        /// </summary>
+        const std::string& GetString() const;
+        uint32_t GetId() const { return id_; }
+        bool IsEmpty() const { return id_ == 0; }
+
+        bool operator==(const AssetName& other) const { return id_ == other.id_; }
+        bool operator!=(const AssetName& other) const { return id_ != other.id_; }
+
+    private:
+        explicit AssetName(uint32_t id) : id_(id) {}
+
+        // 0は空
+        uint32_t id_ = 0;
+    };
+
+}
+
+template<>
+struct std::hash<LIEngine::AssetName> {
+    size_t operator()(const LIEngine::AssetName& name) const { return std::hash<uint32_t>()(name.GetId()); }
+};
@@ -0,0 +1,134 @@
+#include "AssetResidency.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "AssetManager.h"
+#include "Graphics/Core/TextureLoader.h"
+
+namespace {
+    using namespace LIEngine;
+
+    // 表と集めた配列が持っている分
+    // これより多ければどこかで使っている
+    const long kNumResidencyReferences = 2;
+
+    template<class T>
+    void CollectLoaded(AssetMap<T>& map, std::vector<std::shared_ptr<Asset>>& assets) {
+        map.ForEach([&](const std::shared_ptr<T>& asset) {
+            if (asset->IsReady()) {
+                assets.emplace_back(asset);
+            }
+            });
+    }
+
+}
+
+namespace LIEngine {
+
+    void AssetResidency::SetBudget(Asset::Type type, const Budget& budget) {
+        std::lock_guard lock(mutex_);
+        budgets_[static_cast<size_t>(type)] = budget;
+    }
+
+    AssetResidency::Budget AssetResidency::GetBudget(Asset::Type type) const {
+        std::lock_guard lock(mutex_);
+        return budgets_[static_cast<size_t>(type)];
+    }
+
+    AssetResidency::Footprint AssetResidency::GetFootprint(Asset::Type type) const {
+        std::lock_guard lock(mutex_);
+        return footprints_[static_cast<size_t>(type)];
+    }
+
+    AssetResidency::Footprint AssetResidency::GetTotalFootprint() const {
+        std::lock_guard lock(mutex_);
+        Footprint total;
+        for (auto& footprint : footprints_) {
+            total.cpuBytes += footprint.cpuBytes;
+            total.gpuBytes += footprint.gpuBytes;
+            total.numLoaded += footprint.numLoaded;
+        }
+        return total;
+    }
+
+    size_t AssetResidency::GetNumEvicted() const {
+        std::lock_guard lock(mutex_);
+        return numEvicted_;
+    }
+
+    void AssetResidency::Update(AssetManager& assetManager) {
+        uint64_t frame = Asset::currentFrame_.fetch_add(1, std::memory_order_relaxed) + 1;
+
+        std::vector<std::shared_ptr<Asset>> assets;
+        CollectLoaded(assetManager.textureMap, assets);
+        CollectLoaded(assetManager.modelMap, assets);
+        CollectLoaded(assetManager.materialMap, assets);
+        CollectLoaded(assetManager.animationMap, assets);
+        CollectLoaded(assetManager.soundMap, assets);
+
+        std::array<Footprint, kNumTypes> footprints{};
+        for (auto& asset : assets) {
+            Footprint& footprint = footprints[static_cast<size_t>(asset->GetType())];
+            footprint.cpuBytes += asset->GetCPUMemorySize();
+            footprint.gpuBytes += asset->GetGPUMemorySize();
+            ++footprint.numLoaded;
+        }
+
+        std::array<Budget, kNumTypes> budgets;
+        size_t numLoadedBefore = 0;
+        {
+            std::lock_guard lock(mutex_);
+            budgets = budgets_;
+            for (auto& footprint : footprints_) { numLoadedBefore += footprint.numLoaded; }
+        }
+
+        auto IsOverBudget = [&](size_t type) {
+            return footprints[type].cpuBytes > budgets[type].cpuBytes || footprints[type].gpuBytes > budgets[type].gpuBytes;
+            };
+        bool isOverBudget = false;
+        for (size_t type = 0; type < kNumTypes; ++type) {
+            isOverBudget |= IsOverBudget(type);
+        }
+
+        // 予算を超えた種類だけ、使われていない古いものから追い出す
+        size_t numEvicted = 0;
+        if (isOverBudget) {
+            std::stable_sort(assets.begin(), assets.end(), [](const auto& a, const auto& b) {
+                return a->GetLastUsedFrame() < b->GetLastUsedFrame();
+                });
+            for (auto& asset : assets) {
+                size_t type = static_cast<size_t>(asset->GetType());
+                Footprint& footprint = footprints[type];
+                bool isOverCPU = footprint.cpuBytes > budgets[type].cpuBytes;
+                bool isOverGPU = footprint.gpuBytes > budgets[type].gpuBytes;
+                if (!isOverCPU && !isOverGPU) { continue; }
+                size_t cpuBytes = asset->GetCPUMemorySize();
+                size_t gpuBytes = asset->GetGPUMemorySize();
+                // 追い出しても超えている方が減らない
+                if ((isOverCPU ? cpuBytes : 0) + (isOverGPU ? gpuBytes : 0) == 0) { continue; }
+                // 前のフレームから使われている
+                if (asset->GetLastUsedFrame() + 1 >= frame) { continue; }
+                if (asset.use_count() > kNumResidencyReferences || asset->IsReferenced()) { continue; }
+
+                asset->Unload();
+                footprint.cpuBytes -= cpuBytes;
+                footprint.gpuBytes -= gpuBytes;
+                --footprint.numLoaded;
+                ++numEvicted;
+            }
+        }
+
+        size_t numLoaded = 0;
+        for (auto& footprint : footprints) { numLoaded += footprint.numLoaded; }
+        // モデルが持っていたテクスチャは読み込みの表からも外す
+        if (numLoaded < numLoadedBefore) {
+            TextureLoader::ReleaseUnused();
+        }
+
+        std::lock_guard lock(mutex_);
+        footprints_ = footprints;
+        numEvicted_ += numEvicted;
+    }
+
+}
@@ -0,0 +1,67 @@
+///
+/// アセットのメモリ予算
+///
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+
+#include "Asset.h"
+
+namespace LIEngine {
+
+    class AssetManager;
+
+    /// <summary>
+    /// 種類ごとにCPUとGPUのメモリ使用量を数え、予算を超えたら古いものから追い出す
+    /// 追い出すのは表とAssetResidency以外から参照されていない読み込み済みのアセットだけ
+    /// 追い出したアセットは表に残るので、Load(GetPath())で名前を変えずに読みなおせる
+    /// </summary>
+    class AssetResidency {
+    public:
+        // 予算 (バイト)
+        struct Budget {
+            size_t cpuBytes = std::numeric_limits<size_t>::max();
+            size_t gpuBytes = std::numeric_limits<size_t>::max();
+        };
+        // 読み込み済みのものの使用量 (バイト)
+        struct Footprint {
+            size_t cpuBytes = 0;
+            size_t gpuBytes = 0;
+            size_t numLoaded = 0;
+        };
+
+        /// <summary>
+        /// 予算を設定
+        /// 初期値は無制限
+        /// </summary>
+        void SetBudget(Asset::Type type, const Budget& budget);
+        Budget GetBudget(Asset::Type type) const;
+
+        /// <summary>
+        /// 前回のUpdateでの使用量
+        /// </summary>
+        Footprint GetFootprint(Asset::Type type) const;
+        Footprint GetTotalFootprint() const;
+        // これまでに追い出した数
+        size_t GetNumEvicted() const;
+
+        /// <summary>
+        /// フレームを進め、使用量を数えて予算を超えていれば追い出す
+        /// 他のスレッドがアセットの中身を取得していないフレームの終わりに、メインスレッドから呼ぶ
+        /// </summary>
+        void Update(AssetManager& assetManager);
+
+    private:
+        static constexpr size_t kNumTypes = static_cast<size_t>(Asset::Type::NumTypes);
+
+        mutable std::mutex mutex_;
+        std::array<Budget, kNumTypes> budgets_{};
+        std::array<Footprint, kNumTypes> footprints_{};
+        size_t numEvicted_ = 0;
+    };
+
+}
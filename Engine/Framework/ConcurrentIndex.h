@@ -0,0 +1,223 @@
+///
+/// ロックせずに読めるハッシュ索引
+///
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace LIEngine {
+
+    /// <summary>
+    /// 32bitのキーから32bitの値を引く開番地法のハッシュ表
+    /// 読み込みはどのスレッドからでもロックせずにでき、書き込みは呼び出し側でロックする
+    /// 表を作り直すときは新しい表を作って差し替え、古い表は読んでいるスレッドがいなくなってから破棄する
+    /// </summary>
+    /// <typeparam name="KeyHash">uint64_t(uint32_t key) 作り直すときにキーからハッシュを求める</typeparam>
+    template<typename KeyHash>
+    class ConcurrentIndex {
+    public:
+        // 使えないキー
+        static constexpr uint32_t kEmptyKey = 0;
+        static constexpr uint32_t kErasedKey = UINT32_MAX;
+
+        explicit ConcurrentIndex(KeyHash keyHash = KeyHash(), size_t capacity = 16);
+        ConcurrentIndex(const ConcurrentIndex&) = delete;
+        ConcurrentIndex& operator=(const ConcurrentIndex&) = delete;
+
+        /// <summary>
+        /// 探す (どのスレッドからでも)
+        /// </summary>
+        /// <param name="hash">キーのハッシュ</param>
+        /// <param name="match">bool(uint32_t key) 探しているキーか</param>
+        /// <param name="value">見つかった値</param>
+        /// <returns>見つかったか</returns>
+        template<typename Match>
+        bool Find(uint64_t hash, Match&& match, uint32_t& value) const;
+        /// <summary>
+        /// 追加 (呼び出し側でロックし、同じキーがないことを確認しておく)
+        /// </summary>
+        void Insert(uint64_t hash, uint32_t key, uint32_t value);
+        /// <summary>
+        /// 削除 (呼び出し側でロックする)
+        /// </summary>
+        /// <returns>あったか</returns>
+        bool Erase(uint64_t hash, uint32_t key);
+        /// <summary>
+        /// 空にする
+        /// 読み込みと同時に呼ばない
+        /// </summary>
+        void Clear();
+
+        size_t GetSize() const { return size_; }
+
+    private:
+        // 読んでいる間は古い表を破棄しない
+        class ReaderScope {
+        public:
+            explicit ReaderScope(std::atomic<uint32_t>& numReaders) : numReaders_(numReaders) { numReaders_.fetch_add(1, std::memory_order_seq_cst); }
+            ~ReaderScope() { numReaders_.fetch_sub(1, std::memory_order_release); }
+            ReaderScope(const ReaderScope&) = delete;
+            ReaderScope& operator=(const ReaderScope&) = delete;
+        private:
+            std::atomic<uint32_t>& numReaders_;
+        };
+
+        struct Table {
+            explicit Table(size_t capacity) :
+                entries(std::make_unique<std::atomic<uint64_t>[]>(capacity)),
+                mask(capacity - 1) {
+                for (size_t i = 0; i < capacity; ++i) {
+                    entries[i].store(Pack(kEmptyKey, 0), std::memory_order_relaxed);
+                }
+            }
+            std::unique_ptr<std::atomic<uint64_t>[]> entries;
+            size_t mask;
+        };
+
+        // キーと値を1つの値にして、片方だけ書き換わった状態を読まないようにする
+        static uint64_t Pack(uint32_t key, uint32_t value) { return uint64_t(key) << 32 | value; }
+        static uint32_t GetKey(uint64_t entry) { return uint32_t(entry >> 32); }
+        static uint32_t GetValue(uint64_t entry) { return uint32_t(entry); }
+
+        /// <summary>
+        /// 削除済みを除いて詰めた表に差し替える
+        /// </summary>
+        void Rebuild(size_t capacity);
+        /// <summary>
+        /// 読んでいるスレッドがいなければ古い表を破棄する
+        /// </summary>
+        void ReleaseRetiredTables();
+
+        KeyHash keyHash_;
+        std::atomic<Table*> table_;
+        std::unique_ptr<Table> currentTable_;
+        // 差し替えた後、読んでいるスレッドがいるかもしれない表
+        std::vector<std::unique_ptr<Table>> retiredTables_;
+        mutable std::atomic<uint32_t> numReaders_;
+        size_t size_;
+        // 空でない場所の数 (削除済みを含む)
+        size_t numUsed_;
+    };
+
+    template<typename KeyHash>
+    ConcurrentIndex<KeyHash>::ConcurrentIndex(KeyHash keyHash, size_t capacity) :
+        keyHash_(std::move(keyHash)),
+        currentTable_(std::make_unique<Table>(capacity)),
+        numReaders_(0),
+        size_(0),
+        numUsed_(0) {
+        assert(capacity >= 2 && (capacity & (capacity - 1)) == 0);
+        table_.store(currentTable_.get(), std::memory_order_relaxed);
+    }
+
+    template<typename KeyHash>
+    template<typename Match>
+    bool ConcurrentIndex<KeyHash>::Find(uint64_t hash, Match&& match, uint32_t& value) const {
+        // 数えてから表を読む (書き込み側は差し替えてから数を見る)
+        ReaderScope readerScope(numReaders_);
+        const Table* table = table_.load(std::memory_order_seq_cst);
+        for (size_t i = size_t(hash) & table->mask;; i = (i + 1) & table->mask) {
+            uint64_t entry = table->entries[i].load(std::memory_order_acquire);
+            uint32_t key = GetKey(entry);
+            if (key == kEmptyKey) {
+                return false;
+            }
+            if (key != kErasedKey && match(key)) {
+                value = GetValue(entry);
+                return true;
+            }
+        }
+    }
+
+    template<typename KeyHash>
+    void ConcurrentIndex<KeyHash>::Insert(uint64_t hash, uint32_t key, uint32_t value) {
+        assert(key != kEmptyKey && key != kErasedKey);
+        ReleaseRetiredTables();
+        Table* table = table_.load(std::memory_order_relaxed);
+        // 空きが半分を切る前に作り直す (探すときに必ず空きで止まるように)
+        if ((numUsed_ + 1) * 2 > table->mask + 1) {
+            Rebuild(std::max<size_t>(table->mask + 1, std::bit_ceil((size_ + 1) * 4)));
+            table = table_.load(std::memory_order_relaxed);
+        }
+        for (size_t i = size_t(hash) & table->mask;; i = (i + 1) & table->mask) {
+            uint32_t current = GetKey(table->entries[i].load(std::memory_order_relaxed));
+            // 削除済みの場所は使いまわす (読んでいる側は別のキーとして読み飛ばす)
+            if (current == kEmptyKey || current == kErasedKey) {
+                numUsed_ += current == kEmptyKey ? 1 : 0;
+                table->entries[i].store(Pack(key, value), std::memory_order_release);
+                ++size_;
+                return;
+            }
+        }
+    }
+
+    template<typename KeyHash>
+    bool ConcurrentIndex<KeyHash>::Erase(uint64_t hash, uint32_t key) {
+        ReleaseRetiredTables();
+        Table* table = table_.load(std::memory_order_relaxed);
+        for (size_t i = size_t(hash) & table->mask;; i = (i + 1) & table->mask) {
+            uint32_t current = GetKey(table->entries[i].load(std::memory_order_relaxed));
+            if (current == kEmptyKey) {
+                return false;
+            }
+            if (current == key) {
+                // 空にすると後ろに続くキーが見つからなくなる
+                table->entries[i].store(Pack(kErasedKey, 0), std::memory_order_release);
+                --size_;
+                return true;
+            }
+        }
+    }
+
+    template<typename KeyHash>
+    void ConcurrentIndex<KeyHash>::Clear() {
+        size_t capacity = currentTable_->mask + 1;
+        retiredTables_.clear();
+        currentTable_ = std::make_unique<Table>(capacity);
+        table_.store(currentTable_.get(), std::memory_order_release);
+        size_ = 0;
+        numUsed_ = 0;
+    }
+
+    template<typename KeyHash>
+    void ConcurrentIndex<KeyHash>::Rebuild(size_t capacity) {
+        const Table* oldTable = table_.load(std::memory_order_relaxed);
+        auto newTable = std::make_unique<Table>(capacity);
+        for (size_t i = 0; i <= oldTable->mask; ++i) {
+            uint64_t entry = oldTable->entries[i].load(std::memory_order_relaxed);
+            uint32_t key = GetKey(entry);
+            if (key == kEmptyKey || key == kErasedKey) {
+                continue;
+            }
+            for (size_t j = size_t(keyHash_(key)) & newTable->mask;; j = (j + 1) & newTable->mask) {
+                if (GetKey(newTable->entries[j].load(std::memory_order_relaxed)) == kEmptyKey) {
+                    newTable->entries[j].store(entry, std::memory_order_relaxed);
+                    break;
+                }
+            }
+        }
+        numUsed_ = size_;
+        // 書き終えてから差し替える
+        table_.store(newTable.get(), std::memory_order_seq_cst);
+        retiredTables_.emplace_back(std::move(currentTable_));
+        currentTable_ = std::move(newTable);
+        ReleaseRetiredTables();
+    }
+
+    template<typename KeyHash>
+    void ConcurrentIndex<KeyHash>::ReleaseRetiredTables() {
+        // 差し替えた後に0なら、これから読むスレッドは新しい表を読む
+        if (!retiredTables_.empty() && numReaders_.load(std::memory_order_seq_cst) == 0) {
+            retiredTables_.clear();
+        }
+    }
+
+}
@@ -8,9 +8,12 @@
 #include "Input/Input.h"
 #include "Audio/AudioDevice.h"
 #include "Scene/SceneManager.h"
+#include "Scene/SceneIO.h"
 #include "AssetManager.h"
 #include "GameObject/GameObjectManager.h"
 #include "ThreadPool.h"
+#include "TaskGraph.h"
+#include "Collision/CollisionManager.h"
 #ifdef ENABLE_IMGUI
 #include "Editer/EditerManager.h"
 #endif // ENABLE_IMGUI
@@ -75,16 +78,35 @@ namespace LIEngine {
 
         g_game->OnInitialize();
 
-        while (g_gameWindow->ProcessMessage()) {
-            g_input->Update();
-            g_sceneManager->Update();
-
+        // 1フレームの流れ
+        // 前のフレームのGPUへの送信は更新と並行して進め、描画の直前で待つ
+        using Affinity = TaskGraph::Affinity;
+        TaskGraph frameGraph;
+        auto submit = frameGraph.AddTask("Submit", []() { g_renderManager->Submit(); });
+        auto input = frameGraph.AddTask("Input", []() { g_input->Update(); }, {}, Affinity::MainThread);
+        // 読み込みの終わったシーンのゲームオブジェクトを構築する
+        auto sceneLoad = frameGraph.AddTask("SceneLoad", []() { SceneIO::Update(); }, {}, Affinity::MainThread);
+        // ゲームオブジェクトの更新 (トランスフォームの伝播、アニメーションはコンポーネントの中)
+        auto update = frameGraph.AddTask("Update", []() { g_sceneManager->Update(); }, { input, sceneLoad }, Affinity::MainThread);
+        // コールバックがゲームの状態を触るので呼び出したスレッドで (中の判定はスレッドプールで並列)
+        auto collision = frameGraph.AddTask("Collision", []() { CollisionManager::GetInstance()->CheckCollision(g_threadPool.get()); }, { update }, Affinity::MainThread);
+        auto simulated = collision;
 #ifdef ENABLE_IMGUI
-            g_editerManager->Render();
+        simulated = frameGraph.AddTask("Editer", []() { g_editerManager->Render(); }, { collision }, Affinity::MainThread);
 #endif // ENABLE_IMGUI
+        // ゲームの状態が決まったら、描画の準備は並行して進める
+        auto skinning = frameGraph.AddTask("SkinningPalette", []() { g_renderManager->GetSkinningManager().BuildMatrixPalettes(g_threadPool.get()); }, { simulated });
+        auto culling = frameGraph.AddTask("Culling", []() { g_renderManager->Cull(); }, { simulated });
+        auto render = frameGraph.AddTask("Render", []() { g_renderManager->Render(); }, { submit, skinning, culling }, Affinity::MainThread);
+        // 誰もアセットに触れていない間に、予算を超えた分を追い出す
+        frameGraph.AddTask("AssetResidency", []() { g_assetManager->residency.Update(*g_assetManager); }, { render }, Affinity::MainThread);
 
-            g_renderManager->Render();
+        while (g_gameWindow->ProcessMessage()) {
+            frameGraph.Run(*g_threadPool);
         }
+        // 最後のフレームを送る
+        g_renderManager->Submit();
+        SceneIO::Finalize();
 
 #ifdef ENABLE_IMGUI
         g_editerManager->Finalize();
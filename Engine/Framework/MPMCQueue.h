@@ -0,0 +1,133 @@
+///
+/// 複数スレッドから出し入れできる固定長キュー
+///
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace LIEngine {
+
+    /// <summary>
+    /// ロックを使わない固定長の循環キュー (Vyukov)
+    /// 要素ごとの番号で、書き込み中や読み込み中の要素を区別する
+    /// どのスレッドからでも積んで取り出せる
+    /// </summary>
+    /// <typeparam name="T">ムーブできる型</typeparam>
+    template<typename T>
+    class MPMCQueue {
+    public:
+        /// <summary>
+        /// コンストラクタ
+        /// </summary>
+        /// <param name="capacity">容量 (2の累乗)</param>
+        explicit MPMCQueue(size_t capacity);
+        MPMCQueue(const MPMCQueue&) = delete;
+        MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+        /// <summary>
+        /// 後ろに積む
+        /// </summary>
+        /// <returns>一杯ならfalse</returns>
+        bool TryPush(T item);
+        /// <summary>
+        /// 前から取る
+        /// </summary>
+        /// <returns>空ならfalse</returns>
+        bool TryPop(T& item);
+
+        /// <summary>
+        /// おおよその数 (他のスレッドが操作中なら古い値)
+        /// </summary>
+        size_t GetSize() const {
+            size_t enqueue = enqueuePosition_.load(std::memory_order_relaxed);
+            size_t dequeue = dequeuePosition_.load(std::memory_order_relaxed);
+            return enqueue > dequeue ? enqueue - dequeue : 0;
+        }
+        bool IsEmpty() const { return GetSize() == 0; }
+        size_t GetCapacity() const { return mask_ + 1; }
+
+    private:
+        struct Cell {
+            // 積める番か取れる番かを表す
+            std::atomic<size_t> sequence;
+            T item;
+        };
+
+        std::unique_ptr<Cell[]> cells_;
+        size_t mask_;
+        // 積む側と取る側で別のキャッシュラインに置く
+        alignas(64) std::atomic<size_t> enqueuePosition_;
+        alignas(64) std::atomic<size_t> dequeuePosition_;
+    };
+
+    template<typename T>
+    MPMCQueue<T>::MPMCQueue(size_t capacity) :
+        cells_(std::make_unique<Cell[]>(capacity)),
+        mask_(capacity - 1),
+        enqueuePosition_(0),
+        dequeuePosition_(0) {
+        assert(capacity >= 2 && (capacity & (capacity - 1)) == 0);
+        for (size_t i = 0; i < capacity; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    template<typename T>
+    bool MPMCQueue<T>::TryPush(T item) {
+        size_t position = enqueuePosition_.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells_[position & mask_];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t difference = intptr_t(sequence) - intptr_t(position);
+            if (difference == 0) {
+                // 空いているので位置を取り合う
+                if (enqueuePosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    cell.item = std::move(item);
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0) {
+                // 一周前のものがまだ取られていない
+                return false;
+            }
+            else {
+                // 他のスレッドが先に積んだ
+                position = enqueuePosition_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    template<typename T>
+    bool MPMCQueue<T>::TryPop(T& item) {
+        size_t position = dequeuePosition_.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells_[position & mask_];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t difference = intptr_t(sequence) - intptr_t(position + 1);
+            if (difference == 0) {
+                // 書き込み済みなので位置を取り合う
+                if (dequeuePosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    item = std::move(cell.item);
+                    // 次の周で積めるようにする
+                    cell.sequence.store(position + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0) {
+                // 空
+                return false;
+            }
+            else {
+                // 他のスレッドが先に取った
+                position = dequeuePosition_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+}
@@ -39,7 +39,15 @@ namespace LIEngine {
     void ModelAsset::InternalLoad() {
         assert(state_ == State::Loading);
         type_ = Type::Model;
-        core_ = Model::Load(path_);
+        // 先に読んだ中身があれば、ファイルを読みなおさない
+        if (source_) {
+            core_ = Model::Load(*source_);
+            source_.reset();
+        }
+        else {
+            core_ = Model::Load(path_);
+        }
+        SetMemorySize(core_->GetCPUMemorySize(), core_->GetGPUMemorySize());
 
 #ifdef ENABLE_IMGUI
         //// サムネイル画像を作成
@@ -10,12 +10,20 @@
 namespace LIEngine {
 
     class Model;
+    struct ModelSource;
 
     class ModelAsset :
         public Asset {
     public:
         void RenderInInspectorView() override;
 
+        /// <summary>
+        /// 次の読み込みで使う中身 (先にテクスチャを取り出すためにModel::ReadSourceで読んだもの)
+        /// 読み込みより前に設定し、読み込みで使い切る
+        /// </summary>
+        /// <param name="source">GetPath()と同じファイルから読んだもの</param>
+        void SetSource(std::shared_ptr<ModelSource> source) { source_ = std::move(source); }
+
         std::shared_ptr<Model> Get() const { return core_; }
 
 #ifdef ENABLE_IMGUI
@@ -24,8 +32,11 @@ namespace LIEngine {
 #endif // ENABLE_IMGUI
     private:
         void InternalLoad() override;
+        void InternalUnload() override { core_.reset(); }
+        bool IsReferenced() const override { return core_.use_count() > 1; }
 
         std::shared_ptr<Model> core_;
+        std::shared_ptr<ModelSource> source_;
 
 #ifdef ENABLE_IMGUI
         std::unique_ptr<TextureResource> thumbnail_;
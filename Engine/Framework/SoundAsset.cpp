@@ -24,6 +24,7 @@ namespace LIEngine {
         assert(state_ == State::Loading);
         type_ = Type::Sound;
         core_ = Sound::Load(path_);
+        SetMemorySize(core_->GetCPUMemorySize(), 0);
     }
 
 }
\ No newline at end of file
@@ -22,6 +22,8 @@ namespace LIEngine {
 #endif // ENABLE_IMGUI
     private:
         void InternalLoad() override;
+        void InternalUnload() override { core_.reset(); }
+        bool IsReferenced() const override { return core_.use_count() > 1; }
 
         std::shared_ptr<Sound> core_;
     };
@@ -0,0 +1,124 @@
+///
+/// タスクの関数
+///
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace LIEngine {
+
+    /// <summary>
+    /// ムーブのみできるvoid()の関数
+    /// キャプチャがkInlineSize以下ならヒープを使わずに中に持つ
+    /// </summary>
+    class TaskFunction {
+    public:
+        static constexpr size_t kInlineSize = 40;
+
+        TaskFunction() = default;
+        TaskFunction(std::nullptr_t) {}
+        template<typename Function, typename = std::enable_if_t<!std::is_same_v<std::decay_t<Function>, TaskFunction>>>
+        TaskFunction(Function&& function) {
+            Construct(std::forward<Function>(function));
+        }
+        TaskFunction(TaskFunction&& other) noexcept {
+            MoveFrom(other);
+        }
+        TaskFunction& operator=(TaskFunction&& other) noexcept {
+            if (this != &other) {
+                Reset();
+                MoveFrom(other);
+            }
+            return *this;
+        }
+        TaskFunction& operator=(std::nullptr_t) {
+            Reset();
+            return *this;
+        }
+        TaskFunction(const TaskFunction&) = delete;
+        TaskFunction& operator=(const TaskFunction&) = delete;
+        ~TaskFunction() { Reset(); }
+
+        void operator()() {
+            assert(operations_);
+            operations_->invoke(storage_);
+        }
+        explicit operator bool() const { return operations_ != nullptr; }
+
+        /// <summary>
+        /// 中の関数を破棄する
+        /// </summary>
+        void Reset() {
+            if (operations_) {
+                operations_->destroy(storage_);
+                operations_ = nullptr;
+            }
+        }
+
+    private:
+        struct Operations {
+            void (*invoke)(void* storage);
+            // 移動元は破棄済みになる
+            void (*move)(void* destination, void* source);
+            void (*destroy)(void* storage);
+        };
+
+        template<typename Function>
+        static constexpr bool kIsInline =
+            sizeof(Function) <= kInlineSize &&
+            alignof(Function) <= alignof(std::max_align_t) &&
+            std::is_nothrow_move_constructible_v<Function>;
+
+        // 中に持つ
+        template<typename Function>
+        struct InlineOperations {
+            static Function* Get(void* storage) { return std::launder(reinterpret_cast<Function*>(storage)); }
+            static void Invoke(void* storage) { (*Get(storage))(); }
+            static void Move(void* destination, void* source) {
+                new (destination) Function(std::move(*Get(source)));
+                Get(source)->~Function();
+            }
+            static void Destroy(void* storage) { Get(storage)->~Function(); }
+            static constexpr Operations kOperations = { Invoke, Move, Destroy };
+        };
+
+        // 大きいものはヒープに置いてポインタを持つ
+        template<typename Function>
+        struct HeapOperations {
+            static Function*& Get(void* storage) { return *std::launder(reinterpret_cast<Function**>(storage)); }
+            static void Invoke(void* storage) { (*Get(storage))(); }
+            static void Move(void* destination, void* source) { new (destination) Function*(Get(source)); }
+            static void Destroy(void* storage) { delete Get(storage); }
+            static constexpr Operations kOperations = { Invoke, Move, Destroy };
+        };
+
+        template<typename Function>
+        void Construct(Function&& function) {
+            using Type = std::decay_t<Function>;
+            if constexpr (kIsInline<Type>) {
+                new (storage_) Type(std::forward<Function>(function));
+                operations_ = &InlineOperations<Type>::kOperations;
+            }
+            else {
+                new (storage_) Type*(new Type(std::forward<Function>(function)));
+                operations_ = &HeapOperations<Type>::kOperations;
+            }
+        }
+        void MoveFrom(TaskFunction& other) {
+            if (other.operations_) {
+                other.operations_->move(storage_, other.storage_);
+                operations_ = other.operations_;
+                other.operations_ = nullptr;
+            }
+        }
+
+        alignas(std::max_align_t) std::byte storage_[kInlineSize];
+        const Operations* operations_ = nullptr;
+    };
+
+}
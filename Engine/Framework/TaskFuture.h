@@ -0,0 +1,208 @@
+///
+/// タスクの結果
+///
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace LIEngine {
+
+    class ThreadPool;
+
+    /// <summary>
+    /// タスクの優先度
+    /// </summary>
+    enum class TaskPriority {
+        // フレーム内で待たれる処理
+        FrameCritical,
+        // アセットの読み込みなど、フレームをまたいでいい処理
+        // 待っているスレッドは手伝わず、すべてのワーカーが埋まらないよう同時に動く数を絞る
+        Background,
+    };
+
+    /// <summary>
+    /// キャンセルの確認用
+    /// 長いタスクは途中で確認して早めに抜ける
+    /// </summary>
+    class CancellationToken {
+    public:
+        explicit CancellationToken(const std::atomic<bool>& isCancelled) : isCancelled_(&isCancelled) {}
+
+        bool IsCancelled() const { return isCancelled_->load(std::memory_order_relaxed); }
+
+    private:
+        const std::atomic<bool>* isCancelled_;
+    };
+
+    namespace Internal {
+
+        /// <summary>
+        /// タスクの状態
+        /// 取り出したワーカーか、待っているスレッドのどちらか先に取った方が実行する
+        /// </summary>
+        class TaskStateBase {
+        public:
+            enum class Status {
+                Pending,
+                Running,
+                Done,
+            };
+
+            explicit TaskStateBase(ThreadPool& threadPool) :
+                threadPool_(threadPool),
+                status_(Status::Pending),
+                isCancelled_(false),
+                hasResult_(false) {
+            }
+            virtual ~TaskStateBase() {}
+
+            /// <summary>
+            /// まだ誰も実行していなければ実行する
+            /// </summary>
+            /// <returns>実行したか</returns>
+            bool TryRun() {
+                Status expected = Status::Pending;
+                if (!status_.compare_exchange_strong(expected, Status::Running, std::memory_order_acquire)) {
+                    return false;
+                }
+                Execute();
+                hasResult_ = true;
+                status_.store(Status::Done, std::memory_order_release);
+                return true;
+            }
+            /// <summary>
+            /// キャンセルを要求する
+            /// 始まっていなければ実行しない
+            /// </summary>
+            void Cancel() {
+                isCancelled_.store(true, std::memory_order_relaxed);
+                Status expected = Status::Pending;
+                status_.compare_exchange_strong(expected, Status::Done, std::memory_order_release);
+            }
+            /// <summary>
+            /// 終わるまで待つ (ThreadPool.cppで定義)
+            /// 始まっていなければ待っているスレッドで実行し、実行中ならその間他のタスクを手伝う
+            /// </summary>
+            void Wait();
+
+            bool IsDone() const { return status_.load(std::memory_order_acquire) == Status::Done; }
+            bool IsCancelled() const { return isCancelled_.load(std::memory_order_relaxed); }
+            // 終わって結果があるか (始まる前にキャンセルされたものはない)
+            bool HasResult() const { return IsDone() && hasResult_; }
+
+        protected:
+            virtual void Execute() = 0;
+
+            ThreadPool& threadPool_;
+            std::atomic<Status> status_;
+            std::atomic<bool> isCancelled_;
+            bool hasResult_;
+        };
+
+        template<typename T>
+        class TaskResultState : public TaskStateBase {
+        public:
+            using TaskStateBase::TaskStateBase;
+
+            std::optional<T> result;
+        };
+
+        template<>
+        class TaskResultState<void> : public TaskStateBase {
+        public:
+            using TaskStateBase::TaskStateBase;
+        };
+
+        template<typename T, typename Function>
+        class TaskState : public TaskResultState<T> {
+        public:
+            TaskState(ThreadPool& threadPool, Function&& function) :
+                TaskResultState<T>(threadPool),
+                function_(std::move(function)) {
+            }
+
+        private:
+            void Execute() override {
+                CancellationToken token(this->isCancelled_);
+                if constexpr (std::is_void_v<T>) {
+                    Invoke(token);
+                }
+                else {
+                    this->result.emplace(Invoke(token));
+                }
+            }
+            T Invoke(const CancellationToken& token) {
+                if constexpr (std::is_invocable_v<Function&, const CancellationToken&>) {
+                    return function_(token);
+                }
+                else {
+                    return function_();
+                }
+            }
+
+            Function function_;
+        };
+
+        template<typename Function>
+        using TaskResultType = typename std::conditional_t<
+            std::is_invocable_v<Function&, const CancellationToken&>,
+            std::invoke_result<Function&, const CancellationToken&>,
+            std::invoke_result<Function&>>::type;
+
+    }
+
+    /// <summary>
+    /// ThreadPool::Submitで追加したタスクの結果
+    /// コピーしても同じタスクを指す
+    /// </summary>
+    template<typename T>
+    class TaskFuture {
+        friend class ThreadPool;
+    public:
+        TaskFuture() = default;
+
+        /// <summary>
+        /// 終わるまで待つ
+        /// </summary>
+        void Wait() const {
+            assert(IsValid());
+            state_->Wait();
+        }
+        /// <summary>
+        /// 終わるまで待って結果を取得
+        /// 始まる前にキャンセルされたものは結果がない
+        /// </summary>
+        std::add_lvalue_reference_t<T> Get() const {
+            Wait();
+            assert(state_->HasResult());
+            if constexpr (!std::is_void_v<T>) {
+                return *state_->result;
+            }
+        }
+        /// <summary>
+        /// キャンセルを要求する
+        /// 始まっていなければ実行されず、実行中ならCancellationTokenで知らせる
+        /// </summary>
+        void Cancel() const {
+            assert(IsValid());
+            state_->Cancel();
+        }
+
+        bool IsValid() const { return state_ != nullptr; }
+        bool IsReady() const { return state_ && state_->IsDone(); }
+        bool IsCancelled() const { return state_ && state_->IsCancelled(); }
+        bool HasResult() const { return state_ && state_->HasResult(); }
+
+    private:
+        explicit TaskFuture(std::shared_ptr<Internal::TaskResultState<T>> state) : state_(std::move(state)) {}
+
+        std::shared_ptr<Internal::TaskResultState<T>> state_;
+    };
+
+}
@@ -0,0 +1,116 @@
+#include "TaskGraph.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "ThreadPool.h"
+
+namespace LIEngine {
+
+    TaskGraph::TaskHandle TaskGraph::AddTask(const std::string& name, std::function<void()> function, std::initializer_list<TaskHandle> dependencies, Affinity affinity) {
+        assert(numRemainingTasks_.load(std::memory_order_relaxed) == 0);
+        assert(function);
+        TaskHandle handle = TaskHandle(tasks_.size());
+        auto& task = tasks_.emplace_back(std::make_unique<Task>());
+        task->name = name;
+        task->function = std::move(function);
+        task->affinity = affinity;
+        for (TaskHandle dependency : dependencies) {
+            AddDependency(handle, dependency);
+        }
+        return handle;
+    }
+
+    void TaskGraph::AddDependency(TaskHandle task, TaskHandle dependency) {
+        assert(numRemainingTasks_.load(std::memory_order_relaxed) == 0);
+        assert(task < tasks_.size());
+        // 先に追加したものにしか依存できない
+        assert(dependency < task);
+        auto& successors = tasks_[dependency]->successors;
+        if (std::find(successors.begin(), successors.end(), task) != successors.end()) {
+            return;
+        }
+        successors.emplace_back(task);
+        ++tasks_[task]->numDependencies;
+    }
+
+    void TaskGraph::Run(ThreadPool& threadPool) {
+        assert(numRemainingTasks_.load(std::memory_order_relaxed) == 0);
+        if (tasks_.empty()) { return; }
+
+        threadPool_ = &threadPool;
+        numRemainingTasks_.store(tasks_.size(), std::memory_order_relaxed);
+        for (auto& task : tasks_) {
+            task->remainingDependencies.store(task->numDependencies, std::memory_order_relaxed);
+        }
+        // すべて数えなおしてから依存のないものを積む
+        for (TaskHandle handle = 0; handle < TaskHandle(tasks_.size()); ++handle) {
+            if (tasks_[handle]->numDependencies == 0) {
+                Schedule(handle);
+            }
+        }
+
+        while (numRemainingTasks_.load(std::memory_order_acquire) > 0) {
+            TaskHandle handle;
+            if (PopMainThreadTask(handle)) {
+                Execute(handle);
+                continue;
+            }
+            // MainThreadのタスクが来るまで他のタスクを手伝う
+            threadPool.WaitUntil([this]() {
+                return numRemainingTasks_.load(std::memory_order_acquire) == 0 ||
+                    numReadyMainThreadTasks_.load(std::memory_order_acquire) > 0;
+                });
+        }
+        threadPool_ = nullptr;
+    }
+
+    void TaskGraph::Clear() {
+        assert(numRemainingTasks_.load(std::memory_order_relaxed) == 0);
+        tasks_.clear();
+        mainThreadTasks_.clear();
+    }
+
+    void TaskGraph::Schedule(TaskHandle task) {
+        if (tasks_[task]->affinity == Affinity::MainThread) {
+            std::unique_lock<std::mutex> lock(mainThreadMutex_);
+            mainThreadTasks_.emplace_back(task);
+            numReadyMainThreadTasks_.fetch_add(1, std::memory_order_release);
+            return;
+        }
+        threadPool_->PushTask([this, task]() { Execute(task); });
+    }
+
+    void TaskGraph::Execute(TaskHandle task) {
+        {
+            // 名前はグラフが破棄されるまで有効
+            ThreadPool::ProfileScope scope(*threadPool_, tasks_[task]->name.c_str());
+            tasks_[task]->function();
+        }
+        for (TaskHandle successor : tasks_[task]->successors) {
+            // 最後に終わった依存先が積む
+            if (tasks_[successor]->remainingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                Schedule(successor);
+            }
+        }
+        // これ以降はRunが戻り、グラフが破棄されているかもしれない
+        numRemainingTasks_.fetch_sub(1, std::memory_order_release);
+    }
+
+    bool TaskGraph::PopMainThreadTask(TaskHandle& task) {
+        if (numReadyMainThreadTasks_.load(std::memory_order_acquire) == 0) {
+            return false;
+        }
+        std::unique_lock<std::mutex> lock(mainThreadMutex_);
+        if (mainThreadTasks_.empty()) {
+            return false;
+        }
+        // 追加した順に実行する
+        auto iter = std::min_element(mainThreadTasks_.begin(), mainThreadTasks_.end());
+        task = *iter;
+        mainThreadTasks_.erase(iter);
+        numReadyMainThreadTasks_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+}
@@ -0,0 +1,97 @@
+///
+/// タスクグラフ
+///
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace LIEngine {
+
+    class ThreadPool;
+
+    /// <summary>
+    /// 依存関係のあるタスクの集まり
+    /// 一度組み立てれば毎フレームRunで実行できる
+    /// タスクごとに残りの依存数を数え、0になったものからスレッドプールに積む
+    /// </summary>
+    class TaskGraph {
+    public:
+        using TaskHandle = uint32_t;
+
+        /// <summary>
+        /// どのスレッドで実行するか
+        /// </summary>
+        enum class Affinity {
+            // どのスレッドでもいい
+            Any,
+            // Runを呼んだスレッドのみ (ゲームの状態やウィンドウ、描画コマンドを触るもの)
+            MainThread
+        };
+
+        TaskGraph() = default;
+        TaskGraph(const TaskGraph&) = delete;
+        TaskGraph& operator=(const TaskGraph&) = delete;
+
+        /// <summary>
+        /// タスクを追加
+        /// 依存先は先に追加したタスクのみなので循環しない
+        /// </summary>
+        /// <param name="name">名前</param>
+        /// <param name="function">void()</param>
+        /// <param name="dependencies">終わってから実行するタスク</param>
+        /// <param name="affinity">実行するスレッド</param>
+        /// <returns>タスクのハンドル</returns>
+        TaskHandle AddTask(const std::string& name, std::function<void()> function, std::initializer_list<TaskHandle> dependencies = {}, Affinity affinity = Affinity::Any);
+        /// <summary>
+        /// 依存関係を追加
+        /// </summary>
+        /// <param name="task">後に実行するタスク</param>
+        /// <param name="dependency">先に実行するタスク</param>
+        void AddDependency(TaskHandle task, TaskHandle dependency);
+        /// <summary>
+        /// すべてのタスクを実行し、終わるまで戻らない
+        /// MainThreadのタスクは呼び出したスレッドで追加した順に実行し、
+        /// その合間は他のタスクを手伝う
+        /// </summary>
+        void Run(ThreadPool& threadPool);
+        /// <summary>
+        /// タスクをすべて削除
+        /// </summary>
+        void Clear();
+
+        size_t GetNumTasks() const { return tasks_.size(); }
+        const std::string& GetName(TaskHandle task) const { return tasks_[task]->name; }
+
+    private:
+        struct Task {
+            std::string name;
+            std::function<void()> function;
+            // このタスクを待っているタスク
+            std::vector<TaskHandle> successors;
+            uint32_t numDependencies = 0;
+            std::atomic<uint32_t> remainingDependencies = 0;
+            Affinity affinity = Affinity::Any;
+        };
+
+        void Schedule(TaskHandle task);
+        void Execute(TaskHandle task);
+        bool PopMainThreadTask(TaskHandle& task);
+
+        std::vector<std::unique_ptr<Task>> tasks_;
+        ThreadPool* threadPool_ = nullptr;
+        // 実行できるようになったMainThreadのタスク
+        std::vector<TaskHandle> mainThreadTasks_;
+        std::mutex mainThreadMutex_;
+        std::atomic<size_t> numReadyMainThreadTasks_ = 0;
+        // まだ終わっていないタスク数
+        std::atomic<size_t> numRemainingTasks_ = 0;
+    };
+
+}
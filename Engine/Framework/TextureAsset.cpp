@@ -38,6 +38,7 @@ namespace LIEngine {
         assert(state_ == State::Loading);
         type_ = Type::Texture;
         core_ = Texture::Load(path_);
+        SetMemorySize(0, core_->GetResource()->GetGPUMemorySize());
     }
 
 }
\ No newline at end of file
@@ -2,71 +2,361 @@
 
 #include <cassert>
 
+namespace {
+
+    using namespace LIEngine;
+
+    // 寝る前にタスクを探し直す回数
+    const uint32_t kSpinCount = 64;
+
+    // 実行中のワーカーがどのプールの何番か
+    thread_local const ThreadPool* g_currentPool = nullptr;
+    thread_local size_t g_currentQueue = 0;
+    // 盗む相手を選ぶ乱数
+    thread_local uint32_t g_stealSeed = 0;
+
+    uint32_t NextStealIndex() {
+        if (g_stealSeed == 0) {
+            g_stealSeed = uint32_t(std::hash<std::thread::id>()(std::this_thread::get_id())) | 1;
+        }
+        // xorshift32
+        g_stealSeed ^= g_stealSeed << 13;
+        g_stealSeed ^= g_stealSeed >> 17;
+        g_stealSeed ^= g_stealSeed << 5;
+        return g_stealSeed;
+    }
+
+}
+
 namespace LIEngine {
 
     ThreadPool::ThreadPool(size_t threads) :
-        stop_(false),
-        activeTasks_(0) {
+        ownerThread_(std::this_thread::get_id()),
+        injectionQueue_(kInjectionCapacity),
+        numBackgroundTasks_(0),
+        numRunningBackgroundTasks_(0),
+        sharedFreeTasks_(kSharedTaskCapacity),
+        numPendingTasks_(0),
+        numSleepingWorkers_(0),
+        wakeCount_(0),
+        stop_(false) {
         if (threads == 0) {
             threads = std::thread::hardware_concurrency();
         }
+        // 0番は作成したスレッド用
+        for (size_t i = 0; i < threads + 1; ++i) {
+            queues_.emplace_back(std::make_unique<WorkStealingDeque<Task*>>());
+        }
+        taskCaches_.resize(queues_.size());
+        profiler_ = std::make_unique<ThreadPoolProfiler>(queues_.size());
+        maxRunningBackgroundTasks_ = std::max<size_t>(1, threads - 1);
         for (size_t i = 0; i < threads; ++i) {
-            workers_.emplace_back([this] {
-                while (true) {
-                    std::function<void()> task;
-                    {
-                        std::unique_lock<std::mutex> lock(mutex_);
-                        condition_.wait(lock, [this] {
-                            return stop_ || !taskQueue_.empty();
-                            });
-                        if (stop_ && taskQueue_.empty()) {
-                            return;
-                        }
-                        task = std::move(taskQueue_.front());
-                        taskQueue_.pop();
-                        ++activeTasks_;
-                    }
-                    task();
-                    {
-                        std::unique_lock<std::mutex> lock(mutex_);
-                        --activeTasks_;
-                        if (taskQueue_.empty() && activeTasks_ == 0) {
-                            completionCondition_.notify_all();
-                        }
-                    }
-                }
-                });
+            workers_.emplace_back([this, i] { WorkerMain(i + 1); });
         }
     }
 
     ThreadPool::~ThreadPool() {
+        // 残っているタスクは終わらせる
+        WaitForAll();
         {
-            std::unique_lock<std::mutex> lock(mutex_);
+            std::unique_lock<std::mutex> lock(sleepMutex_);
             stop_ = true;
         }
-        condition_.notify_all();
+        sleepCondition_.notify_all();
         for (std::thread& worker : workers_) {
             worker.join();
         }
     }
 
-    void ThreadPool::PushTask(std::function<void()> task) {
+    void ThreadPool::PushTask(TaskFunction task, TaskPriority priority) {
+        assert(!stop_);
+        assert(task);
+        Task* newTask = AllocateTask();
+        newTask->function = std::move(task);
+        newTask->priority = priority;
+        newTask->enqueueTime = profiler_->IsEnabled() ? ThreadPoolProfiler::Now() : 0;
+        numPendingTasks_.fetch_add(1, std::memory_order_relaxed);
+
+        size_t queueIndex = GetQueueIndex();
+        if (priority == TaskPriority::Background) {
+            std::unique_lock<std::mutex> lock(backgroundMutex_);
+            backgroundQueue_.push(newTask);
+            numBackgroundTasks_.fetch_add(1, std::memory_order_relaxed);
+        }
+        else if (queueIndex != kNoQueue) {
+            queues_[queueIndex]->Push(newTask);
+        }
+        else {
+            // 一杯なら空くまで手伝う
+            while (!injectionQueue_.TryPush(newTask)) {
+                WakeWorker();
+                if (!RunOneTask(false)) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+        WakeWorker();
+    }
+
+    void ThreadPool::WaitForAll() {
+        // Backgroundのタスクも待つので手伝う
+        while (numPendingTasks_.load(std::memory_order_acquire) > 0) {
+            if (!RunOneTask(true)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    size_t ThreadPool::GetQueueIndex() const {
+        if (g_currentPool == this) {
+            return g_currentQueue;
+        }
+        return std::this_thread::get_id() == ownerThread_ ? 0 : kNoQueue;
+    }
+
+    bool ThreadPool::RunOneTask(bool allowBackground) {
+        size_t queueIndex = GetQueueIndex();
+        Task* task = FindTask(queueIndex, allowBackground);
+        if (!task) {
+            return false;
+        }
+        bool isBackground = task->priority == TaskPriority::Background;
+        if (profiler_->IsEnabled()) {
+            int64_t enqueueTime = task->enqueueTime;
+            int64_t start = ThreadPoolProfiler::Now();
+            task->function();
+            profiler_->RecordTask(GetProfileThread(queueIndex), enqueueTime, start, ThreadPoolProfiler::Now(), isBackground);
+        }
+        else {
+            task->function();
+        }
+        // キャプチャはすぐに破棄する
+        task->function.Reset();
+        FreeTask(task);
+        if (isBackground) {
+            numRunningBackgroundTasks_.fetch_sub(1, std::memory_order_relaxed);
+            // 上限で待っていたものを起こす
+            if (numBackgroundTasks_.load(std::memory_order_relaxed) > 0) {
+                WakeWorker();
+            }
+        }
+        numPendingTasks_.fetch_sub(1, std::memory_order_release);
+        return true;
+    }
+
+    ThreadPool::Task* ThreadPool::FindTask(size_t queueIndex, bool allowBackground) {
+        Task* task = nullptr;
+        // 自分のキューの新しいものから
+        if (queueIndex != kNoQueue && queues_[queueIndex]->Pop(task)) {
+            return task;
+        }
+        // 外から追加されたもの
+        if (!injectionQueue_.IsEmpty() && injectionQueue_.TryPop(task)) {
+            if (profiler_->IsEnabled()) {
+                profiler_->CountInjectedTask(GetProfileThread(queueIndex));
+            }
+            return task;
+        }
+        // 他のキューの古いものを盗む (同じ相手に集中しないよう始める位置をばらす)
+        size_t numQueues = queues_.size();
+        size_t start = NextStealIndex() % numQueues;
+        for (size_t i = 0; i < numQueues; ++i) {
+            size_t victim = (start + i) % numQueues;
+            if (victim != queueIndex && queues_[victim]->Steal(task)) {
+                if (profiler_->IsEnabled()) {
+                    profiler_->CountSteal(GetProfileThread(queueIndex));
+                }
+                return task;
+            }
+        }
+        // FrameCriticalのタスクがなければBackground
+        if (allowBackground) {
+            return PopBackgroundTask();
+        }
+        return nullptr;
+    }
+
+    ThreadPool::Task* ThreadPool::PopBackgroundTask() {
+        if (numBackgroundTasks_.load(std::memory_order_relaxed) == 0) {
+            return nullptr;
+        }
+        // 先に実行枠を取る
+        size_t numRunning = numRunningBackgroundTasks_.load(std::memory_order_relaxed);
+        do {
+            if (numRunning >= maxRunningBackgroundTasks_) {
+                return nullptr;
+            }
+        } while (!numRunningBackgroundTasks_.compare_exchange_weak(numRunning, numRunning + 1, std::memory_order_relaxed));
+
+        std::unique_lock<std::mutex> lock(backgroundMutex_);
+        if (backgroundQueue_.empty()) {
+            numRunningBackgroundTasks_.fetch_sub(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        Task* task = backgroundQueue_.front();
+        backgroundQueue_.pop();
+        numBackgroundTasks_.fetch_sub(1, std::memory_order_relaxed);
+        return task;
+    }
+
+    ThreadPool::Task* ThreadPool::AllocateTask() {
+        size_t queueIndex = GetQueueIndex();
+        Task* task = nullptr;
+        if (queueIndex == kNoQueue) {
+            if (sharedFreeTasks_.TryPop(task)) {
+                return task;
+            }
+            // 1つだけ使い、残りは共有のリストへ
+            task = AllocateTaskBlock();
+            for (Task* rest = task->next; rest;) {
+                Task* next = rest->next;
+                sharedFreeTasks_.TryPush(rest);
+                rest = next;
+            }
+            return task;
+        }
+        // 自分のリストが空なら共有のリストからまとめて取る
+        TaskCache& cache = taskCaches_[queueIndex];
+        if (!cache.freeList) {
+            while (cache.numTasks < kTaskBatchSize && sharedFreeTasks_.TryPop(task)) {
+                task->next = cache.freeList;
+                cache.freeList = task;
+                ++cache.numTasks;
+            }
+            if (!cache.freeList) {
+                cache.freeList = AllocateTaskBlock();
+                cache.numTasks = kTaskBlockSize;
+            }
+        }
+        task = cache.freeList;
+        cache.freeList = task->next;
+        --cache.numTasks;
+        return task;
+    }
+
+    void ThreadPool::FreeTask(Task* task) {
+        // 共有のリストが一杯で戻せないものは、ブロックごとプールと一緒に破棄される
+        size_t queueIndex = GetQueueIndex();
+        if (queueIndex == kNoQueue) {
+            sharedFreeTasks_.TryPush(task);
+            return;
+        }
+        TaskCache& cache = taskCaches_[queueIndex];
+        task->next = cache.freeList;
+        cache.freeList = task;
+        ++cache.numTasks;
+        // 積むスレッドと実行するスレッドが偏っても溜まり続けないよう共有のリストに戻す
+        if (cache.numTasks > kMaxCachedTasks) {
+            for (size_t i = 0; i < kTaskBatchSize; ++i) {
+                // 戻した瞬間に他のスレッドが使うので先に次を読む
+                Task* next = cache.freeList->next;
+                if (!sharedFreeTasks_.TryPush(cache.freeList)) { break; }
+                cache.freeList = next;
+                --cache.numTasks;
+            }
+        }
+    }
+
+    ThreadPool::Task* ThreadPool::AllocateTaskBlock() {
+        std::unique_lock<std::mutex> lock(taskBlockMutex_);
+        auto& block = taskBlocks_.emplace_back(std::make_unique<Task[]>(kTaskBlockSize));
+        for (size_t i = 0; i + 1 < kTaskBlockSize; ++i) {
+            block[i].next = &block[i + 1];
+        }
+        block[kTaskBlockSize - 1].next = nullptr;
+        return &block[0];
+    }
+
+    bool ThreadPool::HasTask() const {
+        if (!injectionQueue_.IsEmpty()) {
+            return true;
+        }
+        // 上限に達しているBackgroundのタスクは、終わったときに起こされる
+        if (numBackgroundTasks_.load(std::memory_order_relaxed) > 0 &&
+            numRunningBackgroundTasks_.load(std::memory_order_relaxed) < maxRunningBackgroundTasks_) {
+            return true;
+        }
+        for (auto& queue : queues_) {
+            if (!queue->IsEmpty()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void ThreadPool::WakeWorker() {
+        // 寝る側はnumSleepingWorkers_を増やしてからキューを確認するので、
+        // 積んだ後に0なら寝る側が必ずタスクに気づく
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (numSleepingWorkers_.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
         {
-            std::unique_lock<std::mutex> lock(mutex_);
+            std::unique_lock<std::mutex> lock(sleepMutex_);
+            ++wakeCount_;
+        }
+        sleepCondition_.notify_one();
+        if (profiler_->IsEnabled()) {
+            profiler_->CountWakeSignal(GetProfileThread(GetQueueIndex()));
+        }
+    }
+
+    void ThreadPool::WorkerMain(size_t queueIndex) {
+        g_currentPool = this;
+        g_currentQueue = queueIndex;
+
+        uint32_t spin = 0;
+        while (true) {
+            if (RunOneTask(true)) {
+                spin = 0;
+                continue;
+            }
+            if (++spin < kSpinCount) {
+                std::this_thread::yield();
+                continue;
+            }
+            spin = 0;
+
+            std::unique_lock<std::mutex> lock(sleepMutex_);
+            numSleepingWorkers_.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!stop_ && !HasTask()) {
+                bool isProfiling = profiler_->IsEnabled();
+                if (isProfiling) {
+                    profiler_->CountSleep(queueIndex);
+                }
+                uint64_t wakeCount = wakeCount_;
+                sleepCondition_.wait(lock, [&] { return stop_ || wakeCount_ != wakeCount; });
+                if (isProfiling) {
+                    profiler_->CountWakeup(queueIndex);
+                }
+            }
+            numSleepingWorkers_.fetch_sub(1, std::memory_order_relaxed);
             if (stop_) {
-                assert(false);
                 return;
             }
-            taskQueue_.emplace(task);
         }
-        condition_.notify_one();
     }
 
-    void ThreadPool::WaitForAll() {
-        std::unique_lock<std::mutex> lock(mutex_);
-        completionCondition_.wait(lock, [this] {
-            return taskQueue_.empty() && activeTasks_ == 0;
-            });
+    ThreadPool::ProfileScope::ProfileScope(ThreadPool& threadPool, const char* name) :
+        threadPool_(threadPool),
+        name_(name),
+        start_(threadPool.profiler_->IsEnabled() ? ThreadPoolProfiler::Now() : 0) {
+    }
+
+    ThreadPool::ProfileScope::~ProfileScope() {
+        // 途中で計測が止まっていても始まっていた分は記録する
+        if (start_ != 0) {
+            threadPool_.profiler_->RecordEvent(threadPool_.GetProfileThread(threadPool_.GetQueueIndex()), name_, start_, ThreadPoolProfiler::Now());
+        }
+    }
+
+    void Internal::TaskStateBase::Wait() {
+        // 始まっていなければ自分で実行する
+        if (TryRun()) {
+            return;
+        }
+        threadPool_.WaitUntil([this]() { return IsDone(); });
     }
 
 }
\ No newline at end of file
@@ -1,41 +1,296 @@
 ///
 /// スレッドプール
-/// 
+///
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <condition_variable>
-#include <functional>
+#include <memory>
 #include <queue>
 #include <mutex>
 #include <thread>
 #include <vector>
 
+#include "MPMCQueue.h"
+#include "TaskFunction.h"
+#include "TaskFuture.h"
+#include "ThreadPoolProfiler.h"
+#include "WorkStealingDeque.h"
+
 namespace LIEngine {
 
+    /// <summary>
+    /// ワークスティーリングのスレッドプール
+    /// ワーカーと作成したスレッドがそれぞれ両端キューを持ち、
+    /// 自分のキューには後ろから積んで後ろから取り、空になったら他のキューの前から盗む
+    /// 待っている間は寝ずに他のタスクを処理する
+    /// Backgroundのタスクは別のキューに積み、手の空いたワーカーだけが処理する
+    /// タスクは使いまわし、小さい関数は中に持つので、積むたびに確保しない
+    /// </summary>
     class ThreadPool {
     public:
+        /// <summary>
+        /// 計測中のみ、範囲の時間を呼び出したスレッドの名前付きの処理として記録する
+        /// </summary>
+        class ProfileScope {
+        public:
+            /// <summary>
+            /// コンストラクタ
+            /// </summary>
+            /// <param name="threadPool">記録するプール</param>
+            /// <param name="name">静的な文字列 (計測結果を出力するまで有効なもの)</param>
+            ProfileScope(ThreadPool& threadPool, const char* name);
+            ~ProfileScope();
+            ProfileScope(const ProfileScope&) = delete;
+            ProfileScope& operator=(const ProfileScope&) = delete;
+
+        private:
+            ThreadPool& threadPool_;
+            const char* name_;
+            // 計測していなければ0
+            int64_t start_;
+        };
+
         ThreadPool(size_t threads = 0);
         ~ThreadPool();
 
         /// <summary>
         /// タスクを追加
+        /// ワーカーと作成したスレッドからは自分のキューに、他のスレッドからは共有のキューに積む
+        /// どちらもロックしない
+        /// </summary>
+        /// <param name="task">void() (キャプチャがTaskFunction::kInlineSizeを超えると確保する)</param>
+        /// <param name="priority">優先度</param>
+        void PushTask(TaskFunction task, TaskPriority priority = TaskPriority::FrameCritical);
+        /// <summary>
+        /// 結果を受け取れるタスクを追加
         /// </summary>
-        /// <param name="task"></param>
-        void PushTask(std::function<void()> task);
+        /// <param name="function">T() または T(const CancellationToken&)</param>
+        /// <param name="priority">優先度</param>
+        /// <returns>結果</returns>
+        template<typename Function>
+        auto Submit(Function&& function, TaskPriority priority = TaskPriority::FrameCritical) -> TaskFuture<Internal::TaskResultType<std::decay_t<Function>>>;
         /// <summary>
         /// すべてのタスクの終了を待つ
+        /// 待っている間は呼び出したスレッドもタスクを処理する
         /// </summary>
         void WaitForAll();
+        /// <summary>
+        /// 条件を満たすまでタスクを処理しながら待つ
+        /// 手伝うのはFrameCriticalのタスクのみ
+        /// </summary>
+        /// <param name="predicate">bool()</param>
+        template<typename Predicate>
+        void WaitUntil(Predicate&& predicate);
+        /// <summary>
+        /// 塊を空いているスレッドから順に取っていく
+        /// 呼び出したスレッドも処理し、全ての塊が終わるまで戻らない
+        /// </summary>
+        /// <param name="numWorkers">処理するスレッド数 (呼び出したスレッドを含む)</param>
+        /// <param name="numChunks">塊の数</param>
+        /// <param name="work">void(塊の番号, 処理しているスレッドの番号[0,numWorkers))</param>
+        template<typename Work>
+        void ParallelChunks(size_t numWorkers, size_t numChunks, Work&& work);
+        /// <summary>
+        /// [begin,end)の各番号でfunctionを呼ぶ
+        /// </summary>
+        /// <param name="function">void(size_t index)</param>
+        /// <param name="grainSize">1つの塊の数 (0ならスレッド数によらず自動で決める)</param>
+        template<typename Function>
+        void ParallelFor(size_t begin, size_t end, Function&& function, size_t grainSize = 0);
+        /// <summary>
+        /// [begin,end)の各番号をmapで変換し、reduceでまとめる
+        /// 塊の中は番号順、塊どうしは塊の順にまとめるので、grainSizeが同じなら結果は同じ
+        /// </summary>
+        /// <param name="identity">単位元</param>
+        /// <param name="map">T(size_t index)</param>
+        /// <param name="reduce">T(T, T)</param>
+        /// <param name="grainSize">1つの塊の数 (0ならスレッド数によらず自動で決める)</param>
+        template<typename T, typename Map, typename Reduce>
+        T ParallelReduce(size_t begin, size_t end, T identity, Map&& map, Reduce&& reduce, size_t grainSize = 0);
+
+        size_t GetNumThreads() const { return workers_.size(); }
+        /// <summary>
+        /// 計測 (Startを呼ぶまでは各所でIsEnabledを確認するだけ)
+        /// スレッドの番号は0が作成したスレッド、1以降がワーカー、最後がキューを持たないスレッド
+        /// </summary>
+        ThreadPoolProfiler& GetProfiler() { return *profiler_; }
 
     private:
+        struct alignas(64) Task {
+            TaskFunction function;
+            TaskPriority priority = TaskPriority::FrameCritical;
+            union {
+                // 使い終わったタスクのリスト
+                Task* next = nullptr;
+                // 積んだ時間 (計測中のみ)
+                int64_t enqueueTime;
+            };
+        };
+        // スレッドごとの使い終わったタスク
+        struct alignas(64) TaskCache {
+            Task* freeList = nullptr;
+            size_t numTasks = 0;
+        };
+
+        // 自動で分けるときの塊の数
+        static constexpr size_t kAutoChunks = 64;
+        static constexpr size_t kNoQueue = SIZE_MAX;
+        // キューを持たないスレッドから積めるタスク数
+        static constexpr size_t kInjectionCapacity = 4096;
+        // 一度に確保するタスク数
+        static constexpr size_t kTaskBlockSize = 256;
+        // スレッドと共有のリストの間で一度に移すタスク数
+        static constexpr size_t kTaskBatchSize = 64;
+        // 共有のリストに置ける使い終わったタスク数
+        static constexpr size_t kSharedTaskCapacity = 16384;
+        // スレッドが持っておく最大のタスク数
+        static constexpr size_t kMaxCachedTasks = 512;
+
+        /// <summary>
+        /// 呼び出したスレッドのキューの番号
+        /// 0は作成したスレッド、1以降はワーカー、キューを持たないスレッドはkNoQueue
+        /// </summary>
+        size_t GetQueueIndex() const;
+        /// <summary>
+        /// 計測で使うスレッドの番号
+        /// </summary>
+        size_t GetProfileThread(size_t queueIndex) const { return queueIndex != kNoQueue ? queueIndex : queues_.size(); }
+        /// <summary>
+        /// タスクを1つ探して実行する
+        /// </summary>
+        /// <param name="allowBackground">Backgroundのタスクも実行するか</param>
+        /// <returns>実行したか</returns>
+        bool RunOneTask(bool allowBackground);
+        Task* FindTask(size_t queueIndex, bool allowBackground);
+        Task* PopBackgroundTask();
+        /// <summary>
+        /// 使い終わったタスクを取得 (なければまとめて確保)
+        /// </summary>
+        Task* AllocateTask();
+        /// <summary>
+        /// 使い終わったタスクを戻す
+        /// </summary>
+        void FreeTask(Task* task);
+        /// <summary>
+        /// タスクをまとめて確保する
+        /// </summary>
+        /// <returns>確保したタスクのリスト (kTaskBlockSize個)</returns>
+        Task* AllocateTaskBlock();
+        bool HasTask() const;
+        void WakeWorker();
+        void WorkerMain(size_t queueIndex);
+        static size_t GetGrainSize(size_t count, size_t grainSize) {
+            return grainSize > 0 ? grainSize : std::max<size_t>(1, (count + kAutoChunks - 1) / kAutoChunks);
+        }
+
         std::vector<std::thread> workers_;
-        std::queue<std::function<void()>> taskQueue_;
-        std::mutex mutex_;
-        std::condition_variable condition_;
-        std::condition_variable completionCondition_;
+        std::vector<std::unique_ptr<WorkStealingDeque<Task*>>> queues_;
+        std::thread::id ownerThread_;
+        // キューを持たないスレッドから追加されたタスク
+        MPMCQueue<Task*> injectionQueue_;
+        // Backgroundのタスク
+        std::queue<Task*> backgroundQueue_;
+        std::mutex backgroundMutex_;
+        std::atomic<size_t> numBackgroundTasks_;
+        // 実行中のBackgroundのタスク数と上限 (FrameCriticalのためにワーカーを残す)
+        std::atomic<size_t> numRunningBackgroundTasks_;
+        size_t maxRunningBackgroundTasks_;
+        // タスクの使いまわし
+        std::vector<TaskCache> taskCaches_;
+        MPMCQueue<Task*> sharedFreeTasks_;
+        std::mutex taskBlockMutex_;
+        std::vector<std::unique_ptr<Task[]>> taskBlocks_;
+        // 追加されてまだ終わっていないタスク数
+        std::atomic<size_t> numPendingTasks_;
+        // タスクが見つからないワーカーはここで寝る
+        std::mutex sleepMutex_;
+        std::condition_variable sleepCondition_;
+        std::atomic<size_t> numSleepingWorkers_;
+        uint64_t wakeCount_;
         bool stop_;
-        size_t activeTasks_;
+        std::unique_ptr<ThreadPoolProfiler> profiler_;
     };
 
+    template<typename Function>
+    auto ThreadPool::Submit(Function&& function, TaskPriority priority) -> TaskFuture<Internal::TaskResultType<std::decay_t<Function>>> {
+        using Result = Internal::TaskResultType<std::decay_t<Function>>;
+        auto state = std::make_shared<Internal::TaskState<Result, std::decay_t<Function>>>(*this, std::decay_t<Function>(std::forward<Function>(function)));
+        // 待っているスレッドが先に実行していれば何もしない
+        PushTask([state]() { state->TryRun(); }, priority);
+        return TaskFuture<Result>(std::move(state));
+    }
+
+    template<typename Predicate>
+    void ThreadPool::WaitUntil(Predicate&& predicate) {
+        while (!predicate()) {
+            if (!RunOneTask(false)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    template<typename Work>
+    void ThreadPool::ParallelChunks(size_t numWorkers, size_t numChunks, Work&& work) {
+        std::atomic<size_t> nextChunk = 0;
+        auto Run = [&](size_t worker) {
+            for (size_t chunk = nextChunk.fetch_add(1); chunk < numChunks; chunk = nextChunk.fetch_add(1)) {
+                work(chunk, worker);
+            }
+            };
+        size_t numTasks = numWorkers > 0 ? numWorkers - 1 : 0;
+        std::atomic<size_t> numRunning = numTasks;
+        for (size_t i = 0; i < numTasks; ++i) {
+            PushTask([&, i]() {
+                Run(i + 1);
+                numRunning.fetch_sub(1, std::memory_order_release);
+                });
+        }
+        Run(0);
+        // 塊を取り終えても他のスレッドがまだ処理している
+        WaitUntil([&]() { return numRunning.load(std::memory_order_acquire) == 0; });
+    }
+
+    template<typename Function>
+    void ThreadPool::ParallelFor(size_t begin, size_t end, Function&& function, size_t grainSize) {
+        if (begin >= end) { return; }
+        size_t grain = GetGrainSize(end - begin, grainSize);
+        size_t numChunks = (end - begin + grain - 1) / grain;
+        if (workers_.empty() || numChunks < 2) {
+            for (size_t i = begin; i < end; ++i) { function(i); }
+            return;
+        }
+        ParallelChunks(std::min(GetNumThreads() + 1, numChunks), numChunks, [&](size_t chunk, size_t) {
+            size_t chunkBegin = begin + chunk * grain;
+            size_t chunkEnd = std::min(end, chunkBegin + grain);
+            for (size_t i = chunkBegin; i < chunkEnd; ++i) { function(i); }
+            });
+    }
+
+    template<typename T, typename Map, typename Reduce>
+    T ThreadPool::ParallelReduce(size_t begin, size_t end, T identity, Map&& map, Reduce&& reduce, size_t grainSize) {
+        if (begin >= end) { return identity; }
+        size_t grain = GetGrainSize(end - begin, grainSize);
+        size_t numChunks = (end - begin + grain - 1) / grain;
+        std::vector<T> partials(numChunks, identity);
+        auto ReduceChunk = [&](size_t chunk, size_t) {
+            size_t chunkBegin = begin + chunk * grain;
+            size_t chunkEnd = std::min(end, chunkBegin + grain);
+            T result = identity;
+            for (size_t i = chunkBegin; i < chunkEnd; ++i) { result = reduce(result, map(i)); }
+            partials[chunk] = result;
+            };
+        if (workers_.empty() || numChunks < 2) {
+            for (size_t chunk = 0; chunk < numChunks; ++chunk) { ReduceChunk(chunk, 0); }
+        }
+        else {
+            ParallelChunks(std::min(GetNumThreads() + 1, numChunks), numChunks, ReduceChunk);
+        }
+        T result = identity;
+        for (auto& partial : partials) { result = reduce(result, partial); }
+        return result;
+    }
+
 }
\ No newline at end of file
@@ -0,0 +1,228 @@
+#include "ThreadPoolProfiler.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <map>
+
+namespace {
+
+    using namespace LIEngine;
+
+    // 名前のないイベント
+    const char kTaskName[] = "Task";
+
+    double ToMilliseconds(int64_t nanoseconds) { return double(nanoseconds) * 1e-6; }
+    double ToMicroseconds(int64_t nanoseconds) { return double(nanoseconds) * 1e-3; }
+
+}
+
+namespace LIEngine {
+
+    ThreadPoolProfiler::ThreadPoolProfiler(size_t numQueues) :
+        isEnabled_(false),
+        startTime_(0),
+        stopTime_(0) {
+        // 最後はキューを持たないスレッド
+        for (size_t i = 0; i < numQueues + 1; ++i) {
+            records_.emplace_back(std::make_unique<ThreadRecord>());
+        }
+    }
+
+    void ThreadPoolProfiler::Start() {
+        for (auto& record : records_) {
+            record->busyNanoseconds = 0;
+            record->numTasks = 0;
+            record->numBackgroundTasks = 0;
+            record->numSteals = 0;
+            record->numInjectedTasks = 0;
+            record->numSleeps = 0;
+            record->numWakeups = 0;
+            record->numWakeSignals = 0;
+            for (auto& count : record->latencyHistogram) { count = 0; }
+            std::lock_guard<std::mutex> lock(record->eventMutex);
+            record->events.clear();
+            record->numDroppedEvents = 0;
+        }
+        startTime_ = Now();
+        stopTime_ = 0;
+        isEnabled_.store(true, std::memory_order_relaxed);
+    }
+
+    void ThreadPoolProfiler::Stop() {
+        if (!IsEnabled()) { return; }
+        isEnabled_.store(false, std::memory_order_relaxed);
+        stopTime_ = Now();
+    }
+
+    int64_t ThreadPoolProfiler::Now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void ThreadPoolProfiler::RecordTask(size_t thread, int64_t enqueueTime, int64_t start, int64_t end, bool isBackground) {
+        ThreadRecord& record = *records_[thread];
+        record.busyNanoseconds.fetch_add(uint64_t(end - start), std::memory_order_relaxed);
+        record.numTasks.fetch_add(1, std::memory_order_relaxed);
+        if (isBackground) {
+            record.numBackgroundTasks.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (enqueueTime != 0) {
+            record.latencyHistogram[GetLatencyBucket(start - enqueueTime)].fetch_add(1, std::memory_order_relaxed);
+        }
+        RecordEvent(thread, nullptr, start, end);
+    }
+
+    void ThreadPoolProfiler::RecordEvent(size_t thread, const char* name, int64_t start, int64_t end) {
+        ThreadRecord& record = *records_[thread];
+        std::lock_guard<std::mutex> lock(record.eventMutex);
+        if (record.events.size() >= kMaxEventsPerThread) {
+            ++record.numDroppedEvents;
+            return;
+        }
+        record.events.push_back({ name, start, end });
+    }
+
+    nlohmann::json ThreadPoolProfiler::ExportJson() const {
+        int64_t elapsed = GetElapsed();
+        nlohmann::json json;
+        json["duration_ms"] = ToMilliseconds(elapsed);
+
+        std::array<uint64_t, kNumLatencyBuckets> latencyHistogram{};
+        struct NamedTotal {
+            uint64_t count = 0;
+            int64_t total = 0;
+            int64_t max = 0;
+        };
+        std::map<std::string, NamedTotal> namedTotals;
+        uint64_t numDroppedEvents = 0;
+
+        nlohmann::json threads = nlohmann::json::array();
+        for (size_t i = 0; i < records_.size(); ++i) {
+            const ThreadRecord& record = *records_[i];
+            uint64_t busy = record.busyNanoseconds.load(std::memory_order_relaxed);
+            uint64_t numTasks = record.numTasks.load(std::memory_order_relaxed);
+            nlohmann::json thread;
+            thread["name"] = GetThreadName(i);
+            thread["tasks"] = numTasks;
+            thread["background_tasks"] = record.numBackgroundTasks.load(std::memory_order_relaxed);
+            thread["busy_ms"] = ToMilliseconds(int64_t(busy));
+            thread["idle_ms"] = ToMilliseconds(std::max<int64_t>(0, elapsed - int64_t(busy)));
+            thread["utilization"] = elapsed > 0 ? double(busy) / double(elapsed) : 0.0;
+            thread["steals"] = record.numSteals.load(std::memory_order_relaxed);
+            thread["injected_tasks"] = record.numInjectedTasks.load(std::memory_order_relaxed);
+            thread["sleeps"] = record.numSleeps.load(std::memory_order_relaxed);
+            thread["wakeups"] = record.numWakeups.load(std::memory_order_relaxed);
+            thread["wake_signals"] = record.numWakeSignals.load(std::memory_order_relaxed);
+            for (size_t bucket = 0; bucket < kNumLatencyBuckets; ++bucket) {
+                latencyHistogram[bucket] += record.latencyHistogram[bucket].load(std::memory_order_relaxed);
+            }
+            threads.push_back(thread);
+
+            std::lock_guard<std::mutex> lock(record.eventMutex);
+            for (auto& event : record.events) {
+                if (!event.name) { continue; }
+                auto& total = namedTotals[event.name];
+                int64_t duration = event.end - event.start;
+                ++total.count;
+                total.total += duration;
+                total.max = std::max(total.max, duration);
+            }
+            numDroppedEvents += record.numDroppedEvents;
+        }
+        json["threads"] = threads;
+
+        // 待ち時間は区間の上端で百分位を求める
+        nlohmann::json latency;
+        nlohmann::json histogram = nlohmann::json::array();
+        uint64_t numSamples = 0;
+        for (uint64_t count : latencyHistogram) { numSamples += count; }
+        latency["count"] = numSamples;
+        std::pair<const char*, double> percentiles[] = { { "p50_ns", 0.5 }, { "p90_ns", 0.9 }, { "p99_ns", 0.99 } };
+        for (auto& [key, ratio] : percentiles) {
+            uint64_t threshold = uint64_t(std::ceil(double(numSamples) * ratio));
+            uint64_t accumulated = 0;
+            uint64_t value = 0;
+            for (size_t bucket = 0; bucket < kNumLatencyBuckets && numSamples > 0; ++bucket) {
+                accumulated += latencyHistogram[bucket];
+                if (accumulated >= threshold) {
+                    value = uint64_t(2) << bucket;
+                    break;
+                }
+            }
+            latency[key] = value;
+        }
+        for (size_t bucket = 0; bucket < kNumLatencyBuckets; ++bucket) {
+            if (latencyHistogram[bucket] == 0) { continue; }
+            histogram.push_back({ { "min_ns", bucket == 0 ? 0 : uint64_t(1) << bucket }, { "max_ns", uint64_t(2) << bucket }, { "count", latencyHistogram[bucket] } });
+        }
+        latency["histogram"] = histogram;
+        json["latency"] = latency;
+
+        // 合計時間の長い順
+        std::vector<std::pair<std::string, NamedTotal>> sortedTotals(namedTotals.begin(), namedTotals.end());
+        std::sort(sortedTotals.begin(), sortedTotals.end(), [](auto& a, auto& b) { return a.second.total > b.second.total; });
+        nlohmann::json named = nlohmann::json::array();
+        for (auto& [name, total] : sortedTotals) {
+            named.push_back({
+                { "name", name },
+                { "count", total.count },
+                { "total_ms", ToMilliseconds(total.total) },
+                { "average_us", ToMicroseconds(total.total) / double(total.count) },
+                { "max_us", ToMicroseconds(total.max) } });
+        }
+        json["named_tasks"] = named;
+        json["dropped_events"] = numDroppedEvents;
+        return json;
+    }
+
+    nlohmann::json ThreadPoolProfiler::ExportChromeTrace() const {
+        nlohmann::json events = nlohmann::json::array();
+        for (size_t i = 0; i < records_.size(); ++i) {
+            events.push_back({ { "name", "thread_name" }, { "ph", "M" }, { "pid", 0 }, { "tid", i }, { "args", { { "name", GetThreadName(i) } } } });
+            const ThreadRecord& record = *records_[i];
+            std::lock_guard<std::mutex> lock(record.eventMutex);
+            for (auto& event : record.events) {
+                events.push_back({
+                    { "name", event.name ? event.name : kTaskName },
+                    { "ph", "X" },
+                    { "pid", 0 },
+                    { "tid", i },
+                    { "ts", ToMicroseconds(event.start - startTime_) },
+                    { "dur", ToMicroseconds(event.end - event.start) } });
+            }
+        }
+        nlohmann::json json;
+        json["traceEvents"] = events;
+        json["displayTimeUnit"] = "ms";
+        return json;
+    }
+
+    bool ThreadPoolProfiler::Save(const std::filesystem::path& path, bool chromeTrace) const {
+        std::ofstream file(path);
+        if (!file) {
+            return false;
+        }
+        file << (chromeTrace ? ExportChromeTrace() : ExportJson()).dump(4);
+        return bool(file);
+    }
+
+    size_t ThreadPoolProfiler::GetLatencyBucket(int64_t nanoseconds) {
+        if (nanoseconds < 2) { return 0; }
+        size_t bucket = size_t(std::bit_width(uint64_t(nanoseconds))) - 1;
+        return std::min(bucket, kNumLatencyBuckets - 1);
+    }
+
+    std::string ThreadPoolProfiler::GetThreadName(size_t thread) const {
+        if (thread == 0) { return "Owner"; }
+        if (thread + 1 == records_.size()) { return "External"; }
+        return "Worker " + std::to_string(thread);
+    }
+
+    int64_t ThreadPoolProfiler::GetElapsed() const {
+        if (startTime_ == 0) { return 0; }
+        return (IsEnabled() ? Now() : stopTime_) - startTime_;
+    }
+
+}
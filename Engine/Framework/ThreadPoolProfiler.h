@@ -0,0 +1,135 @@
+///
+/// スレッドプールの計測
+///
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Externals/nlohmann/json.hpp"
+
+namespace LIEngine {
+
+    /// <summary>
+    /// スレッドプールのスレッドごとの稼働時間、盗んだ数、起きた数、
+    /// 積んでから始まるまでの時間の分布、名前付きの処理の時間を集める
+    /// 計測していない間は呼び出し元がIsEnabledを確認するだけ
+    /// </summary>
+    class ThreadPoolProfiler {
+    public:
+        // 待ち時間の分布の区間数 (i番目は[2^i, 2^(i+1))ナノ秒、0番目は[0, 2))
+        static constexpr size_t kNumLatencyBuckets = 40;
+        // 1スレッドが記録する最大のイベント数 (超えた分は数だけ数える)
+        static constexpr size_t kMaxEventsPerThread = 1 << 18;
+
+        /// <summary>
+        /// 時間の記録
+        /// </summary>
+        struct Event {
+            // 静的な文字列 (nullptrはスレッドプールのタスク)
+            const char* name;
+            int64_t start;
+            int64_t end;
+        };
+
+        /// <summary>
+        /// スレッドごとの記録
+        /// </summary>
+        struct alignas(64) ThreadRecord {
+            // タスクを実行していた時間
+            std::atomic<uint64_t> busyNanoseconds = 0;
+            std::atomic<uint64_t> numTasks = 0;
+            std::atomic<uint64_t> numBackgroundTasks = 0;
+            // 他のキューから盗んだ数
+            std::atomic<uint64_t> numSteals = 0;
+            // キューを持たないスレッドから積まれたものを取った数
+            std::atomic<uint64_t> numInjectedTasks = 0;
+            // 寝た数、起こされた数、他を起こした数
+            std::atomic<uint64_t> numSleeps = 0;
+            std::atomic<uint64_t> numWakeups = 0;
+            std::atomic<uint64_t> numWakeSignals = 0;
+            // 積んでから始まるまでの時間の分布
+            std::array<std::atomic<uint64_t>, kNumLatencyBuckets> latencyHistogram{};
+            // キューを持たないスレッドは共有するのでロックする
+            mutable std::mutex eventMutex;
+            std::vector<Event> events;
+            uint64_t numDroppedEvents = 0;
+        };
+
+        /// <summary>
+        /// コンストラクタ
+        /// </summary>
+        /// <param name="numQueues">キューを持つスレッドの数 (キューを持たないスレッドの分を1つ足して記録する)</param>
+        explicit ThreadPoolProfiler(size_t numQueues);
+
+        /// <summary>
+        /// 記録を消して計測を始める
+        /// </summary>
+        void Start();
+        /// <summary>
+        /// 計測を止める (記録は残る)
+        /// </summary>
+        void Stop();
+        bool IsEnabled() const { return isEnabled_.load(std::memory_order_relaxed); }
+
+        /// <summary>
+        /// 現在の時間 (ナノ秒)
+        /// </summary>
+        static int64_t Now();
+
+        /// <summary>
+        /// タスクの実行を記録
+        /// </summary>
+        /// <param name="thread">スレッドの番号</param>
+        /// <param name="enqueueTime">積んだ時間 (計測前に積んだものは0)</param>
+        void RecordTask(size_t thread, int64_t enqueueTime, int64_t start, int64_t end, bool isBackground);
+        /// <summary>
+        /// 名前付きの処理を記録
+        /// </summary>
+        /// <param name="name">静的な文字列</param>
+        void RecordEvent(size_t thread, const char* name, int64_t start, int64_t end);
+        void CountSteal(size_t thread) { records_[thread]->numSteals.fetch_add(1, std::memory_order_relaxed); }
+        void CountInjectedTask(size_t thread) { records_[thread]->numInjectedTasks.fetch_add(1, std::memory_order_relaxed); }
+        void CountSleep(size_t thread) { records_[thread]->numSleeps.fetch_add(1, std::memory_order_relaxed); }
+        void CountWakeup(size_t thread) { records_[thread]->numWakeups.fetch_add(1, std::memory_order_relaxed); }
+        void CountWakeSignal(size_t thread) { records_[thread]->numWakeSignals.fetch_add(1, std::memory_order_relaxed); }
+
+        /// <summary>
+        /// 集計をJSONで出力
+        /// スレッドごとの稼働率、盗んだ数、起きた数、待ち時間の分布と百分位、名前ごとの時間
+        /// </summary>
+        nlohmann::json ExportJson() const;
+        /// <summary>
+        /// chrome://tracing や Perfetto で開ける形式で出力
+        /// </summary>
+        nlohmann::json ExportChromeTrace() const;
+        /// <summary>
+        /// ファイルに保存
+        /// </summary>
+        /// <param name="chromeTrace">ExportChromeTraceの形式にするか</param>
+        /// <returns>成功したか</returns>
+        bool Save(const std::filesystem::path& path, bool chromeTrace) const;
+
+        size_t GetNumThreads() const { return records_.size(); }
+        const ThreadRecord& GetRecord(size_t thread) const { return *records_[thread]; }
+
+    private:
+        static size_t GetLatencyBucket(int64_t nanoseconds);
+        std::string GetThreadName(size_t thread) const;
+        // 計測した時間 (計測中なら今まで)
+        int64_t GetElapsed() const;
+
+        std::vector<std::unique_ptr<ThreadRecord>> records_;
+        std::atomic<bool> isEnabled_;
+        int64_t startTime_;
+        int64_t stopTime_;
+    };
+
+}
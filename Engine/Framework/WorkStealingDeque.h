@@ -0,0 +1,158 @@
+///
+/// ワークスティーリング用の両端キュー
+///
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace LIEngine {
+
+    /// <summary>
+    /// Chase-Levの両端キュー
+    /// 持ち主のスレッドだけが後ろに積んで後ろから取り、他のスレッドは前から盗む
+    /// 持ち主の操作はロックも比較交換もなく、最後の1つを取り合う時だけ比較交換する
+    /// </summary>
+    /// <typeparam name="T">ポインタなど、コピーが軽くアトミックに読み書きできる型</typeparam>
+    template<typename T>
+    class WorkStealingDeque {
+    public:
+        /// <summary>
+        /// コンストラクタ
+        /// </summary>
+        /// <param name="capacity">初期容量 (2の累乗)</param>
+        explicit WorkStealingDeque(size_t capacity = 256);
+        WorkStealingDeque(const WorkStealingDeque&) = delete;
+        WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+        /// <summary>
+        /// 後ろに積む (持ち主のみ)
+        /// 一杯なら容量を倍にする
+        /// </summary>
+        void Push(T item);
+        /// <summary>
+        /// 後ろから取る (持ち主のみ)
+        /// </summary>
+        /// <returns>取れたか</returns>
+        bool Pop(T& item);
+        /// <summary>
+        /// 前から盗む (どのスレッドからでも)
+        /// </summary>
+        /// <returns>取れたか (他と取り合って負けた場合もfalse)</returns>
+        bool Steal(T& item);
+
+        /// <summary>
+        /// おおよその数 (他のスレッドが操作中なら古い値)
+        /// </summary>
+        size_t GetSize() const {
+            int64_t bottom = bottom_.load(std::memory_order_relaxed);
+            int64_t top = top_.load(std::memory_order_relaxed);
+            return bottom > top ? size_t(bottom - top) : 0;
+        }
+        bool IsEmpty() const { return GetSize() == 0; }
+
+    private:
+        // 循環バッファ
+        struct Array {
+            explicit Array(size_t capacity) :
+                mask(capacity - 1),
+                items(std::make_unique<std::atomic<T>[]>(capacity)) {
+            }
+
+            size_t GetCapacity() const { return mask + 1; }
+            T Load(int64_t index) const { return items[size_t(index) & mask].load(std::memory_order_relaxed); }
+            void Store(int64_t index, T item) { items[size_t(index) & mask].store(item, std::memory_order_relaxed); }
+
+            size_t mask;
+            std::unique_ptr<std::atomic<T>[]> items;
+        };
+
+        Array* Grow(Array* array, int64_t bottom, int64_t top);
+
+        // 盗む側と持ち主で別のキャッシュラインに置く
+        alignas(64) std::atomic<int64_t> top_;
+        alignas(64) std::atomic<int64_t> bottom_;
+        std::atomic<Array*> array_;
+        // 盗む側がまだ古い配列を読んでいるかもしれないので、破棄するまで残す
+        std::vector<std::unique_ptr<Array>> arrays_;
+    };
+
+    template<typename T>
+    WorkStealingDeque<T>::WorkStealingDeque(size_t capacity) :
+        top_(0),
+        bottom_(0) {
+        assert(capacity > 0 && (capacity & (capacity - 1)) == 0);
+        arrays_.emplace_back(std::make_unique<Array>(capacity));
+        array_.store(arrays_.back().get(), std::memory_order_relaxed);
+    }
+
+    template<typename T>
+    void WorkStealingDeque<T>::Push(T item) {
+        int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        int64_t top = top_.load(std::memory_order_acquire);
+        Array* array = array_.load(std::memory_order_relaxed);
+        if (bottom - top >= int64_t(array->GetCapacity())) {
+            array = Grow(array, bottom, top);
+        }
+        array->Store(bottom, item);
+        // 盗む側がbottomを読んだら中身も見えるようにする
+        bottom_.store(bottom + 1, std::memory_order_release);
+    }
+
+    template<typename T>
+    bool WorkStealingDeque<T>::Pop(T& item) {
+        int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        Array* array = array_.load(std::memory_order_relaxed);
+        bottom_.store(bottom, std::memory_order_relaxed);
+        // 盗む側とtopの読み書きの順番をそろえる
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = top_.load(std::memory_order_relaxed);
+        if (top > bottom) {
+            // 空だった
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return false;
+        }
+        item = array->Load(bottom);
+        if (top == bottom) {
+            // 最後の1つは盗む側と取り合う
+            bool won = top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    template<typename T>
+    bool WorkStealingDeque<T>::Steal(T& item) {
+        int64_t top = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t bottom = bottom_.load(std::memory_order_acquire);
+        if (top >= bottom) {
+            return false;
+        }
+        Array* array = array_.load(std::memory_order_acquire);
+        T stolen = array->Load(top);
+        if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return false;
+        }
+        item = stolen;
+        return true;
+    }
+
+    template<typename T>
+    typename WorkStealingDeque<T>::Array* WorkStealingDeque<T>::Grow(Array* array, int64_t bottom, int64_t top) {
+        auto grown = std::make_unique<Array>(array->GetCapacity() * 2);
+        for (int64_t i = top; i < bottom; ++i) {
+            grown->Store(i, array->Load(i));
+        }
+        Array* result = grown.get();
+        arrays_.emplace_back(std::move(grown));
+        array_.store(result, std::memory_order_release);
+        return result;
+    }
+
+}
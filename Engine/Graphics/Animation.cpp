@@ -7,6 +7,7 @@
 #include <assimp/postprocess.h>
 
 #include "Debug/Debug.h"
+#include "File/AssimpIOSystem.h"
 
 namespace {
 
@@ -72,6 +73,8 @@ namespace LIEngine {
         auto directory = path.parent_path();
 
         Assimp::Importer importer;
+        // アーカイブからも読む
+        importer.SetIOHandler(new AssimpIOSystem);
         int flags = 0;
         const aiScene* scene = importer.ReadFile(path.string(), flags);
         // 読み込めた
@@ -90,6 +93,18 @@ namespace LIEngine {
         return animation;
     }
 
+    size_t Animation::GetCPUMemorySize() const {
+        size_t size = 0;
+        for (auto& [animationName, animationSet] : animationSet_) {
+            for (auto& [nodeName, nodeAnimation] : animationSet.nodeAnimations) {
+                size += nodeAnimation.translate.keyframes.size() * sizeof(Keyframe<Vector3>);
+                size += nodeAnimation.rotate.keyframes.size() * sizeof(Keyframe<Quaternion>);
+                size += nodeAnimation.scale.keyframes.size() * sizeof(Keyframe<Vector3>);
+            }
+        }
+        return size;
+    }
+
     Vector3 CalculateValue(const AnimationCurve<Vector3>& animationCurve, float time) {
         assert(!animationCurve.keyframes.empty());
         if (animationCurve.keyframes.size() == 1 || time <= animationCurve.keyframes[0].time) {
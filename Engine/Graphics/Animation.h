@@ -44,6 +44,8 @@ namespace LIEngine {
         static std::shared_ptr<Animation> Load(const std::filesystem::path& path);
 
         AnimationSet& GetAnimation(const std::string& name) { return animationSet_.at(name); }
+        // メモリ使用量 (バイト)
+        size_t GetCPUMemorySize() const;
 
     private:
         std::map<std::string, AnimationSet> animationSet_;
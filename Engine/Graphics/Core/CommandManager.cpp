@@ -27,6 +27,7 @@ namespace LIEngine {
 
     void CommandManager::Execute() {
         std::lock_guard<std::mutex> lock(mutex_);
+        if (closedCommandLists_.empty()) { return; }
         std::vector<ID3D12CommandList*> pplist(closedCommandLists_.size());
         for (size_t i = 0; i < pplist.size(); ++i) {
             pplist[i] = closedCommandLists_[i].Get();
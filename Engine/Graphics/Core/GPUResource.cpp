@@ -12,6 +12,14 @@ namespace LIEngine {
         }
     }
 
+    size_t GPUResource::GetGPUMemorySize() const {
+        if (!resource_) {
+            return 0;
+        }
+        D3D12_RESOURCE_DESC desc = resource_->GetDesc();
+        return static_cast<size_t>(Graphics::GetInstance()->GetDevice()->GetResourceAllocationInfo(0, 1, &desc).SizeInBytes);
+    }
+
     void GPUResource::CreateResource(
         const std::wstring& name,
         const D3D12_HEAP_PROPERTIES& heapProperties,
@@ -24,6 +24,8 @@ namespace LIEngine {
         D3D12_GPU_VIRTUAL_ADDRESS GetGPUVirtualAddress() const { return resource_->GetGPUVirtualAddress(); }
 
         virtual void Destroy();
+        // ビデオメモリの使用量 (バイト)
+        size_t GetGPUMemorySize() const;
 
         void CreateResource(
             const std::wstring& name,
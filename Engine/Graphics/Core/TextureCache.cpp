@@ -0,0 +1,113 @@
+#include "TextureCache.h"
+
+#include "Externals/DirectXTex/Include/DirectXTex.h"
+
+#include "File/BinaryStream.h"
+#include "File/ContentHash.h"
+#include "File/MappedFile.h"
+#include "File/VirtualFileSystem.h"
+
+namespace {
+    using namespace LIEngine;
+
+    const uint32_t kCacheMagic = 0x5854494C; // "LITX"
+    // ミップマップの生成方法やファイルの形式を変えたら上げる
+    const uint32_t kCacheVersion = 1;
+    const std::filesystem::path kCacheDirectory = "Cache/Textures";
+    const size_t kDDSAlignment = 16;
+
+    struct CacheHeader {
+        uint32_t magic;
+        uint32_t version;
+        // 元のファイルの中身のハッシュ
+        uint64_t sourceHash;
+        // 中身を読まずに変わっていないか確かめる用
+        uint64_t sourceSize;
+        int64_t sourceWriteTime;
+        uint32_t useSRGB;
+        uint32_t reserved;
+        uint64_t ddsOffset;
+        uint64_t ddsSize;
+    };
+
+    // 元のファイルのパスとsRGBの指定ごとに1つ
+    std::filesystem::path GetCachePath(const std::filesystem::path& sourcePath, bool useSRGB) {
+        std::string pathString = sourcePath.lexically_normal().generic_string();
+        uint64_t pathHash = ContentHash::Compute(pathString.data(), pathString.size(), useSRGB ? 1 : 0);
+        return kCacheDirectory / (sourcePath.stem().string() + "_" + ContentHash::ToString(pathHash) + ".dds");
+    }
+
+}
+
+namespace LIEngine {
+
+    namespace TextureCache {
+
+        bool Load(const std::filesystem::path& sourcePath, bool useSRGB, DirectX::ScratchImage& mipImages) {
+            MappedFile cacheFile;
+            if (!cacheFile.Open(GetCachePath(sourcePath, useSRGB))) {
+                return false;
+            }
+            BinaryReader reader(cacheFile.GetData(), cacheFile.GetSize());
+            CacheHeader header = reader.Read<CacheHeader>();
+            if (!reader.IsValid() ||
+                header.magic != kCacheMagic ||
+                header.version != kCacheVersion ||
+                header.useSRGB != uint32_t(useSRGB)) {
+                return false;
+            }
+
+            VirtualFileSystem::FileInfo sourceInfo;
+            if (!VirtualFileSystem::GetFileInfo(sourcePath, sourceInfo) || sourceInfo.size != header.sourceSize) {
+                return false;
+            }
+            // アーカイブ内のものは目次のハッシュで確かめる
+            if (sourceInfo.isInArchive) {
+                if (sourceInfo.contentHash != header.sourceHash) {
+                    return false;
+                }
+            }
+            // 更新日時だけ変わった (チェックアウトしなおした等) なら中身で確かめる
+            else if (sourceInfo.writeTime != header.sourceWriteTime && ContentHash::ComputeFile(sourcePath) != header.sourceHash) {
+                return false;
+            }
+
+            reader.Seek(header.ddsOffset);
+            const void* dds = reader.ReadBytes(header.ddsSize);
+            if (!dds) {
+                return false;
+            }
+            return SUCCEEDED(DirectX::LoadFromDDSMemory(dds, header.ddsSize, DirectX::DDS_FLAGS_NONE, nullptr, mipImages));
+        }
+
+        void Save(const std::filesystem::path& sourcePath, bool useSRGB, const DirectX::ScratchImage& mipImages) {
+            CacheHeader header{};
+            header.magic = kCacheMagic;
+            header.version = kCacheVersion;
+            header.useSRGB = useSRGB;
+            VirtualFileSystem::FileInfo sourceInfo;
+            if (!VirtualFileSystem::GetFileInfo(sourcePath, sourceInfo)) {
+                return;
+            }
+            header.sourceSize = sourceInfo.size;
+            header.sourceWriteTime = sourceInfo.writeTime;
+            header.sourceHash = VirtualFileSystem::ComputeContentHash(sourcePath);
+
+            DirectX::Blob dds;
+            if (FAILED(DirectX::SaveToDDSMemory(mipImages.GetImages(), mipImages.GetImageCount(), mipImages.GetMetadata(), DirectX::DDS_FLAGS_NONE, dds))) {
+                return;
+            }
+
+            BinaryWriter writer;
+            writer.Write(header);
+            writer.Align(kDDSAlignment);
+            header.ddsOffset = writer.GetSize();
+            header.ddsSize = dds.GetBufferSize();
+            writer.WriteBytes(dds.GetBufferPointer(), dds.GetBufferSize());
+            writer.Overwrite(0, header);
+            writer.SaveFile(GetCachePath(sourcePath, useSRGB));
+        }
+
+    }
+
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <filesystem>
+
+namespace DirectX {
+    class ScratchImage;
+}
+
+namespace LIEngine {
+
+    /// <summary>
+    /// 読み込んでミップマップまで生成したテクスチャをDDSで保存しておく
+    /// 2回目以降はデコードもミップマップの生成もせず、1つのファイルを読むだけで済む
+    /// 元のファイルかsRGBの指定が変わると使わない
+    /// </summary>
+    namespace TextureCache {
+        /// <summary>
+        /// キャッシュから読み込む
+        /// 元のファイルのサイズと更新日時が同じならそのまま使い、違えば中身のハッシュで確かめる
+        /// </summary>
+        /// <returns>無いか元のファイルが変わっていればfalse</returns>
+        bool Load(const std::filesystem::path& sourcePath, bool useSRGB, DirectX::ScratchImage& mipImages);
+        /// <summary>
+        /// キャッシュに保存する
+        /// 書き出せなくても次回また生成するだけなので失敗は無視する
+        /// </summary>
+        void Save(const std::filesystem::path& sourcePath, bool useSRGB, const DirectX::ScratchImage& mipImages);
+    }
+
+}
@@ -1,28 +1,116 @@
 #include "TextureLoader.h"
 
+#include <algorithm>
+#include <atomic>
 #include <mutex>
 #include <map>
 
+#include "Externals/DirectXTex/Include/DirectXTex.h"
+
+#include "CommandContext.h"
+#include "Framework/Engine.h"
+#include "Framework/ThreadPool.h"
+
 namespace LIEngine {
 
     namespace TextureLoader {
 
+        // 読み込み中か読み込み済みの1枚
+        // 最初に登録したスレッドが読み込み、他は準備できるまで待つ
+        struct Entry {
+            std::atomic<bool> isReady = false;
+            std::shared_ptr<TextureResource> texture;
+        };
+
+        // 1度に読み込んでアップロードする枚数 (スレッド数あたり)
+        // 読み込んだ画像はアップロードを積むまで残るのでメモリを抑える
+        const size_t kBatchSizePerThread = 2;
+
         std::mutex mutex_;
-        std::map<std::filesystem::path, std::shared_ptr<TextureResource>> g_map;
+        std::map<std::filesystem::path, std::shared_ptr<Entry>> g_map;
+
+        // 登録したものを読み込む
+        void LoadEntries(const std::vector<Request>& requests, const std::vector<std::shared_ptr<Entry>>& entries, const std::vector<size_t>& owned) {
+            ThreadPool* threadPool = Engine::GetThreadPool();
+            size_t batchSize = kBatchSizePerThread * (threadPool ? threadPool->GetNumThreads() + 1 : 1);
+
+            for (size_t batchBegin = 0; batchBegin < owned.size(); batchBegin += batchSize) {
+                size_t batchEnd = std::min(owned.size(), batchBegin + batchSize);
+                std::vector<DirectX::ScratchImage> images(batchEnd - batchBegin);
+
+                // ファイルの読み込みとミップマップの生成は並列に
+                // フレームを待っているスレッドが手伝わないようBackgroundで積む
+                auto Decode = [&](size_t i) {
+                    const Request& request = requests[owned[batchBegin + i]];
+                    TextureResource::DecodeFile(request.path, request.useSRGB, images[i]);
+                    };
+                if (threadPool && images.size() > 1) {
+                    std::vector<TaskFuture<void>> decodes;
+                    for (size_t i = 0; i < images.size(); ++i) {
+                        decodes.emplace_back(threadPool->Submit([&Decode, i]() { Decode(i); }, TaskPriority::Background));
+                    }
+                    // 始まっていないものはこのスレッドで読み込む
+                    for (auto& decode : decodes) { decode.Wait(); }
+                }
+                else {
+                    for (size_t i = 0; i < images.size(); ++i) { Decode(i); }
+                }
+
+                // アップロードは1つのコマンドリストにまとめる
+                CommandContext commandContext;
+                commandContext.Start(D3D12_COMMAND_LIST_TYPE_DIRECT);
+                for (size_t i = 0; i < images.size(); ++i) {
+                    auto texture = std::make_shared<TextureResource>();
+                    texture->Create(commandContext, images[i]);
+                    entries[owned[batchBegin + i]]->texture = texture;
+                }
+                commandContext.Finish(true);
+
+                for (size_t i = batchBegin; i < batchEnd; ++i) {
+                    entries[owned[i]]->isReady.store(true, std::memory_order_release);
+                }
+            }
+        }
 
         std::shared_ptr<TextureResource> Load(const std::filesystem::path& path, bool useSRGB) {
-            std::lock_guard lock(mutex_);
+            return Load(std::vector<Request>{ { path, useSRGB } }).front();
+        }
 
-            auto iter = g_map.find(path);
-            if (iter != g_map.end()) {
-                return iter->second;
+        std::vector<std::shared_ptr<TextureResource>> Load(const std::vector<Request>& requests) {
+            std::vector<std::shared_ptr<Entry>> entries(requests.size());
+            // このスレッドが読み込むもの
+            std::vector<size_t> owned;
+            {
+                // 登録だけロックする
+                std::lock_guard lock(mutex_);
+                for (size_t i = 0; i < requests.size(); ++i) {
+                    auto [iter, isInserted] = g_map.try_emplace(requests[i].path);
+                    if (isInserted) {
+                        iter->second = std::make_shared<Entry>();
+                        owned.emplace_back(i);
+                    }
+                    entries[i] = iter->second;
+                }
             }
 
-            std::shared_ptr<TextureResource> texture = std::make_shared<TextureResource>();
-            texture->Create(path.wstring(), useSRGB);
+            // 先に自分の分を終わらせてから待つので、互いに待ち合うことはない
+            LoadEntries(requests, entries, owned);
 
-            g_map.insert(std::make_pair(path, texture));
-            return texture;
+            std::vector<std::shared_ptr<TextureResource>> textures(requests.size());
+            ThreadPool* threadPool = Engine::GetThreadPool();
+            for (size_t i = 0; i < entries.size(); ++i) {
+                Entry& entry = *entries[i];
+                if (!entry.isReady.load(std::memory_order_acquire)) {
+                    if (threadPool) {
+                        threadPool->WaitUntil([&]() { return entry.isReady.load(std::memory_order_acquire); });
+                    }
+                    else {
+                        while (!entry.isReady.load(std::memory_order_acquire)) { std::this_thread::yield(); }
+                    }
+                }
+                textures[i] = entry.texture;
+            }
+            return textures;
         }
 
         void Release(const std::filesystem::path& path) {
@@ -32,7 +120,16 @@ namespace LIEngine {
 
         void Release(const std::shared_ptr<TextureResource>& texture) {
             std::lock_guard lock(mutex_);
-            std::erase_if(g_map, [&](const auto& iter) { return iter.second == texture; });
+            std::erase_if(g_map, [&](const auto& iter) {
+                return iter.second->isReady.load(std::memory_order_acquire) && iter.second->texture == texture;
+                });
+        }
+
+        size_t ReleaseUnused() {
+            std::lock_guard lock(mutex_);
+            return std::erase_if(g_map, [](const auto& iter) {
+                return iter.second->isReady.load(std::memory_order_acquire) && iter.second->texture.use_count() == 1;
+                });
         }
 
         void ReleaseAll() {
@@ -42,4 +139,4 @@ namespace LIEngine {
 
     }
 
-}
\ No newline at end of file
+}
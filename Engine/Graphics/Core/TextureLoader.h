@@ -2,17 +2,38 @@
 
 #include <memory>
 #include <filesystem>
+#include <vector>
 
 #include "TextureResource.h"
 
 namespace LIEngine {
 
     namespace TextureLoader {
+        /// <summary>
+        /// 読み込む1枚
+        /// </summary>
+        struct Request {
+            std::filesystem::path path;
+            bool useSRGB = false;
+        };
+
         std::shared_ptr<TextureResource> Load(const std::filesystem::path& path, bool useSRGB = false);
+        /// <summary>
+        /// まとめて読み込む
+        /// ファイルの読み込みとミップマップの生成はスレッドプールで並列に行い、アップロードはまとめて積む
+        /// 同じパスを他のスレッドが読み込み中なら、終わるまで他のタスクを手伝いながら待つ
+        /// </summary>
+        /// <returns>requestsと同じ順</returns>
+        std::vector<std::shared_ptr<TextureResource>> Load(const std::vector<Request>& requests);
 
         void Release(const std::filesystem::path& path);
         void Release(const std::shared_ptr<TextureResource>& texture);
+        /// <summary>
+        /// 読み込み済みで、ここ以外から参照されていないものを解放する
+        /// </summary>
+        /// <returns>解放した数</returns>
+        size_t ReleaseUnused();
         void ReleaseAll();
     }
 
-}
\ No newline at end of file
+}
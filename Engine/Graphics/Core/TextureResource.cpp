@@ -2,8 +2,10 @@
 
 #include "Externals/DirectXTex/Include/DirectXTex.h"
 
+#include "File/VirtualFileSystem.h"
 #include "Helper.h"
 #include "Graphics.h"
+#include "TextureCache.h"
 #include "CommandContext.h"
 #include "UploadBuffer.h"
 
@@ -26,25 +28,46 @@ namespace LIEngine {
     }
 
 
-    void TextureResource::Create(CommandContext& commandContext, const std::filesystem::path& path, bool useSRGB) {
-        auto device = Graphics::GetInstance()->GetDevice();
+    void TextureResource::DecodeFile(const std::filesystem::path& path, bool useSRGB, DirectX::ScratchImage& mipImages) {
+        // ミップマップまで生成したものが残っていればデコードしない
+        bool isDDS = path.extension() == ".dds";
+        if (!isDDS && TextureCache::Load(path, useSRGB, mipImages)) {
+            return;
+        }
 
-        // ファイルを読み込む
+        // ファイルを読み込む (アーカイブ内でもディスクでも)
+        FileData file;
+        bool isRead = VirtualFileSystem::ReadFile(path, file);
+        assert(isRead);
+        isRead;
         DirectX::ScratchImage image{};
-        if (path.extension() == ".dds") {
-            ASSERT_IF_FAILED(DirectX::LoadFromDDSFile(path.wstring().c_str(), DirectX::DDS_FLAGS_NONE, nullptr, image));
+        if (isDDS) {
+            ASSERT_IF_FAILED(DirectX::LoadFromDDSMemory(file.GetData(), file.GetSize(), DirectX::DDS_FLAGS_NONE, nullptr, image));
         }
         else {
-            ASSERT_IF_FAILED(DirectX::LoadFromWICFile(path.wstring().c_str(), useSRGB ? DirectX::WIC_FLAGS_FORCE_SRGB : DirectX::WIC_FLAGS_FORCE_RGB, nullptr, image));
+            ASSERT_IF_FAILED(DirectX::LoadFromWICMemory(file.GetData(), file.GetSize(), useSRGB ? DirectX::WIC_FLAGS_FORCE_SRGB : DirectX::WIC_FLAGS_FORCE_RGB, nullptr, image));
         }
         // ミップマップを生成
-        DirectX::ScratchImage mipImages{};
         if (DirectX::IsCompressed(image.GetMetadata().format)) {
             mipImages = std::move(image);
         }
         else {
             ASSERT_IF_FAILED(DirectX::GenerateMipMaps(image.GetImages(), image.GetImageCount(), image.GetMetadata(), DirectX::TEX_FILTER_SRGB, 0, mipImages));
         }
+        // DDSは読み込むだけなので残さない
+        if (!isDDS) {
+            TextureCache::Save(path, useSRGB, mipImages);
+        }
+    }
+
+    void TextureResource::Create(CommandContext& commandContext, const std::filesystem::path& path, bool useSRGB) {
+        DirectX::ScratchImage mipImages{};
+        DecodeFile(path, useSRGB, mipImages);
+        Create(commandContext, mipImages);
+    }
+
+    void TextureResource::Create(CommandContext& commandContext, const DirectX::ScratchImage& mipImages) {
+        auto device = Graphics::GetInstance()->GetDevice();
 
         // リソースを生成
         auto& metadata = mipImages.GetMetadata();
@@ -10,14 +10,32 @@
 #include "DescriptorHandle.h"
 #include "PixelBuffer.h"
 
+namespace DirectX {
+    class ScratchImage;
+}
+
 namespace LIEngine {
 
     class CommandContext;
 
     class TextureResource : public GPUResource {
     public:
+        /// <summary>
+        /// ファイルを読み込んでミップマップを生成する
+        /// 生成したものはTextureCacheに残し、次回からはそれを読む
+        /// GPUを使わないので、どのスレッドからでも並列に呼べる
+        /// </summary>
+        /// <param name="path">ファイルのパス</param>
+        /// <param name="useSRGB">sRGBとして読み込むか (DDS以外)</param>
+        /// <param name="mipImages">ミップマップまで含めた画像</param>
+        static void DecodeFile(const std::filesystem::path& path, bool useSRGB, DirectX::ScratchImage& mipImages);
+
         void Create(const std::filesystem::path& path, bool useSRGB = true);
         void Create(CommandContext& commandContext, const std::filesystem::path& path, bool useSRGB = true);
+        /// <summary>
+        /// DecodeFileで読み込んだ画像からリソースを生成し、アップロードを積む
+        /// </summary>
+        void Create(CommandContext& commandContext, const DirectX::ScratchImage& mipImages);
         void Create(size_t rowPitchBytes, size_t width, size_t heigh, DXGI_FORMAT format, void* dataBegin);
         void Create(CommandContext& commandContext, size_t rowPitchBytes, size_t width, size_t heigh, DXGI_FORMAT format, void* dataBegin, bool isCubeMap = false);
         void Create(CommandContext& commandContext, PixelBuffer& pixelBuffer);
@@ -163,13 +163,13 @@ namespace LIEngine {
 
         commandContext.SetBindlessResource(RootIndex::BindlessTexture);
 
-        auto& instances = modelSorter.GetDrawModels();
+        auto& instances = modelSorter.GetVisibleModels();
         for (auto instance : instances) {
             auto model = instance->GetModel();
 
             InstanceData instanceData;
             instanceData.worldMatrix = /*model->GetRootNode().localMatrix **/ instance->GetWorldMatrix();
-            instanceData.worldInverseTransposeMatrix = instanceData.worldMatrix.Inverse().Transpose();
+            instanceData.worldInverseTransposeMatrix = Matrix3x4(instanceData.worldMatrix).InverseTranspose().ToMatrix4x4();
             commandContext.SetDynamicConstantBufferView(RootIndex::Instance, sizeof(instanceData), &instanceData);
 
             auto instanceMaterial = instance->GetMaterial();
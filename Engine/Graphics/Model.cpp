@@ -1,18 +1,76 @@
 #include "Model.h"
 
+#include <algorithm>
 #include <cassert>
+#include <span>
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
+#include "Externals/nlohmann/json.hpp"
+
 #include "Core/CommandContext.h"
 #include "Core/TextureLoader.h"
+#include "File/AssimpIOSystem.h"
+#include "File/BinaryStream.h"
+#include "File/ContentHash.h"
+#include "File/MappedFile.h"
+#include "File/VirtualFileSystem.h"
 #include "Material.h"
 
 namespace {
     using namespace LIEngine;
 
+    // 焼いたモデルのファイル
+    const uint32_t kCookedMagic = 0x444D494C; // "LIMD"
+    // 解析の内容やファイルの形式を変えたら上げる
+    const uint32_t kCookedVersion = 1;
+    const std::filesystem::path kCookedDirectory = "Cache/Models";
+    // 頂点とインデックスの先頭をそろえる
+    const size_t kCookedBlobAlignment = 16;
+    // 1つのノードが最低限使うバイト数 (空の名前と子の数を含む)
+    const size_t kCookedMinNodeSize = sizeof(Node::Transform) + sizeof(Matrix4x4) + sizeof(uint32_t) * 2;
+    // 壊れたファイルで再帰が深くなりすぎないように
+    const uint32_t kCookedMaxNodeDepth = 256;
+
+    struct CookedHeader {
+        uint32_t magic;
+        uint32_t version;
+        // 元のファイルの中身のハッシュ
+        uint64_t sourceHash;
+        uint32_t vertexSize;
+        uint32_t indexSize;
+        uint64_t numVertices;
+        uint64_t numIndices;
+        uint64_t vertexOffset;
+        uint64_t indexOffset;
+        // メッシュ、マテリアル、スキン、ノード
+        uint64_t metadataOffset;
+    };
+
+    // マテリアルが使うテクスチャのモデルのディレクトリからの相対パス (無ければ空)
+    struct MaterialTextures {
+        std::string albedoMap;
+        std::string metallicRoughnessMap;
+        std::string normalMap;
+    };
+
+    // Assimpか焼いたファイルから読み込んだ中身
+    // 焼いたファイルの場合、頂点とインデックスはマップしたファイルを指す
+    struct ImportedModel {
+        std::vector<Model::Mesh> meshes;
+        std::vector<Model::Vertex> vertices;
+        std::vector<Model::Index> indices;
+        std::span<const Model::Vertex> vertexBlob;
+        std::span<const Model::Index> indexBlob;
+        std::vector<Material> materials;
+        std::vector<MaterialTextures> materialTextures;
+        std::map<std::string, Model::JointWeightData> skinClusterData;
+        Node rootNode;
+        Math::AABB bounds;
+    };
+
     // Vector3からuint32_tに変換する
     uint32_t R32G32B32ToR10G10B10A2(const Vector3& in) {
         uint32_t x = static_cast<uint32_t>(std::clamp((in.x + 1.0f) * 0.5f, 0.0f, 1.0f) * 0x3FF) & 0x3FF;
@@ -113,11 +171,14 @@ namespace {
         
     }
     // aiSceneからPBRマテリアル配列を解析する
-    std::vector<Material> ParseMaterials(const aiScene* scene, const std::filesystem::path& directory) {
+    // テクスチャは焼いたファイルからも読み込めるようパスだけ集める
+    std::vector<Material> ParseMaterials(const aiScene* scene, std::vector<MaterialTextures>& materialTextures) {
         std::vector<Material> materials(scene->mNumMaterials);
+        materialTextures.assign(scene->mNumMaterials, {});
 
         for (uint32_t materialIndex = 0; auto & destMaterial : materials) {
             const aiMaterial* srcMaterial = scene->mMaterials[materialIndex];
+            MaterialTextures& destTextures = materialTextures[materialIndex];
 
             aiColor3D albedo{};
             if (srcMaterial->Get(AI_MATKEY_BASE_COLOR, albedo) == aiReturn_SUCCESS) {
@@ -144,10 +205,7 @@ namespace {
             if (srcMaterial->GetTextureCount(aiTextureType_BASE_COLOR) > 0) {
                 aiString path;
                 srcMaterial->GetTexture(aiTextureType_BASE_COLOR, 0, &path);
-                // 読み込む
-                // TextureLoader内で多重読み込み対応済み
-                std::string filename(path.C_Str());
-                destMaterial.albedoMap = TextureLoader::Load(directory / filename);
+                destTextures.albedoMap = path.C_Str();
             }
             // テクスチャが一つ以上ある
             if (srcMaterial->GetTextureCount(aiTextureType_METALNESS) > 0 &&
@@ -158,25 +216,43 @@ namespace {
                 srcMaterial->GetTexture(aiTextureType_DIFFUSE_ROUGHNESS, 0, &roughnessPath);
                 // 同じテクスチャの場合使用
                 if (metallicPath == roughnessPath) {
-                    // 読み込む
-                    // TextureLoader内で多重読み込み対応済み
-                    std::string filename(metallicPath.C_Str());
-                    destMaterial.metallicRoughnessMap = TextureLoader::Load(directory / filename, false);
+                    destTextures.metallicRoughnessMap = metallicPath.C_Str();
                 }
             }
             // テクスチャが一つ以上ある
             if (srcMaterial->GetTextureCount(aiTextureType_NORMALS) > 0) {
                 aiString path;
                 srcMaterial->GetTexture(aiTextureType_NORMALS, 0, &path);
-                // 読み込む
-                // TextureLoader内で多重読み込み対応済み
-                std::string filename(path.C_Str());
-                destMaterial.normalMap = TextureLoader::Load(directory / filename);
+                destTextures.normalMap = path.C_Str();
             }
             ++materialIndex;
         }
         return materials;
     }
+    // マテリアルのテクスチャを読み込む
+    void LoadMaterialTextures(std::vector<Material>& materials, const std::vector<MaterialTextures>& materialTextures, const std::filesystem::path& directory) {
+        // テクスチャはまとめて並列に読み込む
+        // TextureLoader内で多重読み込み対応済み
+        std::vector<TextureLoader::Request> textureRequests;
+        std::vector<std::shared_ptr<TextureResource>*> textureDestinations;
+        auto RequestTexture = [&](std::shared_ptr<TextureResource>& destination, const std::string& path) {
+            if (path.empty()) {
+                return;
+            }
+            textureRequests.push_back({ directory / path, false });
+            textureDestinations.push_back(&destination);
+            };
+        for (size_t i = 0; i < materials.size(); ++i) {
+            RequestTexture(materials[i].albedoMap, materialTextures[i].albedoMap);
+            RequestTexture(materials[i].metallicRoughnessMap, materialTextures[i].metallicRoughnessMap);
+            RequestTexture(materials[i].normalMap, materialTextures[i].normalMap);
+        }
+
+        auto textures = TextureLoader::Load(textureRequests);
+        for (size_t i = 0; i < textures.size(); ++i) {
+            *textureDestinations[i] = textures[i];
+        }
+    }
     // 再起的にノードを解析する
     Node ParseNode(const aiNode* node) {
         Node result;
@@ -196,23 +272,11 @@ namespace {
         return result;
     }
 
-
-}
-
-namespace LIEngine {
-
-    std::list<ModelInstance*> ModelInstance::instanceLists_;
-
-    std::shared_ptr<Model> Model::Load(const std::filesystem::path& path) {
-
-        // privateコンストラクタをmake_sharedで呼ぶためのヘルパー
-        struct Helper : Model {
-            Helper() : Model() {}
-        };
-        std::shared_ptr<Model> model = std::make_shared<Helper>();
-
-        auto directory = path.parent_path();
+    // Assimpで読み込んで解析する
+    ImportedModel ImportModel(const std::filesystem::path& path) {
         Assimp::Importer importer;
+        // アーカイブからも読む
+        importer.SetIOHandler(new AssimpIOSystem);
         int flags = 0;
 
         // 三角形のみ
@@ -230,18 +294,272 @@ namespace LIEngine {
         }
         assert(scene->HasMeshes());
 
-        model->materials_ = ParseMaterials(scene, directory);
-        model->meshes_ = ParseMeshes(scene, model->materials_, model->vertices_, model->indices_, model->skinClusterData_);
-        model->rootNode_ = ParseNode(scene->mRootNode);
+        ImportedModel model;
+        model.materials = ParseMaterials(scene, model.materialTextures);
+        model.meshes = ParseMeshes(scene, model.materials, model.vertices, model.indices, model.skinClusterData);
+        model.rootNode = ParseNode(scene->mRootNode);
+        // カリング用に一度だけ求めておく (頂点が無ければ原点の大きさ0の箱)
+        model.bounds = Math::AABB(model.vertices.empty() ? Vector3::zero : model.vertices[0].position);
+        for (auto& vertex : model.vertices) {
+            model.bounds.Merge(vertex.position);
+        }
+        model.vertexBlob = model.vertices;
+        model.indexBlob = model.indices;
+        return model;
+    }
+
+    // 元のファイルの中身のハッシュ
+    // gltfはバッファが別ファイルなのでそれも含める
+    uint64_t ComputeSourceHash(const std::filesystem::path& path) {
+        uint64_t hash = VirtualFileSystem::ComputeContentHash(path);
+        FileData file;
+        if (path.extension() != ".gltf" || !VirtualFileSystem::ReadFile(path, file)) {
+            return hash;
+        }
+        nlohmann::json json = nlohmann::json::parse(file.GetData(), file.GetData() + file.GetSize(), nullptr, false);
+        if (json.is_discarded() || !json.contains("buffers")) {
+            return hash;
+        }
+        for (auto& buffer : json["buffers"]) {
+            if (!buffer.contains("uri")) {
+                continue;
+            }
+            std::string uri = buffer["uri"].get<std::string>();
+            // 埋め込みは本体に含まれている
+            if (uri.starts_with("data:")) {
+                continue;
+            }
+            hash = ContentHash::Combine(hash, VirtualFileSystem::ComputeContentHash(path.parent_path() / uri));
+        }
+        return hash;
+    }
+
+    // 元のファイルのパスごとに1つ
+    std::filesystem::path GetCookedPath(const std::filesystem::path& path) {
+        std::string pathString = path.lexically_normal().generic_string();
+        uint64_t pathHash = ContentHash::Compute(pathString.data(), pathString.size());
+        return kCookedDirectory / (path.stem().string() + "_" + ContentHash::ToString(pathHash) + ".model");
+    }
+
+    void WriteNode(BinaryWriter& writer, const Node& node) {
+        writer.Write(node.transform);
+        writer.Write(node.localMatrix);
+        writer.WriteString(node.name);
+        writer.Write<uint32_t>(static_cast<uint32_t>(node.children.size()));
+        for (auto& child : node.children) {
+            WriteNode(writer, child);
+        }
+    }
+
+    // 壊れていればfalse
+    bool ReadNode(BinaryReader& reader, Node& node, uint32_t depth = 0) {
+        if (depth > kCookedMaxNodeDepth) {
+            return false;
+        }
+        node.transform = reader.Read<Node::Transform>();
+        node.localMatrix = reader.Read<Matrix4x4>();
+        node.name = reader.ReadString();
+        uint32_t numChildren = reader.Read<uint32_t>();
+        // 残りに収まらない数は確保しない
+        if (!reader.IsValid() || numChildren > reader.GetRemainingSize() / kCookedMinNodeSize) {
+            return false;
+        }
+        node.children.resize(numChildren);
+        for (auto& child : node.children) {
+            if (!ReadNode(reader, child, depth + 1)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 解析済みの中身を焼く
+    void WriteCookedModel(const std::filesystem::path& cookedPath, uint64_t sourceHash, const ImportedModel& model) {
+        BinaryWriter writer;
+        CookedHeader header{};
+        header.magic = kCookedMagic;
+        header.version = kCookedVersion;
+        header.sourceHash = sourceHash;
+        header.vertexSize = sizeof(Model::Vertex);
+        header.indexSize = sizeof(Model::Index);
+        header.numVertices = model.vertexBlob.size();
+        header.numIndices = model.indexBlob.size();
+        writer.Write(header);
+
+        // 頂点とインデックスはそのままアップロードできる形で置く
+        writer.Align(kCookedBlobAlignment);
+        header.vertexOffset = writer.GetSize();
+        writer.WriteBytes(model.vertexBlob.data(), model.vertexBlob.size_bytes());
+        writer.Align(kCookedBlobAlignment);
+        header.indexOffset = writer.GetSize();
+        writer.WriteBytes(model.indexBlob.data(), model.indexBlob.size_bytes());
+
+        header.metadataOffset = writer.GetSize();
+        writer.WriteArray(model.meshes);
+        writer.Write<uint32_t>(static_cast<uint32_t>(model.materials.size()));
+        for (size_t i = 0; i < model.materials.size(); ++i) {
+            const Material& material = model.materials[i];
+            writer.Write(material.albedo);
+            writer.Write(material.metallic);
+            writer.Write(material.roughness);
+            writer.Write(material.emissive);
+            writer.Write(material.emissiveIntensity);
+            writer.WriteString(model.materialTextures[i].albedoMap);
+            writer.WriteString(model.materialTextures[i].metallicRoughnessMap);
+            writer.WriteString(model.materialTextures[i].normalMap);
+        }
+        writer.Write<uint32_t>(static_cast<uint32_t>(model.skinClusterData.size()));
+        for (auto& [jointName, jointWeightData] : model.skinClusterData) {
+            writer.WriteString(jointName);
+            writer.Write(jointWeightData.inverseBindPoseMatrix);
+            writer.WriteArray(jointWeightData.vertexWeights);
+        }
+        WriteNode(writer, model.rootNode);
+        writer.Write(model.bounds);
+
+        writer.Overwrite(0, header);
+        // 書き出せなくても次回また焼くだけ
+        writer.SaveFile(cookedPath);
+    }
+
+    // 焼いたファイルを読む
+    // 元のファイルが変わっているか壊れていればfalse
+    bool ReadCookedModel(const MappedFile& file, uint64_t sourceHash, ImportedModel& model) {
+        BinaryReader reader(file.GetData(), file.GetSize());
+        CookedHeader header = reader.Read<CookedHeader>();
+        if (!reader.IsValid() ||
+            header.magic != kCookedMagic ||
+            header.version != kCookedVersion ||
+            header.sourceHash != sourceHash ||
+            header.vertexSize != sizeof(Model::Vertex) ||
+            header.indexSize != sizeof(Model::Index) ||
+            header.numVertices == 0 ||
+            header.numVertices > file.GetSize() / sizeof(Model::Vertex) ||
+            header.numIndices > file.GetSize() / sizeof(Model::Index)) {
+            return false;
+        }
+
+        // 頂点とインデックスは解析せずにマップしたまま使う
+        reader.Seek(header.vertexOffset);
+        auto vertices = static_cast<const Model::Vertex*>(reader.ReadBytes(header.numVertices * sizeof(Model::Vertex)));
+        reader.Seek(header.indexOffset);
+        auto indices = static_cast<const Model::Index*>(reader.ReadBytes(header.numIndices * sizeof(Model::Index)));
+        if (!reader.IsValid()) {
+            return false;
+        }
+        model.vertexBlob = { vertices, static_cast<size_t>(header.numVertices) };
+        model.indexBlob = { indices, static_cast<size_t>(header.numIndices) };
+
+        reader.Seek(header.metadataOffset);
+        model.meshes = reader.ReadArray<Model::Mesh>();
+        uint32_t numMaterials = reader.Read<uint32_t>();
+        for (uint32_t i = 0; i < numMaterials && reader.IsValid(); ++i) {
+            Material& material = model.materials.emplace_back();
+            material.albedo = reader.Read<Vector3>();
+            material.metallic = reader.Read<float>();
+            material.roughness = reader.Read<float>();
+            material.emissive = reader.Read<Vector3>();
+            material.emissiveIntensity = reader.Read<float>();
+            MaterialTextures& textures = model.materialTextures.emplace_back();
+            textures.albedoMap = reader.ReadString();
+            textures.metallicRoughnessMap = reader.ReadString();
+            textures.normalMap = reader.ReadString();
+        }
+        uint32_t numJoints = reader.Read<uint32_t>();
+        for (uint32_t i = 0; i < numJoints && reader.IsValid(); ++i) {
+            std::string jointName = reader.ReadString();
+            Model::JointWeightData& jointWeightData = model.skinClusterData[jointName];
+            jointWeightData.inverseBindPoseMatrix = reader.Read<Matrix4x4>();
+            jointWeightData.vertexWeights = reader.ReadArray<Model::VertexWeightData>();
+        }
+        if (!ReadNode(reader, model.rootNode)) {
+            return false;
+        }
+        model.bounds = reader.Read<Math::AABB>();
+        if (!reader.IsValid()) {
+            return false;
+        }
+        // 範囲外を指すメッシュがあれば使わない
+        for (auto& mesh : model.meshes) {
+            if (uint64_t(mesh.vertexOffset) + mesh.vertexCount > header.numVertices ||
+                uint64_t(mesh.indexOffset) + mesh.indexCount > header.numIndices ||
+                mesh.material >= model.materials.size()) {
+                return false;
+            }
+            // インデックスはメッシュの頂点を指す (GPUとBVHに渡す前に確かめる)
+            for (uint32_t i = 0; i < mesh.indexCount; ++i) {
+                if (model.indexBlob[mesh.indexOffset + i] >= mesh.vertexCount) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // 焼いたファイルがあり元のファイルが変わっていなければ、Assimpを使わない
+    // 無ければAssimpで読み込んで焼く
+    void ReadOrImportModel(const std::filesystem::path& path, MappedFile& cookedFile, ImportedModel& imported) {
+        uint64_t sourceHash = ComputeSourceHash(path);
+        std::filesystem::path cookedPath = GetCookedPath(path);
+        if (!cookedFile.Open(cookedPath) || !ReadCookedModel(cookedFile, sourceHash, imported)) {
+            cookedFile.Close();
+            imported = ImportModel(path);
+            WriteCookedModel(cookedPath, sourceHash, imported);
+        }
+    }
+
+
+}
+
+namespace LIEngine {
+
+    // 焼いたファイルはLoadが終わるまでマップしたまま
+    struct ModelSource {
+        std::filesystem::path path;
+        MappedFile cookedFile;
+        ImportedModel imported;
+    };
+
+    std::list<ModelInstance*> ModelInstance::instanceLists_;
+
+    std::shared_ptr<Model> Model::Load(const std::filesystem::path& path) {
+        return Load(*ReadSource(path));
+    }
+
+    std::shared_ptr<ModelSource> Model::ReadSource(const std::filesystem::path& path) {
+        auto source = std::make_shared<ModelSource>();
+        source->path = path;
+        ReadOrImportModel(path, source->cookedFile, source->imported);
+        return source;
+    }
+
+    std::shared_ptr<Model> Model::Load(ModelSource& source) {
+
+        // privateコンストラクタをmake_sharedで呼ぶためのヘルパー
+        struct Helper : Model {
+            Helper() : Model() {}
+        };
+        std::shared_ptr<Model> model = std::make_shared<Helper>();
+
+        const std::filesystem::path& path = source.path;
+        MappedFile& cookedFile = source.cookedFile;
+        ImportedModel& imported = source.imported;
+
+        LoadMaterialTextures(imported.materials, imported.materialTextures, path.parent_path());
+        model->materials_ = std::move(imported.materials);
+        model->meshes_ = std::move(imported.meshes);
+        model->skinClusterData_ = std::move(imported.skinClusterData);
+        model->rootNode_ = std::move(imported.rootNode);
+        model->bounds_ = imported.bounds;
 
         CommandContext commandContext;
         commandContext.Start(D3D12_COMMAND_LIST_TYPE_DIRECT);
         // 中間リソースをコピーする
-        model->vertexBuffer_.Create(path.wstring() + L"VB", model->vertices_.size(), sizeof(model->vertices_[0]));
-        model->indexBuffer_.Create(path.wstring() + L"IB", model->indices_.size(), sizeof(model->indices_[0]));
+        model->vertexBuffer_.Create(path.wstring() + L"VB", imported.vertexBlob.size(), sizeof(Vertex));
+        model->indexBuffer_.Create(path.wstring() + L"IB", imported.indexBlob.size(), sizeof(Index));
 
-        commandContext.CopyBuffer(model->vertexBuffer_, model->vertexBuffer_.GetBufferSize(), model->vertices_.data());
-        commandContext.CopyBuffer(model->indexBuffer_, model->indexBuffer_.GetBufferSize(), model->indices_.data());
+        commandContext.CopyBuffer(model->vertexBuffer_, model->vertexBuffer_.GetBufferSize(), imported.vertexBlob.data());
+        commandContext.CopyBuffer(model->indexBuffer_, model->indexBuffer_.GetBufferSize(), imported.indexBlob.data());
         commandContext.TransitionResource(model->vertexBuffer_, D3D12_RESOURCE_STATE_GENERIC_READ);
         commandContext.TransitionResource(model->indexBuffer_, D3D12_RESOURCE_STATE_GENERIC_READ);
         commandContext.FlushResourceBarriers();
@@ -265,9 +583,45 @@ namespace LIEngine {
         model->blas_.Create(L"ModelBLAS", commandContext, blasDescs);
         commandContext.Finish(true);
 
+        // コライダー用にCPU側にも残す
+        if (cookedFile.IsOpen()) {
+            model->vertices_.assign(imported.vertexBlob.begin(), imported.vertexBlob.end());
+            model->indices_.assign(imported.indexBlob.begin(), imported.indexBlob.end());
+        }
+        else {
+            model->vertices_ = std::move(imported.vertices);
+            model->indices_ = std::move(imported.indices);
+        }
+
         return model;
     }
 
+    std::vector<TextureLoader::Request> Model::GetTextureRequests(const ModelSource& source) {
+        const std::filesystem::path& path = source.path;
+        std::vector<TextureLoader::Request> textureRequests;
+        for (auto& textures : source.imported.materialTextures) {
+            for (auto texture : { &textures.albedoMap, &textures.metallicRoughnessMap, &textures.normalMap }) {
+                // LoadMaterialTexturesと同じパスと指定で
+                if (!texture->empty()) {
+                    textureRequests.push_back({ path.parent_path() / *texture, false });
+                }
+            }
+        }
+        return textureRequests;
+    }
+
+    size_t Model::GetCPUMemorySize() const {
+        size_t size = vertices_.size() * sizeof(Vertex) + indices_.size() * sizeof(Index) + meshes_.size() * sizeof(Mesh);
+        for (auto& [jointName, jointWeightData] : skinClusterData_) {
+            size += jointWeightData.vertexWeights.size() * sizeof(VertexWeightData);
+        }
+        return size;
+    }
+
+    size_t Model::GetGPUMemorySize() const {
+        return vertexBuffer_.GetGPUMemorySize() + indexBuffer_.GetGPUMemorySize() + blas_.GetGPUMemorySize();
+    }
+
     ModelInstance::ModelInstance() {
         instanceLists_.emplace_back(this);
     }
@@ -6,7 +6,9 @@
 #include <vector>
 
 #include "Math/MathUtils.h"
+#include "Math/Geometry.h"
 #include "Core/GPUBuffer.h"
+#include "Core/TextureLoader.h"
 //#include "Mesh.h"
 #include "Node.h"
 #include "Raytracing/BLAS.h"
@@ -14,6 +16,8 @@
 
 namespace LIEngine {
 
+    struct ModelSource;
+
     class Model {
     public:
         struct Vertex {
@@ -44,6 +48,20 @@ namespace LIEngine {
         };
 
         static std::shared_ptr<Model> Load(const std::filesystem::path& path);
+        /// <summary>
+        /// 焼いたファイルを読む (無ければAssimpで読み込んで焼く)
+        /// テクスチャを先に読ませてからLoadに渡すと、ファイルを1回しか読まない
+        /// </summary>
+        /// <param name="path">元のファイルのパス</param>
+        static std::shared_ptr<ModelSource> ReadSource(const std::filesystem::path& path);
+        /// <summary>
+        /// ReadSourceで読んだ中身から作る (中身は使い切る)
+        /// </summary>
+        static std::shared_ptr<Model> Load(ModelSource& source);
+        /// <summary>
+        /// マテリアルが使うテクスチャ (Loadの前に別のタスクでTextureLoaderに読ませる用)
+        /// </summary>
+        static std::vector<TextureLoader::Request> GetTextureRequests(const ModelSource& source);
 
         const BLAS& GetBLAS() const { return blas_; }
         const std::vector<Mesh>& GetMeshes() const { return meshes_; }
@@ -54,8 +72,15 @@ namespace LIEngine {
         const std::vector<Material>& GetMaterials() const { return materials_; }
         const std::map<std::string, JointWeightData> GetSkinClusterData() const { return skinClusterData_; }
         const Node& GetRootNode() const { return rootNode_; }
+        // モデル空間のバウンディングボックス
+        const Math::AABB& GetBounds() const { return bounds_; }
         size_t GetNumVertices() const { return vertices_.size(); }
         size_t GetNumIndices() const { return indices_.size(); }
+        // メモリ使用量 (バイト)
+        size_t GetCPUMemorySize() const;
+        // 頂点、インデックス、BLASのみ
+        // マテリアルのテクスチャはTextureLoaderで他と共有するので数えない (同じ画像のテクスチャアセットと二重に数えないように)
+        size_t GetGPUMemorySize() const;
 
     private:
         Model() = default;
@@ -66,6 +91,7 @@ namespace LIEngine {
         std::vector<Index> indices_;
         std::vector<Material> materials_;
         std::map<std::string, JointWeightData> skinClusterData_;
+        Math::AABB bounds_;
 
         StructuredBuffer vertexBuffer_;
         StructuredBuffer indexBuffer_;
@@ -136,7 +136,7 @@ namespace LIEngine {
 
                 InstanceConstant data;
                 data.worldMatrix = instance->GetWorldMatrix();
-                data.worldInverseTransposeMatrix = instance->GetWorldMatrix().Inverse().Transpose();
+                data.worldInverseTransposeMatrix = Matrix3x4(instance->GetWorldMatrix()).InverseTranspose().ToMatrix4x4();
                 data.color = instance->GetColor();
                 data.alpha = instance->GetAlpha();
                 data.useLighting = instance->UseLighting() ? 1 : 0;
@@ -1,11 +1,14 @@
 #include "ModelSorter.h"
 
+#include "Math/Culling.h"
+
 namespace LIEngine {
 
     void ModelSorter::Sort(const Camera& camera) {
         modelInstanceMap_.clear();
         drawModels_.clear();
-        camera;
+        visibleModels_.clear();
+        statistics_ = {};
         auto& instanceList = ModelInstance::GetInstanceList();
         size_t numDrawModels = 0;
         for (auto& instance : instanceList) {
@@ -20,6 +23,34 @@ namespace LIEngine {
                 drawModels_.emplace_back(instance);
             }
         }
+
+        if (!enableCulling_) {
+            visibleModels_ = drawModels_;
+            return;
+        }
+
+        // スキニングするものはバインドポーズのバウンディングボックスからはみ出すので対象外
+        worldAABBs_.Clear();
+        for (auto instance : drawModels_) {
+            if (instance->GetSkeleton()) { continue; }
+            worldAABBs_.PushBack(Math::TransformAABB(instance->GetWorldMatrix(), instance->GetModel()->GetBounds()));
+        }
+        size_t numVisible = Math::CullAABBs(camera.GetFrustum(), worldAABBs_, visibleFlags_);
+        statistics_.numTested = worldAABBs_.Size();
+        statistics_.numCulled = statistics_.numTested - numVisible;
+
+        // モデルごとにまとまった順番を保つ
+        visibleModels_.reserve(drawModels_.size() - statistics_.numCulled);
+        size_t testedIndex = 0;
+        for (auto instance : drawModels_) {
+            if (instance->GetSkeleton()) {
+                visibleModels_.emplace_back(instance);
+                continue;
+            }
+            if (visibleFlags_[testedIndex++]) {
+                visibleModels_.emplace_back(instance);
+            }
+        }
     }
 
-}
\ No newline at end of file
+}
@@ -5,19 +5,42 @@
 
 #include "Model.h"
 #include "Math/Camera.h"
+#include "Math/BatchTransform.h"
 
 namespace LIEngine {
 
     class ModelSorter {
     public:
+        struct Statistics {
+            // 視錐台と判定した数
+            size_t numTested;
+            // カリングされた数
+            size_t numCulled;
+        };
+
         void Sort(const Camera& camera);
 
+        void SetEnableCulling(bool enableCulling) { enableCulling_ = enableCulling; }
+        bool IsEnableCulling() const { return enableCulling_; }
+
         const std::map<Model*, std::vector<ModelInstance*>>& GetModelInstanceMap() const { return modelInstanceMap_; }
+        // 有効なすべてのインスタンス (画面外も反射や影に映るのでレイトレはこちらを使う)
         const std::vector<ModelInstance*>& GetDrawModels() const { return drawModels_; }
+        // 視錐台カリング後のインスタンス
+        const std::vector<ModelInstance*>& GetVisibleModels() const { return visibleModels_; }
+        const Statistics& GetStatistics() const { return statistics_; }
 
     private:
         std::map<Model*, std::vector<ModelInstance*>> modelInstanceMap_;
         std::vector<ModelInstance*> drawModels_;
+        std::vector<ModelInstance*> visibleModels_;
+
+        // カリング用の作業領域
+        Math::AABBSoA worldAABBs_;
+        std::vector<uint8_t> visibleFlags_;
+
+        Statistics statistics_{};
+        bool enableCulling_ = true;
     };
 
-}
\ No newline at end of file
+}
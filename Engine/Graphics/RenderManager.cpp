@@ -61,7 +61,24 @@ namespace LIEngine {
         DefaultTexture::Finalize();
     }
 
+    void RenderManager::Cull() {
+        auto camera = camera_.lock();
+        if (camera) {
+            modelSorter_.Sort(*camera);
+        }
+    }
+
+    void RenderManager::Submit() {
+        // シグナルを発行し待つ
+        auto& commandManager = graphics_->GetCommandManager();
+        commandManager.GetCommandQueue().WaitForIdle();
+
+        commandManager.Execute();
+        graphics_->GetReleasedObjectTracker().FrameIncrementForRelease();
+    }
+
     void RenderManager::Render() {
+        timer_.KeepFrameRate(60);
 
         uint32_t targetSwapChainBufferIndex = (swapChain_.GetCurrentBackBufferIndex() + 1) % SwapChain::kNumBuffers;
 
@@ -80,8 +97,6 @@ namespace LIEngine {
 
         if (camera && sunLight) {
             // 影、スペキュラ
-            modelSorter_.Sort(*camera);
-
             geometryRenderingPass_.Render(commandContext_, *camera, modelSorter_);
 
             pathtracer_.Dispatch(commandContext_, *camera, modelSorter_);
@@ -159,15 +174,6 @@ namespace LIEngine {
         // バックバッファをフリップ
         swapChain_.Present();
         frameCount_++;
-        // シグナルを発行し待つ
-        auto& commandManager = graphics_->GetCommandManager();
-        commandManager.GetCommandQueue().WaitForIdle();
-
-        commandManager.Execute();
-        graphics_->GetReleasedObjectTracker().FrameIncrementForRelease();
-
-        timer_.KeepFrameRate(60);
-
     }
 
 }
\ No newline at end of file
@@ -49,6 +49,21 @@ namespace LIEngine {
 
         void Initialize();
         void Finalize();
+        /// <summary>
+        /// 視錐台カリング
+        /// コマンドを積まないので、Renderより前に他の処理と並行して呼べる
+        /// </summary>
+        void Cull();
+        /// <summary>
+        /// Renderで積んだコマンドを、前に送ったコマンドの終了を待ってからGPUに送る
+        /// GPUを待つ間ブロックするので、次のフレームの更新と並行して他のスレッドから呼ぶ
+        /// Renderとは同時に呼ばない
+        /// </summary>
+        void Submit();
+        /// <summary>
+        /// フレームレートを保ち、コマンドを積んでフリップする
+        /// 先にSubmit、Cull、スキニングの行列パレット作成を終えておく
+        /// </summary>
         void Render();
 
         void SetCamera(const std::shared_ptr<Camera>& camera) { camera_ = camera; }
@@ -66,6 +81,7 @@ namespace LIEngine {
         ColorBuffer& GetPathtracingResultBuffer() { return postSpatialDenoiser_.GetDenoisedBuffer(); }
         PostEffect& GetPostEffect() { return postEffect_; }
         Sky& GetSky() { return sky_; }
+        ModelSorter& GetModelSorter() { return modelSorter_; }
 
     private:
         RenderManager() = default;
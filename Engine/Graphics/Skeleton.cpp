@@ -2,6 +2,7 @@
 
 #include <cassert>
 
+#include "Math/BatchTransform.h"
 #include "Model.h"
 #include "RenderManager.h"
 #include "SkinningManager.h"
@@ -60,11 +61,15 @@ namespace LIEngine {
 
     void Skeleton::DebugDraw(const Matrix4x4& worldMatrix) {
         auto& lineDrawer = RenderManager::GetInstance()->GetLineDrawer();
+        // ジョイントの位置をまとめてワールド空間に変換する
+        Math::Vector3SoA positions(joints_.size());
+        for (size_t i = 0; i < joints_.size(); ++i) {
+            positions.Set(i, joints_[i].skeletonSpaceMatrix.GetTranslate());
+        }
+        Math::TransformPoints(worldMatrix, positions, positions);
         for (Joint& joint : joints_) {
             if (joint.parent) {
-                Vector3 start = joint.skeletonSpaceMatrix.GetTranslate() * worldMatrix;
-                Vector3 end = joints_[*joint.parent].skeletonSpaceMatrix.GetTranslate() * worldMatrix;
-                lineDrawer.AddLine(start, end);
+                lineDrawer.AddLine(positions.Get(joint.index), positions.Get(*joint.parent));
             }
         }
     }
@@ -29,7 +29,7 @@ namespace LIEngine {
                 continue;
             }
 
-            inverseBindPoseMatrices_[(*it).second] = jointWeight.second.inverseBindPoseMatrix;
+            inverseBindPoseMatrices_[(*it).second] = Matrix3x4(jointWeight.second.inverseBindPoseMatrix);
             for (auto& vertexWeight : jointWeight.second.vertexWeights) {
                 auto& currentInfluence = mappedInfluence[vertexWeight.vertexIndex];
                 for (uint32_t index = 0; index < SkinCluster::kNumMaxInfluence; ++index) {
@@ -65,21 +65,28 @@ namespace LIEngine {
         }
         skinnedBLAS_.Create(L"Skinned BLAS", commandContext, blasDescs_, true);
 
-        Update(commandContext, skeleton);
+        BuildMatrixPalette(skeleton);
+        Update(commandContext);
     }
 
-    void SkinCluster::Update(CommandContext& commandContext, const Skeleton& skeleton) {
-        assert(matrixPaletteBuffer_.GetBufferSize() == skeleton.GetJoints().size() * sizeof(Well));
-
-        auto matrixPaletteBufferAllocation = commandContext.AllocateDynamicBuffer(LinearAllocatorType::Upload, matrixPaletteBuffer_.GetBufferSize());
+    void SkinCluster::BuildMatrixPalette(const Skeleton& skeleton) {
+        auto& joints = skeleton.GetJoints();
+        assert(joints.size() == inverseBindPoseMatrices_.size());
+        matrixPalette_.resize(joints.size());
+        for (size_t jointIndex = 0; jointIndex < joints.size(); ++jointIndex) {
+            // どちらもアフィン変換なので3x4で計算し、4x4の逆行列を避ける
+            Matrix3x4 skeletonSpaceMatrix = inverseBindPoseMatrices_[jointIndex] * Matrix3x4(joints[jointIndex].skeletonSpaceMatrix);
+            matrixPalette_[jointIndex].skeletonSpaceMatrix = skeletonSpaceMatrix.ToMatrix4x4();
+            // シェーダーでは3x3部分のみ使う
+            matrixPalette_[jointIndex].skeletonSpaceInverseTransposeMatrix = skeletonSpaceMatrix.InverseTranspose().ToMatrix4x4();
+        }
+    }
 
-        std::span<Well> mappedPalette = { reinterpret_cast<Well*>(matrixPaletteBufferAllocation.cpu), skeleton.GetJoints().size() };
-        for (size_t jointIndex = 0; jointIndex < skeleton.GetJoints().size(); ++jointIndex) {
-            assert(jointIndex < inverseBindPoseMatrices_.size());
+    void SkinCluster::Update(CommandContext& commandContext) {
+        assert(matrixPaletteBuffer_.GetBufferSize() == matrixPalette_.size() * sizeof(Well));
 
-            mappedPalette[jointIndex].skeletonSpaceMatrix = inverseBindPoseMatrices_[jointIndex] * skeleton.GetJoints()[jointIndex].skeletonSpaceMatrix;
-            mappedPalette[jointIndex].skeletonSpaceInverseTransposeMatrix = mappedPalette[jointIndex].skeletonSpaceMatrix.Inverse().Transpose();
-        }
+        auto matrixPaletteBufferAllocation = commandContext.AllocateDynamicBuffer(LinearAllocatorType::Upload, matrixPaletteBuffer_.GetBufferSize());
+        memcpy(matrixPaletteBufferAllocation.cpu, matrixPalette_.data(), matrixPaletteBuffer_.GetBufferSize());
         commandContext.CopyBufferRegion(matrixPaletteBuffer_, 0, matrixPaletteBufferAllocation.resource, matrixPaletteBufferAllocation.offset, matrixPaletteBuffer_.GetBufferSize());
         commandContext.TransitionResource(matrixPaletteBuffer_, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
         commandContext.FlushResourceBarriers();
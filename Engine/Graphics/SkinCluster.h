@@ -27,7 +27,14 @@ namespace LIEngine {
         };
 
         void Create(CommandContext& commandContext, const std::shared_ptr<Model>& model, const Skeleton& skeleton);
-        void Update(CommandContext& commandContext, const Skeleton& skeleton);
+        /// <summary>
+        /// スケルトンから行列パレットを作る (CPUのみなので他のスレッドからも呼べる)
+        /// </summary>
+        void BuildMatrixPalette(const Skeleton& skeleton);
+        /// <summary>
+        /// 作った行列パレットをGPUに送る
+        /// </summary>
+        void Update(CommandContext& commandContext);
 
         uint32_t GetNumVertices() const { return numVertices_; }
         const StructuredBuffer& GetSkinnedVertexBuffer() const { return skinnedVertexBuffer_; }
@@ -36,7 +43,8 @@ namespace LIEngine {
 
     private:
         std::shared_ptr<Model> model_;
-        std::vector<Matrix4x4> inverseBindPoseMatrices_;
+        std::vector<Matrix3x4> inverseBindPoseMatrices_;
+        std::vector<Well> matrixPalette_;
         StructuredBuffer vertexInfluenceBuffer_;
         StructuredBuffer matrixPaletteBuffer_;
         StructuredBuffer skinnedVertexBuffer_;
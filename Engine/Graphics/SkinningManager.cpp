@@ -2,6 +2,7 @@
 
 #include "Core/ShaderManager.h"
 #include "Core/CommandContext.h"
+#include "Framework/ThreadPool.h"
 
 namespace {
     const wchar_t kComputeShader[] = L"Standard/SkinningCS.hlsl";
@@ -47,22 +48,44 @@ namespace LIEngine {
         if (it != skinClusters_.end()) {
             skinClusters_.erase(it);
         }
+        isPaletteBuilt_ = false;
+    }
+
+    void SkinningManager::BuildMatrixPalettes(ThreadPool* threadPool) {
+        updatedClusters_.clear();
+        for (auto& iter : skinClusters_) {
+            if (iter.first->updated_) {
+                updatedClusters_.emplace_back(iter.first, iter.second.get());
+            }
+        }
+        auto Build = [&](size_t index) {
+            updatedClusters_[index].second->BuildMatrixPalette(*updatedClusters_[index].first);
+            };
+        if (threadPool) {
+            // スケルトンごとに分ける
+            threadPool->ParallelFor(0, updatedClusters_.size(), Build, 1);
+        }
+        else {
+            for (size_t i = 0; i < updatedClusters_.size(); ++i) { Build(i); }
+        }
+        isPaletteBuilt_ = true;
     }
 
     void SkinningManager::Update(CommandContext& commandContext) {
+        if (!isPaletteBuilt_) {
+            BuildMatrixPalettes();
+        }
+        isPaletteBuilt_ = false;
 
-        if (skinClusters_.empty()) { return; }
+        if (updatedClusters_.empty()) { return; }
 
         commandContext.SetComputeRootSignature(rootSignature_);
         commandContext.SetPipelineState(pipelineState_);
-        for (auto& iter : skinClusters_) {
-            auto skeleton = iter.first;
-            if (!skeleton->updated_) { continue; }
-            auto skinCluster = iter.second.get();
+        for (auto& [skeleton, skinCluster] : updatedClusters_) {
             auto model = skinCluster->model_.get();
             uint32_t numVertices = skinCluster->GetNumVertices();
 
-            skinCluster->Update(commandContext, *skeleton);
+            skinCluster->Update(commandContext);
 
             commandContext.TransitionResource(skinCluster->skinnedVertexBuffer_, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
             commandContext.SetComputeDescriptorTable(kMatrixPalette, skinCluster->matrixPaletteBuffer_.GetSRV());
@@ -81,6 +104,7 @@ namespace LIEngine {
             commandContext.FlushResourceBarriers();
             skeleton->updated_ = false;
         }
+        updatedClusters_.clear();
     }
 
 }
\ No newline at end of file
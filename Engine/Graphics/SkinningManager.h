@@ -2,6 +2,7 @@
 
 #include <map>
 #include <memory>
+#include <vector>
 
 #include "Core/RootSignature.h"
 #include "Core/PipelineState.h"
@@ -13,6 +14,7 @@
 namespace LIEngine {
 
     class CommandContext;
+    class ThreadPool;
 
     class SkinningManager {
     public:
@@ -29,6 +31,16 @@ namespace LIEngine {
         void Initialize();
         void Add(Skeleton* skeleton, const std::shared_ptr<Model>& model);
         void Remove(Skeleton* skeleton);
+        /// <summary>
+        /// 更新されたスケルトンの行列パレットを作る
+        /// CPUのみなのでコマンドを積む前に他の処理と並行して呼べる
+        /// </summary>
+        /// <param name="threadPool">nullptrなら呼び出したスレッドだけで作る</param>
+        void BuildMatrixPalettes(ThreadPool* threadPool = nullptr);
+        /// <summary>
+        /// 行列パレットを送り、スキニングを実行する
+        /// BuildMatrixPalettesが呼ばれていなければここで作る
+        /// </summary>
         void Update(CommandContext& commandContext);
 
         const SkinCluster* GetSkinCluster(Skeleton* key) const {
@@ -44,6 +56,9 @@ namespace LIEngine {
         PipelineState pipelineState_;
 
         std::map<Skeleton*, std::unique_ptr<SkinCluster>> skinClusters_;
+        // 行列パレットを作った更新済みのもの
+        std::vector<std::pair<Skeleton*, SkinCluster*>> updatedClusters_;
+        bool isPaletteBuilt_ = false;
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,168 @@
+#include "BatchTransform.h"
+
+#include <cassert>
+#include <cmath>
+
+#include "SIMD.h"
+
+namespace {
+
+    using namespace LIEngine;
+
+    // 行列の各要素をレーン全体に展開したもの
+    template<typename V>
+    struct MatrixLanes {
+        explicit MatrixLanes(const Matrix4x4& matrix) {
+            for (size_t i = 0; i < 4; ++i) {
+                for (size_t j = 0; j < 3; ++j) {
+                    m[i][j] = V::Set(matrix.m[i][j]);
+                }
+            }
+        }
+        V m[4][3];
+    };
+
+    template<typename V>
+    size_t TransformPointsKernel(const MatrixLanes<V>& m, const Math::Vector3SoA& in, Math::Vector3SoA& out, size_t begin) {
+        const float* inX = in.x.data();
+        const float* inY = in.y.data();
+        const float* inZ = in.z.data();
+        float* outX = out.x.data();
+        float* outY = out.y.data();
+        float* outZ = out.z.data();
+        size_t count = in.Size();
+        size_t i = begin;
+        for (; i + V::kWidth <= count; i += V::kWidth) {
+            V x = V::Load(inX + i);
+            V y = V::Load(inY + i);
+            V z = V::Load(inZ + i);
+            (x * m.m[0][0] + y * m.m[1][0] + z * m.m[2][0] + m.m[3][0]).Store(outX + i);
+            (x * m.m[0][1] + y * m.m[1][1] + z * m.m[2][1] + m.m[3][1]).Store(outY + i);
+            (x * m.m[0][2] + y * m.m[1][2] + z * m.m[2][2] + m.m[3][2]).Store(outZ + i);
+        }
+        return i;
+    }
+
+    template<typename V>
+    size_t TransformNormalsKernel(const MatrixLanes<V>& m, const Math::Vector3SoA& in, Math::Vector3SoA& out, size_t begin) {
+        const float* inX = in.x.data();
+        const float* inY = in.y.data();
+        const float* inZ = in.z.data();
+        float* outX = out.x.data();
+        float* outY = out.y.data();
+        float* outZ = out.z.data();
+        size_t count = in.Size();
+        size_t i = begin;
+        for (; i + V::kWidth <= count; i += V::kWidth) {
+            V x = V::Load(inX + i);
+            V y = V::Load(inY + i);
+            V z = V::Load(inZ + i);
+            (x * m.m[0][0] + y * m.m[1][0] + z * m.m[2][0]).Store(outX + i);
+            (x * m.m[0][1] + y * m.m[1][1] + z * m.m[2][1]).Store(outY + i);
+            (x * m.m[0][2] + y * m.m[1][2] + z * m.m[2][2]).Store(outZ + i);
+        }
+        return i;
+    }
+
+    template<typename V>
+    size_t TransformAABBsKernel(const MatrixLanes<V>& m, const Math::AABBSoA& in, Math::AABBSoA& out, size_t begin) {
+        // 回転部分の絶対値
+        V a[3][3];
+        for (size_t r = 0; r < 3; ++r) {
+            for (size_t c = 0; c < 3; ++c) {
+                a[r][c] = Abs(m.m[r][c]);
+            }
+        }
+        const V half = V::Set(0.5f);
+
+        const float* inMinX = in.min.x.data();
+        const float* inMinY = in.min.y.data();
+        const float* inMinZ = in.min.z.data();
+        const float* inMaxX = in.max.x.data();
+        const float* inMaxY = in.max.y.data();
+        const float* inMaxZ = in.max.z.data();
+        float* outMinX = out.min.x.data();
+        float* outMinY = out.min.y.data();
+        float* outMinZ = out.min.z.data();
+        float* outMaxX = out.max.x.data();
+        float* outMaxY = out.max.y.data();
+        float* outMaxZ = out.max.z.data();
+        size_t count = in.Size();
+        size_t i = begin;
+        for (; i + V::kWidth <= count; i += V::kWidth) {
+            V minX = V::Load(inMinX + i), minY = V::Load(inMinY + i), minZ = V::Load(inMinZ + i);
+            V maxX = V::Load(inMaxX + i), maxY = V::Load(inMaxY + i), maxZ = V::Load(inMaxZ + i);
+            V cx = (minX + maxX) * half, cy = (minY + maxY) * half, cz = (minZ + maxZ) * half;
+            V ex = (maxX - minX) * half, ey = (maxY - minY) * half, ez = (maxZ - minZ) * half;
+
+            V tcx = cx * m.m[0][0] + cy * m.m[1][0] + cz * m.m[2][0] + m.m[3][0];
+            V tcy = cx * m.m[0][1] + cy * m.m[1][1] + cz * m.m[2][1] + m.m[3][1];
+            V tcz = cx * m.m[0][2] + cy * m.m[1][2] + cz * m.m[2][2] + m.m[3][2];
+            V tex = ex * a[0][0] + ey * a[1][0] + ez * a[2][0];
+            V tey = ex * a[0][1] + ey * a[1][1] + ez * a[2][1];
+            V tez = ex * a[0][2] + ey * a[1][2] + ez * a[2][2];
+
+            (tcx - tex).Store(outMinX + i);
+            (tcy - tey).Store(outMinY + i);
+            (tcz - tez).Store(outMinZ + i);
+            (tcx + tex).Store(outMaxX + i);
+            (tcy + tey).Store(outMaxY + i);
+            (tcz + tez).Store(outMaxZ + i);
+        }
+        return i;
+    }
+
+}
+
+namespace LIEngine {
+
+    namespace Math {
+
+        void TransformPoints(const Matrix4x4& matrix, const Vector3SoA& in, Vector3SoA& out) {
+            out.Resize(in.Size());
+            size_t i = TransformPointsKernel(MatrixLanes<SIMD::FloatV>(matrix), in, out, 0);
+            TransformPointsKernel(MatrixLanes<SIMD::Float1>(matrix), in, out, i);
+        }
+
+        void TransformNormals(const Matrix4x4& matrix, const Vector3SoA& in, Vector3SoA& out) {
+            out.Resize(in.Size());
+            size_t i = TransformNormalsKernel(MatrixLanes<SIMD::FloatV>(matrix), in, out, 0);
+            TransformNormalsKernel(MatrixLanes<SIMD::Float1>(matrix), in, out, i);
+        }
+
+        void TransformAABBs(const Matrix4x4& matrix, const AABBSoA& in, AABBSoA& out) {
+            out.Resize(in.Size());
+            size_t i = TransformAABBsKernel(MatrixLanes<SIMD::FloatV>(matrix), in, out, 0);
+            TransformAABBsKernel(MatrixLanes<SIMD::Float1>(matrix), in, out, i);
+        }
+
+        AABB TransformAABB(const Matrix4x4& matrix, const AABB& aabb) {
+            Vector3 center = aabb.Center() * matrix;
+            Vector3 extent = aabb.Extent() * 0.5f;
+            Vector3 transformedExtent = {
+                extent.x * std::abs(matrix.m[0][0]) + extent.y * std::abs(matrix.m[1][0]) + extent.z * std::abs(matrix.m[2][0]),
+                extent.x * std::abs(matrix.m[0][1]) + extent.y * std::abs(matrix.m[1][1]) + extent.z * std::abs(matrix.m[2][1]),
+                extent.x * std::abs(matrix.m[0][2]) + extent.y * std::abs(matrix.m[1][2]) + extent.z * std::abs(matrix.m[2][2]) };
+            return { center - transformedExtent, center + transformedExtent };
+        }
+
+        void MultiplyMatrices(const Matrix4x4* lhs, const Matrix4x4& rhs, Matrix4x4* result, size_t count) {
+            // ローカルに写してresultへの書き込みでrhsを読み直さないようにする
+            const Matrix4x4 r = rhs;
+            for (size_t i = 0; i < count; ++i) {
+                Matrix4x4 tmp;
+                SIMD::MultiplyMatrix4x4(lhs[i].m, r.m, tmp.m);
+                result[i] = tmp;
+            }
+        }
+
+        void MultiplyMatrices(const Matrix4x4* lhs, const Matrix4x4* rhs, Matrix4x4* result, size_t count) {
+            assert(result != lhs && result != rhs);
+            for (size_t i = 0; i < count; ++i) {
+                SIMD::MultiplyMatrix4x4(lhs[i].m, rhs[i].m, result[i].m);
+            }
+        }
+
+    }
+
+}
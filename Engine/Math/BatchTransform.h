@@ -0,0 +1,136 @@
+///
+/// 配列の一括変換
+///
+
+#pragma once
+
+#include <vector>
+
+#include "MathUtils.h"
+#include "Geometry.h"
+
+namespace LIEngine {
+
+    namespace Math {
+
+        /// <summary>
+        /// SoA(構造体の配列ではなく配列の構造体)で持つVector3配列
+        /// </summary>
+        struct Vector3SoA {
+            Vector3SoA() = default;
+            explicit Vector3SoA(size_t count) { Resize(count); }
+
+            void Resize(size_t count) {
+                x.resize(count);
+                y.resize(count);
+                z.resize(count);
+            }
+            void Clear() {
+                x.clear();
+                y.clear();
+                z.clear();
+            }
+            void Reserve(size_t count) {
+                x.reserve(count);
+                y.reserve(count);
+                z.reserve(count);
+            }
+            void PushBack(const Vector3& v) {
+                x.push_back(v.x);
+                y.push_back(v.y);
+                z.push_back(v.z);
+            }
+            void Set(size_t index, const Vector3& v) {
+                x[index] = v.x;
+                y[index] = v.y;
+                z[index] = v.z;
+            }
+            Vector3 Get(size_t index) const { return { x[index], y[index], z[index] }; }
+            size_t Size() const { return x.size(); }
+
+            std::vector<float> x;
+            std::vector<float> y;
+            std::vector<float> z;
+        };
+
+        /// <summary>
+        /// SoAで持つAABB配列
+        /// </summary>
+        struct AABBSoA {
+            void Resize(size_t count) {
+                min.Resize(count);
+                max.Resize(count);
+            }
+            void Clear() {
+                min.Clear();
+                max.Clear();
+            }
+            void PushBack(const AABB& aabb) {
+                min.PushBack(aabb.min);
+                max.PushBack(aabb.max);
+            }
+            void Set(size_t index, const AABB& aabb) {
+                min.Set(index, aabb.min);
+                max.Set(index, aabb.max);
+            }
+            AABB Get(size_t index) const { return { min.Get(index), max.Get(index) }; }
+            size_t Size() const { return min.Size(); }
+
+            Vector3SoA min;
+            Vector3SoA max;
+        };
+
+        /// <summary>
+        /// 点を一括変換 (Vector3 * Matrix4x4と同じ)
+        /// inとoutは同じでもよい
+        /// </summary>
+        /// <param name="matrix">変換行列</param>
+        /// <param name="in">入力</param>
+        /// <param name="out">出力</param>
+        void TransformPoints(const Matrix4x4& matrix, const Vector3SoA& in, Vector3SoA& out);
+        /// <summary>
+        /// 方向を一括変換 (Matrix4x4::ApplyRotationと同じ、平行移動なし)
+        /// 非一様スケールを含む行列で法線を変換する場合は逆転置行列を渡す
+        /// inとoutは同じでもよい
+        /// </summary>
+        /// <param name="matrix">変換行列</param>
+        /// <param name="in">入力</param>
+        /// <param name="out">出力</param>
+        void TransformNormals(const Matrix4x4& matrix, const Vector3SoA& in, Vector3SoA& out);
+        /// <summary>
+        /// AABBを一括変換
+        /// 変換後の8頂点を包むAABBを中心と半径から求める
+        /// inとoutは同じでもよい
+        /// </summary>
+        /// <param name="matrix">変換行列</param>
+        /// <param name="in">入力</param>
+        /// <param name="out">出力</param>
+        void TransformAABBs(const Matrix4x4& matrix, const AABBSoA& in, AABBSoA& out);
+        /// <summary>
+        /// AABBを変換
+        /// </summary>
+        /// <param name="matrix">変換行列</param>
+        /// <param name="aabb">AABB</param>
+        /// <returns>変換後の8頂点を包むAABB</returns>
+        AABB TransformAABB(const Matrix4x4& matrix, const AABB& aabb);
+        /// <summary>
+        /// 行列の配列に同じ行列をかける result[i] = lhs[i] * rhs
+        /// ローカル行列に親の行列をかける場合など
+        /// </summary>
+        /// <param name="lhs">左辺の配列</param>
+        /// <param name="rhs">右辺</param>
+        /// <param name="result">結果の配列(lhsと同じでもよい)</param>
+        /// <param name="count">要素数</param>
+        void MultiplyMatrices(const Matrix4x4* lhs, const Matrix4x4& rhs, Matrix4x4* result, size_t count);
+        /// <summary>
+        /// 行列の配列同士をかける result[i] = lhs[i] * rhs[i]
+        /// </summary>
+        /// <param name="lhs">左辺の配列</param>
+        /// <param name="rhs">右辺の配列</param>
+        /// <param name="result">結果の配列(lhs, rhsと重なってはいけない)</param>
+        /// <param name="count">要素数</param>
+        void MultiplyMatrices(const Matrix4x4* lhs, const Matrix4x4* rhs, Matrix4x4* result, size_t count);
+
+    }
+
+}
@@ -33,6 +33,7 @@ namespace LIEngine {
             }
 
             viewProjectionMatrix_ = viewMatrix_ * projectionMatrix_;
+            frustum_ = Math::Frustum(viewProjectionMatrix_);
         }
     }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "MathUtils.h"
+#include "Geometry.h"
 
 namespace LIEngine {
 
@@ -34,6 +35,8 @@ namespace LIEngine {
         const Matrix4x4& GetViewMatrix() const { return viewMatrix_; }
         const Matrix4x4& GetProjectionMatrix() const { return projectionMatrix_; }
         const Matrix4x4& GetViewProjectionMatrix() const { return viewProjectionMatrix_; }
+        // ワールド空間の視錐台
+        const Math::Frustum& GetFrustum() const { return frustum_; }
 
         Vector3 GetForward() const { return rotate_ * Vector3::forward; }
         Vector3 GetRight() const { return rotate_ * Vector3::right; }
@@ -60,6 +63,7 @@ namespace LIEngine {
         Matrix4x4 viewMatrix_;
         Matrix4x4 projectionMatrix_;
         Matrix4x4 viewProjectionMatrix_;
+        Math::Frustum frustum_;
 
         bool needUpdateing_;
     };
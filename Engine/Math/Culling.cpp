@@ -0,0 +1,91 @@
+#include "Culling.h"
+
+#include <cmath>
+
+#include "SIMD.h"
+
+namespace {
+
+    using namespace LIEngine;
+
+    // 平面の各要素をレーン全体に展開したもの
+    template<typename V>
+    struct PlaneLanes {
+        V normalX, normalY, normalZ;
+        V absNormalX, absNormalY, absNormalZ;
+        V distance;
+    };
+
+    // 平面からAABBの最も内側の点までの符号付き距離
+    template<typename V>
+    inline V SignedDistance(const PlaneLanes<V>& plane, V cx, V cy, V cz, V ex, V ey, V ez) {
+        return
+            cx * plane.normalX + cy * plane.normalY + cz * plane.normalZ - plane.distance +
+            ex * plane.absNormalX + ey * plane.absNormalY + ez * plane.absNormalZ;
+    }
+
+    // 全平面での最小値が負なら外側
+    template<typename V>
+    size_t CullAABBsKernel(const Math::Frustum& frustum, const Math::AABBSoA& aabbs, uint8_t* visible, size_t begin) {
+        PlaneLanes<V> planes[Math::Frustum::NumPlanes];
+        for (size_t i = 0; i < Math::Frustum::NumPlanes; ++i) {
+            const Math::Plane& plane = frustum.planes[i];
+            planes[i].normalX = V::Set(plane.normal.x);
+            planes[i].normalY = V::Set(plane.normal.y);
+            planes[i].normalZ = V::Set(plane.normal.z);
+            planes[i].absNormalX = V::Set(std::abs(plane.normal.x));
+            planes[i].absNormalY = V::Set(std::abs(plane.normal.y));
+            planes[i].absNormalZ = V::Set(std::abs(plane.normal.z));
+            planes[i].distance = V::Set(plane.distance);
+        }
+        const V half = V::Set(0.5f);
+
+        const float* minX = aabbs.min.x.data();
+        const float* minY = aabbs.min.y.data();
+        const float* minZ = aabbs.min.z.data();
+        const float* maxX = aabbs.max.x.data();
+        const float* maxY = aabbs.max.y.data();
+        const float* maxZ = aabbs.max.z.data();
+        size_t count = aabbs.Size();
+        size_t i = begin;
+        for (; i + V::kWidth <= count; i += V::kWidth) {
+            V loX = V::Load(minX + i), loY = V::Load(minY + i), loZ = V::Load(minZ + i);
+            V hiX = V::Load(maxX + i), hiY = V::Load(maxY + i), hiZ = V::Load(maxZ + i);
+            V cx = (loX + hiX) * half, cy = (loY + hiY) * half, cz = (loZ + hiZ) * half;
+            V ex = (hiX - loX) * half, ey = (hiY - loY) * half, ez = (hiZ - loZ) * half;
+
+            V minDistance = SignedDistance(planes[0], cx, cy, cz, ex, ey, ez);
+            for (size_t p = 1; p < Math::Frustum::NumPlanes; ++p) {
+                minDistance = Min(minDistance, SignedDistance(planes[p], cx, cy, cz, ex, ey, ez));
+            }
+
+            float result[V::kWidth];
+            minDistance.Store(result);
+            for (size_t lane = 0; lane < V::kWidth; ++lane) {
+                visible[i + lane] = result[lane] >= 0.0f ? 1 : 0;
+            }
+        }
+        return i;
+    }
+
+}
+
+namespace LIEngine {
+
+    namespace Math {
+
+        size_t CullAABBs(const Frustum& frustum, const AABBSoA& aabbs, std::vector<uint8_t>& visible) {
+            visible.resize(aabbs.Size());
+            size_t i = CullAABBsKernel<SIMD::FloatV>(frustum, aabbs, visible.data(), 0);
+            CullAABBsKernel<SIMD::Float1>(frustum, aabbs, visible.data(), i);
+
+            size_t numVisible = 0;
+            for (uint8_t flag : visible) {
+                numVisible += flag;
+            }
+            return numVisible;
+        }
+
+    }
+
+}
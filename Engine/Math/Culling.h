@@ -0,0 +1,29 @@
+///
+/// カリング
+///
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Geometry.h"
+#include "BatchTransform.h"
+
+namespace LIEngine {
+
+    namespace Math {
+
+        /// <summary>
+        /// AABBを一括で視錐台と判定
+        /// いずれかの平面の完全に外側にあるものをカリングする
+        /// </summary>
+        /// <param name="frustum">視錐台</param>
+        /// <param name="aabbs">AABB (視錐台と同じ空間)</param>
+        /// <param name="visible">結果 見えている場合1</param>
+        /// <returns>見えている数</returns>
+        size_t CullAABBs(const Frustum& frustum, const AABBSoA& aabbs, std::vector<uint8_t>& visible);
+
+    }
+
+}
@@ -28,6 +28,47 @@ namespace LIEngine {
             return false;
         }
 
+        Frustum::Frustum(const Matrix4x4& viewProjectionMatrix) {
+            const Matrix4x4& m = viewProjectionMatrix;
+            // クリップ座標の各成分は列との内積
+            Vector4 x = m.GetColumn(0);
+            Vector4 y = m.GetColumn(1);
+            Vector4 z = m.GetColumn(2);
+            Vector4 w = m.GetColumn(3);
+            Vector4 coefficients[NumPlanes] = {
+                w + x,  // -w <= x
+                w - x,  // x <= w
+                w + y,  // -w <= y
+                w - y,  // y <= w
+                z,      // 0 <= z
+                w - z,  // z <= w
+            };
+            for (size_t i = 0; i < NumPlanes; ++i) {
+                Vector3 normal = { coefficients[i].x, coefficients[i].y, coefficients[i].z };
+                float length = normal.Length();
+                // ax + by + cz + d >= 0 を Dot(normal, p) >= distance にする
+                planes[i].normal = normal / length;
+                planes[i].distance = -coefficients[i].w / length;
+            }
+        }
+
+        bool IsCollision(const Frustum& frustum, const AABB& aabb) {
+            Vector3 center = aabb.Center();
+            Vector3 halfExtent = aabb.Extent() * 0.5f;
+            for (auto& plane : frustum.planes) {
+                float distance = Dot(plane.normal, center) - plane.distance;
+                float radius =
+                    std::abs(plane.normal.x) * halfExtent.x +
+                    std::abs(plane.normal.y) * halfExtent.y +
+                    std::abs(plane.normal.z) * halfExtent.z;
+                // 完全に外側
+                if (distance + radius < 0.0f) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
     }
 
 }
\ No newline at end of file
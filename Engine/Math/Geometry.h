@@ -17,6 +17,7 @@ namespace LIEngine {
         struct Capsule;
         struct Plane;
         struct Triangle;
+        struct Frustum;
 
 
         struct Sphere {
@@ -102,6 +103,28 @@ namespace LIEngine {
                     min.z <= point.z &&
                     point.z <= max.z;
             }
+            /// <summary>
+            /// 重なっているか
+            /// </summary>
+            /// <param name="other"></param>
+            /// <returns></returns>
+            bool Intersects(const AABB& other) const {
+                return
+                    min.x <= other.max.x &&
+                    other.min.x <= max.x &&
+                    min.y <= other.max.y &&
+                    other.min.y <= max.y &&
+                    min.z <= other.max.z &&
+                    other.min.z <= max.z;
+            }
+            /// <summary>
+            /// 表面積
+            /// </summary>
+            /// <returns></returns>
+            float SurfaceArea() const {
+                Vector3 d = max - min;
+                return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+            }
 
             Vector3 min;
             Vector3 max;
@@ -171,11 +194,39 @@ namespace LIEngine {
             float distance;
         };
 
+        /// <summary>
+        /// 視錐台
+        /// 各平面の法線は内側を向く
+        /// </summary>
+        struct Frustum {
+            enum PlaneIndex {
+                Left,
+                Right,
+                Bottom,
+                Top,
+                Near,
+                Far,
+
+                NumPlanes
+            };
+
+            Frustum() = default;
+            /// <summary>
+            /// ビュープロジェクション行列から平面を取り出す
+            /// ワールド空間の視錐台になる
+            /// </summary>
+            /// <param name="viewProjectionMatrix"></param>
+            explicit Frustum(const Matrix4x4& viewProjectionMatrix);
+
+            Plane planes[NumPlanes];
+        };
+
 
         bool IsCollision(const Sphere& sphere1, const Sphere& sphere2);
         bool IsCollision(const Sphere& sphere, const AABB& aabb);
         bool IsCollision(const Sphere& sphere, const OBB& obb);
         bool IsCollision(const OBB& obb1, const OBB& obb2);
+        bool IsCollision(const Frustum& frustum, const AABB& aabb);
     }
 
 }
\ No newline at end of file
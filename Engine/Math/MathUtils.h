@@ -2,9 +2,10 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <limits>
 
-#include <DirectXMath.h>
+#include "SIMD.h"
 
 namespace LIEngine {
 
@@ -1014,35 +1015,9 @@ namespace LIEngine {
 #pragma endregion
 #pragma region 演算子のオーバーロード
         friend inline Matrix4x4 operator*(const Matrix4x4& lhs, const Matrix4x4& rhs) noexcept {
-
-            DirectX::XMMATRIX lhsMatrix = DirectX::XMLoadFloat4x4(reinterpret_cast<const DirectX::XMFLOAT4X4*>(lhs.m));
-            DirectX::XMMATRIX rhsMatrix = DirectX::XMLoadFloat4x4(reinterpret_cast<const DirectX::XMFLOAT4X4*>(rhs.m));
-            DirectX::XMMATRIX mulMatrix = DirectX::XMMatrixMultiply(lhsMatrix, rhsMatrix);
-
             Matrix4x4 result;
-            DirectX::XMStoreFloat4x4(reinterpret_cast<DirectX::XMFLOAT4X4*>(result.m), mulMatrix);
+            SIMD::MultiplyMatrix4x4(lhs.m, rhs.m, result.m);
             return result;
-
-            //return {
-            //    lhs.m[0][0] * rhs.m[0][0] + lhs.m[0][1] * rhs.m[1][0] + lhs.m[0][2] * rhs.m[2][0] + lhs.m[0][3] * rhs.m[3][0],
-            //    lhs.m[0][0] * rhs.m[0][1] + lhs.m[0][1] * rhs.m[1][1] + lhs.m[0][2] * rhs.m[2][1] + lhs.m[0][3] * rhs.m[3][1],
-            //    lhs.m[0][0] * rhs.m[0][2] + lhs.m[0][1] * rhs.m[1][2] + lhs.m[0][2] * rhs.m[2][2] + lhs.m[0][3] * rhs.m[3][2],
-            //    lhs.m[0][0] * rhs.m[0][3] + lhs.m[0][1] * rhs.m[1][3] + lhs.m[0][2] * rhs.m[2][3] + lhs.m[0][3] * rhs.m[3][3],
-            //
-            //    lhs.m[1][0] * rhs.m[0][0] + lhs.m[1][1] * rhs.m[1][0] + lhs.m[1][2] * rhs.m[2][0] + lhs.m[1][3] * rhs.m[3][0],
-            //    lhs.m[1][0] * rhs.m[0][1] + lhs.m[1][1] * rhs.m[1][1] + lhs.m[1][2] * rhs.m[2][1] + lhs.m[1][3] * rhs.m[3][1],
-            //    lhs.m[1][0] * rhs.m[0][2] + lhs.m[1][1] * rhs.m[1][2] + lhs.m[1][2] * rhs.m[2][2] + lhs.m[1][3] * rhs.m[3][2],
-            //    lhs.m[1][0] * rhs.m[0][3] + lhs.m[1][1] * rhs.m[1][3] + lhs.m[1][2] * rhs.m[2][3] + lhs.m[1][3] * rhs.m[3][3],
-            //
-            //    lhs.m[2][0] * rhs.m[0][0] + lhs.m[2][1] * rhs.m[1][0] + lhs.m[2][2] * rhs.m[2][0] + lhs.m[2][3] * rhs.m[3][0],
-            //    lhs.m[2][0] * rhs.m[0][1] + lhs.m[2][1] * rhs.m[1][1] + lhs.m[2][2] * rhs.m[2][1] + lhs.m[2][3] * rhs.m[3][1],
-            //    lhs.m[2][0] * rhs.m[0][2] + lhs.m[2][1] * rhs.m[1][2] + lhs.m[2][2] * rhs.m[2][2] + lhs.m[2][3] * rhs.m[3][2],
-            //    lhs.m[2][0] * rhs.m[0][3] + lhs.m[2][1] * rhs.m[1][3] + lhs.m[2][2] * rhs.m[2][3] + lhs.m[2][3] * rhs.m[3][3],
-            //
-            //    lhs.m[3][0] * rhs.m[0][0] + lhs.m[3][1] * rhs.m[1][0] + lhs.m[3][2] * rhs.m[2][0] + lhs.m[3][3] * rhs.m[3][0],
-            //    lhs.m[3][0] * rhs.m[0][1] + lhs.m[3][1] * rhs.m[1][1] + lhs.m[3][2] * rhs.m[2][1] + lhs.m[3][3] * rhs.m[3][1],
-            //    lhs.m[3][0] * rhs.m[0][2] + lhs.m[3][1] * rhs.m[1][2] + lhs.m[3][2] * rhs.m[2][2] + lhs.m[3][3] * rhs.m[3][2],
-            //    lhs.m[3][0] * rhs.m[0][3] + lhs.m[3][1] * rhs.m[1][3] + lhs.m[3][2] * rhs.m[2][3] + lhs.m[3][3] * rhs.m[3][3] };
         }
         friend inline constexpr Vector3 operator*(const Vector3& lhs, const Matrix4x4& rhs) noexcept {
             return {
@@ -1154,15 +1129,8 @@ namespace LIEngine {
         float Determinant() const noexcept;
         Matrix4x4 Adjugate() const noexcept;
         inline Matrix4x4 Inverse() const noexcept {
-            //return 1.0f / Determinant() * Adjugate();
-
-            DirectX::XMMATRIX matrix = DirectX::XMLoadFloat4x4(reinterpret_cast<const DirectX::XMFLOAT4X4*>(m));
-            DirectX::XMVECTOR determinant;
-
-            DirectX::XMMATRIX inverse = DirectX::XMMatrixInverse(&determinant, matrix);
-
             Matrix4x4 result;
-            DirectX::XMStoreFloat4x4(reinterpret_cast<DirectX::XMFLOAT4X4*>(result.m), inverse);
+            SIMD::InverseMatrix4x4(m, result.m);
             return result;
         }
         inline constexpr Matrix4x4 Transpose() const noexcept {
@@ -1178,4 +1146,184 @@ namespace LIEngine {
 #pragma endregion
     };
 
+    /// <summary>
+    /// アフィン変換専用の3x4行列
+    /// Matrix4x4の上4x3部分を転置して持つ(列ベクトル形式、レイトレのインスタンス行列と同じ並び)
+    /// 最後の列(0,0,0,1)を持たない分、積と逆行列が安い
+    /// </summary>
+    class Matrix3x4 {
+    public:
+#pragma region ファクトリ関数
+        static inline constexpr Matrix3x4 MakeAffineTransform(const Vector3& scale, const Quaternion& rotate, const Vector3& translate) noexcept {
+            return Matrix3x4(Matrix4x4::MakeAffineTransform(scale, rotate, translate));
+        }
+        // 各軸と位置から
+        static inline constexpr Matrix3x4 MakeFromAxes(const Vector3& x, const Vector3& y, const Vector3& z, const Vector3& translate) noexcept {
+            return {
+                x.x, y.x, z.x, translate.x,
+                x.y, y.y, z.y, translate.y,
+                x.z, y.z, z.z, translate.z };
+        }
+#pragma endregion
+#pragma region コンストラクタ
+        inline constexpr Matrix3x4() noexcept : Matrix3x4(
+            1.0f, 0.0f, 0.0f, 0.0f,
+            0.0f, 1.0f, 0.0f, 0.0f,
+            0.0f, 0.0f, 1.0f, 0.0f) {}
+        inline constexpr Matrix3x4(
+            float _00, float _01, float _02, float _03,
+            float _10, float _11, float _12, float _13,
+            float _20, float _21, float _22, float _23) noexcept {
+            m[0][0] = _00, m[0][1] = _01, m[0][2] = _02, m[0][3] = _03;
+            m[1][0] = _10, m[1][1] = _11, m[1][2] = _12, m[1][3] = _13;
+            m[2][0] = _20, m[2][1] = _21, m[2][2] = _22, m[2][3] = _23;
+        }
+        // 射影成分(4列目)は捨てる
+        inline constexpr explicit Matrix3x4(const Matrix4x4& matrix) noexcept : Matrix3x4(
+            matrix.m[0][0], matrix.m[1][0], matrix.m[2][0], matrix.m[3][0],
+            matrix.m[0][1], matrix.m[1][1], matrix.m[2][1], matrix.m[3][1],
+            matrix.m[0][2], matrix.m[1][2], matrix.m[2][2], matrix.m[3][2]) {}
+#pragma endregion
+#pragma region 演算子のオーバーロード
+        // Matrix4x4と同じくlhsの後にrhsを適用する
+        friend inline constexpr Matrix3x4 operator*(const Matrix3x4& lhs, const Matrix3x4& rhs) noexcept {
+            Matrix3x4 result;
+            for (size_t i = 0; i < 3; ++i) {
+                for (size_t j = 0; j < 4; ++j) {
+                    result.m[i][j] = rhs.m[i][0] * lhs.m[0][j] + rhs.m[i][1] * lhs.m[1][j] + rhs.m[i][2] * lhs.m[2][j];
+                }
+                result.m[i][3] += rhs.m[i][3];
+            }
+            return result;
+        }
+        friend inline constexpr Vector3 operator*(const Vector3& lhs, const Matrix3x4& rhs) noexcept {
+            return {
+                lhs.x * rhs.m[0][0] + lhs.y * rhs.m[0][1] + lhs.z * rhs.m[0][2] + rhs.m[0][3],
+                lhs.x * rhs.m[1][0] + lhs.y * rhs.m[1][1] + lhs.z * rhs.m[1][2] + rhs.m[1][3],
+                lhs.x * rhs.m[2][0] + lhs.y * rhs.m[2][1] + lhs.z * rhs.m[2][2] + rhs.m[2][3] };
+        }
+        friend inline constexpr Matrix3x4& operator*=(Matrix3x4& lhs, const Matrix3x4& rhs) noexcept {
+            lhs = lhs * rhs;
+            return lhs;
+        }
+#pragma endregion
+#pragma region メンバ関数
+        inline constexpr Matrix4x4 ToMatrix4x4() const noexcept {
+            return {
+                m[0][0], m[1][0], m[2][0], 0.0f,
+                m[0][1], m[1][1], m[2][1], 0.0f,
+                m[0][2], m[1][2], m[2][2], 0.0f,
+                m[0][3], m[1][3], m[2][3], 1.0f };
+        }
+        // ベクトルに回転を適用
+        inline constexpr Vector3 ApplyRotation(const Vector3& vector) const noexcept {
+            return {
+                vector.x * m[0][0] + vector.y * m[0][1] + vector.z * m[0][2],
+                vector.x * m[1][0] + vector.y * m[1][1] + vector.z * m[1][2],
+                vector.x * m[2][0] + vector.y * m[2][1] + vector.z * m[2][2] };
+        }
+        inline constexpr Matrix3x4& SetXAxis(const Vector3& v) noexcept {
+            m[0][0] = v.x, m[1][0] = v.y, m[2][0] = v.z;
+            return *this;
+        }
+        inline constexpr Vector3 GetXAxis() const noexcept {
+            return { m[0][0], m[1][0], m[2][0] };
+        }
+        inline constexpr Matrix3x4& SetYAxis(const Vector3& v) noexcept {
+            m[0][1] = v.x, m[1][1] = v.y, m[2][1] = v.z;
+            return *this;
+        }
+        inline constexpr Vector3 GetYAxis() const noexcept {
+            return { m[0][1], m[1][1], m[2][1] };
+        }
+        inline constexpr Matrix3x4& SetZAxis(const Vector3& v) noexcept {
+            m[0][2] = v.x, m[1][2] = v.y, m[2][2] = v.z;
+            return *this;
+        }
+        inline constexpr Vector3 GetZAxis() const noexcept {
+            return { m[0][2], m[1][2], m[2][2] };
+        }
+        inline Vector3 GetScale() const noexcept {
+            return { GetXAxis().Length(), GetYAxis().Length(), GetZAxis().Length() };
+        }
+        inline Quaternion GetRotate() const noexcept {
+            return Quaternion::MakeFromOrthonormal(GetXAxis().Normalize(), GetYAxis().Normalize(), GetZAxis().Normalize());
+        }
+        inline constexpr Matrix3x4& SetTranslate(const Vector3& v) noexcept {
+            m[0][3] = v.x, m[1][3] = v.y, m[2][3] = v.z;
+            return *this;
+        }
+        inline constexpr Vector3 GetTranslate() const noexcept {
+            return { m[0][3], m[1][3], m[2][3] };
+        }
+        inline constexpr float Determinant() const noexcept {
+            return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+                - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+                + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+        }
+        /// <summary>
+        /// 逆行列
+        /// 3x3部分だけ余因子で逆にして平行移動を戻す
+        /// </summary>
+        inline Matrix3x4 Inverse() const noexcept {
+            Matrix3x4 cofactor = Cofactor();
+            float invDet = 1.0f / Determinant();
+            Matrix3x4 result = {
+                cofactor.m[0][0] * invDet, cofactor.m[1][0] * invDet, cofactor.m[2][0] * invDet, 0.0f,
+                cofactor.m[0][1] * invDet, cofactor.m[1][1] * invDet, cofactor.m[2][1] * invDet, 0.0f,
+                cofactor.m[0][2] * invDet, cofactor.m[1][2] * invDet, cofactor.m[2][2] * invDet, 0.0f };
+            return result.SetTranslate(-result.ApplyRotation(GetTranslate()));
+        }
+        /// <summary>
+        /// 逆行列
+        /// 回転と平行移動のみ(スケールなし)の場合に限る
+        /// </summary>
+        inline constexpr Matrix3x4 InverseOrthonormal() const noexcept {
+            Matrix3x4 result = {
+                m[0][0], m[1][0], m[2][0], 0.0f,
+                m[0][1], m[1][1], m[2][1], 0.0f,
+                m[0][2], m[1][2], m[2][2], 0.0f };
+            return result.SetTranslate(-result.ApplyRotation(GetTranslate()));
+        }
+        /// <summary>
+        /// 法線変換用の逆転置行列
+        /// 平行移動は0になる
+        /// 回転と平行移動のみの場合は逆転置は回転部分そのものなので計算不要
+        /// </summary>
+        inline Matrix3x4 InverseTranspose() const noexcept {
+            Matrix3x4 result = Cofactor();
+            float invDet = 1.0f / Determinant();
+            for (size_t i = 0; i < 3; ++i) {
+                for (size_t j = 0; j < 3; ++j) {
+                    result.m[i][j] *= invDet;
+                }
+            }
+            return result;
+        }
+#pragma endregion
+#pragma region メンバ変数
+        float m[3][4];
+#pragma endregion
+
+    private:
+        // 3x3部分の余因子行列 (平行移動は0)
+        inline constexpr Matrix3x4 Cofactor() const noexcept {
+            return {
+                m[1][1] * m[2][2] - m[1][2] * m[2][1],
+                m[1][2] * m[2][0] - m[1][0] * m[2][2],
+                m[1][0] * m[2][1] - m[1][1] * m[2][0],
+                0.0f,
+
+                m[0][2] * m[2][1] - m[0][1] * m[2][2],
+                m[0][0] * m[2][2] - m[0][2] * m[2][0],
+                m[0][1] * m[2][0] - m[0][0] * m[2][1],
+                0.0f,
+
+                m[0][1] * m[1][2] - m[0][2] * m[1][1],
+                m[0][2] * m[1][0] - m[0][0] * m[1][2],
+                m[0][0] * m[1][1] - m[0][1] * m[1][0],
+                0.0f };
+        }
+    };
+
 }
\ No newline at end of file
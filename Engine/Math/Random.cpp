@@ -0,0 +1,303 @@
+#include "Random.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+#if defined(LIENGINE_SIMD_SSE)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+    using namespace LIEngine;
+
+    constexpr uint32_t kPhiloxM0 = 0xD2511F53;
+    constexpr uint32_t kPhiloxM1 = 0xCD9E8D57;
+    constexpr uint32_t kPhiloxW0 = 0x9E3779B9;
+    constexpr uint32_t kPhiloxW1 = 0xBB67AE85;
+    constexpr size_t kPhiloxRounds = 10;
+
+    // 一括変換用の一時バッファの要素数
+    constexpr size_t kChunkSize = 256;
+
+    uint64_t SplitMix64(uint64_t x) {
+        x += 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    void MakeCounter(uint64_t block, uint64_t stream, uint32_t counter[4]) {
+        counter[0] = uint32_t(block);
+        counter[1] = uint32_t(block >> 32);
+        counter[2] = uint32_t(stream);
+        counter[3] = uint32_t(stream >> 32);
+    }
+
+#if defined(LIENGINE_SIMD_SSE)
+    // 4レーンの32bit積の上位と下位
+    inline void MulHiLo(__m128i a, __m128i m, __m128i& hi, __m128i& lo) {
+        const __m128i lowMask = _mm_set_epi32(0, -1, 0, -1);
+        __m128i even = _mm_mul_epu32(a, m);
+        __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), m);
+        lo = _mm_or_si128(_mm_and_si128(even, lowMask), _mm_slli_epi64(odd, 32));
+        hi = _mm_or_si128(_mm_srli_epi64(even, 32), _mm_andnot_si128(lowMask, odd));
+    }
+
+    // 連続する4ブロック分(16個)をまとめて生成する
+    void Philox4x32x4(uint64_t block, uint64_t stream, const uint32_t key[2], uint32_t* out) {
+        // c[i]の各レーンが1ブロックのi番目のワード
+        __m128i c0 = _mm_set_epi32(int32_t(block + 3), int32_t(block + 2), int32_t(block + 1), int32_t(block));
+        __m128i c1 = _mm_set_epi32(int32_t((block + 3) >> 32), int32_t((block + 2) >> 32), int32_t((block + 1) >> 32), int32_t(block >> 32));
+        __m128i c2 = _mm_set1_epi32(int32_t(stream));
+        __m128i c3 = _mm_set1_epi32(int32_t(stream >> 32));
+        __m128i k0 = _mm_set1_epi32(int32_t(key[0]));
+        __m128i k1 = _mm_set1_epi32(int32_t(key[1]));
+        const __m128i m0 = _mm_set1_epi32(int32_t(kPhiloxM0));
+        const __m128i m1 = _mm_set1_epi32(int32_t(kPhiloxM1));
+        const __m128i w0 = _mm_set1_epi32(int32_t(kPhiloxW0));
+        const __m128i w1 = _mm_set1_epi32(int32_t(kPhiloxW1));
+
+        for (size_t round = 0; round < kPhiloxRounds; ++round) {
+            __m128i hi0, lo0, hi1, lo1;
+            MulHiLo(c0, m0, hi0, lo0);
+            MulHiLo(c2, m1, hi1, lo1);
+            c0 = _mm_xor_si128(_mm_xor_si128(hi1, c1), k0);
+            c1 = lo1;
+            c2 = _mm_xor_si128(_mm_xor_si128(hi0, c3), k1);
+            c3 = lo0;
+            k0 = _mm_add_epi32(k0, w0);
+            k1 = _mm_add_epi32(k1, w1);
+        }
+
+        // ブロックごとの並びに転置
+        __m128i t0 = _mm_unpacklo_epi32(c0, c1);
+        __m128i t1 = _mm_unpacklo_epi32(c2, c3);
+        __m128i t2 = _mm_unpackhi_epi32(c0, c1);
+        __m128i t3 = _mm_unpackhi_epi32(c2, c3);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 0), _mm_unpacklo_epi64(t0, t1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4), _mm_unpackhi_epi64(t0, t1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), _mm_unpacklo_epi64(t2, t3));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 12), _mm_unpackhi_epi64(t2, t3));
+    }
+#endif
+
+    // 32bit乱数を一時バッファに作ってから変換する
+    template<typename T, typename Convert>
+    void FillConverted(const Random::CounterRandom& random, T* out, size_t count, uint64_t offset, Convert convert) {
+        uint32_t bits[kChunkSize];
+        for (size_t i = 0; i < count; i += kChunkSize) {
+            size_t n = std::min(kChunkSize, count - i);
+            random.FillUInt(bits, n, offset + i);
+            T* dest = out + i;
+            for (size_t j = 0; j < n; ++j) {
+                dest[j] = convert(bits[j]);
+            }
+        }
+    }
+
+}
+
+namespace LIEngine {
+
+    namespace Random {
+
+        Vector3 ToUnitVector(uint32_t bits0, uint32_t bits1) {
+            float z = 1.0f - 2.0f * ToFloatUnit(bits0);
+            float phi = Math::TwoPi * ToFloatUnit(bits1);
+            float r = std::sqrt(std::max(0.0f, 1.0f - z * z));
+            return { r * std::cos(phi), r * std::sin(phi), z };
+        }
+
+#pragma region PCG32
+        void PCG32::Advance(uint64_t delta) {
+            // LCGのdelta回分を合成した乗数と加算値を二分累乗で求める
+            uint64_t accMultiplier = 1;
+            uint64_t accIncrement = 0;
+            uint64_t curMultiplier = kMultiplier;
+            uint64_t curIncrement = increment_;
+            while (delta > 0) {
+                if (delta & 1) {
+                    accMultiplier *= curMultiplier;
+                    accIncrement = accIncrement * curMultiplier + curIncrement;
+                }
+                curIncrement = (curMultiplier + 1) * curIncrement;
+                curMultiplier *= curMultiplier;
+                delta >>= 1;
+            }
+            state_ = accMultiplier * state_ + accIncrement;
+        }
+
+        PCG32 PCG32::Split(uint64_t index) const {
+            return PCG32(SplitMix64(state_ ^ SplitMix64(index)), SplitMix64((increment_ >> 1) + index));
+        }
+
+        uint32_t PCG32::NextUIntBounded(uint32_t range) {
+            // Lemireの方法 偏りが出る範囲だけ引き直す
+            uint64_t m = uint64_t(Next()) * range;
+            uint32_t low = uint32_t(m);
+            if (low < range) {
+                uint32_t threshold = (0u - range) % range;
+                while (low < threshold) {
+                    m = uint64_t(Next()) * range;
+                    low = uint32_t(m);
+                }
+            }
+            return uint32_t(m >> 32);
+        }
+
+        void PCG32::FillUInt(uint32_t* out, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = Next();
+            }
+        }
+
+        void PCG32::FillUIntRange(uint32_t* out, size_t count, uint32_t min, uint32_t max) {
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = NextUIntRange(min, max);
+            }
+        }
+
+        void PCG32::FillIntRange(int32_t* out, size_t count, int32_t min, int32_t max) {
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = NextIntRange(min, max);
+            }
+        }
+
+        void PCG32::FillFloatUnit(float* out, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = NextFloatUnit();
+            }
+        }
+
+        void PCG32::FillFloatRange(float* out, size_t count, float min, float max) {
+            float range = max - min;
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = min + range * NextFloatUnit();
+            }
+        }
+
+        void PCG32::FillUnitVector(Vector3* out, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = NextUnitVector();
+            }
+        }
+#pragma endregion
+
+#pragma region Philox
+        void Philox4x32(const uint32_t counter[4], const uint32_t key[2], uint32_t result[4]) {
+            uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+            uint32_t k0 = key[0], k1 = key[1];
+            for (size_t round = 0; round < kPhiloxRounds; ++round) {
+                uint64_t product0 = uint64_t(kPhiloxM0) * c0;
+                uint64_t product1 = uint64_t(kPhiloxM1) * c2;
+                uint32_t hi0 = uint32_t(product0 >> 32), lo0 = uint32_t(product0);
+                uint32_t hi1 = uint32_t(product1 >> 32), lo1 = uint32_t(product1);
+                c0 = hi1 ^ c1 ^ k0;
+                c1 = lo1;
+                c2 = hi0 ^ c3 ^ k1;
+                c3 = lo0;
+                k0 += kPhiloxW0;
+                k1 += kPhiloxW1;
+            }
+            result[0] = c0, result[1] = c1, result[2] = c2, result[3] = c3;
+        }
+
+        uint32_t CounterRandom::UInt(uint64_t index) const {
+            uint32_t counter[4], result[4];
+            MakeCounter(index >> 2, stream_, counter);
+            Philox4x32(counter, key_, result);
+            return result[index & 3];
+        }
+
+        Vector3 CounterRandom::UnitVector(uint64_t index) const {
+            // 2i, 2i+1番目は同じブロックに入る
+            uint32_t counter[4], result[4];
+            MakeCounter(index >> 1, stream_, counter);
+            Philox4x32(counter, key_, result);
+            size_t lane = size_t(index & 1) * 2;
+            return ToUnitVector(result[lane], result[lane + 1]);
+        }
+
+        void CounterRandom::FillUInt(uint32_t* out, size_t count, uint64_t offset) const {
+            uint32_t counter[4], block[4];
+            // ブロックの途中から始まる場合
+            while (count > 0 && (offset & 3) != 0) {
+                *out++ = UInt(offset++);
+                --count;
+            }
+#if defined(LIENGINE_SIMD_SSE)
+            while (count >= 16) {
+                Philox4x32x4(offset >> 2, stream_, key_, out);
+                out += 16;
+                offset += 16;
+                count -= 16;
+            }
+#endif
+            while (count >= 4) {
+                MakeCounter(offset >> 2, stream_, counter);
+                Philox4x32(counter, key_, out);
+                out += 4;
+                offset += 4;
+                count -= 4;
+            }
+            if (count > 0) {
+                MakeCounter(offset >> 2, stream_, counter);
+                Philox4x32(counter, key_, block);
+                std::memcpy(out, block, sizeof(uint32_t) * count);
+            }
+        }
+
+        void CounterRandom::FillUIntRange(uint32_t* out, size_t count, uint32_t min, uint32_t max, uint64_t offset) const {
+            uint32_t range = max - min + 1;
+            if (range == 0) {
+                FillUInt(out, count, offset);
+                return;
+            }
+            FillConverted(*this, out, count, offset, [=](uint32_t bits) { return min + ToUIntBounded(bits, range); });
+        }
+
+        void CounterRandom::FillIntRange(int32_t* out, size_t count, int32_t min, int32_t max, uint64_t offset) const {
+            uint32_t range = uint32_t(max) - uint32_t(min) + 1;
+            if (range == 0) {
+                FillConverted(*this, out, count, offset, [](uint32_t bits) { return int32_t(bits); });
+                return;
+            }
+            FillConverted(*this, out, count, offset, [=](uint32_t bits) { return int32_t(uint32_t(min) + ToUIntBounded(bits, range)); });
+        }
+
+        void CounterRandom::FillFloatUnit(float* out, size_t count, uint64_t offset) const {
+            FillConverted(*this, out, count, offset, [](uint32_t bits) { return ToFloatUnit(bits); });
+        }
+
+        void CounterRandom::FillFloatRange(float* out, size_t count, float min, float max, uint64_t offset) const {
+            float range = max - min;
+            FillConverted(*this, out, count, offset, [=](uint32_t bits) { return min + range * ToFloatUnit(bits); });
+        }
+
+        void CounterRandom::FillUnitVector(Vector3* out, size_t count, uint64_t offset) const {
+            // 1つのベクトルに2つ使う
+            for (size_t i = 0; i < count; i += kChunkSize / 2) {
+                uint32_t bits[kChunkSize];
+                size_t n = std::min(kChunkSize / 2, count - i);
+                FillUInt(bits, n * 2, (offset + i) * 2);
+                for (size_t j = 0; j < n; ++j) {
+                    out[i + j] = ToUnitVector(bits[j * 2], bits[j * 2 + 1]);
+                }
+            }
+        }
+#pragma endregion
+
+        void RandomNumberGenerator::SetSeed(uint32_t seed) {
+            engine_.Seed(seed);
+        }
+
+        void RandomNumberGenerator::Randomize() {
+            std::random_device seedGenerator;
+            engine_.Seed((uint64_t(seedGenerator()) << 32) | seedGenerator());
+        }
+
+    }
+
+}
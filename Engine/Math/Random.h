@@ -1,21 +1,221 @@
 #pragma once
 
 #include <cstdint>
-#include <random>
+#include <cfloat>
+#include <climits>
+
+#include "MathUtils.h"
 
 namespace LIEngine {
 
     namespace Random {
 
+        /// <summary>
+        /// 32bitの乱数を[0,1)のfloatに変換
+        /// 上位24bitを使うので全ての値が等間隔になる
+        /// </summary>
+        inline constexpr float ToFloatUnit(uint32_t bits) { return float(bits >> 8) * (1.0f / 16777216.0f); }
+        /// <summary>
+        /// 32bitの乱数を[0,range)に変換
+        /// 乗算とシフトのみ、偏りはrange/2^32以下
+        /// </summary>
+        inline constexpr uint32_t ToUIntBounded(uint32_t bits, uint32_t range) { return uint32_t((uint64_t(bits) * range) >> 32); }
+        /// <summary>
+        /// 2つの32bitの乱数を単位球面上に一様な単位ベクトルに変換
+        /// </summary>
+        Vector3 ToUnitVector(uint32_t bits0, uint32_t bits1);
+
+        /// <summary>
+        /// PCG32 (状態16バイトの小さい逐次乱数エンジン)
+        /// std::uniform_*_distributionにそのまま渡せる
+        /// </summary>
+        class PCG32 {
+        public:
+            using result_type = uint32_t;
+            static constexpr result_type min() { return 0; }
+            static constexpr result_type max() { return UINT32_MAX; }
+
+            explicit PCG32(uint64_t seed = 0x853C49E6748FEA9Bull, uint64_t stream = 0xDA3E39CB94B95BDBull) { Seed(seed, stream); }
+
+            /// <summary>
+            /// シードとストリームをセット
+            /// 同じシードでもストリームが違えば別の系列になる
+            /// </summary>
+            /// <param name="seed">シード</param>
+            /// <param name="stream">ストリーム番号</param>
+            void Seed(uint64_t seed, uint64_t stream = 0xDA3E39CB94B95BDBull) {
+                state_ = 0;
+                increment_ = (stream << 1) | 1;
+                Next();
+                state_ += seed;
+                Next();
+            }
+
+            uint32_t operator()() { return Next(); }
+            uint32_t Next() {
+                uint64_t oldState = state_;
+                state_ = oldState * kMultiplier + increment_;
+                uint32_t xorShifted = uint32_t(((oldState >> 18) ^ oldState) >> 27);
+                uint32_t rotation = uint32_t(oldState >> 59);
+                return (xorShifted >> rotation) | (xorShifted << ((0u - rotation) & 31));
+            }
+
+            /// <summary>
+            /// delta個分読み飛ばす (O(log delta))
+            /// </summary>
+            /// <param name="delta">読み飛ばす数</param>
+            void Advance(uint64_t delta);
+            /// <summary>
+            /// 現在の状態から独立したストリームを派生させる
+            /// タスク番号などを渡せばスレッド数によらず同じ結果になる
+            /// </summary>
+            /// <param name="index">派生番号</param>
+            /// <returns></returns>
+            PCG32 Split(uint64_t index) const;
+
+            /// <summary>
+            /// [0,range)を偏りなく取得
+            /// </summary>
+            /// <param name="range"></param>
+            /// <returns></returns>
+            uint32_t NextUIntBounded(uint32_t range);
+            /// <summary>
+            /// 範囲指定して取得 (minとmaxを含む)
+            /// </summary>
+            /// <param name="min"></param>
+            /// <param name="max"></param>
+            /// <returns></returns>
+            uint32_t NextUIntRange(uint32_t min, uint32_t max) {
+                uint32_t range = max - min + 1;
+                return range == 0 ? Next() : min + NextUIntBounded(range);
+            }
+            /// <summary>
+            /// 範囲指定して取得 (minとmaxを含む)
+            /// </summary>
+            /// <param name="min"></param>
+            /// <param name="max"></param>
+            /// <returns></returns>
+            int32_t NextIntRange(int32_t min, int32_t max) {
+                return int32_t(uint32_t(min) + NextUIntRange(0u, uint32_t(max) - uint32_t(min)));
+            }
+            /// <summary>
+            /// 範囲指定して取得
+            /// </summary>
+            /// <param name="min"></param>
+            /// <param name="max"></param>
+            /// <returns></returns>
+            float NextFloatRange(float min, float max) { return min + (max - min) * NextFloatUnit(); }
+            /// <summary>
+            /// [0,1)を取得
+            /// </summary>
+            /// <returns></returns>
+            float NextFloatUnit() { return ToFloatUnit(Next()); }
+            /// <summary>
+            /// 単位ベクトルを取得
+            /// </summary>
+            /// <returns></returns>
+            Vector3 NextUnitVector() {
+                uint32_t bits0 = Next();
+                return ToUnitVector(bits0, Next());
+            }
+
+            /// <summary>
+            /// 一括取得
+            /// </summary>
+            void FillUInt(uint32_t* out, size_t count);
+            void FillUIntRange(uint32_t* out, size_t count, uint32_t min, uint32_t max);
+            void FillIntRange(int32_t* out, size_t count, int32_t min, int32_t max);
+            void FillFloatUnit(float* out, size_t count);
+            void FillFloatRange(float* out, size_t count, float min, float max);
+            void FillUnitVector(Vector3* out, size_t count);
+
+        private:
+            static constexpr uint64_t kMultiplier = 6364136223846793005ull;
+
+            uint64_t state_;
+            uint64_t increment_;
+        };
+
+        /// <summary>
+        /// Philox4x32-10
+        /// カウンターとキーから乱数を作る(状態を持たない)
+        /// </summary>
+        /// <param name="counter">カウンター</param>
+        /// <param name="key">キー</param>
+        /// <param name="result">4つの32bit乱数</param>
+        void Philox4x32(const uint32_t counter[4], const uint32_t key[2], uint32_t result[4]);
+
+        /// <summary>
+        /// カウンターベースの乱数ストリーム
+        /// i番目の値は(シード, ストリーム, i)だけで決まるので
+        /// 範囲を分けて並列に埋めてもスレッド数によらず同じ結果になる
+        /// </summary>
+        class CounterRandom {
+        public:
+            explicit CounterRandom(uint64_t seed = 0, uint64_t stream = 0) :
+                key_{ uint32_t(seed), uint32_t(seed >> 32) }, stream_(stream) {}
+
+            /// <summary>
+            /// 同じシードの別ストリームを取得
+            /// </summary>
+            /// <param name="stream">ストリーム番号(タスク番号など)</param>
+            /// <returns></returns>
+            CounterRandom Split(uint64_t stream) const {
+                CounterRandom result = *this;
+                result.stream_ = stream;
+                return result;
+            }
+
+            /// <summary>
+            /// i番目の32bit乱数
+            /// </summary>
+            uint32_t UInt(uint64_t index) const;
+            /// <summary>
+            /// i番目の[0,1)
+            /// </summary>
+            float FloatUnit(uint64_t index) const { return ToFloatUnit(UInt(index)); }
+            /// <summary>
+            /// i番目の単位ベクトル (2i, 2i+1番目の乱数を使う)
+            /// </summary>
+            Vector3 UnitVector(uint64_t index) const;
+
+            /// <summary>
+            /// offset番目からcount個を一括取得
+            /// 並列に埋める場合はoffsetに担当範囲の先頭を渡す
+            /// </summary>
+            void FillUInt(uint32_t* out, size_t count, uint64_t offset = 0) const;
+            void FillUIntRange(uint32_t* out, size_t count, uint32_t min, uint32_t max, uint64_t offset = 0) const;
+            void FillIntRange(int32_t* out, size_t count, int32_t min, int32_t max, uint64_t offset = 0) const;
+            void FillFloatUnit(float* out, size_t count, uint64_t offset = 0) const;
+            void FillFloatRange(float* out, size_t count, float min, float max, uint64_t offset = 0) const;
+            void FillUnitVector(Vector3* out, size_t count, uint64_t offset = 0) const;
+
+        private:
+            uint32_t key_[2];
+            uint64_t stream_;
+        };
+
         class RandomNumberGenerator {
         public:
-            RandomNumberGenerator(uint32_t seed = 0) : engine_((seed == 0) ? seedGenerator_() : seed) {}
+            /// <summary>
+            /// コンストラクタ
+            /// </summary>
+            /// <param name="seed">0の場合はランダムなシード</param>
+            RandomNumberGenerator(uint32_t seed = 0) {
+                if (seed == 0) { Randomize(); }
+                else { SetSeed(seed); }
+            }
 
             /// <summary>
             /// シードをセット
+            /// 0も含め、同じシードなら同じ並びになる
             /// </summary>
             /// <param name="seed"></param>
-            void SetSeed(uint32_t seed) { engine_.seed(seed); }
+            void SetSeed(uint32_t seed);
+            /// <summary>
+            /// random_deviceから取ったシードをセット
+            /// </summary>
+            void Randomize();
 
             /// <summary>
             /// 範囲指定して取得
@@ -23,7 +223,7 @@ namespace LIEngine {
             /// <param name="min"></param>
             /// <param name="max"></param>
             /// <returns></returns>
-            int32_t NextIntRange(int32_t min, int32_t max) { return std::uniform_int_distribution<int32_t>(min, max)(engine_); }
+            int32_t NextIntRange(int32_t min, int32_t max) { return engine_.NextIntRange(min, max); }
             /// <summary>
             /// intの最小値から最大値を取得
             /// </summary>
@@ -36,7 +236,7 @@ namespace LIEngine {
             /// <param name="min"></param>
             /// <param name="max"></param>
             /// <returns></returns>
-            uint32_t NextUIntRange(uint32_t min, uint32_t max) { return std::uniform_int_distribution<uint32_t>(min, max)(engine_); }
+            uint32_t NextUIntRange(uint32_t min, uint32_t max) { return engine_.NextUIntRange(min, max); }
             /// <summary>
             /// uintの最小値から最大値を取得
             /// </summary>
@@ -49,7 +249,7 @@ namespace LIEngine {
             /// <param name="min"></param>
             /// <param name="max"></param>
             /// <returns></returns>
-            float NextFloatRange(float min, float max) { return std::uniform_real_distribution<float>(min, max)(engine_); }
+            float NextFloatRange(float min, float max) { return engine_.NextFloatRange(min, max); }
             /// <summary>
             /// floatの最小値から最大値を取得
             /// </summary>
@@ -59,13 +259,14 @@ namespace LIEngine {
             /// 0~1を取得
             /// </summary>
             /// <returns></returns>
-            float NextFloatUnit() { return NextFloatRange(0.0f, 1.0f); }
+            float NextFloatUnit() { return engine_.NextFloatUnit(); }
+
+            PCG32& GetEngine() { return engine_; }
 
         private:
-            std::random_device seedGenerator_;
-            std::mt19937 engine_;
+            PCG32 engine_;
         };
 
     }
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,312 @@
+///
+/// SIMDバックエンド
+///
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// バックエンドの選択
+// LIENGINE_SIMD_FORCE_SCALAR を定義するとスカラー実装に固定する
+// AVX2はコンパイラがAVX2を有効にしている場合(/arch:AVX2, -mavx2)のみ使用する
+#if !defined(LIENGINE_SIMD_FORCE_SCALAR)
+#if defined(__AVX2__)
+#define LIENGINE_SIMD_AVX2 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || defined(LIENGINE_SIMD_AVX2)
+#define LIENGINE_SIMD_SSE 1
+#endif
+#endif
+
+#if defined(LIENGINE_SIMD_AVX2)
+#include <immintrin.h>
+#elif defined(LIENGINE_SIMD_SSE)
+#include <emmintrin.h>
+#endif
+
+namespace LIEngine {
+
+    namespace SIMD {
+
+        // すべての関数は行優先(row-major)の float[4][4] を扱う
+        // 結果の格納先は入力と重なってはいけない
+
+        namespace Scalar {
+
+            /// <summary>
+            /// 行列の積 result = lhs * rhs
+            /// </summary>
+            inline void MultiplyMatrix4x4(const float lhs[4][4], const float rhs[4][4], float result[4][4]) noexcept {
+                for (size_t i = 0; i < 4; ++i) {
+                    float l0 = lhs[i][0], l1 = lhs[i][1], l2 = lhs[i][2], l3 = lhs[i][3];
+                    for (size_t j = 0; j < 4; ++j) {
+                        result[i][j] = l0 * rhs[0][j] + l1 * rhs[1][j] + l2 * rhs[2][j] + l3 * rhs[3][j];
+                    }
+                }
+            }
+
+            /// <summary>
+            /// 逆行列
+            /// 2x2の小行列式を使い回して余因子を求める
+            /// </summary>
+            inline void InverseMatrix4x4(const float m[4][4], float result[4][4]) noexcept {
+                float s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+                float s1 = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+                float s2 = m[0][0] * m[1][3] - m[1][0] * m[0][3];
+                float s3 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+                float s4 = m[0][1] * m[1][3] - m[1][1] * m[0][3];
+                float s5 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+
+                float c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+                float c4 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+                float c3 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+                float c2 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+                float c1 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+                float c0 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+
+                float invDet = 1.0f / (s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+
+                result[0][0] = (m[1][1] * c5 - m[1][2] * c4 + m[1][3] * c3) * invDet;
+                result[0][1] = (-m[0][1] * c5 + m[0][2] * c4 - m[0][3] * c3) * invDet;
+                result[0][2] = (m[3][1] * s5 - m[3][2] * s4 + m[3][3] * s3) * invDet;
+                result[0][3] = (-m[2][1] * s5 + m[2][2] * s4 - m[2][3] * s3) * invDet;
+
+                result[1][0] = (-m[1][0] * c5 + m[1][2] * c2 - m[1][3] * c1) * invDet;
+                result[1][1] = (m[0][0] * c5 - m[0][2] * c2 + m[0][3] * c1) * invDet;
+                result[1][2] = (-m[3][0] * s5 + m[3][2] * s2 - m[3][3] * s1) * invDet;
+                result[1][3] = (m[2][0] * s5 - m[2][2] * s2 + m[2][3] * s1) * invDet;
+
+                result[2][0] = (m[1][0] * c4 - m[1][1] * c2 + m[1][3] * c0) * invDet;
+                result[2][1] = (-m[0][0] * c4 + m[0][1] * c2 - m[0][3] * c0) * invDet;
+                result[2][2] = (m[3][0] * s4 - m[3][1] * s2 + m[3][3] * s0) * invDet;
+                result[2][3] = (-m[2][0] * s4 + m[2][1] * s2 - m[2][3] * s0) * invDet;
+
+                result[3][0] = (-m[1][0] * c3 + m[1][1] * c1 - m[1][2] * c0) * invDet;
+                result[3][1] = (m[0][0] * c3 - m[0][1] * c1 + m[0][2] * c0) * invDet;
+                result[3][2] = (-m[3][0] * s3 + m[3][1] * s1 - m[3][2] * s0) * invDet;
+                result[3][3] = (m[2][0] * s3 - m[2][1] * s1 + m[2][2] * s0) * invDet;
+            }
+
+        }
+
+#if defined(LIENGINE_SIMD_SSE)
+        namespace SSE {
+
+            template<int x, int y, int z, int w>
+            inline __m128 Shuffle(__m128 a, __m128 b) noexcept {
+                return _mm_shuffle_ps(a, b, x | (y << 2) | (z << 4) | (w << 6));
+            }
+            template<int x, int y, int z, int w>
+            inline __m128 Swizzle(__m128 v) noexcept {
+                return _mm_shuffle_ps(v, v, x | (y << 2) | (z << 4) | (w << 6));
+            }
+
+            // 2x2行列(x y / z w)の演算
+            // A * B
+            inline __m128 Mat2Mul(__m128 a, __m128 b) noexcept {
+                return _mm_add_ps(_mm_mul_ps(a, Swizzle<0, 3, 0, 3>(b)), _mm_mul_ps(Swizzle<1, 0, 3, 2>(a), Swizzle<2, 1, 2, 1>(b)));
+            }
+            // adj(A) * B
+            inline __m128 Mat2AdjMul(__m128 a, __m128 b) noexcept {
+                return _mm_sub_ps(_mm_mul_ps(Swizzle<3, 3, 0, 0>(a), b), _mm_mul_ps(Swizzle<1, 1, 2, 2>(a), Swizzle<2, 3, 0, 1>(b)));
+            }
+            // A * adj(B)
+            inline __m128 Mat2MulAdj(__m128 a, __m128 b) noexcept {
+                return _mm_sub_ps(_mm_mul_ps(a, Swizzle<3, 0, 3, 0>(b)), _mm_mul_ps(Swizzle<1, 0, 3, 2>(a), Swizzle<2, 1, 2, 1>(b)));
+            }
+
+            /// <summary>
+            /// 行列の積 result = lhs * rhs
+            /// </summary>
+            inline void MultiplyMatrix4x4(const float lhs[4][4], const float rhs[4][4], float result[4][4]) noexcept {
+                __m128 r0 = _mm_loadu_ps(rhs[0]);
+                __m128 r1 = _mm_loadu_ps(rhs[1]);
+                __m128 r2 = _mm_loadu_ps(rhs[2]);
+                __m128 r3 = _mm_loadu_ps(rhs[3]);
+                for (size_t i = 0; i < 4; ++i) {
+                    __m128 row = _mm_loadu_ps(lhs[i]);
+                    __m128 v = _mm_mul_ps(Swizzle<0, 0, 0, 0>(row), r0);
+                    v = _mm_add_ps(v, _mm_mul_ps(Swizzle<1, 1, 1, 1>(row), r1));
+                    v = _mm_add_ps(v, _mm_mul_ps(Swizzle<2, 2, 2, 2>(row), r2));
+                    v = _mm_add_ps(v, _mm_mul_ps(Swizzle<3, 3, 3, 3>(row), r3));
+                    _mm_storeu_ps(result[i], v);
+                }
+            }
+
+            /// <summary>
+            /// 逆行列
+            /// 2x2のブロック行列に分けて求める
+            /// </summary>
+            inline void InverseMatrix4x4(const float m[4][4], float result[4][4]) noexcept {
+                __m128 row0 = _mm_loadu_ps(m[0]);
+                __m128 row1 = _mm_loadu_ps(m[1]);
+                __m128 row2 = _mm_loadu_ps(m[2]);
+                __m128 row3 = _mm_loadu_ps(m[3]);
+
+                // | A B |
+                // | C D |
+                __m128 a = _mm_movelh_ps(row0, row1);
+                __m128 b = _mm_movehl_ps(row1, row0);
+                __m128 c = _mm_movelh_ps(row2, row3);
+                __m128 d = _mm_movehl_ps(row3, row2);
+
+                // (|A| |B| |C| |D|)
+                __m128 detSub = _mm_sub_ps(
+                    _mm_mul_ps(Shuffle<0, 2, 0, 2>(row0, row2), Shuffle<1, 3, 1, 3>(row1, row3)),
+                    _mm_mul_ps(Shuffle<1, 3, 1, 3>(row0, row2), Shuffle<0, 2, 0, 2>(row1, row3)));
+                __m128 detA = Swizzle<0, 0, 0, 0>(detSub);
+                __m128 detB = Swizzle<1, 1, 1, 1>(detSub);
+                __m128 detC = Swizzle<2, 2, 2, 2>(detSub);
+                __m128 detD = Swizzle<3, 3, 3, 3>(detSub);
+
+                __m128 dc = Mat2AdjMul(d, c);
+                __m128 ab = Mat2AdjMul(a, b);
+                __m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), Mat2Mul(b, dc));
+                __m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), Mat2Mul(c, ab));
+                __m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), Mat2MulAdj(d, ab));
+                __m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), Mat2MulAdj(a, dc));
+
+                // |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+                __m128 detM = _mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC));
+                __m128 tr = _mm_mul_ps(ab, Swizzle<0, 2, 1, 3>(dc));
+                tr = _mm_add_ps(tr, Swizzle<2, 3, 0, 1>(tr));
+                tr = _mm_add_ps(tr, Swizzle<1, 0, 3, 2>(tr));
+                detM = _mm_sub_ps(detM, tr);
+
+                __m128 invDetM = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), detM);
+                x = _mm_mul_ps(x, invDetM);
+                y = _mm_mul_ps(y, invDetM);
+                z = _mm_mul_ps(z, invDetM);
+                w = _mm_mul_ps(w, invDetM);
+
+                _mm_storeu_ps(result[0], Shuffle<3, 1, 3, 1>(x, y));
+                _mm_storeu_ps(result[1], Shuffle<2, 0, 2, 0>(x, y));
+                _mm_storeu_ps(result[2], Shuffle<3, 1, 3, 1>(z, w));
+                _mm_storeu_ps(result[3], Shuffle<2, 0, 2, 0>(z, w));
+            }
+
+        }
+#endif // LIENGINE_SIMD_SSE
+
+#if defined(LIENGINE_SIMD_AVX2)
+        namespace AVX2 {
+
+            /// <summary>
+            /// 行列の積 result = lhs * rhs
+            /// 2行ずつ256bitで処理する
+            /// </summary>
+            inline void MultiplyMatrix4x4(const float lhs[4][4], const float rhs[4][4], float result[4][4]) noexcept {
+                __m256 r0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(rhs[0]));
+                __m256 r1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(rhs[1]));
+                __m256 r2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(rhs[2]));
+                __m256 r3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(rhs[3]));
+                for (size_t i = 0; i < 4; i += 2) {
+                    __m256 rows = _mm256_loadu_ps(lhs[i]);
+                    __m256 v = _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0x00), r0);
+                    v = _mm256_add_ps(v, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0x55), r1));
+                    v = _mm256_add_ps(v, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0xAA), r2));
+                    v = _mm256_add_ps(v, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0xFF), r3));
+                    _mm256_storeu_ps(result[i], v);
+                }
+            }
+
+            // 逆行列は依存が多く256bit化の恩恵がないのでSSEと共通
+            using SSE::InverseMatrix4x4;
+
+        }
+#endif // LIENGINE_SIMD_AVX2
+
+        // 配列を一括処理するためのレーン型
+        // カーネルはレーン型のテンプレートとして書き、端数はFloat1で処理する
+
+        struct Float1 {
+            static constexpr size_t kWidth = 1;
+
+            static inline Float1 Load(const float* p) noexcept { return { *p }; }
+            static inline Float1 Set(float s) noexcept { return { s }; }
+            inline void Store(float* p) const noexcept { *p = v; }
+
+            friend inline Float1 operator+(Float1 lhs, Float1 rhs) noexcept { return { lhs.v + rhs.v }; }
+            friend inline Float1 operator-(Float1 lhs, Float1 rhs) noexcept { return { lhs.v - rhs.v }; }
+            friend inline Float1 operator*(Float1 lhs, Float1 rhs) noexcept { return { lhs.v * rhs.v }; }
+            friend inline Float1 Min(Float1 lhs, Float1 rhs) noexcept { return { lhs.v < rhs.v ? lhs.v : rhs.v }; }
+            friend inline Float1 Max(Float1 lhs, Float1 rhs) noexcept { return { lhs.v > rhs.v ? lhs.v : rhs.v }; }
+            friend inline Float1 Abs(Float1 value) noexcept { return { value.v < 0.0f ? -value.v : value.v }; }
+            // 各レーンの lhs <= rhs をビットにして返す
+            friend inline uint32_t LessEqualMask(Float1 lhs, Float1 rhs) noexcept { return lhs.v <= rhs.v ? 1u : 0u; }
+
+            float v;
+        };
+
+#if defined(LIENGINE_SIMD_SSE)
+        struct Float4 {
+            static constexpr size_t kWidth = 4;
+
+            static inline Float4 Load(const float* p) noexcept { return { _mm_loadu_ps(p) }; }
+            static inline Float4 Set(float s) noexcept { return { _mm_set1_ps(s) }; }
+            inline void Store(float* p) const noexcept { _mm_storeu_ps(p, v); }
+
+            friend inline Float4 operator+(Float4 lhs, Float4 rhs) noexcept { return { _mm_add_ps(lhs.v, rhs.v) }; }
+            friend inline Float4 operator-(Float4 lhs, Float4 rhs) noexcept { return { _mm_sub_ps(lhs.v, rhs.v) }; }
+            friend inline Float4 operator*(Float4 lhs, Float4 rhs) noexcept { return { _mm_mul_ps(lhs.v, rhs.v) }; }
+            friend inline Float4 Min(Float4 lhs, Float4 rhs) noexcept { return { _mm_min_ps(lhs.v, rhs.v) }; }
+            friend inline Float4 Max(Float4 lhs, Float4 rhs) noexcept { return { _mm_max_ps(lhs.v, rhs.v) }; }
+            friend inline Float4 Abs(Float4 value) noexcept { return { _mm_andnot_ps(_mm_set1_ps(-0.0f), value.v) }; }
+            friend inline uint32_t LessEqualMask(Float4 lhs, Float4 rhs) noexcept { return uint32_t(_mm_movemask_ps(_mm_cmple_ps(lhs.v, rhs.v))); }
+
+            __m128 v;
+        };
+#endif // LIENGINE_SIMD_SSE
+
+#if defined(LIENGINE_SIMD_AVX2)
+        struct Float8 {
+            static constexpr size_t kWidth = 8;
+
+            static inline Float8 Load(const float* p) noexcept { return { _mm256_loadu_ps(p) }; }
+            static inline Float8 Set(float s) noexcept { return { _mm256_set1_ps(s) }; }
+            inline void Store(float* p) const noexcept { _mm256_storeu_ps(p, v); }
+
+            friend inline Float8 operator+(Float8 lhs, Float8 rhs) noexcept { return { _mm256_add_ps(lhs.v, rhs.v) }; }
+            friend inline Float8 operator-(Float8 lhs, Float8 rhs) noexcept { return { _mm256_sub_ps(lhs.v, rhs.v) }; }
+            friend inline Float8 operator*(Float8 lhs, Float8 rhs) noexcept { return { _mm256_mul_ps(lhs.v, rhs.v) }; }
+            friend inline Float8 Min(Float8 lhs, Float8 rhs) noexcept { return { _mm256_min_ps(lhs.v, rhs.v) }; }
+            friend inline Float8 Max(Float8 lhs, Float8 rhs) noexcept { return { _mm256_max_ps(lhs.v, rhs.v) }; }
+            friend inline Float8 Abs(Float8 value) noexcept { return { _mm256_andnot_ps(_mm256_set1_ps(-0.0f), value.v) }; }
+            friend inline uint32_t LessEqualMask(Float8 lhs, Float8 rhs) noexcept { return uint32_t(_mm256_movemask_ps(_mm256_cmp_ps(lhs.v, rhs.v, _CMP_LE_OQ))); }
+
+            __m256 v;
+        };
+#endif // LIENGINE_SIMD_AVX2
+
+#if defined(LIENGINE_SIMD_AVX2)
+        namespace Backend = AVX2;
+        using FloatV = Float8;
+        inline constexpr const char* kBackendName = "AVX2";
+#elif defined(LIENGINE_SIMD_SSE)
+        namespace Backend = SSE;
+        using FloatV = Float4;
+        inline constexpr const char* kBackendName = "SSE";
+#else
+        namespace Backend = Scalar;
+        using FloatV = Float1;
+        inline constexpr const char* kBackendName = "Scalar";
+#endif
+
+        /// <summary>
+        /// 選択されたバックエンドで行列の積を求める
+        /// </summary>
+        inline void MultiplyMatrix4x4(const float lhs[4][4], const float rhs[4][4], float result[4][4]) noexcept {
+            Backend::MultiplyMatrix4x4(lhs, rhs, result);
+        }
+
+        /// <summary>
+        /// 選択されたバックエンドで逆行列を求める
+        /// </summary>
+        inline void InverseMatrix4x4(const float m[4][4], float result[4][4]) noexcept {
+            Backend::InverseMatrix4x4(m, result);
+        }
+
+    }
+
+}
@@ -30,7 +30,8 @@ namespace LIEngine {
             parent_ = parent;
             // 新しい親がいる場合親空間のローカルにする
             if (parent_) {
-                Matrix4x4 localMatrix = worldMatrix * parent_->worldMatrix.Inverse();
+                // ワールド行列はアフィン変換なので3x4の逆行列で足りる
+                Matrix3x4 localMatrix = Matrix3x4(worldMatrix) * Matrix3x4(parent_->worldMatrix).Inverse();
                 scale = localMatrix.GetScale();
                 rotate = localMatrix.GetRotate();
                 translate = localMatrix.GetTranslate();
@@ -1,14 +1,19 @@
 #include "SceneIO.h"
 
 #include <cassert>
-#include <fstream>
+#include <memory>
 #include <queue>
+#include <vector>
 
 #include "Framework/Engine.h"
 #include "GameObject/GameObjectManager.h"
 #include "Framework/AssetManager.h"
+#include "Framework/AssetLoadGraph.h"
+#include "Graphics/Model.h"
+#include "Graphics/Core/TextureLoader.h"
 #include "Externals/nlohmann/json.hpp"
 #include "File/JsonConverter.h"
+#include "File/VirtualFileSystem.h"
 
 namespace {
 
@@ -59,8 +64,39 @@ namespace {
         }
     }
 
-    // アセットを読み込む
-    void LoadAssets(const nlohmann::json& assets) {
+    // 読み込み中のシーン
+    struct PendingScene {
+        std::string name;
+        // アセットがそろってから構築する
+        nlohmann::json objects;
+        AssetLoadGraph loadGraph;
+    };
+
+    // メインスレッドからのみ触る
+    std::unique_ptr<PendingScene> g_pendingScene;
+    std::function<void(const std::string&)> g_readyCallback;
+
+    // 名前とパスだけ先に表に登録する (読み込みはグラフのタスクで)
+    template<class T>
+    std::shared_ptr<T> AddAsset(AssetMap<T>& map, const std::filesystem::path& path, const std::string& name) {
+        auto asset = std::make_shared<T>();
+        asset->SetName(name);
+        asset->SetPath(path);
+        map.Add(asset);
+        return asset;
+    }
+
+    // 呼び出したタスクで読み込む
+    // 表に載っていてメインスレッドから見えるので、名前とパスは書き換えない
+    // Loadで積んだタスクが始まっていなければ、WaitForLoadがこのスレッドで実行する
+    void LoadInTask(Asset& asset) {
+        asset.Load();
+        asset.WaitForLoad();
+    }
+
+    // アセットごとに読み込みのタスクを組み立てる
+    // モデルはマテリアルのテクスチャを先に別のタスクで読み込み、モデルの読み込みがテクスチャを待たないようにする
+    void PlanAssets(const nlohmann::json& assets, AssetLoadGraph& loadGraph) {
         assert(assets.is_array());
         auto assetManager = Engine::GetAssetManager();
 
@@ -68,36 +104,45 @@ namespace {
             if (asset.contains("type")) {
                 assert(asset.contains("path") && asset.contains("name"));
                 Asset::Type type = static_cast<Asset::Type>(asset.at("type"));
+                std::filesystem::path path = asset.at("path").get<std::string>();
+                std::string name = asset.at("name").get<std::string>();
                 switch (type)
                 {
                 case Asset::Type::Texture: {
-                    auto texture = std::make_shared<TextureAsset>();
-                    texture->Load(asset.at("path"), asset.at("name"));
-                    assetManager->textureMap.Add(texture);
+                    auto texture = AddAsset(assetManager->textureMap, path, name);
+                    loadGraph.AddTask("Texture " + name, [texture]() { LoadInTask(*texture); });
                     break;
                 }
                 case Asset::Type::Model: {
-                    auto model = std::make_shared<ModelAsset>();
-                    model->Load(asset.at("path"), asset.at("name"));
-                    assetManager->modelMap.Add(model);
+                    auto model = AddAsset(assetManager->modelMap, path, name);
+                    // モデルが読み込むまでResidencyに解放されないよう持っておく
+                    // 他のモデルと同じテクスチャはTextureLoaderが1回だけ読み込む
+                    auto textures = std::make_shared<std::vector<std::shared_ptr<TextureResource>>>();
+                    // 焼いたファイルはここで1回だけ読み、モデルの読み込みに渡す
+                    auto texturesTask = loadGraph.AddTask("ModelTextures " + name, [model, textures, path]() {
+                        auto source = Model::ReadSource(path);
+                        *textures = TextureLoader::Load(Model::GetTextureRequests(*source));
+                        model->SetSource(std::move(source));
+                        });
+                    loadGraph.AddTask("Model " + name, [model, textures]() {
+                        LoadInTask(*model);
+                        textures->clear();
+                        }, { texturesTask });
                     break;
                 }
                 case Asset::Type::Material: {
-                    auto material = std::make_shared<MaterialAsset>();
-                    material->Load(asset.at("path"), asset.at("name"));
-                    assetManager->materialMap.Add(material);
+                    auto material = AddAsset(assetManager->materialMap, path, name);
+                    loadGraph.AddTask("Material " + name, [material]() { LoadInTask(*material); });
                     break;
                 }
                 case Asset::Type::Animation: {
-                    auto animation = std::make_shared<AnimationAsset>();
-                    animation->Load(asset.at("path"), asset.at("name"));
-                    assetManager->animationMap.Add(animation);
+                    auto animation = AddAsset(assetManager->animationMap, path, name);
+                    loadGraph.AddTask("Animation " + name, [animation]() { LoadInTask(*animation); });
                     break;
                 }
                 case Asset::Type::Sound: {
-                    auto sound = std::make_shared<SoundAsset>();
-                    sound->Load(asset.at("path"), asset.at("name"));
-                    assetManager->soundMap.Add(sound);
+                    auto sound = AddAsset(assetManager->soundMap, path, name);
+                    loadGraph.AddTask("Sound " + name, [sound]() { LoadInTask(*sound); });
                     break;
                 }
                 default:
@@ -116,32 +161,89 @@ namespace LIEngine {
 
         void Load(const std::filesystem::path& path) {
 
+            // 読み込み中のシーンは終わるのを待ってから捨てる
+            if (g_pendingScene) {
+                g_pendingScene->loadGraph.Wait();
+                g_pendingScene.reset();
+            }
+
             // 既存シーンをクリア
             Engine::GetGameObjectManager()->Clear();
             Engine::GetAssetManager()->Clear();
 
-            // ファイルを読み込む
-            std::ifstream file(path);
-            assert(file.is_open());
-
-            nlohmann::json json;
-            file >> json;
+            // ファイルを読み込む (アーカイブ内でもディスクでも)
+            FileData file;
+            bool isRead = VirtualFileSystem::ReadFile(path, file);
+            assert(isRead);
+            isRead;
 
-            file.close();
+            nlohmann::json json = nlohmann::json::parse(file.GetData(), file.GetData() + file.GetSize());
 
             assert(json.is_object());
             assert(json.contains("name"));
             assert(json.at("name").is_string());
 
-            auto sceneName = json.at("name").get<std::string>();
+            auto scene = std::make_unique<PendingScene>();
+            scene->name = json.at("name").get<std::string>();
 
             if (json.contains("objects")) {
-                BuildScene(json.at("objects"));
+                scene->objects = std::move(json.at("objects"));
             }
 
+            // ゲームオブジェクトがアセットを名前で引けるよう、先に登録して読み込み始める
             if (json.contains("assets")) {
-                LoadAssets(json.at("assets"));
+                PlanAssets(json.at("assets"), scene->loadGraph);
+            }
+            scene->loadGraph.Start(*Engine::GetThreadPool());
+            g_pendingScene = std::move(scene);
+        }
+
+        void Update() {
+            if (!g_pendingScene || !g_pendingScene->loadGraph.IsReady()) {
+                return;
+            }
+            auto scene = std::move(g_pendingScene);
+            if (!scene->objects.is_null()) {
+                BuildScene(scene->objects);
+            }
+            if (g_readyCallback) {
+                g_readyCallback(scene->name);
+            }
+        }
+
+        void WaitForLoad() {
+            if (g_pendingScene) {
+                g_pendingScene->loadGraph.Wait();
+            }
+            Update();
+        }
+
+        bool IsLoading() {
+            return g_pendingScene != nullptr;
+        }
+
+        LoadProgress GetProgress() {
+            LoadProgress progress;
+            if (g_pendingScene) {
+                auto graphProgress = g_pendingScene->loadGraph.GetProgress();
+                progress.numCompleted = graphProgress.numCompleted;
+                progress.numTasks = graphProgress.numTasks;
+                progress.isLoading = true;
+            }
+            return progress;
+        }
+
+        void SetReadyCallback(std::function<void(const std::string&)> callback) {
+            g_readyCallback = std::move(callback);
+        }
+
+        void Finalize() {
+            // 読み込み中のタスクがスレッドプールより先に終わるように
+            if (g_pendingScene) {
+                g_pendingScene->loadGraph.Wait();
+                g_pendingScene.reset();
             }
+            g_readyCallback = nullptr;
         }
 
         void Save(const std::filesystem::path& path) {
@@ -1,15 +1,50 @@
 #pragma once
 
 #include <filesystem>
+#include <functional>
+#include <string>
 
 namespace LIEngine {
 
     namespace SceneIO {
+        /// <summary>
+        /// 読み込みの進み具合
+        /// </summary>
+        struct LoadProgress {
+            // 終わった読み込みタスク数と全体のタスク数
+            size_t numCompleted = 0;
+            size_t numTasks = 0;
+            bool isLoading = false;
+        };
+
         /// <summary>
         ///  シーンをロード
+        /// アセットを表に登録して依存順に並列で読み込み始め、終わるのを待たずに戻る
+        /// ゲームオブジェクトはアセットがそろってからUpdateで構築する
         /// </summary>
         /// <param name="path"></param>
         void Load(const std::filesystem::path& path);
+        /// <summary>
+        /// 読み込みが終わっていればゲームオブジェクトを構築し、準備完了を通知する
+        /// メインスレッドで毎フレーム呼ぶ
+        /// </summary>
+        void Update();
+        /// <summary>
+        /// 読み込みが終わるまで待ち、ゲームオブジェクトを構築する
+        /// </summary>
+        void WaitForLoad();
+        bool IsLoading();
+        LoadProgress GetProgress();
+        /// <summary>
+        /// 準備ができた (アセットがそろい、ゲームオブジェクトを構築した) ときに呼ぶ関数
+        /// メインスレッドから呼ぶ
+        /// </summary>
+        /// <param name="callback">void(const std::string& シーン名)</param>
+        void SetReadyCallback(std::function<void(const std::string&)> callback);
+        /// <summary>
+        /// 読み込み中なら終わるのを待って捨てる (スレッドプールを破棄する前に呼ぶ)
+        /// </summary>
+        void Finalize();
 
         /// <summary>
         /// シーンをセーブ
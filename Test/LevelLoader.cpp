@@ -8,24 +8,32 @@
 #include "CameraComponent.h"
 #include "Collision/Collider.h"
 #include "Collision/CollisionManager.h"
+#include "Framework/AssetManager.h"
+#include "File/VirtualFileSystem.h"
 
 namespace LevelLoader {
 
     using namespace LIEngine;
 
     void Load(const std::filesystem::path& path, GameObjectManager& gameObjectManager) {
-        std::ifstream file(path);
-        assert(file.is_open());
+        FileData file;
+        bool isRead = VirtualFileSystem::ReadFile(path, file);
+        assert(isRead);
+        isRead;
 
-        nlohmann::json json;
-        file >> json;
-
-        file.close();
+        nlohmann::json json = nlohmann::json::parse(file.GetData(), file.GetData() + file.GetSize());
 
         assert(json.is_object());
         assert(json.contains("name"));
         assert(json.at("name").is_string() && json.at("name").get<std::string>() == "scene");
 
+        // 小さいコライダーが密集するレベルはグリッドを選べる
+        if (json.contains("broadphase")) {
+            auto& broadphase = json.at("broadphase");
+            BroadphaseType type = broadphase.at("type") == "HASH_GRID" ? BroadphaseType::HashGrid : BroadphaseType::Tree;
+            CollisionManager::GetInstance()->SetBroadphase(type, broadphase.value("cell_size", 2.0f));
+        }
+
         for (auto& object : json.at("objects")) {
             if (object.contains("disabled")) {
                 bool disabled = object["disabled"].get<bool>();
@@ -61,6 +69,16 @@ namespace LevelLoader {
                     component->SetCenter(center);
                     component->SetSize(size);
                 }
+                else if (collider.at("type") == "MESH" && object.contains("model_name")) {
+                    // 見た目と同じモデルの三角形で判定する
+                    auto asset = AssetManager::GetInstance()->modelMap.Get(object.at("model_name"));
+                    if (asset && asset->IsReady()) {
+                        auto component = gameObject->AddComponent<MeshCollider>();
+                        component->SetModel(asset->Get());
+                        gameObject->transform.UpdateMatrix();
+                        component->SetWorldMatrix(gameObject->transform.worldMatrix);
+                    }
+                }
             }
             gameObjectManager.AddGameObject(gameObject);
         }
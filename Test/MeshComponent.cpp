@@ -10,7 +10,7 @@ using namespace LIEngine;
 void MeshComponent::Initialize() {
     if (!modelName_.empty()) {
         auto assetManager = AssetManager::GetInstance();
-        asset_ = assetManager->modelMap.Get(modelName_);
+        asset_ = assetManager->modelMap.FindHandle(modelName_);
         ApplyModel();
     }
 
@@ -27,12 +27,14 @@ void MeshComponent::Update() {
 void MeshComponent::Edit() {
 #ifdef ENABLE_IMGUI
 
-    if (ImGui::BeginCombo("Model", asset_->GetName().c_str())) {
-        AssetManager::GetInstance()->modelMap.ForEach([this](const std::shared_ptr<ModelAsset>& asset) {
-            bool isSelected = asset->GetName() == asset_->GetName();
+    auto& modelMap = AssetManager::GetInstance()->modelMap;
+    auto current = modelMap.Get(asset_);
+    if (ImGui::BeginCombo("Model", current ? current->GetName().c_str() : modelName_.c_str())) {
+        modelMap.ForEach([&](const std::shared_ptr<ModelAsset>& asset) {
+            bool isSelected = asset == current;
             if (ImGui::Selectable(asset->GetName().c_str(), isSelected) && asset->IsReady()) {
-                asset_ = asset;
-                modelName_ = asset_->GetName();
+                modelName_ = asset->GetName();
+                asset_ = modelMap.FindHandle(modelName_);
                 ApplyModel();
             }
             if (isSelected) {
@@ -71,8 +73,9 @@ void MeshComponent::Import(const nlohmann::json& json) {
 }
 
 void MeshComponent::ApplyModel() {
-    assert(asset_);
-    model_.SetModel(asset_->Get());
+    auto asset = AssetManager::GetInstance()->modelMap.Get(asset_);
+    assert(asset);
+    model_.SetModel(asset->Get());
     customMaterial_ = std::shared_ptr<Material>();
 
     if (model_.GetModel()->GetMaterials().size() <= 2) {
@@ -1,6 +1,7 @@
 #pragma once
 #include "GameObject/Component.h"
 
+#include "Framework/AssetHandle.h"
 #include "Framework/ModelAsset.h"
 #include "Graphics/Model.h"
 
@@ -40,6 +41,7 @@ private:
 
     LIEngine::ModelInstance model_;
     std::shared_ptr<LIEngine::Material> customMaterial_;
-    std::shared_ptr<LIEngine::ModelAsset> asset_;
+    // 名前で引くのは初期化時のみ (削除されると取得できなくなる)
+    LIEngine::AssetHandle<LIEngine::ModelAsset> asset_;
     std::string modelName_;
 };
\ No newline at end of file
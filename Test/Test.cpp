@@ -13,6 +13,7 @@
 #include "Graphics/Animation.h"
 #include "Graphics/Sprite.h"
 #include "Graphics/Core/TextureLoader.h"
+#include "File/VirtualFileSystem.h"
 #include "Debug/Debug.h"
 
 #include "TestScene.h"
@@ -25,7 +26,12 @@ namespace {
     const char kResourceAssociationFile[] = "Resources/Association.json";
 }
 
+const char Test::kResourceArchiveFile[] = "Resources.pak";
+
 void Test::OnInitialize() {
+    // まとめたアーカイブがあればそこから読む (無ければResources以下をそのまま読む)
+    VirtualFileSystem::Mount(kResourceArchiveFile);
+
     auto gameObjectManager = Engine::GetGameObjectManager();
     gameObjectManager->SetFactory<DemoGameObjectFactory>();
     gameObjectManager->SetComponentRegisterer<DemoComponentRegisterer>();
@@ -38,16 +44,16 @@ void Test::OnInitialize() {
 }
 
 void Test::OnFinalize() {
+    VirtualFileSystem::UnmountAll();
 }
 
 void Test::LoadResource() {
-    std::ifstream file;
-    file.open(kResourceAssociationFile);
-    assert(file.is_open());
+    FileData file;
+    bool isRead = VirtualFileSystem::ReadFile(kResourceAssociationFile, file);
+    assert(isRead);
+    isRead;
 
-    nlohmann::json json;
-    file >> json;
-    file.close();
+    nlohmann::json json = nlohmann::json::parse(file.GetData(), file.GetData() + file.GetSize());
 
 
     AssetManager* assetManager = AssetManager::GetInstance();
@@ -4,6 +4,8 @@
 class Test :
     public LIEngine::Game {
 public:
+    // Resources以下をまとめたアーカイブ
+    static const char kResourceArchiveFile[];
 
     /// <summary>
     /// 初期化
@@ -1,11 +1,19 @@
 #include <Windows.h>
 
+#include <string_view>
+
 #include "Framework/Engine.h"
+#include "File/AssetArchive.h"
 #include "Test.h"
 
 using namespace LIEngine;
 
-int WINAPI WinMain(_In_ HINSTANCE, _In_opt_ HINSTANCE, _In_ LPSTR, _In_ int) {
+int WINAPI WinMain(_In_ HINSTANCE, _In_opt_ HINSTANCE, _In_ LPSTR commandLine, _In_ int) {
+
+    // -pack でResources以下をアーカイブにまとめて終了
+    if (std::string_view(commandLine).find("-pack") != std::string_view::npos) {
+        return AssetArchive::Build("Resources", Test::kResourceArchiveFile) ? 0 : 1;
+    }
 
     Game* game = new Test;
     Engine::Run(game);